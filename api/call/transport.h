@@ -35,6 +35,11 @@ struct PacketOptions {
   bool is_retransmit = false;
   bool included_in_feedback = false;
   bool included_in_allocation = false;
+  // Whether the packet is part of a burst that the socket may send together
+  // with the rest of it, and whether it ends that burst. See
+  // rtc::PacketOptions.
+  bool batchable = false;
+  bool last_packet_in_batch = false;
 };
 
 class Transport {
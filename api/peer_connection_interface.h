@@ -116,6 +116,7 @@
 #include "rtc_base/network.h"
 #include "rtc_base/rtc_certificate.h"
 #include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/rtc_certificate_pool.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/ssl_certificate.h"
 #include "rtc_base/ssl_stream_adapter.h"
@@ -647,6 +648,13 @@ class RTC_EXPORT PeerConnectionInterface : public rtc::RefCountInterface {
     // settings set in PeerConnectionFactory (which is deprecated).
     absl::optional<CryptoOptions> crypto_options;
 
+    // If positive, SRTP protection of outgoing RTP packets is done on this
+    // many threads, with the packets of an SSRC always protected by the same
+    // thread. Meant for senders with many outgoing streams, such as selective
+    // forwarding servers, for which encryption on the network thread alone is
+    // the bottleneck. Ignored when external auth is used.
+    int srtp_crypto_worker_count = 0;
+
     // Configure if we should include the SDP attribute extmap-allow-mixed in
     // our offer. Although we currently do support this, it's not included in
     // our offer by default due to a previous bug that caused the SDP parser to
@@ -1390,6 +1398,19 @@ class RTC_EXPORT PeerConnectionFactoryInterface
     // party supports DTLS 1.0 and the other DTLS 1.2, DTLS 1.0 will be used.
     rtc::SSLProtocolVersion ssl_max_version = rtc::SSL_PROTOCOL_DTLS_12;
 
+    // If set to true, DTLS sessions are cached by the factory and resumed when
+    // a later PeerConnection connects to a peer with the same certificate.
+    // Resumed handshakes take one round trip less and skip the key exchange,
+    // which helps servers when many peers reconnect at once.
+    bool enable_dtls_session_resumption = false;
+
+    // If set, PeerConnections that are created without a certificate or
+    // certificate generator of their own take their certificate from a pool
+    // that the factory keeps filled in the background, instead of waiting
+    // for one to be generated. The pool is created by the first SetOptions()
+    // call that sets this; later changes to the config have no effect.
+    absl::optional<rtc::RTCCertificatePool::Config> certificate_pool;
+
     // Sets crypto related options, e.g. enabled cipher suites.
     CryptoOptions crypto_options = CryptoOptions::NoGcm();
   };
@@ -62,6 +62,246 @@ const char EMPTY_TRANSACTION_ID[] = "0000000000000000";
 const uint32_t STUN_FINGERPRINT_XOR_VALUE = 0x5354554E;
 const int SERVER_NOT_REACHABLE_ERROR = 701;
 
+static size_t PaddedLength(size_t length) {
+  return (length + 3) & ~size_t{3};
+}
+
+// Computes the MESSAGE-INTEGRITY of a message in |data| whose M-I attribute of
+// |mi_attr_size| bytes is at |mi_pos|, using the procedure outlined in
+// RFC 5389, section 15.4. The HMAC covers the message up to the attribute,
+// with the length in the header adjusted to end right after it; hashing the
+// header in pieces avoids copying the message to adjust that length.
+static void ComputeMessageIntegrity(const rtc::HmacSha1& key,
+                                    const char* data,
+                                    size_t mi_pos,
+                                    size_t mi_attr_size,
+                                    char hmac[kStunMessageIntegritySize]) {
+  static_assert(rtc::HmacSha1::kSize == kStunMessageIntegritySize, "");
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  uint8_t adjusted_length[2];
+  rtc::SetBE16(adjusted_length,
+               static_cast<uint16_t>(mi_pos + kStunAttributeHeaderSize +
+                                     mi_attr_size - kStunHeaderSize));
+  key.Compute({rtc::MakeArrayView(bytes, 2), adjusted_length,
+               rtc::MakeArrayView(bytes + 4, mi_pos - 4)},
+              reinterpret_cast<uint8_t*>(hmac));
+}
+
+// StunMessageView
+
+StunMessageView::Attribute StunMessageView::Iterator::operator*() const {
+  RTC_DCHECK(pos_ != end_);
+  Attribute attribute;
+  attribute.type = rtc::GetBE16(pos_);
+  attribute.value = rtc::ArrayView<const uint8_t>(
+      pos_ + kStunAttributeHeaderSize, rtc::GetBE16(pos_ + 2));
+  return attribute;
+}
+
+StunMessageView::Iterator& StunMessageView::Iterator::operator++() {
+  RTC_DCHECK(pos_ != end_);
+  size_t padded_length = PaddedLength(rtc::GetBE16(pos_ + 2));
+  pos_ += kStunAttributeHeaderSize;
+  pos_ += std::min<size_t>(padded_length, end_ - pos_);
+  return *this;
+}
+
+bool StunMessageView::Parse(const char* data, size_t size) {
+  *this = StunMessageView();
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  if (size < kStunHeaderSize) {
+    return false;
+  }
+  // RTP and RTCP set the MSB of first byte, since first two bits are version,
+  // and version is always 2 (10). If set, this is not a STUN packet.
+  if (bytes[0] & 0x80) {
+    return false;
+  }
+  if (rtc::GetBE16(bytes + 2) != size - kStunHeaderSize) {
+    return false;
+  }
+
+  size_t last_attribute_offset = 0;
+  size_t pos = kStunHeaderSize;
+  while (pos < size) {
+    if (size - pos < kStunAttributeHeaderSize) {
+      return false;
+    }
+    size_t attr_length = rtc::GetBE16(bytes + pos + 2);
+    last_attribute_offset = pos;
+    pos += kStunAttributeHeaderSize;
+    if (size - pos < attr_length) {
+      return false;
+    }
+    pos += std::min(PaddedLength(attr_length), size - pos);
+  }
+
+  data_ = bytes;
+  size_ = size;
+  last_attribute_offset_ = last_attribute_offset;
+  return true;
+}
+
+int StunMessageView::type() const {
+  RTC_DCHECK(!empty());
+  return rtc::GetBE16(data_);
+}
+
+size_t StunMessageView::length() const {
+  RTC_DCHECK(!empty());
+  return size_ - kStunHeaderSize;
+}
+
+bool StunMessageView::IsLegacy() const {
+  RTC_DCHECK(!empty());
+  return rtc::GetBE32(data_ + kStunTransactionIdOffset -
+                      kStunMagicCookieLength) != kStunMagicCookie;
+}
+
+absl::string_view StunMessageView::transaction_id() const {
+  RTC_DCHECK(!empty());
+  if (IsLegacy()) {
+    return absl::string_view(
+        data() + kStunTransactionIdOffset - kStunMagicCookieLength,
+        kStunLegacyTransactionIdLength);
+  }
+  return absl::string_view(data() + kStunTransactionIdOffset,
+                           kStunTransactionIdLength);
+}
+
+StunMessageView::Iterator StunMessageView::begin() const {
+  return empty() ? end() : Iterator(data_ + kStunHeaderSize, data_ + size_);
+}
+
+StunMessageView::Iterator StunMessageView::end() const {
+  return Iterator(data_ + size_, data_ + size_);
+}
+
+bool StunMessageView::GetAttribute(int type, Attribute* attribute) const {
+  for (const Attribute& attr : *this) {
+    if (attr.type == type) {
+      *attribute = attr;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool StunMessageView::HasAttribute(int type) const {
+  Attribute attribute;
+  return GetAttribute(type, &attribute);
+}
+
+bool StunMessageView::GetByteString(int type, absl::string_view* value) const {
+  Attribute attribute;
+  if (!GetAttribute(type, &attribute)) {
+    return false;
+  }
+  *value = absl::string_view(
+      reinterpret_cast<const char*>(attribute.value.data()),
+      attribute.value.size());
+  return true;
+}
+
+bool StunMessageView::GetUInt32(int type, uint32_t* value) const {
+  Attribute attribute;
+  if (!GetAttribute(type, &attribute) ||
+      attribute.value.size() != StunUInt32Attribute::SIZE) {
+    return false;
+  }
+  *value = rtc::GetBE32(attribute.value.data());
+  return true;
+}
+
+bool StunMessageView::GetUInt64(int type, uint64_t* value) const {
+  Attribute attribute;
+  if (!GetAttribute(type, &attribute) ||
+      attribute.value.size() != StunUInt64Attribute::SIZE) {
+    return false;
+  }
+  *value = rtc::GetBE64(attribute.value.data());
+  return true;
+}
+
+// See RFC 5389, section 15.2.
+bool StunMessageView::GetXorAddress(int type,
+                                    rtc::SocketAddress* address) const {
+  Attribute attribute;
+  if (!GetAttribute(type, &attribute) || attribute.value.size() < 4) {
+    return false;
+  }
+  const uint8_t* value = attribute.value.data();
+  uint16_t port = rtc::GetBE16(value + 2) ^ (kStunMagicCookie >> 16);
+  uint8_t family = value[1];
+  if (family == STUN_ADDRESS_IPV4 &&
+      attribute.value.size() == StunAddressAttribute::SIZE_IP4) {
+    address->SetIP(rtc::GetBE32(value + 4) ^ kStunMagicCookie);
+  } else if (family == STUN_ADDRESS_IPV6 &&
+             attribute.value.size() == StunAddressAttribute::SIZE_IP6) {
+    // The magic cookie and the transaction ID together make up the mask.
+    in6_addr ip;
+    uint8_t* ip_bytes = reinterpret_cast<uint8_t*>(&ip);
+    const uint8_t* mask =
+        data_ + kStunTransactionIdOffset - kStunMagicCookieLength;
+    for (size_t i = 0; i < sizeof(ip); ++i) {
+      ip_bytes[i] = value[4 + i] ^ mask[i];
+    }
+    address->SetIP(rtc::IPAddress(ip));
+  } else {
+    return false;
+  }
+  address->SetPort(port);
+  return true;
+}
+
+bool StunMessageView::ValidateMessageIntegrity(
+    absl::string_view password) const {
+  return ValidateMessageIntegrity(
+      rtc::HmacSha1(password.data(), password.size()));
+}
+
+bool StunMessageView::ValidateMessageIntegrity32(
+    absl::string_view password) const {
+  return ValidateMessageIntegrity32(
+      rtc::HmacSha1(password.data(), password.size()));
+}
+
+bool StunMessageView::ValidateMessageIntegrity(
+    const rtc::HmacSha1& key) const {
+  return ValidateMessageIntegrityOfType(STUN_ATTR_MESSAGE_INTEGRITY,
+                                        kStunMessageIntegritySize, key);
+}
+
+bool StunMessageView::ValidateMessageIntegrity32(
+    const rtc::HmacSha1& key) const {
+  return ValidateMessageIntegrityOfType(STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32,
+                                        kStunMessageIntegrity32Size, key);
+}
+
+bool StunMessageView::ValidateMessageIntegrityOfType(
+    int mi_attr_type,
+    size_t mi_attr_size,
+    const rtc::HmacSha1& key) const {
+  Attribute attribute;
+  if (empty() || size_ % 4 != 0 || !GetAttribute(mi_attr_type, &attribute) ||
+      attribute.value.size() != mi_attr_size) {
+    return false;
+  }
+  size_t mi_pos = attribute.value.data() - kStunAttributeHeaderSize - data_;
+  char hmac[kStunMessageIntegritySize];
+  ComputeMessageIntegrity(key, data(), mi_pos, mi_attr_size, hmac);
+  return memcmp(attribute.value.data(), hmac, mi_attr_size) == 0;
+}
+
+bool StunMessageView::ValidateFingerprint() const {
+  if (empty() || last_attribute_offset_ + kStunAttributeHeaderSize +
+                         StunUInt32Attribute::SIZE !=
+                     size_) {
+    return false;
+  }
+  return StunMessage::ValidateFingerprint(data(), size_);
+}
+
 // StunMessage
 
 StunMessage::StunMessage()
@@ -204,17 +444,17 @@ const StunUInt16ListAttribute* StunMessage::GetUnknownAttributes() const {
 bool StunMessage::ValidateMessageIntegrity(const char* data,
                                            size_t size,
                                            const std::string& password) {
-  return ValidateMessageIntegrityOfType(STUN_ATTR_MESSAGE_INTEGRITY,
-                                        kStunMessageIntegritySize, data, size,
-                                        password);
+  return ValidateMessageIntegrityOfType(
+      STUN_ATTR_MESSAGE_INTEGRITY, kStunMessageIntegritySize, data, size,
+      rtc::HmacSha1(password));
 }
 
 bool StunMessage::ValidateMessageIntegrity32(const char* data,
                                              size_t size,
                                              const std::string& password) {
-  return ValidateMessageIntegrityOfType(STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32,
-                                        kStunMessageIntegrity32Size, data, size,
-                                        password);
+  return ValidateMessageIntegrityOfType(
+      STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32, kStunMessageIntegrity32Size, data,
+      size, rtc::HmacSha1(password));
 }
 
 // Verifies a STUN message has a valid MESSAGE-INTEGRITY attribute, using the
@@ -223,7 +463,7 @@ bool StunMessage::ValidateMessageIntegrityOfType(int mi_attr_type,
                                                  size_t mi_attr_size,
                                                  const char* data,
                                                  size_t size,
-                                                 const std::string& password) {
+                                                 const rtc::HmacSha1& key) {
   RTC_DCHECK(mi_attr_size <= kStunMessageIntegritySize);
 
   // Verifying the size of the message.
@@ -268,34 +508,8 @@ bool StunMessage::ValidateMessageIntegrityOfType(int mi_attr_type,
     return false;
   }
 
-  // Getting length of the message to calculate Message Integrity.
-  size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
-  if (size > mi_pos + kStunAttributeHeaderSize + mi_attr_size) {
-    // Stun message has other attributes after message integrity.
-    // Adjust the length parameter in stun message to calculate HMAC.
-    size_t extra_offset =
-        size - (mi_pos + kStunAttributeHeaderSize + mi_attr_size);
-    size_t new_adjusted_len = size - extra_offset - kStunHeaderSize;
-
-    // Writing new length of the STUN message @ Message Length in temp buffer.
-    //      0                   1                   2                   3
-    //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //     |0 0|     STUN Message Type     |         Message Length        |
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
-  }
-
   char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, password.c_str(), password.size(),
-                       temp_data.get(), mi_pos, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
-    return false;
-  }
+  ComputeMessageIntegrity(key, data, current_pos, mi_attr_size, hmac);
 
   // Comparing the calculated HMAC with the one present in the message.
   return memcmp(data + current_pos + kStunAttributeHeaderSize, hmac,
@@ -303,26 +517,30 @@ bool StunMessage::ValidateMessageIntegrityOfType(int mi_attr_type,
 }
 
 bool StunMessage::AddMessageIntegrity(const std::string& password) {
-  return AddMessageIntegrityOfType(STUN_ATTR_MESSAGE_INTEGRITY,
-                                   kStunMessageIntegritySize, password.c_str(),
-                                   password.size());
+  return AddMessageIntegrity(rtc::HmacSha1(password));
 }
 
 bool StunMessage::AddMessageIntegrity(const char* key, size_t keylen) {
+  return AddMessageIntegrity(rtc::HmacSha1(key, keylen));
+}
+
+bool StunMessage::AddMessageIntegrity(const rtc::HmacSha1& key) {
   return AddMessageIntegrityOfType(STUN_ATTR_MESSAGE_INTEGRITY,
-                                   kStunMessageIntegritySize, key, keylen);
+                                   kStunMessageIntegritySize, key);
 }
 
 bool StunMessage::AddMessageIntegrity32(absl::string_view password) {
+  return AddMessageIntegrity32(rtc::HmacSha1(password.data(), password.size()));
+}
+
+bool StunMessage::AddMessageIntegrity32(const rtc::HmacSha1& key) {
   return AddMessageIntegrityOfType(STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32,
-                                   kStunMessageIntegrity32Size, password.data(),
-                                   password.length());
+                                   kStunMessageIntegrity32Size, key);
 }
 
 bool StunMessage::AddMessageIntegrityOfType(int attr_type,
                                             size_t attr_size,
-                                            const char* key,
-                                            size_t keylen) {
+                                            const rtc::HmacSha1& key) {
   // Add the attribute with a dummy value. Since this is a known attribute, it
   // can't fail.
   RTC_DCHECK(attr_size <= kStunMessageIntegritySize);
@@ -336,17 +554,10 @@ bool StunMessage::AddMessageIntegrityOfType(int attr_type,
   if (!Write(&buf))
     return false;
 
-  int msg_len_for_hmac = static_cast<int>(
-      buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length());
+  size_t msg_len_for_hmac =
+      buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length();
   char hmac[kStunMessageIntegritySize];
-  size_t ret = rtc::ComputeHmac(rtc::DIGEST_SHA_1, key, keylen, buf.Data(),
-                                msg_len_for_hmac, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
-    RTC_LOG(LS_ERROR) << "HMAC computation failed. Message-Integrity "
-                         "has dummy value.";
-    return false;
-  }
+  key.Compute(buf.Data(), msg_len_for_hmac, reinterpret_cast<uint8_t*>(hmac));
 
   // Insert correct HMAC into the attribute.
   msg_integrity_attr->CopyBytes(hmac, attr_size);
@@ -428,76 +639,39 @@ bool StunMessage::AddFingerprint() {
 }
 
 bool StunMessage::Read(ByteBufferReader* buf) {
-  if (!buf->ReadUInt16(&type_)) {
-    return false;
-  }
-
-  if (type_ & 0x8000) {
-    // RTP and RTCP set the MSB of first byte, since first two bits are version,
-    // and version is always 2 (10). If set, this is not a STUN packet.
-    return false;
-  }
-
-  if (!buf->ReadUInt16(&length_)) {
-    return false;
-  }
-
-  std::string magic_cookie;
-  if (!buf->ReadString(&magic_cookie, kStunMagicCookieLength)) {
-    return false;
-  }
-
-  std::string transaction_id;
-  if (!buf->ReadString(&transaction_id, kStunTransactionIdLength)) {
+  StunMessageView view;
+  if (!view.Parse(buf->Data(), buf->Length())) {
     return false;
   }
+  buf->Consume(view.size());
+  return Read(view);
+}
 
-  uint32_t magic_cookie_int;
-  static_assert(sizeof(magic_cookie_int) == kStunMagicCookieLength,
-                "Integer size mismatch: magic_cookie_int and kStunMagicCookie");
-  std::memcpy(&magic_cookie_int, magic_cookie.data(), sizeof(magic_cookie_int));
-  if (rtc::NetworkToHost32(magic_cookie_int) != kStunMagicCookie) {
-    // If magic cookie is invalid it means that the peer implements
-    // RFC3489 instead of RFC5389.
-    transaction_id.insert(0, magic_cookie);
-  }
-  RTC_DCHECK(IsValidTransactionId(transaction_id));
-  transaction_id_ = transaction_id;
+bool StunMessage::Read(const StunMessageView& view) {
+  RTC_DCHECK(!view.empty());
+  type_ = static_cast<uint16_t>(view.type());
+  length_ = static_cast<uint16_t>(view.length());
+  absl::string_view transaction_id = view.transaction_id();
+  transaction_id_.assign(transaction_id.data(), transaction_id.size());
+  RTC_DCHECK(IsValidTransactionId(transaction_id_));
   reduced_transaction_id_ = ReduceTransactionId(transaction_id_);
 
-  if (length_ != buf->Length()) {
-    return false;
-  }
-
   attrs_.resize(0);
-
-  size_t rest = buf->Length() - length_;
-  while (buf->Length() > rest) {
-    uint16_t attr_type, attr_length;
-    if (!buf->ReadUInt16(&attr_type))
-      return false;
-    if (!buf->ReadUInt16(&attr_length))
-      return false;
-
+  for (const StunMessageView::Attribute& attribute : view) {
     std::unique_ptr<StunAttribute> attr(
-        CreateAttribute(attr_type, attr_length));
+        CreateAttribute(attribute.type, attribute.value.size()));
     if (!attr) {
       // Skip any unknown or malformed attributes.
-      if ((attr_length % 4) != 0) {
-        attr_length += (4 - (attr_length % 4));
-      }
-      if (!buf->Consume(attr_length)) {
-        return false;
-      }
-    } else {
-      if (!attr->Read(buf)) {
-        return false;
-      }
-      attrs_.push_back(std::move(attr));
+      continue;
+    }
+    ByteBufferReader attr_buf(
+        reinterpret_cast<const char*>(attribute.value.data()),
+        attribute.value.size());
+    if (!attr->Read(&attr_buf)) {
+      return false;
     }
+    attrs_.push_back(std::move(attr));
   }
-
-  RTC_DCHECK(buf->Length() == rest);
   return true;
 }
 
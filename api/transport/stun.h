@@ -21,7 +21,10 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "api/array_view.h"
 #include "rtc_base/byte_buffer.h"
+#include "rtc_base/hmac_sha1.h"
 #include "rtc_base/ip_address.h"
 #include "rtc_base/socket_address.h"
 
@@ -139,6 +142,91 @@ class StunUInt32Attribute;
 class StunUInt64Attribute;
 class StunXorAddressAttribute;
 
+// A read-only view of a STUN message in the buffer it was received in.
+// Parsing only checks the framing of the header and the attributes; it does
+// not allocate or copy anything, so it is cheap enough to run on every packet,
+// and attribute values are handed out as pointers into the buffer. The buffer
+// must outlive the view. StunMessage::Read() builds on this.
+class StunMessageView {
+ public:
+  // An attribute of the message. |value| points into the buffer of the
+  // message and does not include the padding.
+  struct Attribute {
+    uint16_t type;
+    rtc::ArrayView<const uint8_t> value;
+  };
+
+  // Iterates over the attributes in the order they appear in the message.
+  class Iterator {
+   public:
+    Attribute operator*() const;
+    Iterator& operator++();
+    bool operator==(const Iterator& other) const { return pos_ == other.pos_; }
+    bool operator!=(const Iterator& other) const { return pos_ != other.pos_; }
+
+   private:
+    friend class StunMessageView;
+    Iterator(const uint8_t* pos, const uint8_t* end) : pos_(pos), end_(end) {}
+
+    const uint8_t* pos_;
+    const uint8_t* end_;
+  };
+
+  StunMessageView() = default;
+
+  // Parses the STUN message in |data|, which has to be exactly one message.
+  // Returns false, and leaves the view empty, if it is not. Like StunMessage,
+  // this tolerates missing padding after the last attribute.
+  bool Parse(const char* data, size_t size);
+
+  bool empty() const { return size_ == 0; }
+  const char* data() const { return reinterpret_cast<const char*>(data_); }
+  size_t size() const { return size_; }
+
+  int type() const;
+  // The length of the message, excluding the STUN header.
+  size_t length() const;
+  // Returns true if the message conforms to RFC3489 rather than RFC5389, in
+  // which case the transaction ID is 16 bytes long rather than 12.
+  bool IsLegacy() const;
+  absl::string_view transaction_id() const;
+
+  Iterator begin() const;
+  Iterator end() const;
+
+  // Finds the first attribute of |type|. Returns false if there is none.
+  bool GetAttribute(int type, Attribute* attribute) const;
+  bool HasAttribute(int type) const;
+
+  // Get the value of the first attribute of |type|. Return false if there is
+  // none, or if it has the wrong size.
+  bool GetByteString(int type, absl::string_view* value) const;
+  bool GetUInt32(int type, uint32_t* value) const;
+  bool GetUInt64(int type, uint64_t* value) const;
+  // Decodes an XOR-MAPPED-ADDRESS style attribute.
+  bool GetXorAddress(int type, rtc::SocketAddress* address) const;
+
+  // Like the StunMessage functions of the same name, but without copying the
+  // message to compute the HMAC.
+  bool ValidateMessageIntegrity(absl::string_view password) const;
+  bool ValidateMessageIntegrity32(absl::string_view password) const;
+  // Like the above, with a key that is reused across messages, which saves
+  // setting up the HMAC for every message.
+  bool ValidateMessageIntegrity(const rtc::HmacSha1& key) const;
+  bool ValidateMessageIntegrity32(const rtc::HmacSha1& key) const;
+  // Also checks that FINGERPRINT is the last attribute.
+  bool ValidateFingerprint() const;
+
+ private:
+  bool ValidateMessageIntegrityOfType(int mi_attr_type,
+                                      size_t mi_attr_size,
+                                      const rtc::HmacSha1& key) const;
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t last_attribute_offset_ = 0;
+};
+
 // Records a complete STUN/TURN message.  Each message consists of a type and
 // any number of attributes.  Each attribute is parsed into an instance of an
 // appropriate class (see above).  The Get* methods will return instances of
@@ -203,10 +291,12 @@ class StunMessage {
   // Adds a MESSAGE-INTEGRITY attribute that is valid for the current message.
   bool AddMessageIntegrity(const std::string& password);
   bool AddMessageIntegrity(const char* key, size_t keylen);
+  bool AddMessageIntegrity(const rtc::HmacSha1& key);
 
   // Adds a STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32 attribute that is valid for the
   // current message.
   bool AddMessageIntegrity32(absl::string_view password);
+  bool AddMessageIntegrity32(const rtc::HmacSha1& key);
 
   // Verify that a buffer has stun magic cookie and one of the specified
   // methods. Note that it does not check for the existance of FINGERPRINT.
@@ -223,6 +313,8 @@ class StunMessage {
   // Parses the STUN packet in the given buffer and records it here. The
   // return value indicates whether this was successful.
   bool Read(rtc::ByteBufferReader* buf);
+  // Records a STUN packet that has already been parsed in place.
+  bool Read(const StunMessageView& view);
 
   // Writes this object into a STUN packet. The return value indicates whether
   // this was successful.
@@ -255,13 +347,12 @@ class StunMessage {
   static bool IsValidTransactionId(const std::string& transaction_id);
   bool AddMessageIntegrityOfType(int mi_attr_type,
                                  size_t mi_attr_size,
-                                 const char* key,
-                                 size_t keylen);
+                                 const rtc::HmacSha1& key);
   static bool ValidateMessageIntegrityOfType(int mi_attr_type,
                                              size_t mi_attr_size,
                                              const char* data,
                                              size_t size,
-                                             const std::string& password);
+                                             const rtc::HmacSha1& key);
 
   uint16_t type_;
   uint16_t length_;
@@ -0,0 +1,157 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "api/transport/stun.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/crc32.h"
+#include "rtc_base/hmac_sha1.h"
+
+namespace cricket {
+namespace {
+
+constexpr char kPassword[] = "VOkJxbRl1RmTxUk/WvJxBt";
+
+// A connectivity check as sent by a controlling ICE agent.
+std::string CreateBindingRequest() {
+  IceMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  RTC_CHECK(msg.SetTransactionID("0123456789ab"));
+  msg.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, "rmtufrag:localufrag"));
+  msg.AddAttribute(std::make_unique<StunUInt32Attribute>(
+      STUN_ATTR_NETWORK_INFO, 0x00010001));
+  msg.AddAttribute(
+      std::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 0x6e7f1eff));
+  msg.AddAttribute(std::make_unique<StunUInt64Attribute>(
+      STUN_ATTR_ICE_CONTROLLING, 0x0123456789abcdefULL));
+  msg.AddAttribute(StunAttribute::CreateByteString(STUN_ATTR_USE_CANDIDATE));
+  RTC_CHECK(msg.AddMessageIntegrity(kPassword));
+  RTC_CHECK(msg.AddFingerprint());
+  rtc::ByteBufferWriter buf;
+  RTC_CHECK(msg.Write(&buf));
+  return std::string(buf.Data(), buf.Length());
+}
+
+// Builds an IceMessage, as Port::GetStunMessage does for every check.
+void BM_StunMessageRead(benchmark::State& state) {
+  const std::string packet = CreateBindingRequest();
+  for (auto _ : state) {
+    IceMessage msg;
+    rtc::ByteBufferReader buf(packet.data(), packet.size());
+    RTC_CHECK(msg.Read(&buf));
+    benchmark::DoNotOptimize(msg.GetByteString(STUN_ATTR_USERNAME));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_StunMessageRead);
+
+// Parses in place and reads what an ICE-lite endpoint needs to answer.
+void BM_StunMessageViewParse(benchmark::State& state) {
+  const std::string packet = CreateBindingRequest();
+  for (auto _ : state) {
+    StunMessageView view;
+    RTC_CHECK(view.Parse(packet.data(), packet.size()));
+    absl::string_view username;
+    uint32_t priority;
+    RTC_CHECK(view.GetByteString(STUN_ATTR_USERNAME, &username));
+    RTC_CHECK(view.GetUInt32(STUN_ATTR_PRIORITY, &priority));
+    benchmark::DoNotOptimize(username);
+    benchmark::DoNotOptimize(view.HasAttribute(STUN_ATTR_USE_CANDIDATE));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_StunMessageViewParse);
+
+// The checks done on every connectivity check before it is answered.
+void BM_StunMessageValidate(benchmark::State& state) {
+  const std::string packet = CreateBindingRequest();
+  for (auto _ : state) {
+    RTC_CHECK(
+        StunMessage::ValidateFingerprint(packet.data(), packet.size()));
+    RTC_CHECK(StunMessage::ValidateMessageIntegrity(
+        packet.data(), packet.size(), kPassword));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_StunMessageValidate);
+
+void BM_StunMessageViewValidate(benchmark::State& state) {
+  const std::string packet = CreateBindingRequest();
+  for (auto _ : state) {
+    StunMessageView view;
+    RTC_CHECK(view.Parse(packet.data(), packet.size()));
+    RTC_CHECK(view.ValidateFingerprint());
+    RTC_CHECK(view.ValidateMessageIntegrity(kPassword));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_StunMessageViewValidate);
+
+// As a Port validates checks, with the password set up as an HMAC key once.
+void BM_StunMessageViewValidateCachedKey(benchmark::State& state) {
+  const std::string packet = CreateBindingRequest();
+  const rtc::HmacSha1 key(kPassword);
+  for (auto _ : state) {
+    StunMessageView view;
+    RTC_CHECK(view.Parse(packet.data(), packet.size()));
+    RTC_CHECK(view.ValidateFingerprint());
+    RTC_CHECK(view.ValidateMessageIntegrity(key));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+BENCHMARK(BM_StunMessageViewValidateCachedKey);
+
+// Signs a binding response, as a Connection does for every check it answers.
+void BM_StunBindingResponse(benchmark::State& state) {
+  const bool cached_key = state.range(0);
+  const rtc::HmacSha1 key(kPassword);
+  for (auto _ : state) {
+    StunMessage response;
+    response.SetType(STUN_BINDING_RESPONSE);
+    RTC_CHECK(response.SetTransactionID("0123456789ab"));
+    response.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_MAPPED_ADDRESS, rtc::SocketAddress("1.2.3.4", 5678)));
+    RTC_CHECK(cached_key ? response.AddMessageIntegrity(key)
+                         : response.AddMessageIntegrity(kPassword));
+    RTC_CHECK(response.AddFingerprint());
+    rtc::ByteBufferWriter buf;
+    RTC_CHECK(response.Write(&buf));
+    benchmark::DoNotOptimize(buf.Data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StunBindingResponse)->Arg(false)->Arg(true);
+
+// FINGERPRINT is a CRC32 over the whole message. The sizes range from a
+// bare message header to a full-size packet.
+void BM_Crc32(benchmark::State& state) {
+  const std::string data(state.range(0), '\x5a');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rtc::ComputeCrc32(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Crc32)->Arg(20)->Arg(100)->Arg(1200);
+
+}  // namespace
+}  // namespace cricket
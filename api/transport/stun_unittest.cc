@@ -1314,6 +1314,38 @@ TEST_F(StunTest, AddMessageIntegrity) {
       kRfc5769SampleMsgPassword));
 }
 
+// The same, with the password set up as an HMAC key once for all messages.
+TEST_F(StunTest, AddAndValidateMessageIntegrityWithKey) {
+  const rtc::HmacSha1 key(kRfc5769SampleMsgPassword);
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                         sizeof(kRfc5769SampleRequest)));
+  EXPECT_TRUE(view.ValidateMessageIntegrity(key));
+  EXPECT_FALSE(view.ValidateMessageIntegrity(rtc::HmacSha1("InvalidPassword")));
+
+  IceMessage msg;
+  rtc::ByteBufferReader buf(
+      reinterpret_cast<const char*>(kRfc5769SampleResponseWithoutMI),
+      sizeof(kRfc5769SampleResponseWithoutMI));
+  EXPECT_TRUE(msg.Read(&buf));
+  EXPECT_TRUE(msg.AddMessageIntegrity(key));
+  const StunByteStringAttribute* mi_attr =
+      msg.GetByteString(STUN_ATTR_MESSAGE_INTEGRITY);
+  EXPECT_EQ(
+      0, memcmp(mi_attr->bytes(), kCalculatedHmac2, sizeof(kCalculatedHmac2)));
+
+  IceMessage msg32;
+  msg32.SetType(GOOG_PING_REQUEST);
+  msg32.SetTransactionID("0123456789ab");
+  EXPECT_TRUE(msg32.AddMessageIntegrity32(key));
+  rtc::ByteBufferWriter buf32;
+  EXPECT_TRUE(msg32.Write(&buf32));
+  ASSERT_TRUE(view.Parse(buf32.Data(), buf32.Length()));
+  EXPECT_TRUE(view.ValidateMessageIntegrity32(key));
+  EXPECT_TRUE(view.ValidateMessageIntegrity32(kRfc5769SampleMsgPassword));
+  EXPECT_FALSE(view.ValidateMessageIntegrity(key));
+}
+
 // Check our STUN message validation code against the RFC5769 test messages.
 TEST_F(StunTest, ValidateMessageIntegrity32) {
   // Try the messages from RFC 5769.
@@ -1903,4 +1935,114 @@ TEST_F(StunTest, IsStunMethod) {
       sizeof(kRfc5769SampleRequest)));
 }
 
+TEST_F(StunTest, ParseMessageView) {
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                         sizeof(kRfc5769SampleRequest)));
+  EXPECT_EQ(STUN_BINDING_REQUEST, view.type());
+  EXPECT_EQ(sizeof(kRfc5769SampleRequest) - kStunHeaderSize, view.length());
+  EXPECT_FALSE(view.IsLegacy());
+  EXPECT_EQ(absl::string_view(
+                reinterpret_cast<const char*>(kRfc5769SampleMsgTransactionId),
+                sizeof(kRfc5769SampleMsgTransactionId)),
+            view.transaction_id());
+
+  std::vector<uint16_t> types;
+  for (const StunMessageView::Attribute& attribute : view) {
+    types.push_back(attribute.type);
+  }
+  EXPECT_EQ(std::vector<uint16_t>({STUN_ATTR_SOFTWARE, STUN_ATTR_PRIORITY,
+                                   STUN_ATTR_ICE_CONTROLLED,
+                                   STUN_ATTR_USERNAME,
+                                   STUN_ATTR_MESSAGE_INTEGRITY,
+                                   STUN_ATTR_FINGERPRINT}),
+            types);
+
+  absl::string_view username;
+  ASSERT_TRUE(view.GetByteString(STUN_ATTR_USERNAME, &username));
+  EXPECT_EQ(kRfc5769SampleMsgUsername, username);
+  uint32_t priority = 0;
+  ASSERT_TRUE(view.GetUInt32(STUN_ATTR_PRIORITY, &priority));
+  EXPECT_EQ(0x6e0001ffU, priority);
+  uint64_t tie_breaker = 0;
+  ASSERT_TRUE(view.GetUInt64(STUN_ATTR_ICE_CONTROLLED, &tie_breaker));
+  EXPECT_EQ(0x932ff9b151263b36ULL, tie_breaker);
+  EXPECT_FALSE(view.GetUInt64(STUN_ATTR_PRIORITY, &tie_breaker));
+  EXPECT_FALSE(view.HasAttribute(STUN_ATTR_USE_CANDIDATE));
+
+  EXPECT_TRUE(view.ValidateFingerprint());
+  EXPECT_TRUE(view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_FALSE(view.ValidateMessageIntegrity("InvalidPassword"));
+  EXPECT_FALSE(view.ValidateMessageIntegrity32(kRfc5769SampleMsgPassword));
+
+  // The view agrees with a StunMessage read from it.
+  IceMessage msg;
+  ASSERT_TRUE(msg.Read(view));
+  EXPECT_EQ(view.type(), msg.type());
+  EXPECT_EQ(view.transaction_id(), msg.transaction_id());
+  ASSERT_TRUE(msg.GetUInt32(STUN_ATTR_PRIORITY));
+  EXPECT_EQ(priority, msg.GetUInt32(STUN_ATTR_PRIORITY)->value());
+}
+
+TEST_F(StunTest, ParseMessageViewWithXorAddress) {
+  StunMessageView view;
+  rtc::SocketAddress address;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleResponse),
+                         sizeof(kRfc5769SampleResponse)));
+  ASSERT_TRUE(view.GetXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, &address));
+  EXPECT_EQ(kRfc5769SampleMsgMappedAddress, address);
+  EXPECT_TRUE(view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_TRUE(view.ValidateFingerprint());
+
+  ASSERT_TRUE(
+      view.Parse(reinterpret_cast<const char*>(kRfc5769SampleResponseIPv6),
+                 sizeof(kRfc5769SampleResponseIPv6)));
+  ASSERT_TRUE(view.GetXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, &address));
+  EXPECT_EQ(kRfc5769SampleMsgIPv6MappedAddress, address);
+  EXPECT_FALSE(view.GetXorAddress(STUN_ATTR_SOFTWARE, &address));
+}
+
+TEST_F(StunTest, ParseLegacyMessageView) {
+  unsigned char rfc3489_packet[sizeof(kStunMessageWithIPv4MappedAddress)];
+  memcpy(rfc3489_packet, kStunMessageWithIPv4MappedAddress,
+         sizeof(kStunMessageWithIPv4MappedAddress));
+  // Overwrite the magic cookie here.
+  memcpy(&rfc3489_packet[4], "ABCD", 4);
+
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(rfc3489_packet),
+                         sizeof(rfc3489_packet)));
+  EXPECT_TRUE(view.IsLegacy());
+  EXPECT_EQ(absl::string_view(reinterpret_cast<const char*>(&rfc3489_packet[4]),
+                              kStunLegacyTransactionIdLength),
+            view.transaction_id());
+  EXPECT_FALSE(view.ValidateFingerprint());
+}
+
+TEST_F(StunTest, FailToParseInvalidMessageViews) {
+  StunMessageView view;
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithZeroLength),
+                 kRealLengthOfInvalidLengthTestCases));
+  EXPECT_TRUE(view.empty());
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithSmallLength),
+                 kRealLengthOfInvalidLengthTestCases));
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithExcessLength),
+                 kRealLengthOfInvalidLengthTestCases));
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(kRtcpPacket),
+                          sizeof(kRtcpPacket)));
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                          kStunHeaderSize - 1));
+
+  // The length in the header matches, but the attributes overrun it.
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithBadHmacAtEnd),
+                 sizeof(kStunMessageWithBadHmacAtEnd)));
+  EXPECT_TRUE(view.empty());
+  EXPECT_FALSE(view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_FALSE(view.ValidateFingerprint());
+}
+
 }  // namespace cricket
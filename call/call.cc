@@ -37,6 +37,7 @@
 #include "logging/rtc_event_log/events/rtc_event_video_send_stream_config.h"
 #include "logging/rtc_event_log/rtc_stream_config.h"
 #include "modules/congestion_controller/include/receive_side_congestion_controller.h"
+#include "modules/pacing/pacer_thread_pool.h"
 #include "modules/rtp_rtcp/include/flexfec_receiver.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
@@ -419,7 +420,9 @@ Call* Call::Create(const Call::Config& config) {
 Call* Call::Create(const Call::Config& config,
                    rtc::scoped_refptr<SharedModuleThread> call_thread) {
   return Create(config, Clock::GetRealTimeClock(), std::move(call_thread),
-                ProcessThread::Create("PacerThread"));
+                config.pacer_thread_pool
+                    ? config.pacer_thread_pool->CreatePacerThread()
+                    : ProcessThread::Create("PacerThread"));
 }
 
 Call* Call::Create(const Call::Config& config,
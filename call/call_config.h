@@ -23,6 +23,7 @@
 namespace webrtc {
 
 class AudioProcessing;
+class PacerThreadPool;
 class RtcEventLog;
 
 struct CallConfig {
@@ -60,6 +61,11 @@ struct CallConfig {
   // NetEq factory to use for this call.
   NetEqFactory* neteq_factory = nullptr;
 
+  // Pool of pacer threads shared with other calls. If set, the pacer of this
+  // call runs on one of its threads instead of on a thread of its own. Must
+  // outlive the call. Not used with the "WebRTC-TaskQueuePacer" field trial.
+  PacerThreadPool* pacer_thread_pool = nullptr;
+
   // Key-value mapping of internal configurations to apply,
   // e.g. field trials.
   const WebRtcKeyValueConfig* trials = nullptr;
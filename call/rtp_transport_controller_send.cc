@@ -542,11 +542,10 @@ void RtpTransportControllerSend::OnTransportFeedback(
   auto feedback_time = Timestamp::Millis(clock_->TimeInMilliseconds());
   task_queue_.PostTask([this, feedback, feedback_time]() {
     RTC_DCHECK_RUN_ON(&task_queue_);
-    absl::optional<TransportPacketsFeedback> feedback_msg =
-        transport_feedback_adapter_.ProcessTransportFeedback(feedback,
-                                                             feedback_time);
-    if (feedback_msg && controller_) {
-      PostUpdates(controller_->OnTransportPacketsFeedback(*feedback_msg));
+    if (transport_feedback_adapter_.ProcessTransportFeedback(
+            feedback, feedback_time, &feedback_msg_) &&
+        controller_) {
+      PostUpdates(controller_->OnTransportPacketsFeedback(feedback_msg_));
     }
     pacer()->UpdateOutstandingData(
         transport_feedback_adapter_.GetOutstandingData());
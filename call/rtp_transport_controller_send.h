@@ -161,6 +161,8 @@ class RtpTransportControllerSend final
 
   TransportFeedbackAdapter transport_feedback_adapter_
       RTC_GUARDED_BY(task_queue_);
+  // Reused for every transport feedback, to not reallocate its vectors.
+  TransportPacketsFeedback feedback_msg_ RTC_GUARDED_BY(task_queue_);
 
   NetworkControllerFactoryInterface* const controller_factory_override_
       RTC_PT_GUARDED_BY(task_queue_);
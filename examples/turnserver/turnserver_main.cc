@@ -8,15 +8,19 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdlib.h>
+
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 
 #include "examples/turnserver/read_auth_file.h"
 #include "p2p/base/basic_packet_socket_factory.h"
 #include "p2p/base/port_interface.h"
+#include "p2p/base/sharded_turn_server.h"
 #include "p2p/base/turn_server.h"
 #include "rtc_base/async_udp_socket.h"
 #include "rtc_base/ip_address.h"
@@ -32,6 +36,8 @@ class TurnFileAuth : public cricket::TurnAuthInterface {
   explicit TurnFileAuth(std::map<std::string, std::string> name_to_key)
       : name_to_key_(std::move(name_to_key)) {}
 
+  // Only reads the map, so it can be shared by the shards of a
+  // ShardedTurnServer.
   virtual bool GetKey(const std::string& username,
                       const std::string& realm,
                       std::string* key) {
@@ -51,8 +57,9 @@ class TurnFileAuth : public cricket::TurnAuthInterface {
 }  // namespace
 
 int main(int argc, char* argv[]) {
-  if (argc != 5) {
-    std::cerr << "usage: turnserver int-addr ext-ip realm auth-file"
+  if (argc != 5 && argc != 6) {
+    std::cerr << "usage: turnserver int-addr ext-ip realm auth-file "
+                 "[num-shards]"
               << std::endl;
     return 1;
   }
@@ -69,7 +76,43 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  int num_shards = 1;
+  if (argc == 6) {
+    num_shards = atoi(argv[5]);
+    if (num_shards < 1) {
+      std::cerr << "Invalid number of shards: " << argv[5] << std::endl;
+      return 1;
+    }
+  }
+
+  std::fstream auth_file(argv[4], std::fstream::in);
+  TurnFileAuth auth(auth_file.is_open()
+                        ? webrtc_examples::ReadAuthFile(&auth_file)
+                        : std::map<std::string, std::string>());
+
   rtc::Thread* main = rtc::Thread::Current();
+  if (num_shards > 1) {
+    // Each shard runs a TurnServer on its own thread, sharing the UDP port.
+    cricket::ShardedTurnServer::Config config;
+    config.internal_address = int_addr;
+    config.external_ip = ext_addr;
+    config.realm = argv[3];
+    config.software = kSoftware;
+    config.auth_hook = &auth;
+    config.num_shards = num_shards;
+    std::unique_ptr<cricket::ShardedTurnServer> server =
+        cricket::ShardedTurnServer::Create(config);
+    if (!server) {
+      std::cerr << "Failed to start " << num_shards << " shards at "
+                << int_addr.ToString() << std::endl;
+      return 1;
+    }
+    std::cout << "Listening internally at " << int_addr.ToString() << " with "
+              << num_shards << " shards" << std::endl;
+    main->Run();
+    return 0;
+  }
+
   rtc::AsyncUDPSocket* int_socket =
       rtc::AsyncUDPSocket::Create(main->socketserver(), int_addr);
   if (!int_socket) {
@@ -79,11 +122,6 @@ int main(int argc, char* argv[]) {
   }
 
   cricket::TurnServer server(main);
-  std::fstream auth_file(argv[4], std::fstream::in);
-
-  TurnFileAuth auth(auth_file.is_open()
-                        ? webrtc_examples::ReadAuthFile(&auth_file)
-                        : std::map<std::string, std::string>());
   server.set_realm(argv[3]);
   server.set_software(kSoftware);
   server.set_auth_hook(&auth);
@@ -1910,6 +1910,8 @@ bool WebRtcVideoChannel::SendRtp(const uint8_t* data,
       options.included_in_feedback;
   rtc_options.info_signaled_after_sent.included_in_allocation =
       options.included_in_allocation;
+  rtc_options.batchable = options.batchable;
+  rtc_options.last_packet_in_batch = options.last_packet_in_batch;
   return MediaChannel::SendPacket(&packet, rtc_options);
 }
 
@@ -133,9 +133,24 @@ DelayBasedBwe::Result DelayBasedBwe::IncomingPacketFeedbackVector(
     absl::optional<DataRate> probe_bitrate,
     absl::optional<NetworkStateEstimate> network_estimate,
     bool in_alr) {
+  return IncomingPacketFeedbackVector(msg.SortedByReceiveTime(),
+                                      msg.feedback_time, acked_bitrate,
+                                      probe_bitrate, std::move(network_estimate),
+                                      in_alr);
+}
+
+DelayBasedBwe::Result DelayBasedBwe::IncomingPacketFeedbackVector(
+    rtc::ArrayView<const PacketResult> packet_feedback_vector,
+    Timestamp feedback_time,
+    absl::optional<DataRate> acked_bitrate,
+    absl::optional<DataRate> probe_bitrate,
+    absl::optional<NetworkStateEstimate> network_estimate,
+    bool in_alr) {
   RTC_DCHECK_RUNS_SERIALIZED(&network_race_);
+  RTC_DCHECK(std::is_sorted(packet_feedback_vector.begin(),
+                            packet_feedback_vector.end(),
+                            PacketResult::ReceiveTimeOrder()));
 
-  auto packet_feedback_vector = msg.SortedByReceiveTime();
   // TODO(holmer): An empty feedback vector here likely means that
   // all acks were too late and that the send time history had
   // timed out. We should reduce the rate when this occurs.
@@ -150,12 +165,29 @@ DelayBasedBwe::Result DelayBasedBwe::IncomingPacketFeedbackVector(
                               BweNames::kBweNamesMax);
     uma_recorded_ = true;
   }
-  bool delayed_feedback = true;
+
   bool recovered_from_overuse = false;
+  // Taken before a reset below, so that the first packet after a stream
+  // timeout while underusing still counts as recovering from overuse.
   BandwidthUsage prev_detector_state = active_delay_detector_->State();
-  for (const auto& packet_feedback : packet_feedback_vector) {
-    delayed_feedback = false;
-    IncomingPacketFeedback(packet_feedback, msg.feedback_time);
+  // Reset if the stream has timed out. All packets of the feedback are seen at
+  // the same time, so this is only needed once per feedback.
+  if (last_seen_packet_.IsInfinite() ||
+      feedback_time - last_seen_packet_ > kStreamTimeOut) {
+    video_inter_arrival_.reset(
+        new InterArrival(kTimestampGroupTicks, kTimestampToMs, true));
+    video_delay_detector_.reset(
+        new TrendlineEstimator(key_value_config_, network_state_predictor_));
+    audio_inter_arrival_.reset(
+        new InterArrival(kTimestampGroupTicks, kTimestampToMs, true));
+    audio_delay_detector_.reset(
+        new TrendlineEstimator(key_value_config_, network_state_predictor_));
+    active_delay_detector_ = video_delay_detector_.get();
+  }
+  last_seen_packet_ = feedback_time;
+
+  for (const PacketResult& packet_feedback : packet_feedback_vector) {
+    IncomingPacketFeedback(packet_feedback, feedback_time);
     if (prev_detector_state == BandwidthUsage::kBwUnderusing &&
         active_delay_detector_->State() == BandwidthUsage::kBwNormal) {
       recovered_from_overuse = true;
@@ -163,35 +195,15 @@ DelayBasedBwe::Result DelayBasedBwe::IncomingPacketFeedbackVector(
     prev_detector_state = active_delay_detector_->State();
   }
 
-  if (delayed_feedback) {
-    // TODO(bugs.webrtc.org/10125): Design a better mechanism to safe-guard
-    // against building very large network queues.
-    return Result();
-  }
   rate_control_.SetInApplicationLimitedRegion(in_alr);
   rate_control_.SetNetworkStateEstimate(network_estimate);
   return MaybeUpdateEstimate(acked_bitrate, probe_bitrate,
                              std::move(network_estimate),
-                             recovered_from_overuse, in_alr, msg.feedback_time);
+                             recovered_from_overuse, in_alr, feedback_time);
 }
 
 void DelayBasedBwe::IncomingPacketFeedback(const PacketResult& packet_feedback,
                                            Timestamp at_time) {
-  // Reset if the stream has timed out.
-  if (last_seen_packet_.IsInfinite() ||
-      at_time - last_seen_packet_ > kStreamTimeOut) {
-    video_inter_arrival_.reset(
-        new InterArrival(kTimestampGroupTicks, kTimestampToMs, true));
-    video_delay_detector_.reset(
-        new TrendlineEstimator(key_value_config_, network_state_predictor_));
-    audio_inter_arrival_.reset(
-        new InterArrival(kTimestampGroupTicks, kTimestampToMs, true));
-    audio_delay_detector_.reset(
-        new TrendlineEstimator(key_value_config_, network_state_predictor_));
-    active_delay_detector_ = video_delay_detector_.get();
-  }
-  last_seen_packet_ = at_time;
-
   // Ignore "small" packets if many/most packets in the call are "large". The
   // packet size may have a significant effect on the propagation delay,
   // especially at low bandwidths. Variations in packet size will then show up
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "absl/types/optional.h"
+#include "api/array_view.h"
 #include "api/network_state_predictor.h"
 #include "api/transport/network_types.h"
 #include "api/transport/webrtc_key_value_config.h"
@@ -86,6 +87,17 @@ class DelayBasedBwe {
       absl::optional<DataRate> probe_bitrate,
       absl::optional<NetworkStateEstimate> network_estimate,
       bool in_alr);
+  // As above, for the received packets of a feedback, sorted as by
+  // TransportPacketsFeedback::SortedByReceiveTime(). Processes the whole
+  // feedback in one pass, without copying it, so that callers can sort the
+  // packets once and share them with other estimators.
+  Result IncomingPacketFeedbackVector(
+      rtc::ArrayView<const PacketResult> packet_feedback_vector,
+      Timestamp feedback_time,
+      absl::optional<DataRate> acked_bitrate,
+      absl::optional<DataRate> probe_bitrate,
+      absl::optional<NetworkStateEstimate> network_estimate,
+      bool in_alr);
   void OnRttUpdate(TimeDelta avg_rtt);
   bool LatestEstimate(std::vector<uint32_t>* ssrcs, DataRate* bitrate) const;
   void SetStartBitrate(DataRate start_bitrate);
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "api/transport/network_types.h"
+#include "api/transport/webrtc_key_value_config.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "benchmark/benchmark.h"
+#include "modules/congestion_controller/goog_cc/delay_based_bwe.h"
+#include "modules/congestion_controller/goog_cc/trendline_estimator.h"
+#include "rtc_base/random.h"
+
+namespace webrtc {
+namespace {
+
+// 10000 packets per second, reported by transport feedback every 10 ms.
+constexpr TimeDelta kPacketInterval = TimeDelta::Micros(100);
+constexpr int kPacketsPerFeedback = 100;
+constexpr TimeDelta kDuration = TimeDelta::Seconds(10);
+constexpr DataSize kPacketSize = DataSize::Bytes(1200);
+
+class TrendlineWindowTrials : public WebRtcKeyValueConfig {
+ public:
+  explicit TrendlineWindowTrials(int window_size)
+      : window_size_(window_size) {}
+  std::string Lookup(absl::string_view key) const override {
+    if (key == TrendlineEstimatorSettings::kKey) {
+      return "window_size:" + std::to_string(window_size_);
+    }
+    return "";
+  }
+
+ private:
+  const int window_size_;
+};
+
+// The feedback of kDuration of packets, sent at a steady rate and received
+// with a queueing delay that slowly builds up and drains again, plus jitter.
+std::vector<TransportPacketsFeedback> GenerateFeedback() {
+  Random random(0x5eed);
+  std::vector<TransportPacketsFeedback> feedbacks;
+  const Timestamp start_time = Timestamp::Seconds(1000);
+  int64_t sequence_number = 0;
+  for (Timestamp send_time = start_time; send_time < start_time + kDuration;) {
+    TransportPacketsFeedback feedback;
+    for (int i = 0; i < kPacketsPerFeedback; ++i) {
+      PacketResult packet;
+      packet.sent_packet.send_time = send_time;
+      packet.sent_packet.sequence_number = sequence_number++;
+      packet.sent_packet.size = kPacketSize;
+      const double phase =
+          (send_time - start_time).ms() % 4000 / 4000.0;
+      const TimeDelta queue_delay = TimeDelta::Micros(
+          static_cast<int64_t>(40000 * std::min(phase, 1 - phase)) +
+          random.Rand(0, 2000));
+      packet.receive_time =
+          send_time + TimeDelta::Millis(20) + queue_delay;
+      feedback.packet_feedbacks.push_back(packet);
+      send_time += kPacketInterval;
+    }
+    feedback.feedback_time = send_time + TimeDelta::Millis(30);
+    feedbacks.push_back(feedback);
+  }
+  return feedbacks;
+}
+
+// Runs kDuration of feedback through a DelayBasedBwe. With range(1) == 0, the
+// feedback is passed as TransportPacketsFeedback, which DelayBasedBwe sorts
+// into a vector of its own; otherwise it is sorted into a reused vector
+// first, as GoogCcNetworkController does. range(0) is the trendline window
+// size.
+void BM_DelayBasedBwe(benchmark::State& state) {
+  const TrendlineWindowTrials field_trials(state.range(0));
+  const bool presorted = state.range(1) != 0;
+  const std::vector<TransportPacketsFeedback> feedbacks = GenerateFeedback();
+  std::vector<PacketResult> sorted_packets;
+  int64_t num_packets = 0;
+  for (auto _ : state) {
+    DelayBasedBwe bwe(&field_trials, /*event_log=*/nullptr,
+                      /*network_state_predictor=*/nullptr);
+    for (const TransportPacketsFeedback& feedback : feedbacks) {
+      DelayBasedBwe::Result result;
+      if (presorted) {
+        sorted_packets.assign(feedback.packet_feedbacks.begin(),
+                              feedback.packet_feedbacks.end());
+        if (!std::is_sorted(sorted_packets.begin(), sorted_packets.end(),
+                            PacketResult::ReceiveTimeOrder())) {
+          std::sort(sorted_packets.begin(), sorted_packets.end(),
+                    PacketResult::ReceiveTimeOrder());
+        }
+        result = bwe.IncomingPacketFeedbackVector(
+            sorted_packets, feedback.feedback_time,
+            /*acked_bitrate=*/absl::nullopt, /*probe_bitrate=*/absl::nullopt,
+            /*network_estimate=*/absl::nullopt, /*in_alr=*/false);
+      } else {
+        result = bwe.IncomingPacketFeedbackVector(
+            feedback, /*acked_bitrate=*/absl::nullopt,
+            /*probe_bitrate=*/absl::nullopt,
+            /*network_estimate=*/absl::nullopt, /*in_alr=*/false);
+      }
+      benchmark::DoNotOptimize(result);
+      num_packets += feedback.packet_feedbacks.size();
+    }
+  }
+  state.SetItemsProcessed(num_packets);
+}
+BENCHMARK(BM_DelayBasedBwe)
+    ->Args({20, 0})
+    ->Args({20, 1})
+    ->Args({200, 0})
+    ->Args({200, 1})
+    ->Unit(benchmark::kMillisecond);
+
+// Updates a TrendlineEstimator with a window of range(0) packet groups, once
+// per group.
+void BM_TrendlineEstimator(benchmark::State& state) {
+  const TrendlineWindowTrials field_trials(state.range(0));
+  TrendlineEstimator estimator(&field_trials,
+                               /*network_state_predictor=*/nullptr);
+  Random random(0x5eed);
+  int64_t send_time_ms = 1000;
+  int64_t arrival_time_ms = 2000;
+  for (auto _ : state) {
+    const double send_delta_ms = 5;
+    const double recv_delta_ms = random.Rand(3, 7);
+    send_time_ms += send_delta_ms;
+    arrival_time_ms += recv_delta_ms;
+    estimator.Update(recv_delta_ms, send_delta_ms, send_time_ms,
+                     arrival_time_ms, kPacketSize.bytes(),
+                     /*calculated_deltas=*/true);
+    benchmark::DoNotOptimize(estimator.State());
+  }
+}
+BENCHMARK(BM_TrendlineEstimator)->Arg(20)->Arg(200);
+
+}  // namespace
+}  // namespace webrtc
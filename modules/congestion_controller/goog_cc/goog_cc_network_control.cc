@@ -66,6 +66,24 @@ bool IsEnabled(const WebRtcKeyValueConfig* config, absl::string_view key) {
 bool IsNotDisabled(const WebRtcKeyValueConfig* config, absl::string_view key) {
   return !absl::StartsWith(config->Lookup(key), "Disabled");
 }
+
+// Fills |packets| with the received packets of |report|, as
+// TransportPacketsFeedback::SortedByReceiveTime(), but reusing its capacity.
+// Feedback is mostly in receive order already, so sorting is often skipped.
+void GetReceivedPacketsSortedByReceiveTime(
+    const TransportPacketsFeedback& report,
+    std::vector<PacketResult>* packets) {
+  packets->clear();
+  for (const PacketResult& packet : report.packet_feedbacks) {
+    if (packet.receive_time.IsFinite())
+      packets->push_back(packet);
+  }
+  if (!std::is_sorted(packets->begin(), packets->end(),
+                      PacketResult::ReceiveTimeOrder())) {
+    std::sort(packets->begin(), packets->end(),
+              PacketResult::ReceiveTimeOrder());
+  }
+}
 }  // namespace
 
 GoogCcNetworkController::GoogCcNetworkController(NetworkControllerConfig config,
@@ -418,11 +436,12 @@ NetworkControlUpdate GoogCcNetworkController::OnTransportPacketsFeedback(
   TimeDelta min_propagation_rtt = TimeDelta::PlusInfinity();
   Timestamp max_recv_time = Timestamp::MinusInfinity();
 
-  std::vector<PacketResult> feedbacks = report.ReceivedWithSendInfo();
-  for (const auto& feedback : feedbacks)
+  // The received packets are sorted once, and shared by the estimators below.
+  GetReceivedPacketsSortedByReceiveTime(report, &received_packets_);
+  for (const auto& feedback : received_packets_)
     max_recv_time = std::max(max_recv_time, feedback.receive_time);
 
-  for (const auto& feedback : feedbacks) {
+  for (const auto& feedback : received_packets_) {
     TimeDelta feedback_rtt =
         report.feedback_time - feedback.sent_packet.send_time;
     TimeDelta min_pending_time = feedback.receive_time - max_recv_time;
@@ -450,7 +469,7 @@ NetworkControlUpdate GoogCcNetworkController::OnTransportPacketsFeedback(
     }
 
     TimeDelta feedback_min_rtt = TimeDelta::PlusInfinity();
-    for (const auto& packet_feedback : feedbacks) {
+    for (const auto& packet_feedback : received_packets_) {
       TimeDelta pending_time = packet_feedback.receive_time - max_recv_time;
       TimeDelta rtt = report.feedback_time -
                       packet_feedback.sent_packet.send_time - pending_time;
@@ -486,12 +505,12 @@ NetworkControlUpdate GoogCcNetworkController::OnTransportPacketsFeedback(
   }
   previously_in_alr_ = alr_start_time.has_value();
   acknowledged_bitrate_estimator_->IncomingPacketFeedbackVector(
-      report.SortedByReceiveTime());
+      received_packets_);
   auto acknowledged_bitrate = acknowledged_bitrate_estimator_->bitrate();
   bandwidth_estimation_->SetAcknowledgedRate(acknowledged_bitrate,
                                              report.feedback_time);
   bandwidth_estimation_->IncomingPacketFeedbackVector(report);
-  for (const auto& feedback : report.SortedByReceiveTime()) {
+  for (const auto& feedback : received_packets_) {
     if (feedback.sent_packet.pacing_info.probe_cluster_id !=
         PacedPacketInfo::kNotAProbe) {
       probe_bitrate_estimator_->HandleProbeAndEstimateBitrate(feedback);
@@ -538,8 +557,8 @@ NetworkControlUpdate GoogCcNetworkController::OnTransportPacketsFeedback(
 
   DelayBasedBwe::Result result;
   result = delay_based_bwe_->IncomingPacketFeedbackVector(
-      report, acknowledged_bitrate, probe_bitrate, estimate_,
-      alr_start_time.has_value());
+      received_packets_, report.feedback_time, acknowledged_bitrate,
+      probe_bitrate, estimate_, alr_start_time.has_value());
 
   if (result.updated) {
     if (result.probe) {
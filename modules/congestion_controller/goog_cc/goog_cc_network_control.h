@@ -120,6 +120,9 @@ class GoogCcNetworkController : public NetworkControllerInterface {
   int expected_packets_since_last_loss_update_ = 0;
 
   std::deque<int64_t> feedback_max_rtts_;
+  // The received packets of the current feedback, sorted by receive time.
+  // Kept to reuse its capacity.
+  std::vector<PacketResult> received_packets_;
 
   DataRate last_loss_based_target_rate_;
   DataRate last_pushback_target_rate_;
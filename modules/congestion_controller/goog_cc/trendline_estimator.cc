@@ -51,32 +51,6 @@ size_t ReadTrendlineFilterWindowSize(
   return TrendlineEstimatorSettings::kDefaultTrendlineWindowSize;
 }
 
-absl::optional<double> LinearFitSlope(
-    const std::deque<TrendlineEstimator::PacketTiming>& packets) {
-  RTC_DCHECK(packets.size() >= 2);
-  // Compute the "center of mass".
-  double sum_x = 0;
-  double sum_y = 0;
-  for (const auto& packet : packets) {
-    sum_x += packet.arrival_time_ms;
-    sum_y += packet.smoothed_delay_ms;
-  }
-  double x_avg = sum_x / packets.size();
-  double y_avg = sum_y / packets.size();
-  // Compute the slope k = \sum (x_i-x_avg)(y_i-y_avg) / \sum (x_i-x_avg)^2
-  double numerator = 0;
-  double denominator = 0;
-  for (const auto& packet : packets) {
-    double x = packet.arrival_time_ms;
-    double y = packet.smoothed_delay_ms;
-    numerator += (x - x_avg) * (y - y_avg);
-    denominator += (x - x_avg) * (x - x_avg);
-  }
-  if (denominator == 0)
-    return absl::nullopt;
-  return numerator / denominator;
-}
-
 absl::optional<double> ComputeSlopeCap(
     const std::deque<TrendlineEstimator::PacketTiming>& packets,
     const TrendlineEstimatorSettings& settings) {
@@ -112,6 +86,46 @@ constexpr int kDeltaCounterMax = 1000;
 
 }  // namespace
 
+void SlidingLinearFit::Add(double x, double y) {
+  if (num_points_ == 0) {
+    origin_x_ = x;
+    origin_y_ = y;
+  }
+  x -= origin_x_;
+  y -= origin_y_;
+  ++num_points_;
+  sum_x_ += x;
+  sum_y_ += y;
+  sum_xx_ += x * x;
+  sum_xy_ += x * y;
+}
+
+void SlidingLinearFit::Remove(double x, double y) {
+  RTC_DCHECK_GT(num_points_, 0);
+  x -= origin_x_;
+  y -= origin_y_;
+  --num_points_;
+  sum_x_ -= x;
+  sum_y_ -= y;
+  sum_xx_ -= x * x;
+  sum_xy_ -= x * y;
+}
+
+void SlidingLinearFit::Reset() {
+  *this = SlidingLinearFit();
+}
+
+absl::optional<double> SlidingLinearFit::Slope() const {
+  RTC_DCHECK_GE(num_points_, 2);
+  // k = \sum (x_i-x_avg)(y_i-y_avg) / \sum (x_i-x_avg)^2, with both sums
+  // multiplied by the number of points.
+  const double n = num_points_;
+  const double denominator = n * sum_xx_ - sum_x_ * sum_x_;
+  if (denominator <= 0)
+    return absl::nullopt;
+  return (n * sum_xy_ - sum_x_ * sum_y_) / denominator;
+}
+
 constexpr char TrendlineEstimatorSettings::kKey[];
 
 TrendlineEstimatorSettings::TrendlineEstimatorSettings(
@@ -215,6 +229,8 @@ void TrendlineEstimator::UpdateTrendline(double recv_delta_ms,
   delay_hist_.emplace_back(
       static_cast<double>(arrival_time_ms - first_arrival_time_ms_),
       smoothed_delay_, accumulated_delay_);
+  linear_fit_.Add(delay_hist_.back().arrival_time_ms,
+                  delay_hist_.back().smoothed_delay_ms);
   if (settings_.enable_sort) {
     for (size_t i = delay_hist_.size() - 1;
          i > 0 &&
@@ -223,8 +239,14 @@ void TrendlineEstimator::UpdateTrendline(double recv_delta_ms,
       std::swap(delay_hist_[i], delay_hist_[i - 1]);
     }
   }
-  if (delay_hist_.size() > settings_.window_size)
+  if (delay_hist_.size() > settings_.window_size) {
+    linear_fit_.Remove(delay_hist_.front().arrival_time_ms,
+                       delay_hist_.front().smoothed_delay_ms);
     delay_hist_.pop_front();
+  }
+  // Recomputing the sums once per window keeps the update O(1) on average.
+  if (++packets_since_fit_reset_ >= settings_.window_size)
+    ResetLinearFit();
 
   // Simple linear regression.
   double trend = prev_trend_;
@@ -234,7 +256,7 @@ void TrendlineEstimator::UpdateTrendline(double recv_delta_ms,
     // 0 < trend < 1   ->  the delay increases, queues are filling up
     //   trend == 0    ->  the delay does not change
     //   trend < 0     ->  the delay decreases, queues are being emptied
-    trend = LinearFitSlope(delay_hist_).value_or(trend);
+    trend = linear_fit_.Slope().value_or(trend);
     if (settings_.enable_cap) {
       absl::optional<double> cap = ComputeSlopeCap(delay_hist_, settings_);
       // We only use the cap to filter out overuse detections, not
@@ -249,6 +271,13 @@ void TrendlineEstimator::UpdateTrendline(double recv_delta_ms,
   Detect(trend, send_delta_ms, arrival_time_ms);
 }
 
+void TrendlineEstimator::ResetLinearFit() {
+  linear_fit_.Reset();
+  for (const PacketTiming& packet : delay_hist_)
+    linear_fit_.Add(packet.arrival_time_ms, packet.smoothed_delay_ms);
+  packets_since_fit_reset_ = 0;
+}
+
 void TrendlineEstimator::Update(double recv_delta_ms,
                                 double send_delta_ms,
                                 int64_t send_time_ms,
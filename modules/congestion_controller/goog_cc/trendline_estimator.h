@@ -17,6 +17,7 @@
 #include <memory>
 #include <utility>
 
+#include "absl/types/optional.h"
 #include "api/network_state_predictor.h"
 #include "api/transport/webrtc_key_value_config.h"
 #include "modules/congestion_controller/goog_cc/delay_increase_detector_interface.h"
@@ -51,6 +52,33 @@ struct TrendlineEstimatorSettings {
   std::unique_ptr<StructParametersParser> Parser();
 };
 
+// Running sums for a least squares fit of a line to a sliding window of
+// points, so that points can enter and leave the window in constant time.
+// The sums are kept relative to the first point added since the last Reset(),
+// which keeps them small and, for integer x, exact. Callers should Reset() and
+// re-add the points of the window now and then, to bound the rounding errors
+// that accumulate in the sums of y.
+class SlidingLinearFit {
+ public:
+  void Add(double x, double y);
+  // |x| and |y| must be those of a point that was added.
+  void Remove(double x, double y);
+  void Reset();
+
+  size_t size() const { return num_points_; }
+  // The slope of the fitted line, or nullopt if all points have the same x.
+  absl::optional<double> Slope() const;
+
+ private:
+  size_t num_points_ = 0;
+  double origin_x_ = 0;
+  double origin_y_ = 0;
+  double sum_x_ = 0;
+  double sum_y_ = 0;
+  double sum_xx_ = 0;
+  double sum_xy_ = 0;
+};
+
 class TrendlineEstimator : public DelayIncreaseDetectorInterface {
  public:
   TrendlineEstimator(const WebRtcKeyValueConfig* key_value_config,
@@ -92,6 +120,8 @@ class TrendlineEstimator : public DelayIncreaseDetectorInterface {
   void Detect(double trend, double ts_delta, int64_t now_ms);
 
   void UpdateThreshold(double modified_offset, int64_t now_ms);
+  // Recomputes |linear_fit_| from |delay_hist_|.
+  void ResetLinearFit();
 
   // Parameters.
   TrendlineEstimatorSettings settings_;
@@ -106,6 +136,8 @@ class TrendlineEstimator : public DelayIncreaseDetectorInterface {
   double smoothed_delay_;
   // Linear least squares regression.
   std::deque<PacketTiming> delay_hist_;
+  SlidingLinearFit linear_fit_;
+  size_t packets_since_fit_reset_ = 0;
 
   const double k_up_;
   const double k_down_;
@@ -10,10 +10,15 @@
 
 #include "modules/congestion_controller/goog_cc/trendline_estimator.h"
 
+#include <math.h>
+
 #include <algorithm>
+#include <deque>
 #include <numeric>
+#include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "api/transport/field_trial_based_config.h"
 #include "rtc_base/random.h"
 #include "test/gtest.h"
@@ -37,6 +42,29 @@ class PacketTimeGenerator {
   size_t packets_;
 };
 
+// The least squares slope computed directly from the points, as
+// TrendlineEstimator did before it kept running sums.
+absl::optional<double> DirectLinearFitSlope(
+    const std::deque<std::pair<double, double>>& points) {
+  double sum_x = 0;
+  double sum_y = 0;
+  for (const auto& point : points) {
+    sum_x += point.first;
+    sum_y += point.second;
+  }
+  double x_avg = sum_x / points.size();
+  double y_avg = sum_y / points.size();
+  double numerator = 0;
+  double denominator = 0;
+  for (const auto& point : points) {
+    numerator += (point.first - x_avg) * (point.second - y_avg);
+    denominator += (point.first - x_avg) * (point.first - x_avg);
+  }
+  if (denominator == 0)
+    return absl::nullopt;
+  return numerator / denominator;
+}
+
 class TrendlineEstimatorTest : public testing::Test {
  public:
   TrendlineEstimatorTest()
@@ -148,4 +176,51 @@ TEST_F(TrendlineEstimatorTest, IncludesSmallPacketsByDefault) {
   EXPECT_EQ(count, kPacketCount);  // All packets processed
 }
 
+TEST(SlidingLinearFitTest, MatchesDirectFitOverManySlides) {
+  constexpr size_t kWindowSize = 20;
+  Random random(0x7e4d);
+  SlidingLinearFit fit;
+  std::deque<std::pair<double, double>> points;
+  int64_t arrival_time_ms = 3600 * 1000;
+  double delay_ms = 0;
+  for (int i = 0; i < 100000; ++i) {
+    arrival_time_ms += random.Rand(0, 30);
+    delay_ms += random.Gaussian(0, 2);
+    points.emplace_back(arrival_time_ms, delay_ms);
+    fit.Add(points.back().first, points.back().second);
+    if (points.size() > kWindowSize) {
+      fit.Remove(points.front().first, points.front().second);
+      points.pop_front();
+    }
+    // As TrendlineEstimator, recompute the sums once per window.
+    if (i % kWindowSize == 0) {
+      fit.Reset();
+      for (const auto& point : points)
+        fit.Add(point.first, point.second);
+    }
+    if (points.size() < 2)
+      continue;
+    ASSERT_EQ(fit.size(), points.size());
+    absl::optional<double> expected = DirectLinearFitSlope(points);
+    absl::optional<double> slope = fit.Slope();
+    ASSERT_EQ(expected.has_value(), slope.has_value()) << i;
+    if (expected) {
+      ASSERT_NEAR(*expected, *slope, 1e-9 * std::max(1.0, fabs(*expected)))
+          << i;
+    }
+  }
+}
+
+TEST(SlidingLinearFitTest, NoSlopeForEqualArrivalTimes) {
+  SlidingLinearFit fit;
+  fit.Add(1000, 1.5);
+  fit.Add(1000, 2.5);
+  fit.Add(1000, -0.5);
+  EXPECT_FALSE(fit.Slope().has_value());
+  fit.Add(1010, 2.5);
+  EXPECT_TRUE(fit.Slope().has_value());
+  fit.Remove(1010, 2.5);
+  EXPECT_FALSE(fit.Slope().has_value());
+}
+
 }  // namespace webrtc
@@ -27,6 +27,11 @@
 namespace webrtc {
 
 constexpr TimeDelta kSendTimeHistoryWindow = TimeDelta::Seconds(60);
+// Initial size of the ring buffer of PacketFeedbackHistory, enough for the
+// packets in flight of most calls.
+constexpr size_t kMinHistorySize = 64;
+// The ring buffer is shrunk again if it has grown larger than this.
+constexpr size_t kMaxRetainedHistorySize = 1024;
 
 void InFlightBytesTracker::AddInFlightPacketBytes(
     const PacketFeedback& packet) {
@@ -84,8 +89,82 @@ bool InFlightBytesTracker::NetworkRouteComparator::operator()(
   return a.connected < b.connected;
 }
 
-TransportFeedbackAdapter::TransportFeedbackAdapter() = default;
+PacketFeedbackHistory::PacketFeedbackHistory() = default;
+PacketFeedbackHistory::~PacketFeedbackHistory() = default;
+
+bool PacketFeedbackHistory::Insert(const PacketFeedback& packet) {
+  const int64_t seq_num = packet.sent.sequence_number;
+  if (empty()) {
+    begin_seq_num_ = seq_num;
+    end_seq_num_ = seq_num;
+  }
+  if (seq_num < begin_seq_num_)
+    return false;
+  if (seq_num >= end_seq_num_) {
+    Grow(seq_num + 1 - begin_seq_num_);
+    end_seq_num_ = seq_num + 1;
+  }
+  Slot& entry = slot(seq_num);
+  if (entry.present)
+    return false;
+  entry.packet = packet;
+  entry.present = true;
+  return true;
+}
+
+PacketFeedback* PacketFeedbackHistory::Find(int64_t seq_num) {
+  if (seq_num < begin_seq_num_ || seq_num >= end_seq_num_)
+    return nullptr;
+  Slot& entry = slot(seq_num);
+  return entry.present ? &entry.packet : nullptr;
+}
+
+void PacketFeedbackHistory::Erase(int64_t seq_num) {
+  if (seq_num < begin_seq_num_ || seq_num >= end_seq_num_)
+    return;
+  slot(seq_num).present = false;
+  AdvanceBegin();
+}
+
+void PacketFeedbackHistory::PopFront() {
+  RTC_DCHECK(!empty());
+  Erase(begin_seq_num_);
+}
+
+void PacketFeedbackHistory::Grow(size_t min_size) {
+  if (min_size <= slots_.size())
+    return;
+  size_t new_size = std::max(slots_.size(), kMinHistorySize);
+  while (new_size < min_size)
+    new_size *= 2;
+  Resize(new_size);
+}
 
+void PacketFeedbackHistory::Resize(size_t new_size) {
+  RTC_DCHECK_GE(new_size, static_cast<size_t>(end_seq_num_ - begin_seq_num_));
+  std::vector<Slot> old_slots(new_size);
+  old_slots.swap(slots_);
+  if (old_slots.empty())
+    return;
+  for (int64_t seq_num = begin_seq_num_; seq_num < end_seq_num_; ++seq_num) {
+    Slot& old_slot =
+        old_slots[static_cast<uint64_t>(seq_num) & (old_slots.size() - 1)];
+    if (old_slot.present)
+      slot(seq_num) = old_slot;
+  }
+}
+
+void PacketFeedbackHistory::AdvanceBegin() {
+  while (!empty() && !slot(begin_seq_num_).present)
+    ++begin_seq_num_;
+  // Give back the memory of a long period without feedback, but leave smaller
+  // sizes be, so that bursts of packets in flight do not resize back and forth.
+  const size_t span = end_seq_num_ - begin_seq_num_;
+  if (slots_.size() > kMaxRetainedHistorySize && span * 8 <= slots_.size())
+    Resize(slots_.size() / 4);
+}
+
+TransportFeedbackAdapter::TransportFeedbackAdapter() = default;
 
 void TransportFeedbackAdapter::AddPacket(const RtpPacketSendInfo& packet_info,
                                          size_t overhead_bytes,
@@ -99,15 +178,26 @@ void TransportFeedbackAdapter::AddPacket(const RtpPacketSendInfo& packet_info,
   packet.network_route = network_route_;
   packet.sent.pacing_info = packet_info.pacing_info;
 
-  while (!history_.empty() &&
-         creation_time - history_.begin()->second.creation_time >
-             kSendTimeHistoryWindow) {
+  while (!history_.empty()) {
+    PacketFeedback* oldest = history_.Find(history_.begin_seq_num());
+    if (creation_time - oldest->creation_time <= kSendTimeHistoryWindow)
+      break;
     // TODO(sprang): Warn if erasing (too many) old items?
-    if (history_.begin()->second.sent.sequence_number > last_ack_seq_num_)
-      in_flight_.RemoveInFlightPacketBytes(history_.begin()->second);
-    history_.erase(history_.begin());
+    if (oldest->sent.sequence_number > last_ack_seq_num_)
+      in_flight_.RemoveInFlightPacketBytes(*oldest);
+    history_.PopFront();
+  }
+  while (!lost_history_.empty() &&
+         creation_time - lost_history_.begin()->second.creation_time >
+             kSendTimeHistoryWindow) {
+    if (lost_history_.begin()->first > last_ack_seq_num_)
+      in_flight_.RemoveInFlightPacketBytes(lost_history_.begin()->second);
+    lost_history_.erase(lost_history_.begin());
+  }
+  if (!history_.Insert(packet) &&
+      packet.sent.sequence_number < history_.begin_seq_num()) {
+    lost_history_.insert(std::make_pair(packet.sent.sequence_number, packet));
   }
-  history_.insert(std::make_pair(packet.sent.sequence_number, packet));
 }
 
 absl::optional<SentPacket> TransportFeedbackAdapter::ProcessSentPacket(
@@ -117,10 +207,10 @@ absl::optional<SentPacket> TransportFeedbackAdapter::ProcessSentPacket(
   if (sent_packet.info.included_in_feedback || sent_packet.packet_id != -1) {
     int64_t unwrapped_seq_num =
         seq_num_unwrapper_.Unwrap(sent_packet.packet_id);
-    auto it = history_.find(unwrapped_seq_num);
-    if (it != history_.end()) {
-      bool packet_retransmit = it->second.sent.send_time.IsFinite();
-      it->second.sent.send_time = send_time;
+    PacketFeedback* packet = FindPacket(unwrapped_seq_num);
+    if (packet) {
+      bool packet_retransmit = packet->sent.send_time.IsFinite();
+      packet->sent.send_time = send_time;
       last_send_time_ = std::max(last_send_time_, send_time);
       // TODO(srte): Don't do this on retransmit.
       if (!pending_untracked_size_.IsZero()) {
@@ -128,14 +218,14 @@ absl::optional<SentPacket> TransportFeedbackAdapter::ProcessSentPacket(
           RTC_LOG(LS_WARNING)
               << "appending acknowledged data for out of order packet. (Diff: "
               << ToString(last_untracked_send_time_ - send_time) << " ms.)";
-        it->second.sent.prior_unacked_data += pending_untracked_size_;
+        packet->sent.prior_unacked_data += pending_untracked_size_;
         pending_untracked_size_ = DataSize::Zero();
       }
       if (!packet_retransmit) {
-        if (it->second.sent.sequence_number > last_ack_seq_num_)
-          in_flight_.AddInFlightPacketBytes(it->second);
-        it->second.sent.data_in_flight = GetOutstandingData();
-        return it->second.sent;
+        if (packet->sent.sequence_number > last_ack_seq_num_)
+          in_flight_.AddInFlightPacketBytes(*packet);
+        packet->sent.data_in_flight = GetOutstandingData();
+        return packet->sent;
       }
     }
   } else if (sent_packet.info.included_in_allocation) {
@@ -153,27 +243,38 @@ absl::optional<TransportPacketsFeedback>
 TransportFeedbackAdapter::ProcessTransportFeedback(
     const rtcp::TransportFeedback& feedback,
     Timestamp feedback_receive_time) {
+  TransportPacketsFeedback msg;
+  if (!ProcessTransportFeedback(feedback, feedback_receive_time, &msg))
+    return absl::nullopt;
+  return msg;
+}
+
+bool TransportFeedbackAdapter::ProcessTransportFeedback(
+    const rtcp::TransportFeedback& feedback,
+    Timestamp feedback_receive_time,
+    TransportPacketsFeedback* msg) {
   if (feedback.GetPacketStatusCount() == 0) {
     RTC_LOG(LS_INFO) << "Empty transport feedback packet received.";
-    return absl::nullopt;
+    return false;
   }
 
-  TransportPacketsFeedback msg;
-  msg.feedback_time = feedback_receive_time;
+  msg->feedback_time = feedback_receive_time;
+  msg->first_unacked_send_time = Timestamp::PlusInfinity();
+  msg->sendless_arrival_times.clear();
 
-  msg.prior_in_flight = in_flight_.GetOutstandingData(network_route_);
-  msg.packet_feedbacks =
-      ProcessTransportFeedbackInner(feedback, feedback_receive_time);
-  if (msg.packet_feedbacks.empty())
-    return absl::nullopt;
+  msg->prior_in_flight = in_flight_.GetOutstandingData(network_route_);
+  ProcessTransportFeedbackInner(feedback, feedback_receive_time,
+                                &msg->packet_feedbacks);
+  if (msg->packet_feedbacks.empty())
+    return false;
 
-  auto it = history_.find(last_ack_seq_num_);
-  if (it != history_.end()) {
-    msg.first_unacked_send_time = it->second.sent.send_time;
+  PacketFeedback* last_acked = FindPacket(last_ack_seq_num_);
+  if (last_acked) {
+    msg->first_unacked_send_time = last_acked->sent.send_time;
   }
-  msg.data_in_flight = in_flight_.GetOutstandingData(network_route_);
+  msg->data_in_flight = in_flight_.GetOutstandingData(network_route_);
 
-  return msg;
+  return true;
 }
 
 void TransportFeedbackAdapter::SetNetworkRoute(
@@ -185,10 +286,10 @@ DataSize TransportFeedbackAdapter::GetOutstandingData() const {
   return in_flight_.GetOutstandingData(network_route_);
 }
 
-std::vector<PacketResult>
-TransportFeedbackAdapter::ProcessTransportFeedbackInner(
+void TransportFeedbackAdapter::ProcessTransportFeedbackInner(
     const rtcp::TransportFeedback& feedback,
-    Timestamp feedback_receive_time) {
+    Timestamp feedback_receive_time,
+    std::vector<PacketResult>* packet_results) {
   // Add timestamp deltas to a local time base selected on first packet arrival.
   // This won't be the true time base, but makes it easier to manually inspect
   // time stamps.
@@ -208,56 +309,67 @@ TransportFeedbackAdapter::ProcessTransportFeedbackInner(
   }
   last_timestamp_ = feedback.GetBaseTime();
 
-  std::vector<PacketResult> packet_result_vector;
-  packet_result_vector.reserve(feedback.GetPacketStatusCount());
+  packet_results->clear();
+  packet_results->reserve(feedback.GetPacketStatusCount());
 
   size_t failed_lookups = 0;
   size_t ignored = 0;
-  TimeDelta packet_offset = TimeDelta::Zero();
-  for (const auto& packet : feedback.GetAllPackets()) {
-    int64_t seq_num = seq_num_unwrapper_.Unwrap(packet.sequence_number());
+  feedback.ForAllPackets([&](uint16_t sequence_number,
+                             TimeDelta delta_since_base) {
+    int64_t seq_num = seq_num_unwrapper_.Unwrap(sequence_number);
 
     if (seq_num > last_ack_seq_num_) {
-      // Starts at history_.begin() if last_ack_seq_num_ < 0, since any valid
-      // sequence number is >= 0.
-      for (auto it = history_.upper_bound(last_ack_seq_num_);
-           it != history_.upper_bound(seq_num); ++it) {
+      for (int64_t acked = std::max(last_ack_seq_num_ + 1,
+                                    history_.begin_seq_num());
+           acked <= seq_num && acked < history_.end_seq_num(); ++acked) {
+        PacketFeedback* packet = history_.Find(acked);
+        if (packet)
+          in_flight_.RemoveInFlightPacketBytes(*packet);
+      }
+      for (auto it = lost_history_.upper_bound(last_ack_seq_num_);
+           it != lost_history_.end() && it->first <= seq_num; ++it) {
         in_flight_.RemoveInFlightPacketBytes(it->second);
       }
       last_ack_seq_num_ = seq_num;
     }
 
-    auto it = history_.find(seq_num);
-    if (it == history_.end()) {
+    PacketFeedback* packet = FindPacket(seq_num);
+    if (!packet) {
       ++failed_lookups;
-      continue;
+      return;
     }
 
-    if (it->second.sent.send_time.IsInfinite()) {
+    if (packet->sent.send_time.IsInfinite()) {
       // TODO(srte): Fix the tests that makes this happen and make this a
       // DCHECK.
       RTC_DLOG(LS_ERROR)
           << "Received feedback before packet was indicated as sent";
-      continue;
+      return;
     }
 
-    PacketFeedback packet_feedback = it->second;
-    if (packet.received()) {
-      packet_offset += packet.delta();
-      packet_feedback.receive_time =
-          current_offset_ + packet_offset.RoundDownTo(TimeDelta::Millis(1));
-      // Note: Lost packets are not removed from history because they might be
-      // reported as received by a later feedback.
-      history_.erase(it);
-    }
-    if (packet_feedback.network_route == network_route_) {
-      PacketResult result;
-      result.sent_packet = packet_feedback.sent;
-      result.receive_time = packet_feedback.receive_time;
-      packet_result_vector.push_back(result);
+    if (packet->network_route == network_route_) {
+      packet_results->emplace_back();
+      packet_results->back().sent_packet = packet->sent;
+      if (delta_since_base.IsFinite()) {
+        packet_results->back().receive_time =
+            current_offset_ +
+            delta_since_base.RoundDownTo(TimeDelta::Millis(1));
+      }
     } else {
       ++ignored;
     }
+    if (delta_since_base.IsFinite()) {
+      // Note: Lost packets are not removed from history because they might be
+      // reported as received by a later feedback.
+      ErasePacket(seq_num);
+    }
+  });
+
+  // Acknowledged packets still in |history_| were reported lost.
+  while (!history_.empty() && history_.begin_seq_num() <= last_ack_seq_num_) {
+    lost_history_.insert(std::make_pair(
+        history_.begin_seq_num(), *history_.Find(history_.begin_seq_num())));
+    history_.PopFront();
   }
 
   if (failed_lookups > 0) {
@@ -269,8 +381,22 @@ TransportFeedbackAdapter::ProcessTransportFeedbackInner(
     RTC_LOG(LS_INFO) << "Ignoring " << ignored
                      << " packets because they were sent on a different route.";
   }
+}
+
+PacketFeedback* TransportFeedbackAdapter::FindPacket(int64_t seq_num) {
+  PacketFeedback* packet = history_.Find(seq_num);
+  if (packet)
+    return packet;
+  auto it = lost_history_.find(seq_num);
+  return it != lost_history_.end() ? &it->second : nullptr;
+}
 
-  return packet_result_vector;
+void TransportFeedbackAdapter::ErasePacket(int64_t seq_num) {
+  if (history_.Find(seq_num)) {
+    history_.Erase(seq_num);
+  } else {
+    lost_history_.erase(seq_num);
+  }
 }
 
 }  // namespace webrtc
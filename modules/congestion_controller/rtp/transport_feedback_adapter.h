@@ -55,6 +55,50 @@ class InFlightBytesTracker {
   std::map<rtc::NetworkRoute, DataSize, NetworkRouteComparator> in_flight_data_;
 };
 
+// The PacketFeedback of sent packets, indexed by transport sequence number in a
+// ring buffer. Packets are expected to be added, acknowledged and dropped
+// roughly in sequence number order, so it only allocates when it grows.
+class PacketFeedbackHistory {
+ public:
+  PacketFeedbackHistory();
+  ~PacketFeedbackHistory();
+
+  bool empty() const { return begin_seq_num_ == end_seq_num_; }
+  // The range of sequence numbers the history spans. The first one is present
+  // unless the history is empty.
+  int64_t begin_seq_num() const { return begin_seq_num_; }
+  int64_t end_seq_num() const { return end_seq_num_; }
+
+  // Adds |packet| under |packet.sent.sequence_number|. Returns false, and does
+  // not add it, if it is before begin_seq_num() or already present.
+  bool Insert(const PacketFeedback& packet);
+  // Returns null if the packet is not present.
+  PacketFeedback* Find(int64_t seq_num);
+  void Erase(int64_t seq_num);
+  // Erases the packet at begin_seq_num().
+  void PopFront();
+
+ private:
+  struct Slot {
+    PacketFeedback packet;
+    bool present = false;
+  };
+
+  Slot& slot(int64_t seq_num) {
+    return slots_[static_cast<uint64_t>(seq_num) & (slots_.size() - 1)];
+  }
+  void Grow(size_t min_size);
+  void Resize(size_t new_size);
+  // Drops erased packets from the front, so that the first one is present.
+  void AdvanceBegin();
+
+  // Empty, or a power of two in size. Slots outside
+  // [begin_seq_num_, end_seq_num_) are never present.
+  std::vector<Slot> slots_;
+  int64_t begin_seq_num_ = 0;
+  int64_t end_seq_num_ = 0;
+};
+
 class TransportFeedbackAdapter {
  public:
   TransportFeedbackAdapter();
@@ -68,6 +112,11 @@ class TransportFeedbackAdapter {
   absl::optional<TransportPacketsFeedback> ProcessTransportFeedback(
       const rtcp::TransportFeedback& feedback,
       Timestamp feedback_receive_time);
+  // As above, but fills in |msg|, reusing the capacity of its vectors. Returns
+  // false if there is no feedback to report.
+  bool ProcessTransportFeedback(const rtcp::TransportFeedback& feedback,
+                                Timestamp feedback_receive_time,
+                                TransportPacketsFeedback* msg);
 
   void SetNetworkRoute(const rtc::NetworkRoute& network_route);
 
@@ -76,15 +125,24 @@ class TransportFeedbackAdapter {
  private:
   enum class SendTimeHistoryStatus { kNotAdded, kOk, kDuplicate };
 
-  std::vector<PacketResult> ProcessTransportFeedbackInner(
+  void ProcessTransportFeedbackInner(
       const rtcp::TransportFeedback& feedback,
-      Timestamp feedback_receive_time);
+      Timestamp feedback_receive_time,
+      std::vector<PacketResult>* packet_results);
+
+  PacketFeedback* FindPacket(int64_t seq_num);
+  void ErasePacket(int64_t seq_num);
 
   DataSize pending_untracked_size_ = DataSize::Zero();
   Timestamp last_send_time_ = Timestamp::MinusInfinity();
   Timestamp last_untracked_send_time_ = Timestamp::MinusInfinity();
   SequenceNumberUnwrapper seq_num_unwrapper_;
-  std::map<int64_t, PacketFeedback> history_;
+  // Sent packets that are not yet acknowledged.
+  PacketFeedbackHistory history_;
+  // Acknowledged packets that were reported lost, kept in case a later
+  // feedback reports them received, and the rare packet added after a later
+  // one was acknowledged.
+  std::map<int64_t, PacketFeedback> lost_history_;
 
   // Sequence numbers are never negative, using -1 as it always < a real
   // sequence number.
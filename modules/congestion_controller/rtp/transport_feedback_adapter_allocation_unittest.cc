@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "api/transport/network_types.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "modules/congestion_controller/rtp/transport_feedback_adapter.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/network/sent_packet.h"
+#include "test/allocation_counter.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kPacketsPerFeedback = 10;
+constexpr int kPacketsInFlight = 500;
+constexpr int kNumFeedbacks = 1000;
+constexpr TimeDelta kFeedbackInterval = TimeDelta::Millis(1);
+constexpr TimeDelta kFeedbackDelay = TimeDelta::Millis(30);
+
+// Once the send history has reached its steady state size, processing a
+// parsed transport feedback into a reused TransportPacketsFeedback doesn't
+// allocate.
+TEST(TransportFeedbackAdapterAllocationTest, ReusedFeedbackDoesNotAllocate) {
+  TransportFeedbackAdapter adapter;
+  TransportPacketsFeedback feedback_msg;
+  Timestamp now = Timestamp::Seconds(1000);
+  int64_t next_sequence_number = 0;
+  int64_t next_acked_sequence_number = 0;
+  uint8_t feedback_sequence_number = 0;
+
+  for (int i = 0; i < kNumFeedbacks; ++i) {
+    now += kFeedbackInterval;
+    for (int j = 0; j < kPacketsPerFeedback; ++j) {
+      RtpPacketSendInfo packet_info;
+      packet_info.transport_sequence_number =
+          static_cast<uint16_t>(next_sequence_number++);
+      packet_info.ssrc = 1234;
+      packet_info.length = 1200;
+      packet_info.packet_type = RtpPacketMediaType::kVideo;
+      adapter.AddPacket(packet_info, /*overhead_bytes=*/0, now);
+      adapter.ProcessSentPacket(
+          rtc::SentPacket(packet_info.transport_sequence_number, now.ms()));
+    }
+    if (next_sequence_number < kPacketsInFlight + kPacketsPerFeedback)
+      continue;
+
+    const Timestamp receive_time = now - kFeedbackDelay;
+    rtcp::TransportFeedback built_feedback;
+    built_feedback.SetBase(static_cast<uint16_t>(next_acked_sequence_number),
+                           receive_time.us());
+    for (int j = 0; j < kPacketsPerFeedback; ++j) {
+      built_feedback.AddReceivedPacket(
+          static_cast<uint16_t>(next_acked_sequence_number++),
+          (receive_time + TimeDelta::Micros(100 * j)).us());
+    }
+    built_feedback.SetFeedbackSequenceNumber(feedback_sequence_number++);
+    const rtc::Buffer raw_feedback = built_feedback.Build();
+    std::unique_ptr<rtcp::TransportFeedback> feedback =
+        rtcp::TransportFeedback::ParseFrom(raw_feedback.data(),
+                                           raw_feedback.size());
+    ASSERT_TRUE(feedback);
+
+    // The first feedbacks size |feedback_msg|.
+    const int64_t allocations_before = test::NumAllocations();
+    ASSERT_TRUE(
+        adapter.ProcessTransportFeedback(*feedback, now, &feedback_msg));
+    if (i >= kNumFeedbacks / 2) {
+      EXPECT_EQ(test::NumAllocations(), allocations_before) << "feedback " << i;
+    }
+    ASSERT_EQ(static_cast<size_t>(kPacketsPerFeedback),
+              feedback_msg.packet_feedbacks.size());
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "api/task_queue/queued_task.h"
+#include "api/transport/network_types.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "benchmark/benchmark.h"
+#include "modules/congestion_controller/rtp/transport_feedback_adapter.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/network/sent_packet.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "test/allocation_counter.h"
+
+namespace webrtc {
+namespace {
+
+// 10000 packets per second, acknowledged by transport feedback every
+// millisecond. The feedback arrives 50 ms after the packets were sent, and
+// 30 ms after they were received.
+constexpr TimeDelta kFeedbackInterval = TimeDelta::Millis(1);
+constexpr int kPacketsPerFeedback = 10;
+constexpr int kPacketsInFlight = 500;
+constexpr TimeDelta kFeedbackDelay = TimeDelta::Millis(30);
+constexpr size_t kPacketSize = 1200;
+// Long enough for the send history to reach its steady state size.
+constexpr TimeDelta kWarmUpTime = TimeDelta::Seconds(2);
+
+// Sends the packets and processes the transport feedback for them as a call
+// does: RTCPReceiver parses each feedback block into a new TransportFeedback,
+// and RtpTransportControllerSend copies it into the task that processes it on
+// its task queue, into a TransportPacketsFeedback that it keeps.
+class FeedbackSimulation {
+ public:
+  FeedbackSimulation() : now_(Timestamp::Seconds(1000)) {}
+
+  // Sends the packets of one feedback interval, and processes the feedback
+  // received in it. Returns the number of allocations made, not counting
+  // those of building the serialized feedback.
+  int64_t RunFeedbackInterval() {
+    now_ += kFeedbackInterval;
+    const int64_t allocations_before_send = test::NumAllocations();
+    for (int i = 0; i < kPacketsPerFeedback; ++i)
+      SendPacket();
+    int64_t allocations = test::NumAllocations() - allocations_before_send;
+
+    if (next_sequence_number_ < kPacketsInFlight + kPacketsPerFeedback)
+      return allocations;
+    const rtc::Buffer raw_feedback = BuildFeedback();
+    const int64_t allocations_before_feedback = test::NumAllocations();
+    rtcp::CommonHeader header;
+    header.Parse(raw_feedback.data(), raw_feedback.size());
+    auto parsed_feedback = std::make_unique<rtcp::TransportFeedback>(
+        /*include_timestamps=*/true, /*include_lost=*/false);
+    parsed_feedback->Parse(header);
+    OnTransportFeedback(*parsed_feedback);
+    return allocations + test::NumAllocations() - allocations_before_feedback;
+  }
+
+ private:
+  void OnTransportFeedback(const rtcp::TransportFeedback& feedback) {
+    const Timestamp feedback_time = now_;
+    std::unique_ptr<QueuedTask> task =
+        ToQueuedTask([this, feedback, feedback_time] {
+          adapter_.ProcessTransportFeedback(feedback, feedback_time,
+                                            &feedback_msg_);
+          benchmark::DoNotOptimize(feedback_msg_.packet_feedbacks.data());
+        });
+    task->Run();
+  }
+
+  void SendPacket() {
+    RtpPacketSendInfo packet_info;
+    packet_info.transport_sequence_number =
+        static_cast<uint16_t>(next_sequence_number_);
+    packet_info.ssrc = 1234;
+    packet_info.length = kPacketSize;
+    packet_info.packet_type = RtpPacketMediaType::kVideo;
+    adapter_.AddPacket(packet_info, /*overhead_bytes=*/0, now_);
+    adapter_.ProcessSentPacket(
+        rtc::SentPacket(packet_info.transport_sequence_number, now_.ms()));
+    ++next_sequence_number_;
+  }
+
+  // Acknowledges the next kPacketsPerFeedback packets as received.
+  rtc::Buffer BuildFeedback() {
+    const Timestamp receive_time = now_ - kFeedbackDelay;
+    rtcp::TransportFeedback feedback;
+    feedback.SetBase(static_cast<uint16_t>(next_acked_sequence_number_),
+                     receive_time.us());
+    for (int i = 0; i < kPacketsPerFeedback; ++i) {
+      feedback.AddReceivedPacket(
+          static_cast<uint16_t>(next_acked_sequence_number_++),
+          (receive_time + TimeDelta::Micros(100 * i)).us());
+    }
+    feedback.SetFeedbackSequenceNumber(feedback_sequence_number_++);
+    return feedback.Build();
+  }
+
+  Timestamp now_;
+  int64_t next_sequence_number_ = 0;
+  int64_t next_acked_sequence_number_ = 0;
+  uint8_t feedback_sequence_number_ = 0;
+  TransportFeedbackAdapter adapter_;
+  TransportPacketsFeedback feedback_msg_;
+};
+
+// Reports the allocations for sending the packets of, and processing, one
+// transport feedback, once the history has reached its steady state size.
+// transport_feedback_adapter_allocation_unittest checks that processing the
+// parsed feedback itself doesn't allocate.
+void BM_TransportFeedback(benchmark::State& state) {
+  FeedbackSimulation simulation;
+  for (TimeDelta time = TimeDelta::Zero(); time < kWarmUpTime;
+       time += kFeedbackInterval) {
+    simulation.RunFeedbackInterval();
+  }
+
+  int64_t allocations = 0;
+  int64_t num_feedbacks = 0;
+  for (auto _ : state) {
+    allocations += simulation.RunFeedbackInterval();
+    ++num_feedbacks;
+  }
+  state.counters["allocations_per_feedback"] =
+      static_cast<double>(allocations) / num_feedbacks;
+}
+BENCHMARK(BM_TransportFeedback);
+
+}  // namespace
+}  // namespace webrtc
@@ -228,6 +228,37 @@ TEST_F(TransportFeedbackAdapterTest, HandlesDroppedPackets) {
   ComparePacketFeedbackVectors(expected_packets, res->packet_feedbacks);
 }
 
+TEST_F(TransportFeedbackAdapterTest,
+       ReceiveTimesIncludeDeltasOfPacketsNotInHistory) {
+  std::vector<PacketResult> packets;
+  packets.push_back(CreatePacket(100, 200, 0, 1500, kPacingInfo0));
+  packets.push_back(CreatePacket(150, 210, 1, 1500, kPacingInfo0));
+  packets.push_back(CreatePacket(160, 220, 2, 1500, kPacingInfo0));
+
+  // The send history has no record of the packet in the middle.
+  OnSentPacket(packets[0]);
+  OnSentPacket(packets[2]);
+
+  rtcp::TransportFeedback feedback;
+  feedback.SetBase(packets[0].sent_packet.sequence_number,
+                   packets[0].receive_time.us());
+  for (const auto& packet : packets) {
+    EXPECT_TRUE(feedback.AddReceivedPacket(packet.sent_packet.sequence_number,
+                                           packet.receive_time.us()));
+  }
+  feedback.Build();
+
+  // The receive delta of each packet is relative to the packet received
+  // before it, whether or not that one could be looked up, so the last packet
+  // keeps its receive time relative to the first.
+  std::vector<PacketResult> expected_packets = {packets[0], packets[2]};
+  auto res = adapter_->ProcessTransportFeedback(feedback, clock_.CurrentTime());
+  ASSERT_TRUE(res);
+  ComparePacketFeedbackVectors(expected_packets, res->packet_feedbacks);
+  EXPECT_EQ(TimeDelta::Millis(60), res->packet_feedbacks[1].receive_time -
+                                       res->packet_feedbacks[0].receive_time);
+}
+
 TEST_F(TransportFeedbackAdapterTest, SendTimeWrapsBothWays) {
   int64_t kHighArrivalTimeMs = rtcp::TransportFeedback::kDeltaScaleFactor *
                                static_cast<int64_t>(1 << 8) *
@@ -412,6 +443,88 @@ TEST_F(TransportFeedbackAdapterTest, IgnoreDuplicatePacketSentCalls) {
   EXPECT_FALSE(duplicate_packet.has_value());
 }
 
+TEST_F(TransportFeedbackAdapterTest, ReportsLostPacketReceivedLater) {
+  std::vector<PacketResult> packets;
+  packets.push_back(CreatePacket(100, 200, 0, 1500, kPacingInfo0));
+  packets.push_back(CreatePacket(110, 210, 1, 1500, kPacingInfo0));
+  packets.push_back(CreatePacket(120, 220, 2, 1500, kPacingInfo0));
+
+  for (const auto& packet : packets)
+    OnSentPacket(packet);
+  EXPECT_EQ(adapter_->GetOutstandingData(), DataSize::Bytes(3 * 1500));
+
+  rtcp::TransportFeedback feedback;
+  feedback.SetBase(packets[0].sent_packet.sequence_number,
+                   packets[0].receive_time.us());
+  EXPECT_TRUE(feedback.AddReceivedPacket(packets[0].sent_packet.sequence_number,
+                                         packets[0].receive_time.us()));
+  EXPECT_TRUE(feedback.AddReceivedPacket(packets[2].sent_packet.sequence_number,
+                                         packets[2].receive_time.us()));
+  feedback.Build();
+
+  auto res = adapter_->ProcessTransportFeedback(feedback, clock_.CurrentTime());
+  ASSERT_TRUE(res.has_value());
+  ComparePacketFeedbackVectors(packets, res->packet_feedbacks);
+  EXPECT_TRUE(res->packet_feedbacks[1].receive_time.IsInfinite());
+  EXPECT_EQ(adapter_->GetOutstandingData(), DataSize::Zero());
+
+  // A later feedback may still report the lost packet as received.
+  rtcp::TransportFeedback late_feedback;
+  late_feedback.SetBase(packets[1].sent_packet.sequence_number,
+                        packets[1].receive_time.us());
+  EXPECT_TRUE(
+      late_feedback.AddReceivedPacket(packets[1].sent_packet.sequence_number,
+                                      packets[1].receive_time.us()));
+  late_feedback.Build();
+
+  res = adapter_->ProcessTransportFeedback(late_feedback, clock_.CurrentTime());
+  ASSERT_TRUE(res.has_value());
+  ASSERT_EQ(res->packet_feedbacks.size(), 1u);
+  EXPECT_EQ(res->packet_feedbacks[0].sent_packet.sequence_number, 1);
+  EXPECT_EQ(res->packet_feedbacks[0].sent_packet.send_time,
+            packets[1].sent_packet.send_time);
+  EXPECT_TRUE(res->packet_feedbacks[0].receive_time.IsFinite());
+}
+
+TEST_F(TransportFeedbackAdapterTest, HandlesManyPacketsInFlight) {
+  // More packets in flight than the initial size of the send history, and a
+  // feedback message reused for all feedback.
+  const int kNumPackets = 1000;
+  const int kPacketsPerFeedback = 100;
+  std::vector<PacketResult> packets;
+  for (int i = 0; i < kNumPackets; ++i) {
+    packets.push_back(CreatePacket(1000 + i, 500 + i, i, 1000, kPacingInfo0));
+    OnSentPacket(packets.back());
+  }
+  EXPECT_EQ(adapter_->GetOutstandingData(),
+            DataSize::Bytes(kNumPackets * 1000));
+
+  TransportPacketsFeedback msg;
+  for (int first = 0; first < kNumPackets; first += kPacketsPerFeedback) {
+    rtcp::TransportFeedback feedback;
+    feedback.SetBase(packets[first].sent_packet.sequence_number,
+                     packets[first].receive_time.us());
+    for (int i = first; i < first + kPacketsPerFeedback; ++i) {
+      EXPECT_TRUE(feedback.AddReceivedPacket(
+          packets[i].sent_packet.sequence_number,
+          packets[i].receive_time.us()));
+    }
+    feedback.Build();
+
+    ASSERT_TRUE(adapter_->ProcessTransportFeedback(
+        feedback, clock_.CurrentTime(), &msg));
+    ComparePacketFeedbackVectors(
+        std::vector<PacketResult>(
+            packets.begin() + first,
+            packets.begin() + first + kPacketsPerFeedback),
+        msg.packet_feedbacks);
+    EXPECT_EQ(msg.data_in_flight,
+              DataSize::Bytes((kNumPackets - first - kPacketsPerFeedback) *
+                              1000));
+  }
+  EXPECT_EQ(adapter_->GetOutstandingData(), DataSize::Zero());
+}
+
 }  // namespace test
 }  // namespace webrtc_cc
 }  // namespace webrtc
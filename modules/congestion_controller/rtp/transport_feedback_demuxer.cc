@@ -57,18 +57,19 @@ void TransportFeedbackDemuxer::OnTransportFeedback(
   std::vector<StreamFeedbackObserver::StreamPacketInfo> stream_feedbacks;
   {
     rtc::CritScope cs(&lock_);
-    for (const auto& packet : feedback.GetAllPackets()) {
-      int64_t seq_num =
-          seq_num_unwrapper_.UnwrapWithoutUpdate(packet.sequence_number());
-      auto it = history_.find(seq_num);
-      if (it != history_.end()) {
-        auto packet_info = it->second;
-        packet_info.received = packet.received();
-        stream_feedbacks.push_back(packet_info);
-        if (packet.received())
-          history_.erase(it);
-      }
-    }
+    feedback.ForAllPackets(
+        [&](uint16_t sequence_number, TimeDelta delta_since_base) {
+          int64_t seq_num =
+              seq_num_unwrapper_.UnwrapWithoutUpdate(sequence_number);
+          auto it = history_.find(seq_num);
+          if (it != history_.end()) {
+            auto packet_info = it->second;
+            packet_info.received = delta_since_base.IsFinite();
+            stream_feedbacks.push_back(packet_info);
+            if (packet_info.received)
+              history_.erase(it);
+          }
+        });
   }
 
   rtc::CritScope cs(&observers_lock_);
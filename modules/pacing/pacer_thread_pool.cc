@@ -0,0 +1,318 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/pacer_thread_pool.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "api/task_queue/queued_task.h"
+#include "modules/include/module.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
+#include "rtc_base/location.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+namespace {
+
+// As in ProcessThreadImpl, signals that a module has requested a callback
+// right away.
+constexpr int64_t kCallProcessImmediately = -1;
+
+// The longest a pool thread sleeps when none of its pacers is due.
+constexpr int64_t kMaxWaitMs = 60 * 1000;
+
+constexpr int64_t kNeverMs = std::numeric_limits<int64_t>::max();
+
+int64_t GetNextCallbackTime(Module* module, int64_t time_now) {
+  int64_t interval = module->TimeUntilNextProcess();
+  if (interval < 0) {
+    // Falling behind, we should call the callback now.
+    return time_now;
+  }
+  return time_now + interval;
+}
+
+}  // namespace
+
+// A thread of the pool, which processes the pacers assigned to it.
+class PacerThreadPool::Worker {
+ public:
+  explicit Worker(const std::string& name)
+      : thread_(&Worker::Run, this, name) {
+    thread_.Start();
+  }
+
+  ~Worker() {
+    {
+      rtc::CritScope lock(&lock_);
+      RTC_DCHECK(threads_.empty());
+      stop_ = true;
+    }
+    wake_up_.Set();
+    thread_.Stop();
+  }
+
+  // Guards the state of the pacer threads of this worker too. It is held
+  // while they are processed, so taking it waits for any ongoing Process() of
+  // their modules.
+  rtc::CriticalSection* lock() { return &lock_; }
+
+  void WakeUp() { wake_up_.Set(); }
+
+  size_t num_pacers() const {
+    rtc::CritScope lock(&lock_);
+    return threads_.size();
+  }
+
+  void AddPacer(PacerThread* thread) {
+    rtc::CritScope lock(&lock_);
+    threads_.push_back(thread);
+  }
+
+  void RemovePacer(PacerThread* thread) {
+    rtc::CritScope lock(&lock_);
+    threads_.erase(std::remove(threads_.begin(), threads_.end(), thread),
+                   threads_.end());
+  }
+
+ private:
+  static void Run(void* obj) {
+    Worker* worker = static_cast<Worker*>(obj);
+    while (worker->Process()) {
+    }
+  }
+
+  bool Process();
+
+  rtc::CriticalSection lock_;
+  rtc::Event wake_up_;
+  std::vector<PacerThread*> threads_ RTC_GUARDED_BY(lock_);
+  bool stop_ RTC_GUARDED_BY(lock_) = false;
+  rtc::PlatformThread thread_;
+};
+
+// The process thread of one pacer. Its modules and tasks are run by |worker_|,
+// mirroring ProcessThreadImpl.
+class PacerThreadPool::PacerThread : public ProcessThread {
+ public:
+  explicit PacerThread(Worker* worker) : worker_(worker) {
+    worker_->AddPacer(this);
+  }
+
+  ~PacerThread() override {
+    Stop();
+    worker_->RemovePacer(this);
+  }
+
+  void Start() override {
+    std::vector<Module*> modules;
+    {
+      rtc::CritScope lock(worker_->lock());
+      if (started_)
+        return;
+      for (const ModuleCallback& m : modules_)
+        modules.push_back(m.module);
+    }
+    for (Module* module : modules)
+      module->ProcessThreadAttached(this);
+    {
+      rtc::CritScope lock(worker_->lock());
+      started_ = true;
+    }
+    worker_->WakeUp();
+  }
+
+  void Stop() override {
+    std::vector<Module*> modules;
+    {
+      // Once this returns, the worker is done with the modules.
+      rtc::CritScope lock(worker_->lock());
+      if (!started_)
+        return;
+      started_ = false;
+      for (const ModuleCallback& m : modules_)
+        modules.push_back(m.module);
+    }
+    for (Module* module : modules)
+      module->ProcessThreadAttached(nullptr);
+  }
+
+  void WakeUp(Module* module) override {
+    {
+      rtc::CritScope lock(worker_->lock());
+      for (ModuleCallback& m : modules_) {
+        if (m.module == module)
+          m.next_callback = kCallProcessImmediately;
+      }
+    }
+    worker_->WakeUp();
+  }
+
+  void PostTask(std::unique_ptr<QueuedTask> task) override {
+    {
+      rtc::CritScope lock(worker_->lock());
+      queue_.push_back(std::move(task));
+    }
+    worker_->WakeUp();
+  }
+
+  void PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                       uint32_t milliseconds) override {
+    int64_t run_at_ms = rtc::TimeMillis() + milliseconds;
+    {
+      rtc::CritScope lock(worker_->lock());
+      delayed_tasks_.emplace(run_at_ms, std::move(task));
+    }
+    worker_->WakeUp();
+  }
+
+  void RegisterModule(Module* module, const rtc::Location& from) override {
+    RTC_DCHECK(module) << from.ToString();
+    bool started;
+    {
+      rtc::CritScope lock(worker_->lock());
+      RTC_DCHECK(std::none_of(
+          modules_.begin(), modules_.end(),
+          [module](const ModuleCallback& m) { return m.module == module; }))
+          << "Already registered, now attempting from here: "
+          << from.ToString();
+      started = started_;
+    }
+    if (started)
+      module->ProcessThreadAttached(this);
+    {
+      rtc::CritScope lock(worker_->lock());
+      modules_.emplace_back(module);
+    }
+    worker_->WakeUp();
+  }
+
+  void DeRegisterModule(Module* module) override {
+    RTC_DCHECK(module);
+    {
+      rtc::CritScope lock(worker_->lock());
+      modules_.remove_if(
+          [module](const ModuleCallback& m) { return m.module == module; });
+    }
+    module->ProcessThreadAttached(nullptr);
+  }
+
+  // Runs the modules and tasks that are due at |now|, and returns when they
+  // are due next. Called by |worker_| with its lock held.
+  int64_t Process(int64_t now);
+
+ private:
+  struct ModuleCallback {
+    explicit ModuleCallback(Module* module) : module(module) {}
+
+    Module* const module;
+    int64_t next_callback = 0;  // Absolute timestamp.
+  };
+
+  void Delete() override { delete this; }
+
+  Worker* const worker_;
+  // Guarded by the lock of |worker_|.
+  bool started_ = false;
+  std::list<ModuleCallback> modules_;
+  std::deque<std::unique_ptr<QueuedTask>> queue_;
+  std::multimap<int64_t, std::unique_ptr<QueuedTask>> delayed_tasks_;
+};
+
+int64_t PacerThreadPool::PacerThread::Process(int64_t now) {
+  if (!started_)
+    return kNeverMs;
+  CurrentTaskQueueSetter set_current(this);
+
+  int64_t next_checkpoint = kNeverMs;
+  for (ModuleCallback& m : modules_) {
+    if (m.next_callback == 0)
+      m.next_callback = GetNextCallbackTime(m.module, now);
+
+    if (m.next_callback <= now ||
+        m.next_callback == kCallProcessImmediately) {
+      m.module->Process();
+      // As ProcessThreadImpl, use a new 'now' reference to calculate when the
+      // next callback should occur.
+      m.next_callback = GetNextCallbackTime(m.module, rtc::TimeMillis());
+    }
+    next_checkpoint = std::min(next_checkpoint, m.next_callback);
+  }
+
+  while (!delayed_tasks_.empty() && delayed_tasks_.begin()->first <= now) {
+    queue_.push_back(std::move(delayed_tasks_.begin()->second));
+    delayed_tasks_.erase(delayed_tasks_.begin());
+  }
+  if (!delayed_tasks_.empty())
+    next_checkpoint = std::min(next_checkpoint, delayed_tasks_.begin()->first);
+
+  while (!queue_.empty()) {
+    std::unique_ptr<QueuedTask> task = std::move(queue_.front());
+    queue_.pop_front();
+    if (!task->Run()) {
+      // The task has taken ownership of itself.
+      task.release();
+    }
+  }
+  return next_checkpoint;
+}
+
+bool PacerThreadPool::Worker::Process() {
+  TRACE_EVENT0("webrtc", "PacerThreadPool::Worker::Process");
+  int64_t now = rtc::TimeMillis();
+  int64_t next_checkpoint = now + kMaxWaitMs;
+  {
+    rtc::CritScope lock(&lock_);
+    if (stop_)
+      return false;
+    // Indexed, since a task run here may add a pacer to this worker.
+    for (size_t i = 0; i < threads_.size(); ++i)
+      next_checkpoint = std::min(next_checkpoint, threads_[i]->Process(now));
+  }
+
+  int64_t time_to_wait = next_checkpoint - rtc::TimeMillis();
+  if (time_to_wait > 0)
+    wake_up_.Wait(static_cast<int>(time_to_wait));
+  return true;
+}
+
+PacerThreadPool::PacerThreadPool(int num_threads) {
+  RTC_DCHECK_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(
+        std::make_unique<Worker>("PacerPool" + std::to_string(i)));
+  }
+}
+
+PacerThreadPool::~PacerThreadPool() = default;
+
+std::unique_ptr<ProcessThread> PacerThreadPool::CreatePacerThread() {
+  Worker* least_loaded = workers_.front().get();
+  for (const auto& worker : workers_) {
+    if (worker->num_pacers() < least_loaded->num_pacers())
+      least_loaded = worker.get();
+  }
+  return std::make_unique<PacerThread>(least_loaded);
+}
+
+}  // namespace webrtc
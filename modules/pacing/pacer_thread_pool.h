@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_PACING_PACER_THREAD_POOL_H_
+#define MODULES_PACING_PACER_THREAD_POOL_H_
+
+#include <memory>
+#include <vector>
+
+#include "modules/utility/include/process_thread.h"
+#include "rtc_base/constructor_magic.h"
+
+namespace webrtc {
+
+// Runs the pacers of many calls on a small, fixed set of threads, instead of
+// on a "PacerThread" per call. Each call still has its own PacedSender, and so
+// its own budgets, queue and probes; only the threads and their timers are
+// shared. A pool thread wakes up once for all of its pacers that are due in
+// the same millisecond, and periodic pacers that are processed together stay
+// aligned, so that the number of wakeups no longer grows with the number of
+// calls.
+//
+// The pool may be used from any thread, and must outlive the process threads
+// created from it.
+class PacerThreadPool {
+ public:
+  explicit PacerThreadPool(int num_threads);
+  ~PacerThreadPool();
+
+  // Creates a process thread for the pacer of one call. Its modules run on the
+  // pool thread with the fewest pacers. Start() and Stop() of the returned
+  // thread only start and stop processing of its own modules and tasks; the
+  // pool threads run until the pool is destroyed. Unlike ProcessThreadImpl,
+  // all methods may be called from any thread.
+  std::unique_ptr<ProcessThread> CreatePacerThread();
+
+  int num_threads() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  class PacerThread;
+  class Worker;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(PacerThreadPool);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_PACING_PACER_THREAD_POOL_H_
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#if defined(WEBRTC_POSIX)
+#include <sys/resource.h>
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/units/data_rate.h"
+#include "benchmark/benchmark.h"
+#include "modules/pacing/paced_sender.h"
+#include "modules/pacing/pacer_thread_pool.h"
+#include "modules/pacing/packet_router.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "modules/utility/include/process_thread.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/sleep.h"
+
+namespace webrtc {
+namespace {
+
+// Each call sends a 20 ms audio packet, and its pacer is otherwise idle, as
+// is typical for a server relaying many small calls.
+constexpr int64_t kPacketIntervalMs = 20;
+constexpr size_t kPacketSize = 160;
+constexpr int kRunTimeMs = 2000;
+
+class CountingPacketRouter : public PacketRouter {
+ public:
+  void SendPacket(std::unique_ptr<RtpPacketToSend> packet,
+                  const PacedPacketInfo& cluster_info) override {
+    packets_sent_.fetch_add(1, std::memory_order_relaxed);
+  }
+  std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePadding(
+      DataSize size) override {
+    return {};
+  }
+
+  int packets_sent() const { return packets_sent_.load(); }
+
+ private:
+  std::atomic<int> packets_sent_{0};
+};
+
+// The voluntary context switches of the process, i.e. how often any of its
+// threads went to sleep, most of them until a timer fired.
+int64_t ContextSwitches() {
+#if defined(WEBRTC_POSIX)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_nvcsw;
+#endif
+  return 0;
+}
+
+// Runs range(0) calls, each with its own PacedSender. With range(1) == 0, each
+// pacer has a thread of its own, as Call does by default; otherwise the pacers
+// share a PacerThreadPool of range(1) threads.
+void BM_ConcurrentPacers(benchmark::State& state) {
+  const int num_calls = state.range(0);
+  const int num_pool_threads = state.range(1);
+  Clock* clock = Clock::GetRealTimeClock();
+
+  std::unique_ptr<PacerThreadPool> pool;
+  if (num_pool_threads > 0)
+    pool = std::make_unique<PacerThreadPool>(num_pool_threads);
+
+  std::vector<std::unique_ptr<CountingPacketRouter>> routers;
+  std::vector<std::unique_ptr<ProcessThread>> threads;
+  std::vector<std::unique_ptr<PacedSender>> pacers;
+  for (int i = 0; i < num_calls; ++i) {
+    routers.push_back(std::make_unique<CountingPacketRouter>());
+    threads.push_back(pool ? pool->CreatePacerThread()
+                           : ProcessThread::Create("PacerThread"));
+    pacers.push_back(std::make_unique<PacedSender>(
+        clock, routers.back().get(), /*event_log=*/nullptr,
+        /*field_trials=*/nullptr, threads.back().get()));
+    pacers.back()->SetPacingRates(DataRate::KilobitsPerSec(300),
+                                  DataRate::Zero());
+    threads.back()->Start();
+  }
+
+  uint16_t sequence_number = 0;
+  double cpu_percent = 0;
+  double wakeups_per_second = 0;
+  for (auto _ : state) {
+    const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+    const int64_t start_switches = ContextSwitches();
+    const int64_t start_ms = rtc::TimeMillis();
+    for (int64_t next_ms = start_ms; next_ms < start_ms + kRunTimeMs;
+         next_ms += kPacketIntervalMs) {
+      for (size_t i = 0; i < pacers.size(); ++i) {
+        auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+        packet->set_packet_type(RtpPacketMediaType::kAudio);
+        packet->SetSsrc(1000 + i);
+        packet->SetSequenceNumber(sequence_number);
+        packet->SetPayloadSize(kPacketSize);
+        std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+        packets.push_back(std::move(packet));
+        pacers[i]->EnqueuePackets(std::move(packets));
+      }
+      ++sequence_number;
+      SleepMs(static_cast<int>(std::max<int64_t>(
+          0, next_ms + kPacketIntervalMs - rtc::TimeMillis())));
+    }
+    const double elapsed_s = (rtc::TimeMillis() - start_ms) / 1000.0;
+    cpu_percent =
+        (rtc::GetProcessCpuTimeNanos() - start_cpu_ns) / 1e7 / elapsed_s;
+    wakeups_per_second = (ContextSwitches() - start_switches) / elapsed_s;
+  }
+  state.counters["cpu_percent"] = cpu_percent;
+  state.counters["wakeups_per_second"] = wakeups_per_second;
+
+  int packets_sent = 0;
+  for (size_t i = 0; i < pacers.size(); ++i) {
+    threads[i]->Stop();
+    pacers[i].reset();
+    packets_sent += routers[i]->packets_sent();
+  }
+  benchmark::DoNotOptimize(packets_sent);
+}
+BENCHMARK(BM_ConcurrentPacers)
+    ->Args({100, 0})
+    ->Args({100, 4})
+    ->Args({1000, 0})
+    ->Args({1000, 4})
+    ->Iterations(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace webrtc
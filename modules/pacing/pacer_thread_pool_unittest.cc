@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/pacer_thread_pool.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "api/task_queue/queued_task.h"
+#include "modules/include/module.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
+#include "rtc_base/location.h"
+#include "rtc_base/platform_thread_types.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Return;
+
+constexpr int kEventWaitTimeout = 500;
+
+class MockModule : public Module {
+ public:
+  MOCK_METHOD(int64_t, TimeUntilNextProcess, (), (override));
+  MOCK_METHOD(void, Process, (), (override));
+  MOCK_METHOD(void, ProcessThreadAttached, (ProcessThread*), (override));
+};
+
+ACTION_P(SetEvent, event) {
+  event->Set();
+}
+
+TEST(PacerThreadPoolTest, ProcessesModulesOnlyWhileStarted) {
+  PacerThreadPool pool(1);
+  std::unique_ptr<ProcessThread> thread = pool.CreatePacerThread();
+  rtc::Event event;
+
+  MockModule module;
+  EXPECT_CALL(module, TimeUntilNextProcess()).WillRepeatedly(Return(1));
+  EXPECT_CALL(module, Process()).Times(0);
+  thread->RegisterModule(&module, RTC_FROM_HERE);
+  EXPECT_FALSE(event.Wait(20));
+  ::testing::Mock::VerifyAndClearExpectations(&module);
+
+  EXPECT_CALL(module, TimeUntilNextProcess()).WillRepeatedly(Return(1));
+  EXPECT_CALL(module, Process())
+      .WillOnce(DoAll(SetEvent(&event), Return()))
+      .WillRepeatedly(Return());
+  EXPECT_CALL(module, ProcessThreadAttached(thread.get()));
+  thread->Start();
+  EXPECT_TRUE(event.Wait(kEventWaitTimeout));
+
+  // Once stopped, the module is no longer processed.
+  EXPECT_CALL(module, ProcessThreadAttached(nullptr));
+  thread->Stop();
+  ::testing::Mock::VerifyAndClearExpectations(&module);
+  EXPECT_CALL(module, TimeUntilNextProcess()).Times(0);
+  EXPECT_CALL(module, Process()).Times(0);
+  EXPECT_FALSE(event.Wait(20));
+
+  EXPECT_CALL(module, ProcessThreadAttached(nullptr));
+  thread->DeRegisterModule(&module);
+}
+
+TEST(PacerThreadPoolTest, WakeUpProcessesModuleRightAway) {
+  PacerThreadPool pool(1);
+  std::unique_ptr<ProcessThread> thread = pool.CreatePacerThread();
+  rtc::Event started;
+  rtc::Event woken_up;
+
+  MockModule module;
+  EXPECT_CALL(module, ProcessThreadAttached(_)).Times(2);
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(60 * 1000));
+  EXPECT_CALL(module, Process())
+      .WillOnce(DoAll(SetEvent(&started), Return()))
+      .WillOnce(DoAll(SetEvent(&woken_up), Return()));
+  thread->RegisterModule(&module, RTC_FROM_HERE);
+  thread->Start();
+  ASSERT_TRUE(started.Wait(kEventWaitTimeout));
+
+  thread->WakeUp(&module);
+  EXPECT_TRUE(woken_up.Wait(kEventWaitTimeout));
+  thread->DeRegisterModule(&module);
+}
+
+TEST(PacerThreadPoolTest, RunsTasksOnItsPacerThread) {
+  PacerThreadPool pool(2);
+  std::unique_ptr<ProcessThread> thread = pool.CreatePacerThread();
+  thread->Start();
+  rtc::Event event;
+  thread->PostDelayedTask(ToQueuedTask([&] {
+                            EXPECT_EQ(TaskQueueBase::Current(), thread.get());
+                            event.Set();
+                          }),
+                          10);
+  EXPECT_TRUE(event.Wait(kEventWaitTimeout));
+}
+
+TEST(PacerThreadPoolTest, SpreadsPacersOverThePool) {
+  constexpr int kNumThreads = 2;
+  constexpr int kNumPacers = 6;
+  PacerThreadPool pool(kNumThreads);
+  EXPECT_EQ(kNumThreads, pool.num_threads());
+
+  rtc::CriticalSection lock;
+  std::set<rtc::PlatformThreadRef> process_threads;
+  rtc::Event all_processed;
+  int num_processed = 0;
+
+  std::vector<std::unique_ptr<MockModule>> modules;
+  std::vector<std::unique_ptr<ProcessThread>> threads;
+  for (int i = 0; i < kNumPacers; ++i) {
+    auto module = std::make_unique<MockModule>();
+    EXPECT_CALL(*module, ProcessThreadAttached(_)).Times(2);
+    EXPECT_CALL(*module, TimeUntilNextProcess())
+        .WillOnce(Return(0))
+        .WillRepeatedly(Return(60 * 1000));
+    EXPECT_CALL(*module, Process()).WillOnce(Invoke([&] {
+      rtc::CritScope cs(&lock);
+      process_threads.insert(rtc::CurrentThreadRef());
+      if (++num_processed == kNumPacers)
+        all_processed.Set();
+    }));
+    threads.push_back(pool.CreatePacerThread());
+    threads.back()->RegisterModule(module.get(), RTC_FROM_HERE);
+    threads.back()->Start();
+    modules.push_back(std::move(module));
+  }
+  ASSERT_TRUE(all_processed.Wait(kEventWaitTimeout));
+  {
+    rtc::CritScope cs(&lock);
+    EXPECT_EQ(static_cast<size_t>(kNumThreads), process_threads.size());
+  }
+
+  for (int i = 0; i < kNumPacers; ++i)
+    threads[i]->DeRegisterModule(modules[i].get());
+}
+
+}  // namespace
+}  // namespace webrtc
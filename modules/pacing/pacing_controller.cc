@@ -89,6 +89,10 @@ const float PacingController::kDefaultPaceMultiplier = 2.5f;
 const TimeDelta PacingController::kPausedProcessInterval =
     kCongestedPacketInterval;
 const TimeDelta PacingController::kMinSleepTime = TimeDelta::Millis(1);
+const TimeDelta PacingController::kDefaultMaxBurstInterval =
+    TimeDelta::Millis(1);
+const TimeDelta PacingController::kDefaultCoalescingTolerance =
+    TimeDelta::Micros(500);
 
 PacingController::PacingController(Clock* clock,
                                    PacketSender* packet_sender,
@@ -112,6 +116,9 @@ PacingController::PacingController(Clock* clock,
           IsEnabled(*field_trials_, "WebRTC-Pacer-IgnoreTransportOverhead")),
       padding_target_duration_(GetDynamicPaddingTarget(*field_trials_)),
       min_packet_limit_(kDefaultMinPacketLimit),
+      precise_timing_(false),
+      max_burst_interval_(kDefaultMaxBurstInterval),
+      coalescing_tolerance_(TimeDelta::Zero()),
       transport_overhead_per_packet_(DataSize::Zero()),
       last_timestamp_(clock_->CurrentTime()),
       paused_(false),
@@ -141,6 +148,19 @@ PacingController::PacingController(Clock* clock,
   ParseFieldTrial({&min_packet_limit_ms},
                   field_trials_->Lookup("WebRTC-Pacer-MinPacketLimitMs"));
   min_packet_limit_ = TimeDelta::Millis(min_packet_limit_ms.Get());
+
+  FieldTrialFlag precise_timing("Enabled");
+  FieldTrialParameter<TimeDelta> max_burst("burst", kDefaultMaxBurstInterval);
+  FieldTrialParameter<TimeDelta> tolerance("tolerance",
+                                           kDefaultCoalescingTolerance);
+  ParseFieldTrial({&precise_timing, &max_burst, &tolerance},
+                  field_trials_->Lookup("WebRTC-Pacer-PreciseTiming"));
+  // Only dynamic mode times packets individually.
+  if (precise_timing && mode_ == ProcessMode::kDynamic) {
+    precise_timing_ = true;
+    max_burst_interval_ = std::max(max_burst.Get(), TimeDelta::Zero());
+    coalescing_tolerance_ = std::max(tolerance.Get(), TimeDelta::Zero());
+  }
   UpdateBudgetWithElapsedTime(min_packet_limit_);
 }
 
@@ -197,6 +217,10 @@ bool PacingController::IsProbing() const {
   return prober_.is_probing();
 }
 
+bool PacingController::IsPreciseTiming() const {
+  return precise_timing_;
+}
+
 Timestamp PacingController::CurrentTime() const {
   Timestamp time = clock_->CurrentTime();
   if (time < last_timestamp_) {
@@ -309,7 +333,11 @@ TimeDelta PacingController::UpdateTimeAndGetElapsed(Timestamp now) {
   if (last_process_time_.IsMinusInfinity()) {
     return TimeDelta::Zero();
   }
-  RTC_DCHECK_GE(now, last_process_time_);
+  if (now < last_process_time_) {
+    // In precise timing, the send schedule may be a little ahead of the clock.
+    RTC_DCHECK_LE(last_process_time_ - now, coalescing_tolerance_);
+    return TimeDelta::Zero();
+  }
   TimeDelta elapsed_time = now - last_process_time_;
   last_process_time_ = now;
   if (elapsed_time > kMaxElapsedTime) {
@@ -398,11 +426,14 @@ Timestamp PacingController::NextSendTime() const {
 void PacingController::ProcessPackets() {
   Timestamp now = CurrentTime();
   Timestamp target_send_time = now;
+  // Packets due up to this time are sent in this call. In precise timing, that
+  // includes those due within the coalescing tolerance.
+  const Timestamp due_time = now + coalescing_tolerance_;
   if (mode_ == ProcessMode::kDynamic) {
     target_send_time = NextSendTime();
     if (target_send_time.IsMinusInfinity()) {
       target_send_time = now;
-    } else if (now < target_send_time) {
+    } else if (due_time < target_send_time) {
       // We are too early, but if queue is empty still allow draining some debt.
       TimeDelta elapsed_time = UpdateTimeAndGetElapsed(now);
       UpdateBudgetWithElapsedTime(elapsed_time);
@@ -423,6 +454,13 @@ void PacingController::ProcessPackets() {
       UpdateBudgetWithElapsedTime(last_process_time_ - target_send_time);
       target_send_time = last_process_time_;
     }
+
+    if (precise_timing_ && target_send_time < now - max_burst_interval_) {
+      // The call is late. Rather than sending everything that should have
+      // been sent by now at once, let the send schedule skip ahead so that
+      // at most |max_burst_interval_| worth of packets go out together.
+      target_send_time = now - max_burst_interval_;
+    }
   }
 
   Timestamp previous_process_time = last_process_time_;
@@ -447,6 +485,7 @@ void PacingController::ProcessPackets() {
   }
 
   if (paused_) {
+    packet_sender_->OnBatchComplete();
     return;
   }
 
@@ -526,7 +565,7 @@ void PacingController::ProcessPackets() {
     // Fetch the next packet, so long as queue is not empty or budget is not
     // exhausted.
     std::unique_ptr<RtpPacketToSend> rtp_packet =
-        GetPendingPacket(pacing_info, target_send_time, now);
+        GetPendingPacket(pacing_info, target_send_time, due_time);
 
     if (rtp_packet == nullptr) {
       // No packet available to send, check if we should send padding.
@@ -575,12 +614,13 @@ void PacingController::ProcessPackets() {
       if (next_send_time.IsMinusInfinity()) {
         target_send_time = now;
       } else {
-        target_send_time = std::min(now, next_send_time);
+        target_send_time = std::min(due_time, next_send_time);
       }
     }
   }
 
   last_process_time_ = std::max(last_process_time_, previous_process_time);
+  packet_sender_->OnBatchComplete();
 
   if (is_probing) {
     probing_send_failure_ = data_sent == DataSize::Zero();
@@ -686,8 +726,9 @@ void PacingController::OnPaddingSent(DataSize data_sent) {
   if (data_sent > DataSize::Zero()) {
     UpdateBudgetWithSentData(data_sent);
   }
-  last_send_time_ = CurrentTime();
-  last_process_time_ = CurrentTime();
+  Timestamp now = CurrentTime();
+  last_send_time_ = now;
+  last_process_time_ = std::max(last_process_time_, now);
 }
 
 void PacingController::UpdateBudgetWithElapsedTime(TimeDelta delta) {
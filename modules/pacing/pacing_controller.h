@@ -59,6 +59,9 @@ class PacingController {
                             const PacedPacketInfo& cluster_info) = 0;
     virtual std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePadding(
         DataSize size) = 0;
+    // Called after the packets of one ProcessPackets() call have been passed
+    // to SendPacket(), so that they can be sent to the network as one batch.
+    virtual void OnBatchComplete() {}
   };
 
   // Expected max pacer delay. If ExpectedQueueTime() is higher than
@@ -79,6 +82,10 @@ class PacingController {
 
   static const TimeDelta kMinSleepTime;
 
+  // Defaults for "WebRTC-Pacer-PreciseTiming", see |precise_timing_|.
+  static const TimeDelta kDefaultMaxBurstInterval;
+  static const TimeDelta kDefaultCoalescingTolerance;
+
   PacingController(Clock* clock,
                    PacketSender* packet_sender,
                    RtcEventLog* event_log,
@@ -148,6 +155,9 @@ class PacingController {
 
   bool IsProbing() const;
 
+  // True if packets are timed individually, see |precise_timing_|.
+  bool IsPreciseTiming() const;
+
  private:
   void EnqueuePacketInternal(std::unique_ptr<RtpPacketToSend> packet,
                              int priority);
@@ -189,6 +199,16 @@ class PacingController {
 
   TimeDelta min_packet_limit_;
 
+  // With "WebRTC-Pacer-PreciseTiming" enabled in dynamic mode, every packet
+  // is sent at its own send time rather than in bursts. The send schedule may
+  // run up to |coalescing_tolerance_| ahead of the clock, so that a packet due
+  // before the next wakeup could happen is sent now, and it may fall at most
+  // |max_burst_interval_| behind after a late wakeup, so that catching up
+  // does not send more than that much data at once.
+  bool precise_timing_;
+  TimeDelta max_burst_interval_;
+  TimeDelta coalescing_tolerance_;
+
   DataSize transport_overhead_per_packet_;
 
   // TODO(webrtc:9716): Remove this when we are certain clocks are monotonic.
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "api/transport/webrtc_key_value_config.h"
+#include "api/units/data_rate.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "benchmark/benchmark.h"
+#include "modules/pacing/pacing_controller.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/random.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+namespace {
+
+// A low-latency stream, as from cloud gaming: 60 frames per second of about
+// 25 Mbps, paced at 35 Mbps over a 40 Mbps bottleneck link. If the pacer were
+// perfectly smooth, nothing would queue at the bottleneck.
+constexpr TimeDelta kFrameInterval = TimeDelta::Micros(16667);
+constexpr int kPacketsPerFrame = 43;
+constexpr size_t kPacketSize = 1200;
+constexpr DataRate kPacingRate = DataRate::KilobitsPerSec(35000);
+constexpr DataRate kLinkCapacity = DataRate::KilobitsPerSec(40000);
+constexpr TimeDelta kDuration = TimeDelta::Seconds(10);
+
+enum class PacerMode {
+  // PacingController in periodic mode, processed by PacedSender every 5 ms.
+  kPeriodic,
+  // PacingController in dynamic mode, processed as TaskQueuePacedSender does.
+  kDynamic,
+  // As kDynamic, with "WebRTC-Pacer-PreciseTiming".
+  kPrecise,
+};
+
+class PacerTrials : public WebRtcKeyValueConfig {
+ public:
+  explicit PacerTrials(bool precise_timing) : precise_timing_(precise_timing) {}
+  std::string Lookup(absl::string_view key) const override {
+    if (precise_timing_ && key == "WebRTC-Pacer-PreciseTiming") {
+      return "Enabled";
+    }
+    return "";
+  }
+
+ private:
+  const bool precise_timing_;
+};
+
+// Passes the paced packets through a bottleneck link and records how long
+// each one queues there. That is the delay that bursts from the pacer add for
+// any other packets crossing the link, such as audio or input events.
+class BottleneckLink : public PacingController::PacketSender {
+ public:
+  explicit BottleneckLink(Clock* clock)
+      : clock_(clock), link_free_time_(Timestamp::MinusInfinity()) {}
+
+  void SendPacket(std::unique_ptr<RtpPacketToSend> packet,
+                  const PacedPacketInfo& cluster_info) override {
+    const Timestamp now = clock_->CurrentTime();
+    const Timestamp start_time = std::max(now, link_free_time_);
+    link_free_time_ =
+        start_time + DataSize::Bytes(packet->payload_size()) / kLinkCapacity;
+    const double queue_delay_us = (start_time - now).us<double>();
+    sum_queue_delay_us_ += queue_delay_us;
+    sum_squared_queue_delay_us_ += queue_delay_us * queue_delay_us;
+    max_queue_delay_us_ = std::max(max_queue_delay_us_, queue_delay_us);
+    ++num_packets_;
+  }
+
+  std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePadding(
+      DataSize size) override {
+    return {};
+  }
+
+  int num_packets() const { return num_packets_; }
+  double mean_queue_delay_us() const {
+    return sum_queue_delay_us_ / std::max(num_packets_, 1);
+  }
+  double max_queue_delay_us() const { return max_queue_delay_us_; }
+  // The standard deviation of the queueing delay, i.e. the jitter it adds to
+  // the one-way delay.
+  double queue_delay_jitter_us() const {
+    const double mean = mean_queue_delay_us();
+    return sqrt(std::max(
+        0.0, sum_squared_queue_delay_us_ / std::max(num_packets_, 1) -
+                 mean * mean));
+  }
+
+ private:
+  Clock* const clock_;
+  Timestamp link_free_time_;
+  int num_packets_ = 0;
+  double sum_queue_delay_us_ = 0;
+  double sum_squared_queue_delay_us_ = 0;
+  double max_queue_delay_us_ = 0;
+};
+
+// Returns when a timer set |delay| from |now| fires. Task queues take whole
+// milliseconds, and wakeups are somewhat late, occasionally by a lot.
+Timestamp TimerFireTime(Timestamp now, TimeDelta delay, Random* random) {
+  TimeDelta lateness = TimeDelta::Micros(random->Rand(0, 200));
+  if (random->Rand(0, 99) == 0) {
+    lateness += TimeDelta::Millis(3);
+  }
+  return now + TimeDelta::Millis(delay.ms()) + lateness;
+}
+
+// Simulates kDuration of the stream through a pacer in |mode|, processed as
+// its owner would, and reports the bottleneck link delays and the number of
+// times the pacer is processed, whether its timer fired or packets were
+// enqueued.
+void BM_PacingMode(benchmark::State& state) {
+  const PacerMode mode = static_cast<PacerMode>(state.range(0));
+  int wakeups = 0;
+  double mean_queue_delay_us = 0;
+  double max_queue_delay_us = 0;
+  double queue_delay_jitter_us = 0;
+  for (auto _ : state) {
+    SimulatedClock clock(Timestamp::Seconds(1000));
+    Random random(0x1234);
+    PacerTrials field_trials(mode == PacerMode::kPrecise);
+    BottleneckLink link(&clock);
+    PacingController pacer(&clock, &link, /*event_log=*/nullptr,
+                           &field_trials,
+                           mode == PacerMode::kPeriodic
+                               ? PacingController::ProcessMode::kPeriodic
+                               : PacingController::ProcessMode::kDynamic);
+    pacer.SetProbingEnabled(false);
+    pacer.SetPacingRates(kPacingRate, DataRate::Zero());
+
+    const Timestamp end_time = clock.CurrentTime() + kDuration;
+    Timestamp next_frame_time = clock.CurrentTime();
+    Timestamp timer_time = clock.CurrentTime();
+    uint16_t sequence_number = 0;
+    wakeups = 0;
+
+    auto process = [&]() {
+      ++wakeups;
+      pacer.ProcessPackets();
+      const Timestamp now = clock.CurrentTime();
+      Timestamp next_send_time = pacer.NextSendTime();
+      if (mode != PacerMode::kPeriodic) {
+        // The default hold-back window of TaskQueuePacedSender.
+        next_send_time =
+            std::max(next_send_time, now + PacingController::kMinSleepTime);
+      }
+      const TimeDelta sleep_time =
+          std::max(TimeDelta::Zero(), next_send_time - now);
+      timer_time = std::min(timer_time, TimerFireTime(now, sleep_time, &random));
+    };
+
+    while (clock.CurrentTime() < end_time) {
+      if (next_frame_time <= timer_time) {
+        clock.AdvanceTime(next_frame_time - clock.CurrentTime());
+        for (int i = 0; i < kPacketsPerFrame; ++i) {
+          auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+          packet->set_packet_type(RtpPacketMediaType::kVideo);
+          packet->SetSsrc(12345);
+          packet->SetSequenceNumber(sequence_number++);
+          packet->SetPayloadSize(kPacketSize);
+          pacer.EnqueuePacket(std::move(packet));
+        }
+        next_frame_time += kFrameInterval;
+        // TaskQueuePacedSender processes new packets right away if it is
+        // time to; PacedSender leaves them to the next periodic call.
+        if (mode != PacerMode::kPeriodic &&
+            clock.CurrentTime() >= pacer.NextSendTime()) {
+          process();
+        }
+      } else {
+        clock.AdvanceTime(timer_time - clock.CurrentTime());
+        timer_time = Timestamp::PlusInfinity();
+        process();
+      }
+    }
+    mean_queue_delay_us = link.mean_queue_delay_us();
+    max_queue_delay_us = link.max_queue_delay_us();
+    queue_delay_jitter_us = link.queue_delay_jitter_us();
+    benchmark::DoNotOptimize(link.num_packets());
+  }
+  state.counters["wakeups_per_second"] =
+      static_cast<double>(wakeups) / kDuration.seconds<double>();
+  state.counters["queue_delay_us"] = mean_queue_delay_us;
+  state.counters["max_queue_delay_us"] = max_queue_delay_us;
+  state.counters["jitter_us"] = queue_delay_jitter_us;
+}
+BENCHMARK(BM_PacingMode)
+    ->Arg(static_cast<int>(PacerMode::kPeriodic))
+    ->Arg(static_cast<int>(PacerMode::kDynamic))
+    ->Arg(static_cast<int>(PacerMode::kPrecise))
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace webrtc
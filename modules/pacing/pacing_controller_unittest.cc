@@ -112,6 +112,7 @@ class MockPacketSender : public PacingController::PacketSender {
               GeneratePadding,
               (DataSize target_size),
               (override));
+  MOCK_METHOD(void, OnBatchComplete, (), (override));
 };
 
 class PacingControllerPadding : public PacingController::PacketSender {
@@ -462,6 +463,73 @@ TEST_P(PacingControllerFieldTrialTest, DefaultBudgetDoesNotAffectAudio) {
   ProcessNext(&pacer);
 }
 
+TEST_P(PacingControllerFieldTrialTest, PreciseTimingSendsPacketsDueSoon) {
+  ScopedFieldTrials trial(
+      "WebRTC-Pacer-PreciseTiming/Enabled,tolerance:500us/");
+  PacingController pacer(&clock_, &callback_, nullptr, nullptr, GetParam());
+  if (GetParam() == PacingController::ProcessMode::kPeriodic) {
+    // Only applies when NOT using interval budget.
+    EXPECT_FALSE(pacer.IsPreciseTiming());
+    return;
+  }
+  EXPECT_TRUE(pacer.IsPreciseTiming());
+  // One video packet every 10 ms.
+  pacer.SetPacingRates(DataRate::KilobitsPerSec(800), DataRate::Zero());
+  for (int i = 0; i < 3; ++i) {
+    InsertPacket(&pacer, &video);
+  }
+  EXPECT_CALL(callback_, SendPacket).Times(1);
+  pacer.ProcessPackets();
+  ::testing::Mock::VerifyAndClearExpectations(&callback_);
+
+  const Timestamp next_send_time = pacer.NextSendTime();
+  EXPECT_EQ(next_send_time - clock_.CurrentTime(), TimeDelta::Millis(10));
+
+  // Too early, even with the tolerance.
+  clock_.AdvanceTime(next_send_time - clock_.CurrentTime() -
+                     TimeDelta::Micros(600));
+  EXPECT_CALL(callback_, SendPacket).Times(0);
+  pacer.ProcessPackets();
+  ::testing::Mock::VerifyAndClearExpectations(&callback_);
+
+  // Within the tolerance, the packet is sent now rather than after another
+  // wakeup.
+  clock_.AdvanceTime(TimeDelta::Micros(200));
+  EXPECT_CALL(callback_, SendPacket).Times(1);
+  pacer.ProcessPackets();
+  ::testing::Mock::VerifyAndClearExpectations(&callback_);
+
+  // Sending early does not pull the following packets forward.
+  EXPECT_EQ(pacer.NextSendTime(), next_send_time + TimeDelta::Millis(10));
+}
+
+TEST_P(PacingControllerFieldTrialTest, PreciseTimingBoundsBurstWhenLate) {
+  if (GetParam() == PacingController::ProcessMode::kPeriodic) {
+    // This test applies only when NOT using interval budget.
+    return;
+  }
+  ScopedFieldTrials trial("WebRTC-Pacer-PreciseTiming/Enabled,burst:25ms/");
+  PacingController pacer(&clock_, &callback_, nullptr, nullptr, GetParam());
+  // One video packet every 10 ms.
+  pacer.SetPacingRates(DataRate::KilobitsPerSec(800), DataRate::Zero());
+  for (int i = 0; i < 6; ++i) {
+    InsertPacket(&pacer, &video);
+  }
+  EXPECT_CALL(callback_, SendPacket).Times(1);
+  pacer.ProcessPackets();
+  ::testing::Mock::VerifyAndClearExpectations(&callback_);
+
+  // Process 60 ms late, when the remaining five packets are all due. Only
+  // those that fit within the 25 ms burst are sent.
+  clock_.AdvanceTimeMilliseconds(60);
+  EXPECT_CALL(callback_, SendPacket).Times(3);
+  pacer.ProcessPackets();
+  ::testing::Mock::VerifyAndClearExpectations(&callback_);
+
+  // The rest follow at the pacing rate.
+  EXPECT_EQ(pacer.NextSendTime() - clock_.CurrentTime(), TimeDelta::Millis(5));
+}
+
 INSTANTIATE_TEST_SUITE_P(WithAndWithoutIntervalBudget,
                          PacingControllerFieldTrialTest,
                          ::testing::Values(false, true));
@@ -1613,6 +1681,36 @@ TEST_P(PacingControllerTest, ProbeClusterId) {
   }
 }
 
+TEST_P(PacingControllerTest, CompletesBatchAfterEachProcessCall) {
+  MockPacketSender callback;
+  pacer_ = std::make_unique<PacingController>(&clock_, &callback, nullptr,
+                                              nullptr, GetParam());
+  Init();
+
+  // Audio is not paced, so all three packets go out in the same process call,
+  // followed by the end of the batch.
+  const uint32_t kSsrc = 12345;
+  uint16_t sequence_number = 1234;
+  for (int i = 0; i < 3; ++i) {
+    Send(RtpPacketMediaType::kAudio, kSsrc, sequence_number++,
+         clock_.TimeInMilliseconds(), 100);
+  }
+  {
+    ::testing::InSequence seq;
+    EXPECT_CALL(callback, SendPacket).Times(3);
+    EXPECT_CALL(callback, OnBatchComplete);
+  }
+  pacer_->ProcessPackets();
+  ::testing::Mock::VerifyAndClearExpectations(&callback);
+
+  // A batch is completed even when the pacer is paused.
+  pacer_->Pause();
+  EXPECT_CALL(callback, SendPacket).Times(0);
+  EXPECT_CALL(callback, OnBatchComplete);
+  clock_.AdvanceTime(TimeUntilNextProcess());
+  pacer_->ProcessPackets();
+}
+
 TEST_P(PacingControllerTest, OwnedPacketPrioritizedOnType) {
   MockPacketSender callback;
   pacer_ = std::make_unique<PacingController>(&clock_, &callback, nullptr,
@@ -111,6 +111,13 @@ void PacketRouter::RemoveSendRtpModule(RtpRtcpInterface* rtp_module) {
   if (last_send_module_ == rtp_module) {
     last_send_module_ = nullptr;
   }
+  auto it = std::find(modules_used_in_current_batch_.begin(),
+                      modules_used_in_current_batch_.end(), rtp_module);
+  if (it != modules_used_in_current_batch_.end()) {
+    // Don't leave packets of the current batch behind in the module.
+    rtp_module->OnBatchComplete();
+    modules_used_in_current_batch_.erase(it);
+  }
 }
 
 void PacketRouter::AddReceiveRtpModule(RtcpFeedbackSenderInterface* rtcp_sender,
@@ -171,6 +178,19 @@ void PacketRouter::SendPacket(std::unique_ptr<RtpPacketToSend> packet,
     // properties needed for payload based padding. Cache it for later use.
     last_send_module_ = rtp_module;
   }
+  if (std::find(modules_used_in_current_batch_.begin(),
+                modules_used_in_current_batch_.end(),
+                rtp_module) == modules_used_in_current_batch_.end()) {
+    modules_used_in_current_batch_.push_back(rtp_module);
+  }
+}
+
+void PacketRouter::OnBatchComplete() {
+  MutexLock lock(&modules_mutex_);
+  for (RtpRtcpInterface* rtp_module : modules_used_in_current_batch_) {
+    rtp_module->OnBatchComplete();
+  }
+  modules_used_in_current_batch_.clear();
 }
 
 std::vector<std::unique_ptr<RtpPacketToSend>> PacketRouter::GeneratePadding(
@@ -59,6 +59,9 @@ class PacketRouter : public RemoteBitrateObserver,
                   const PacedPacketInfo& cluster_info) override;
   std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePadding(
       DataSize size) override;
+  // Lets every module that sent a packet since the last call send the packets
+  // it holds back for the batch.
+  void OnBatchComplete() override;
 
   uint16_t CurrentTransportSequenceNumber() const;
 
@@ -103,6 +106,9 @@ class PacketRouter : public RemoteBitrateObserver,
       RTC_GUARDED_BY(modules_mutex_);
   // The last module used to send media.
   RtpRtcpInterface* last_send_module_ RTC_GUARDED_BY(modules_mutex_);
+  // Modules that sent a packet since the last OnBatchComplete().
+  std::vector<RtpRtcpInterface*> modules_used_in_current_batch_
+      RTC_GUARDED_BY(modules_mutex_);
   // Rtcp modules of the rtp receivers.
   std::vector<RtcpFeedbackSenderInterface*> rtcp_feedback_senders_
       RTC_GUARDED_BY(modules_mutex_);
@@ -20,92 +20,31 @@
 namespace webrtc {
 namespace {
 static constexpr DataSize kMaxLeadingSize = DataSize::Bytes(1400);
+
+// Returns the index of the lowest set bit of a non-zero |mask|.
+int LowestSetBit(uint32_t mask) {
+  RTC_DCHECK_NE(mask, 0);
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz(mask);
+#else
+  int index = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    ++index;
+  }
+  return index;
+#endif
 }
+}  // namespace
 
-RoundRobinPacketQueue::QueuedPacket::QueuedPacket(const QueuedPacket& rhs) =
+RoundRobinPacketQueue::QueuedPacket::QueuedPacket() = default;
+RoundRobinPacketQueue::QueuedPacket::QueuedPacket(QueuedPacket&& other) =
     default;
+RoundRobinPacketQueue::QueuedPacket&
+RoundRobinPacketQueue::QueuedPacket::operator=(QueuedPacket&& other) = default;
 RoundRobinPacketQueue::QueuedPacket::~QueuedPacket() = default;
 
-RoundRobinPacketQueue::QueuedPacket::QueuedPacket(
-    int priority,
-    Timestamp enqueue_time,
-    uint64_t enqueue_order,
-    std::multiset<Timestamp>::iterator enqueue_time_it,
-    std::unique_ptr<RtpPacketToSend> packet)
-    : priority_(priority),
-      enqueue_time_(enqueue_time),
-      enqueue_order_(enqueue_order),
-      is_retransmission_(packet->packet_type() ==
-                         RtpPacketMediaType::kRetransmission),
-      enqueue_time_it_(enqueue_time_it),
-      owned_packet_(packet.release()) {}
-
-bool RoundRobinPacketQueue::QueuedPacket::operator<(
-    const RoundRobinPacketQueue::QueuedPacket& other) const {
-  if (priority_ != other.priority_)
-    return priority_ > other.priority_;
-  if (is_retransmission_ != other.is_retransmission_)
-    return other.is_retransmission_;
-
-  return enqueue_order_ > other.enqueue_order_;
-}
-
-int RoundRobinPacketQueue::QueuedPacket::Priority() const {
-  return priority_;
-}
-
-RtpPacketMediaType RoundRobinPacketQueue::QueuedPacket::Type() const {
-  return *owned_packet_->packet_type();
-}
-
-uint32_t RoundRobinPacketQueue::QueuedPacket::Ssrc() const {
-  return owned_packet_->Ssrc();
-}
-
-Timestamp RoundRobinPacketQueue::QueuedPacket::EnqueueTime() const {
-  return enqueue_time_;
-}
-
-bool RoundRobinPacketQueue::QueuedPacket::IsRetransmission() const {
-  return Type() == RtpPacketMediaType::kRetransmission;
-}
-
-uint64_t RoundRobinPacketQueue::QueuedPacket::EnqueueOrder() const {
-  return enqueue_order_;
-}
-
-RtpPacketToSend* RoundRobinPacketQueue::QueuedPacket::RtpPacket() const {
-  return owned_packet_;
-}
-
-void RoundRobinPacketQueue::QueuedPacket::UpdateEnqueueTimeIterator(
-    std::multiset<Timestamp>::iterator it) {
-  enqueue_time_it_ = it;
-}
-
-std::multiset<Timestamp>::iterator
-RoundRobinPacketQueue::QueuedPacket::EnqueueTimeIterator() const {
-  return enqueue_time_it_;
-}
-
-void RoundRobinPacketQueue::QueuedPacket::SubtractPauseTime(
-    TimeDelta pause_time_sum) {
-  enqueue_time_ -= pause_time_sum;
-}
-
-RoundRobinPacketQueue::PriorityPacketQueue::const_iterator
-RoundRobinPacketQueue::PriorityPacketQueue::begin() const {
-  return c.begin();
-}
-
-RoundRobinPacketQueue::PriorityPacketQueue::const_iterator
-RoundRobinPacketQueue::PriorityPacketQueue::end() const {
-  return c.end();
-}
-
-RoundRobinPacketQueue::Stream::Stream() : size(DataSize::Zero()), ssrc(0) {}
-RoundRobinPacketQueue::Stream::Stream(const Stream& stream) = default;
-RoundRobinPacketQueue::Stream::~Stream() = default;
+RoundRobinPacketQueue::Stream::Stream(uint32_t ssrc) : ssrc(ssrc) {}
 
 bool IsEnabled(const WebRtcKeyValueConfig* field_trials, const char* name) {
   if (!field_trials) {
@@ -127,90 +66,145 @@ RoundRobinPacketQueue::RoundRobinPacketQueue(
       pause_time_sum_(TimeDelta::Zero()),
       include_overhead_(false) {}
 
-RoundRobinPacketQueue::~RoundRobinPacketQueue() {
-  // Make sure to release any packets owned by raw pointer in QueuedPacket.
-  while (!Empty()) {
-    Pop();
-  }
-}
+RoundRobinPacketQueue::~RoundRobinPacketQueue() = default;
 
 void RoundRobinPacketQueue::Push(int priority,
                                  Timestamp enqueue_time,
                                  uint64_t enqueue_order,
                                  std::unique_ptr<RtpPacketToSend> packet) {
   RTC_DCHECK(packet->packet_type().has_value());
-  if (size_packets_ == 0) {
-    // Single packet fast-path.
-    single_packet_queue_.emplace(
-        QueuedPacket(priority, enqueue_time, enqueue_order,
-                     enqueue_times_.end(), std::move(packet)));
-    UpdateQueueTime(enqueue_time);
-    single_packet_queue_->SubtractPauseTime(pause_time_sum_);
-    size_packets_ = 1;
-    size_ += PacketSize(*single_packet_queue_);
+  RTC_DCHECK_GE(priority, 0);
+  RTC_DCHECK_LT(priority, kNumPriorityLevels);
+  priority = std::min(std::max(priority, 0), kNumPriorityLevels - 1);
+
+  // In order to figure out how much time a packet has spent in the queue
+  // while not in a paused state, we subtract the total amount of time the
+  // queue has been paused so far, and when the packet is popped we subtract
+  // the total amount of time the queue has been paused at that moment. This
+  // way we subtract the total amount of time the packet has spent in the
+  // queue while in a paused state.
+  UpdateQueueTime(enqueue_time);
+
+  const uint32_t stream_index = GetOrCreateStream(packet->Ssrc());
+  Stream& stream = streams_[stream_index];
+  const uint32_t index = AllocatePacket();
+  QueuedPacket& queued_packet = packets_[index];
+  queued_packet.priority = priority;
+  queued_packet.is_retransmission =
+      packet->packet_type() == RtpPacketMediaType::kRetransmission;
+  queued_packet.enqueue_time = enqueue_time - pause_time_sum_;
+  // A packet pushed into an empty queue reports its pause adjusted enqueue
+  // time as the oldest enqueue time, any other packet its actual one.
+  queued_packet.oldest_enqueue_time =
+      size_packets_ == 0 ? queued_packet.enqueue_time : enqueue_time;
+  queued_packet.enqueue_order = enqueue_order;
+  queued_packet.stream_index = stream_index;
+  queued_packet.packet = std::move(packet);
+  single_packet_mode_ = size_packets_ == 0;
+
+  // Append to the push order list.
+  queued_packet.prev_pushed = last_pushed_;
+  queued_packet.next_pushed = kInvalidIndex;
+  if (last_pushed_ != kInvalidIndex) {
+    packets_[last_pushed_].next_pushed = index;
+  } else {
+    first_pushed_ = index;
+  }
+  last_pushed_ = index;
+
+  // Append to the stream FIFO.
+  const int queue_index =
+      QueueIndex(priority, queued_packet.is_retransmission);
+  PacketFifo& fifo = stream.queues[queue_index];
+  RTC_DCHECK(fifo.tail == kInvalidIndex ||
+             packets_[fifo.tail].enqueue_order < enqueue_order);
+  queued_packet.next_in_stream = kInvalidIndex;
+  if (fifo.tail != kInvalidIndex) {
+    packets_[fifo.tail].next_in_stream = index;
   } else {
-    MaybePromoteSinglePacketToNormalQueue();
-    Push(QueuedPacket(priority, enqueue_time, enqueue_order,
-                      enqueue_times_.insert(enqueue_time), std::move(packet)));
+    fifo.head = index;
   }
+  fifo.tail = index;
+  stream.non_empty_queues |= 1u << queue_index;
+
+  if (stream.scheduled_priority < 0) {
+    ScheduleStream(stream_index, priority);
+  } else if (priority < stream.scheduled_priority) {
+    // The priority of this SSRC increased, reschedule it. Note that lower
+    // ordinal means higher priority.
+    UnscheduleStream(stream_index);
+    ScheduleStream(stream_index, priority);
+  }
+
+  size_packets_ += 1;
+  size_ += PacketSize(queued_packet);
 }
 
 std::unique_ptr<RtpPacketToSend> RoundRobinPacketQueue::Pop() {
-  if (single_packet_queue_.has_value()) {
-    RTC_DCHECK(stream_priorities_.empty());
-    std::unique_ptr<RtpPacketToSend> rtp_packet(
-        single_packet_queue_->RtpPacket());
-    single_packet_queue_.reset();
-    queue_time_sum_ = TimeDelta::Zero();
-    size_packets_ = 0;
-    size_ = DataSize::Zero();
-    return rtp_packet;
-  }
-
   RTC_DCHECK(!Empty());
-  Stream* stream = GetHighestPriorityStream();
-  const QueuedPacket& queued_packet = stream->packet_queue.top();
+  const uint32_t stream_index = HighestPriorityStream();
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK_NE(stream.non_empty_queues, 0);
+  const int queue_index = LowestSetBit(stream.non_empty_queues);
+  PacketFifo& fifo = stream.queues[queue_index];
+  const uint32_t index = fifo.head;
+  QueuedPacket& queued_packet = packets_[index];
 
-  stream_priorities_.erase(stream->priority_it);
+  UnscheduleStream(stream_index);
 
   // Calculate the total amount of time spent by this packet in the queue
-  // while in a non-paused state. Note that the |pause_time_sum_ms_| was
-  // subtracted from |packet.enqueue_time_ms| when the packet was pushed, and
-  // by subtracting it now we effectively remove the time spent in in the
+  // while in a non-paused state. Note that the |pause_time_sum_| was
+  // subtracted from |queued_packet.enqueue_time| when the packet was pushed,
+  // and by subtracting it now we effectively remove the time spent in in the
   // queue while in a paused state.
   TimeDelta time_in_non_paused_state =
-      time_last_updated_ - queued_packet.EnqueueTime() - pause_time_sum_;
+      time_last_updated_ - queued_packet.enqueue_time - pause_time_sum_;
   queue_time_sum_ -= time_in_non_paused_state;
 
-  RTC_CHECK(queued_packet.EnqueueTimeIterator() != enqueue_times_.end());
-  enqueue_times_.erase(queued_packet.EnqueueTimeIterator());
-
-  // Update |bytes| of this stream. The general idea is that the stream that
+  // Update |size| of this stream. The general idea is that the stream that
   // has sent the least amount of bytes should have the highest priority.
   // The problem with that is if streams send with different rates, in which
   // case a "budget" will be built up for the stream sending at the lower
-  // rate. To avoid building a too large budget we limit |bytes| to be within
+  // rate. To avoid building a too large budget we limit |size| to be within
   // kMaxLeading bytes of the stream that has sent the most amount of bytes.
   DataSize packet_size = PacketSize(queued_packet);
-  stream->size =
-      std::max(stream->size + packet_size, max_size_ - kMaxLeadingSize);
-  max_size_ = std::max(max_size_, stream->size);
+  if (!single_packet_mode_) {
+    stream.size =
+        std::max(stream.size + packet_size, max_size_ - kMaxLeadingSize);
+    max_size_ = std::max(max_size_, stream.size);
+  }
+  single_packet_mode_ = false;
 
   size_ -= packet_size;
   size_packets_ -= 1;
   RTC_CHECK(size_packets_ > 0 || queue_time_sum_ == TimeDelta::Zero());
 
-  std::unique_ptr<RtpPacketToSend> rtp_packet(queued_packet.RtpPacket());
-  stream->packet_queue.pop();
+  // Unlink from the stream FIFO and the push order list.
+  fifo.head = queued_packet.next_in_stream;
+  if (fifo.head == kInvalidIndex) {
+    fifo.tail = kInvalidIndex;
+    stream.non_empty_queues &= ~(1u << queue_index);
+  }
+  if (queued_packet.prev_pushed != kInvalidIndex) {
+    packets_[queued_packet.prev_pushed].next_pushed =
+        queued_packet.next_pushed;
+  } else {
+    first_pushed_ = queued_packet.next_pushed;
+  }
+  if (queued_packet.next_pushed != kInvalidIndex) {
+    packets_[queued_packet.next_pushed].prev_pushed =
+        queued_packet.prev_pushed;
+  } else {
+    last_pushed_ = queued_packet.prev_pushed;
+  }
+
+  std::unique_ptr<RtpPacketToSend> rtp_packet =
+      std::move(queued_packet.packet);
+  FreePacket(index);
 
   // If there are packets left to be sent, schedule the stream again.
-  RTC_CHECK(!IsSsrcScheduled(stream->ssrc));
-  if (stream->packet_queue.empty()) {
-    stream->priority_it = stream_priorities_.end();
-  } else {
-    int priority = stream->packet_queue.top().Priority();
-    stream->priority_it = stream_priorities_.emplace(
-        StreamPrioKey(priority, stream->size), stream->ssrc);
+  if (stream.non_empty_queues != 0) {
+    ScheduleStream(stream_index, TopPacket(stream).priority);
   }
 
   return rtp_packet;
@@ -218,10 +212,10 @@ std::unique_ptr<RtpPacketToSend> RoundRobinPacketQueue::Pop() {
 
 bool RoundRobinPacketQueue::Empty() const {
   if (size_packets_ == 0) {
-    RTC_DCHECK(!single_packet_queue_.has_value() && stream_priorities_.empty());
+    RTC_DCHECK(first_pushed_ == kInvalidIndex && non_empty_levels_ == 0);
     return true;
   }
-  RTC_DCHECK(single_packet_queue_.has_value() || !stream_priorities_.empty());
+  RTC_DCHECK(first_pushed_ != kInvalidIndex && non_empty_levels_ != 0);
   return false;
 }
 
@@ -235,34 +229,21 @@ DataSize RoundRobinPacketQueue::Size() const {
 
 absl::optional<Timestamp> RoundRobinPacketQueue::LeadingAudioPacketEnqueueTime()
     const {
-  if (single_packet_queue_.has_value()) {
-    if (single_packet_queue_->Type() == RtpPacketMediaType::kAudio) {
-      return single_packet_queue_->EnqueueTime();
-    }
+  if (Empty()) {
     return absl::nullopt;
   }
-
-  if (stream_priorities_.empty()) {
-    return absl::nullopt;
-  }
-  uint32_t ssrc = stream_priorities_.begin()->second;
-
-  const auto& top_packet = streams_.find(ssrc)->second.packet_queue.top();
-  if (top_packet.Type() == RtpPacketMediaType::kAudio) {
-    return top_packet.EnqueueTime();
+  const QueuedPacket& top_packet =
+      TopPacket(streams_[HighestPriorityStream()]);
+  if (top_packet.packet->packet_type() == RtpPacketMediaType::kAudio) {
+    return top_packet.enqueue_time;
   }
   return absl::nullopt;
 }
 
 Timestamp RoundRobinPacketQueue::OldestEnqueueTime() const {
-  if (single_packet_queue_.has_value()) {
-    return single_packet_queue_->EnqueueTime();
-  }
-
   if (Empty())
     return Timestamp::MinusInfinity();
-  RTC_CHECK(!enqueue_times_.empty());
-  return *enqueue_times_.begin();
+  return packets_[first_pushed_].oldest_enqueue_time;
 }
 
 void RoundRobinPacketQueue::UpdateQueueTime(Timestamp now) {
@@ -289,27 +270,23 @@ void RoundRobinPacketQueue::SetPauseState(bool paused, Timestamp now) {
 }
 
 void RoundRobinPacketQueue::SetIncludeOverhead() {
-  MaybePromoteSinglePacketToNormalQueue();
+  single_packet_mode_ = false;
   include_overhead_ = true;
   // We need to update the size to reflect overhead for existing packets.
-  for (const auto& stream : streams_) {
-    for (const QueuedPacket& packet : stream.second.packet_queue) {
-      size_ += DataSize::Bytes(packet.RtpPacket()->headers_size()) +
-               transport_overhead_per_packet_;
-    }
+  for (uint32_t index = first_pushed_; index != kInvalidIndex;
+       index = packets_[index].next_pushed) {
+    size_ += DataSize::Bytes(packets_[index].packet->headers_size()) +
+             transport_overhead_per_packet_;
   }
 }
 
 void RoundRobinPacketQueue::SetTransportOverhead(DataSize overhead_per_packet) {
-  MaybePromoteSinglePacketToNormalQueue();
+  single_packet_mode_ = false;
   if (include_overhead_) {
-    DataSize previous_overhead = transport_overhead_per_packet_;
     // We need to update the size to reflect overhead for existing packets.
-    for (const auto& stream : streams_) {
-      int packets = stream.second.packet_queue.size();
-      size_ -= packets * previous_overhead;
-      size_ += packets * overhead_per_packet;
-    }
+    const int64_t packets = static_cast<int64_t>(size_packets_);
+    size_ -= packets * transport_overhead_per_packet_;
+    size_ += packets * overhead_per_packet;
   }
   transport_overhead_per_packet_ = overhead_per_packet;
 }
@@ -320,87 +297,141 @@ TimeDelta RoundRobinPacketQueue::AverageQueueTime() const {
   return queue_time_sum_ / size_packets_;
 }
 
-void RoundRobinPacketQueue::Push(QueuedPacket packet) {
-  auto stream_info_it = streams_.find(packet.Ssrc());
-  if (stream_info_it == streams_.end()) {
-    stream_info_it = streams_.emplace(packet.Ssrc(), Stream()).first;
-    stream_info_it->second.priority_it = stream_priorities_.end();
-    stream_info_it->second.ssrc = packet.Ssrc();
-  }
-
-  Stream* stream = &stream_info_it->second;
-
-  if (stream->priority_it == stream_priorities_.end()) {
-    // If the SSRC is not currently scheduled, add it to |stream_priorities_|.
-    RTC_CHECK(!IsSsrcScheduled(stream->ssrc));
-    stream->priority_it = stream_priorities_.emplace(
-        StreamPrioKey(packet.Priority(), stream->size), packet.Ssrc());
-  } else if (packet.Priority() < stream->priority_it->first.priority) {
-    // If the priority of this SSRC increased, remove the outdated StreamPrioKey
-    // and insert a new one with the new priority. Note that |priority_| uses
-    // lower ordinal for higher priority.
-    stream_priorities_.erase(stream->priority_it);
-    stream->priority_it = stream_priorities_.emplace(
-        StreamPrioKey(packet.Priority(), stream->size), packet.Ssrc());
-  }
-  RTC_CHECK(stream->priority_it != stream_priorities_.end());
-
-  if (packet.EnqueueTimeIterator() == enqueue_times_.end()) {
-    // Promotion from single-packet queue. Just add to enqueue times.
-    packet.UpdateEnqueueTimeIterator(
-        enqueue_times_.insert(packet.EnqueueTime()));
-  } else {
-    // In order to figure out how much time a packet has spent in the queue
-    // while not in a paused state, we subtract the total amount of time the
-    // queue has been paused so far, and when the packet is popped we subtract
-    // the total amount of time the queue has been paused at that moment. This
-    // way we subtract the total amount of time the packet has spent in the
-    // queue while in a paused state.
-    UpdateQueueTime(packet.EnqueueTime());
-    packet.SubtractPauseTime(pause_time_sum_);
-
-    size_packets_ += 1;
-    size_ += PacketSize(packet);
-  }
-
-  stream->packet_queue.push(packet);
+int RoundRobinPacketQueue::QueueIndex(int priority, bool is_retransmission) {
+  // Within a priority level retransmissions are sent first.
+  return 2 * priority + (is_retransmission ? 0 : 1);
 }
 
 DataSize RoundRobinPacketQueue::PacketSize(const QueuedPacket& packet) const {
-  DataSize packet_size = DataSize::Bytes(packet.RtpPacket()->payload_size() +
-                                         packet.RtpPacket()->padding_size());
+  DataSize packet_size = DataSize::Bytes(packet.packet->payload_size() +
+                                         packet.packet->padding_size());
   if (include_overhead_) {
-    packet_size += DataSize::Bytes(packet.RtpPacket()->headers_size()) +
+    packet_size += DataSize::Bytes(packet.packet->headers_size()) +
                    transport_overhead_per_packet_;
   }
   return packet_size;
 }
 
-void RoundRobinPacketQueue::MaybePromoteSinglePacketToNormalQueue() {
-  if (single_packet_queue_.has_value()) {
-    Push(*single_packet_queue_);
-    single_packet_queue_.reset();
+uint32_t RoundRobinPacketQueue::AllocatePacket() {
+  if (free_packets_ == kInvalidIndex) {
+    packets_.emplace_back();
+    return static_cast<uint32_t>(packets_.size() - 1);
   }
+  uint32_t index = free_packets_;
+  free_packets_ = packets_[index].next_in_stream;
+  return index;
 }
 
-RoundRobinPacketQueue::Stream*
-RoundRobinPacketQueue::GetHighestPriorityStream() {
-  RTC_CHECK(!stream_priorities_.empty());
-  uint32_t ssrc = stream_priorities_.begin()->second;
-
-  auto stream_info_it = streams_.find(ssrc);
-  RTC_CHECK(stream_info_it != streams_.end());
-  RTC_CHECK(stream_info_it->second.priority_it == stream_priorities_.begin());
-  RTC_CHECK(!stream_info_it->second.packet_queue.empty());
-  return &stream_info_it->second;
+void RoundRobinPacketQueue::FreePacket(uint32_t index) {
+  QueuedPacket& packet = packets_[index];
+  packet.stream_index = kInvalidIndex;
+  packet.prev_pushed = kInvalidIndex;
+  packet.next_pushed = kInvalidIndex;
+  packet.next_in_stream = free_packets_;
+  free_packets_ = index;
 }
 
-bool RoundRobinPacketQueue::IsSsrcScheduled(uint32_t ssrc) const {
-  for (const auto& scheduled_stream : stream_priorities_) {
-    if (scheduled_stream.second == ssrc)
-      return true;
+uint32_t RoundRobinPacketQueue::GetOrCreateStream(uint32_t ssrc) {
+  auto it = stream_index_by_ssrc_.find(ssrc);
+  if (it != stream_index_by_ssrc_.end()) {
+    return it->second;
   }
-  return false;
+  const uint32_t stream_index = static_cast<uint32_t>(streams_.size());
+  stream_index_by_ssrc_.emplace(ssrc, stream_index);
+  streams_.emplace_back(ssrc);
+  return stream_index;
+}
+
+const RoundRobinPacketQueue::QueuedPacket& RoundRobinPacketQueue::TopPacket(
+    const Stream& stream) const {
+  RTC_DCHECK_NE(stream.non_empty_queues, 0);
+  return packets_[stream.queues[LowestSetBit(stream.non_empty_queues)].head];
+}
+
+bool RoundRobinPacketQueue::StreamLess(uint32_t a, uint32_t b) const {
+  const Stream& stream_a = streams_[a];
+  const Stream& stream_b = streams_[b];
+  if (stream_a.size != stream_b.size)
+    return stream_a.size < stream_b.size;
+  return stream_a.schedule_order < stream_b.schedule_order;
+}
+
+void RoundRobinPacketQueue::ScheduleStream(uint32_t stream_index,
+                                           int priority) {
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK_LT(stream.scheduled_priority, 0);
+  std::vector<uint32_t>& heap = schedule_[priority];
+  stream.scheduled_priority = priority;
+  stream.schedule_order = next_schedule_order_++;
+  stream.heap_position = heap.size();
+  heap.push_back(stream_index);
+  non_empty_levels_ |= 1u << priority;
+  SiftUp(&heap, stream.heap_position);
+}
+
+void RoundRobinPacketQueue::UnscheduleStream(uint32_t stream_index) {
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK_GE(stream.scheduled_priority, 0);
+  std::vector<uint32_t>& heap = schedule_[stream.scheduled_priority];
+  const size_t position = stream.heap_position;
+  RTC_DCHECK_EQ(heap[position], stream_index);
+  const uint32_t last = heap.back();
+  heap.pop_back();
+  if (position < heap.size()) {
+    heap[position] = last;
+    streams_[last].heap_position = position;
+    SiftUp(&heap, position);
+    SiftDown(&heap, streams_[last].heap_position);
+  }
+  if (heap.empty()) {
+    non_empty_levels_ &= ~(1u << stream.scheduled_priority);
+  }
+  stream.scheduled_priority = -1;
+}
+
+void RoundRobinPacketQueue::SiftUp(std::vector<uint32_t>* heap,
+                                   size_t position) {
+  std::vector<uint32_t>& h = *heap;
+  const uint32_t stream_index = h[position];
+  while (position > 0) {
+    size_t parent = (position - 1) / 2;
+    if (!StreamLess(stream_index, h[parent]))
+      break;
+    h[position] = h[parent];
+    streams_[h[position]].heap_position = position;
+    position = parent;
+  }
+  h[position] = stream_index;
+  streams_[stream_index].heap_position = position;
+}
+
+void RoundRobinPacketQueue::SiftDown(std::vector<uint32_t>* heap,
+                                     size_t position) {
+  std::vector<uint32_t>& h = *heap;
+  const uint32_t stream_index = h[position];
+  const size_t size = h.size();
+  while (true) {
+    size_t child = 2 * position + 1;
+    if (child >= size)
+      break;
+    if (child + 1 < size && StreamLess(h[child + 1], h[child]))
+      ++child;
+    if (!StreamLess(h[child], stream_index))
+      break;
+    h[position] = h[child];
+    streams_[h[position]].heap_position = position;
+    position = child;
+  }
+  h[position] = stream_index;
+  streams_[stream_index].heap_position = position;
+}
+
+uint32_t RoundRobinPacketQueue::HighestPriorityStream() const {
+  RTC_CHECK_NE(non_empty_levels_, 0);
+  const std::vector<uint32_t>& heap =
+      schedule_[LowestSetBit(non_empty_levels_)];
+  RTC_DCHECK(!heap.empty());
+  return heap.front();
 }
 
 }  // namespace webrtc
@@ -14,11 +14,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#include <list>
-#include <map>
+#include <array>
 #include <memory>
-#include <queue>
-#include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "api/transport/webrtc_key_value_config.h"
@@ -31,6 +30,14 @@
 
 namespace webrtc {
 
+// Paced packet queue that sends the highest priority packets first and,
+// within a priority level, serves the stream that has sent the fewest bytes.
+//
+// Push() and Pop() are O(1) except for scheduling streams, which is O(log n)
+// in the number of streams with packets queued at the same priority level,
+// since those streams are kept in a binary heap per level. A bucketed or list
+// based O(1) scheduler would only approximate the byte counts, and with them
+// the order in which streams are served, which must stay exactly as before.
 class RoundRobinPacketQueue {
  public:
   RoundRobinPacketQueue(Timestamp start_time,
@@ -60,90 +67,78 @@ class RoundRobinPacketQueue {
   void SetTransportOverhead(DataSize overhead_per_packet);
 
  private:
+  // Packets are stored in |packets_|, a pool of nodes that are recycled
+  // through a free list, and linked together by index. Each stream keeps one
+  // FIFO per priority level and retransmission flag, so that the next packet
+  // of a stream is always at the head of its first non-empty FIFO. This
+  // relies on |enqueue_order| increasing with every Push().
+  static constexpr int kNumPriorityLevels = 8;
+  static constexpr int kNumStreamQueues = 2 * kNumPriorityLevels;
+  static constexpr uint32_t kInvalidIndex = 0xFFFFFFFF;
+
   struct QueuedPacket {
-   public:
-    QueuedPacket(int priority,
-                 Timestamp enqueue_time,
-                 uint64_t enqueue_order,
-                 std::multiset<Timestamp>::iterator enqueue_time_it,
-                 std::unique_ptr<RtpPacketToSend> packet);
-    QueuedPacket(const QueuedPacket& rhs);
+    QueuedPacket();
+    QueuedPacket(QueuedPacket&& other);
+    QueuedPacket& operator=(QueuedPacket&& other);
     ~QueuedPacket();
 
-    bool operator<(const QueuedPacket& other) const;
-
-    int Priority() const;
-    RtpPacketMediaType Type() const;
-    uint32_t Ssrc() const;
-    Timestamp EnqueueTime() const;
-    bool IsRetransmission() const;
-    uint64_t EnqueueOrder() const;
-    RtpPacketToSend* RtpPacket() const;
-
-    std::multiset<Timestamp>::iterator EnqueueTimeIterator() const;
-    void UpdateEnqueueTimeIterator(std::multiset<Timestamp>::iterator it);
-    void SubtractPauseTime(TimeDelta pause_time_sum);
-
-   private:
-    int priority_;
-    Timestamp enqueue_time_;  // Absolute time of pacer queue entry.
-    uint64_t enqueue_order_;
-    bool is_retransmission_;  // Cached for performance.
-    std::multiset<Timestamp>::iterator enqueue_time_it_;
-    // Raw pointer since priority_queue doesn't allow for moving
-    // out of the container.
-    RtpPacketToSend* owned_packet_;
+    std::unique_ptr<RtpPacketToSend> packet;
+    int priority = 0;
+    bool is_retransmission = false;
+    // Absolute time of pacer queue entry, minus the pause time accumulated
+    // at that point.
+    Timestamp enqueue_time = Timestamp::MinusInfinity();
+    // The time reported by OldestEnqueueTime() while this is the oldest
+    // packet.
+    Timestamp oldest_enqueue_time = Timestamp::MinusInfinity();
+    uint64_t enqueue_order = 0;
+    uint32_t stream_index = kInvalidIndex;
+    // Next packet in the same stream FIFO, or in the free list.
+    uint32_t next_in_stream = kInvalidIndex;
+    // Neighbours in push order across all streams.
+    uint32_t prev_pushed = kInvalidIndex;
+    uint32_t next_pushed = kInvalidIndex;
   };
 
-  class PriorityPacketQueue : public std::priority_queue<QueuedPacket> {
-   public:
-    using const_iterator = container_type::const_iterator;
-    const_iterator begin() const;
-    const_iterator end() const;
-  };
-
-  struct StreamPrioKey {
-    StreamPrioKey(int priority, DataSize size)
-        : priority(priority), size(size) {}
-
-    bool operator<(const StreamPrioKey& other) const {
-      if (priority != other.priority)
-        return priority < other.priority;
-      return size < other.size;
-    }
-
-    const int priority;
-    const DataSize size;
+  struct PacketFifo {
+    uint32_t head = kInvalidIndex;
+    uint32_t tail = kInvalidIndex;
   };
 
   struct Stream {
-    Stream();
-    Stream(const Stream&);
-
-    virtual ~Stream();
+    explicit Stream(uint32_t ssrc);
 
-    DataSize size;
     uint32_t ssrc;
-
-    PriorityPacketQueue packet_queue;
-
-    // Whenever a packet is inserted for this stream we check if |priority_it|
-    // points to an element in |stream_priorities_|, and if it does it means
-    // this stream has already been scheduled, and if the scheduled priority is
-    // lower than the priority of the incoming packet we reschedule this stream
-    // with the higher priority.
-    std::multimap<StreamPrioKey, uint32_t>::iterator priority_it;
+    DataSize size = DataSize::Zero();
+    // Bit i is set if |queues[i]| is non-empty.
+    uint32_t non_empty_queues = 0;
+    std::array<PacketFifo, kNumStreamQueues> queues;
+    // Priority level the stream is scheduled at, or -1 if it has no packets.
+    int scheduled_priority = -1;
+    // Position in |schedule_[scheduled_priority]|.
+    size_t heap_position = 0;
+    // Breaks ties between streams with the same size, first scheduled first.
+    uint64_t schedule_order = 0;
   };
 
-  void Push(QueuedPacket packet);
+  static int QueueIndex(int priority, bool is_retransmission);
 
   DataSize PacketSize(const QueuedPacket& packet) const;
-  void MaybePromoteSinglePacketToNormalQueue();
-
-  Stream* GetHighestPriorityStream();
-
-  // Just used to verify correctness.
-  bool IsSsrcScheduled(uint32_t ssrc) const;
+  uint32_t AllocatePacket();
+  void FreePacket(uint32_t index);
+  // Returns the index of the stream in |streams_|.
+  uint32_t GetOrCreateStream(uint32_t ssrc);
+  const QueuedPacket& TopPacket(const Stream& stream) const;
+
+  // Stream scheduling. Each priority level keeps a binary min-heap of stream
+  // indices ordered by (size, schedule_order) in contiguous storage, and
+  // |non_empty_levels_| finds the highest priority level in O(1).
+  bool StreamLess(uint32_t a, uint32_t b) const;
+  void ScheduleStream(uint32_t stream_index, int priority);
+  void UnscheduleStream(uint32_t stream_index);
+  void SiftUp(std::vector<uint32_t>* heap, size_t position);
+  void SiftDown(std::vector<uint32_t>* heap, size_t position);
+  uint32_t HighestPriorityStream() const;
 
   DataSize transport_overhead_per_packet_;
 
@@ -156,20 +151,26 @@ class RoundRobinPacketQueue {
   TimeDelta queue_time_sum_;
   TimeDelta pause_time_sum_;
 
-  // A map of streams used to prioritize from which stream to send next. We use
-  // a multimap instead of a priority_queue since the priority of a stream can
-  // change as a new packet is inserted, and a multimap allows us to remove and
-  // then reinsert a StreamPrioKey if the priority has increased.
-  std::multimap<StreamPrioKey, uint32_t> stream_priorities_;
-
-  // A map of SSRCs to Streams.
-  std::map<uint32_t, Stream> streams_;
-
-  // The enqueue time of every packet currently in the queue. Used to figure out
-  // the age of the oldest packet in the queue.
-  std::multiset<Timestamp> enqueue_times_;
-
-  absl::optional<QueuedPacket> single_packet_queue_;
+  std::vector<QueuedPacket> packets_;
+  uint32_t free_packets_ = kInvalidIndex;
+  // Oldest and newest packet still in the queue. Enqueue times never
+  // decrease, so the oldest packet is always the first one pushed.
+  uint32_t first_pushed_ = kInvalidIndex;
+  uint32_t last_pushed_ = kInvalidIndex;
+
+  // Streams are never removed, since their |size| determines their share of
+  // the bandwidth when they become active again.
+  std::vector<Stream> streams_;
+  std::unordered_map<uint32_t, uint32_t> stream_index_by_ssrc_;
+
+  std::array<std::vector<uint32_t>, kNumPriorityLevels> schedule_;
+  uint32_t non_empty_levels_ = 0;
+  uint64_t next_schedule_order_ = 0;
+
+  // True while the queue holds a single packet that was pushed into an empty
+  // queue. A packet that passes through an otherwise empty queue is not
+  // charged to its stream.
+  bool single_packet_mode_ = false;
 
   bool include_overhead_;
 };
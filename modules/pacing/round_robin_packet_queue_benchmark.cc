@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/units/timestamp.h"
+#include "benchmark/benchmark.h"
+#include "modules/pacing/round_robin_packet_queue.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kPacketsPerRound = 1000000;
+// The queue only reads the packet sizes, so small packets are used to keep a
+// million of them in memory.
+constexpr size_t kPacketSize = 100;
+
+// Same mapping as PacingController.
+int PriorityForType(RtpPacketMediaType type) {
+  switch (type) {
+    case RtpPacketMediaType::kAudio:
+      return 1;
+    case RtpPacketMediaType::kRetransmission:
+      return 2;
+    case RtpPacketMediaType::kVideo:
+    case RtpPacketMediaType::kForwardErrorCorrection:
+      return 3;
+    case RtpPacketMediaType::kPadding:
+      return 4;
+  }
+  return 4;
+}
+
+// Pushes kPacketsPerRound packets spread round-robin over |state.range(0)|
+// streams and pops them all again, which is what the pacer does at a high
+// rate, with all of them in the queue at once. Every 20th packet is a
+// retransmission and every 50th an audio packet so that streams move between
+// priority levels. Packets are recycled across rounds to keep allocations out
+// of the measurement.
+void BM_RoundRobinPacketQueuePushPop(benchmark::State& state) {
+  const size_t num_streams = static_cast<size_t>(state.range(0));
+  std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+  packets.reserve(kPacketsPerRound);
+  for (size_t i = 0; i < kPacketsPerRound; ++i) {
+    auto packet = std::make_unique<RtpPacketToSend>(nullptr, kPacketSize);
+    packet->SetSsrc(static_cast<uint32_t>(1000 + i % num_streams));
+    packet->SetPayloadSize(kPacketSize - packet->headers_size());
+    if (i % 50 == 0) {
+      packet->set_packet_type(RtpPacketMediaType::kAudio);
+    } else if (i % 20 == 0) {
+      packet->set_packet_type(RtpPacketMediaType::kRetransmission);
+    } else {
+      packet->set_packet_type(RtpPacketMediaType::kVideo);
+    }
+    packets.push_back(std::move(packet));
+  }
+
+  Timestamp now = Timestamp::Millis(1000);
+  RoundRobinPacketQueue queue(now, nullptr);
+  uint64_t enqueue_order = 0;
+  for (auto s : state) {
+    for (auto& packet : packets) {
+      int priority = PriorityForType(*packet->packet_type());
+      queue.Push(priority, now, enqueue_order++, std::move(packet));
+    }
+    now += TimeDelta::Millis(1);
+    queue.UpdateQueueTime(now);
+    for (auto& packet : packets) {
+      packet = queue.Pop();
+    }
+    benchmark::DoNotOptimize(packets.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerRound);
+}
+
+BENCHMARK(BM_RoundRobinPacketQueuePushPop)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,435 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/round_robin_packet_queue.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kSsrc = 1000;
+constexpr DataSize kMaxLeadingSize = DataSize::Bytes(1400);
+
+// Same mapping as PacingController.
+int PriorityForType(RtpPacketMediaType type) {
+  switch (type) {
+    case RtpPacketMediaType::kAudio:
+      return 1;
+    case RtpPacketMediaType::kRetransmission:
+      return 2;
+    case RtpPacketMediaType::kVideo:
+    case RtpPacketMediaType::kForwardErrorCorrection:
+      return 3;
+    case RtpPacketMediaType::kPadding:
+      return 4;
+  }
+  return 4;
+}
+
+std::unique_ptr<RtpPacketToSend> CreatePacket(RtpPacketMediaType type,
+                                              uint32_t ssrc,
+                                              uint16_t sequence_number,
+                                              size_t payload_size) {
+  auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+  packet->set_packet_type(type);
+  packet->SetSsrc(ssrc);
+  packet->SetSequenceNumber(sequence_number);
+  if (type == RtpPacketMediaType::kPadding) {
+    packet->SetPadding(std::min<size_t>(payload_size, 255));
+  } else {
+    packet->SetPayloadSize(payload_size);
+  }
+  return packet;
+}
+
+// The queue as it was implemented with a std::map of streams, a
+// std::multimap of stream priorities and a priority queue per stream. Kept as
+// the reference for the pop order and the queue statistics.
+class ReferencePacketQueue {
+ public:
+  explicit ReferencePacketQueue(Timestamp start_time)
+      : time_last_updated_(start_time) {}
+
+  void Push(int priority,
+            Timestamp enqueue_time,
+            uint64_t enqueue_order,
+            const RtpPacketToSend& rtp_packet) {
+    Packet packet;
+    packet.ssrc = rtp_packet.Ssrc();
+    packet.sequence_number = rtp_packet.SequenceNumber();
+    packet.type = *rtp_packet.packet_type();
+    packet.priority = priority;
+    packet.enqueue_order = enqueue_order;
+    packet.enqueue_time = enqueue_time;
+    packet.payload_size = DataSize::Bytes(rtp_packet.payload_size() +
+                                          rtp_packet.padding_size());
+    packet.headers_size = DataSize::Bytes(rtp_packet.headers_size());
+    if (size_packets_ == 0) {
+      // Single packet fast-path.
+      packet.enqueue_time_it = enqueue_times_.end();
+      single_packet_ = packet;
+      UpdateQueueTime(enqueue_time);
+      single_packet_->enqueue_time -= pause_time_sum_;
+      size_packets_ = 1;
+      size_ += PacketSize(*single_packet_);
+    } else {
+      MaybePromoteSinglePacket();
+      packet.enqueue_time_it = enqueue_times_.insert(enqueue_time);
+      PushToStream(packet);
+    }
+  }
+
+  // Returns the SSRC and sequence number of the popped packet.
+  std::pair<uint32_t, uint16_t> Pop() {
+    if (single_packet_) {
+      std::pair<uint32_t, uint16_t> popped(single_packet_->ssrc,
+                                           single_packet_->sequence_number);
+      single_packet_.reset();
+      queue_time_sum_ = TimeDelta::Zero();
+      size_packets_ = 0;
+      size_ = DataSize::Zero();
+      return popped;
+    }
+
+    Stream& stream = streams_[stream_priorities_.begin()->second];
+    auto top = TopPacket(&stream);
+    stream_priorities_.erase(stream.priority_it);
+    queue_time_sum_ -= time_last_updated_ - top->enqueue_time - pause_time_sum_;
+    enqueue_times_.erase(top->enqueue_time_it);
+
+    DataSize packet_size = PacketSize(*top);
+    stream.size =
+        std::max(stream.size + packet_size, max_size_ - kMaxLeadingSize);
+    max_size_ = std::max(max_size_, stream.size);
+    size_ -= packet_size;
+    size_packets_ -= 1;
+
+    std::pair<uint32_t, uint16_t> popped(top->ssrc, top->sequence_number);
+    stream.packets.erase(top);
+    stream.scheduled = !stream.packets.empty();
+    if (stream.scheduled) {
+      stream.priority_it = stream_priorities_.emplace(
+          std::make_pair(TopPacket(&stream)->priority, stream.size),
+          popped.first);
+    }
+    return popped;
+  }
+
+  bool Empty() const { return size_packets_ == 0; }
+  size_t SizeInPackets() const { return size_packets_; }
+  DataSize Size() const { return size_; }
+
+  absl::optional<Timestamp> LeadingAudioPacketEnqueueTime() {
+    if (single_packet_) {
+      if (single_packet_->type == RtpPacketMediaType::kAudio)
+        return single_packet_->enqueue_time;
+      return absl::nullopt;
+    }
+    if (stream_priorities_.empty())
+      return absl::nullopt;
+    auto top = TopPacket(&streams_[stream_priorities_.begin()->second]);
+    if (top->type == RtpPacketMediaType::kAudio)
+      return top->enqueue_time;
+    return absl::nullopt;
+  }
+
+  Timestamp OldestEnqueueTime() const {
+    if (single_packet_)
+      return single_packet_->enqueue_time;
+    if (Empty())
+      return Timestamp::MinusInfinity();
+    return *enqueue_times_.begin();
+  }
+
+  TimeDelta AverageQueueTime() const {
+    if (Empty())
+      return TimeDelta::Zero();
+    return queue_time_sum_ / size_packets_;
+  }
+
+  void UpdateQueueTime(Timestamp now) {
+    if (now == time_last_updated_)
+      return;
+    TimeDelta delta = now - time_last_updated_;
+    if (paused_) {
+      pause_time_sum_ += delta;
+    } else {
+      queue_time_sum_ += TimeDelta::Micros(delta.us() * size_packets_);
+    }
+    time_last_updated_ = now;
+  }
+
+  void SetPauseState(bool paused, Timestamp now) {
+    if (paused_ == paused)
+      return;
+    UpdateQueueTime(now);
+    paused_ = paused;
+  }
+
+  void SetIncludeOverhead() {
+    MaybePromoteSinglePacket();
+    include_overhead_ = true;
+    for (const auto& stream : streams_) {
+      for (const Packet& packet : stream.second.packets)
+        size_ += packet.headers_size + transport_overhead_per_packet_;
+    }
+  }
+
+  void SetTransportOverhead(DataSize overhead_per_packet) {
+    MaybePromoteSinglePacket();
+    if (include_overhead_) {
+      for (const auto& stream : streams_) {
+        int packets = stream.second.packets.size();
+        size_ -= packets * transport_overhead_per_packet_;
+        size_ += packets * overhead_per_packet;
+      }
+    }
+    transport_overhead_per_packet_ = overhead_per_packet;
+  }
+
+ private:
+  struct Packet {
+    uint32_t ssrc;
+    uint16_t sequence_number;
+    RtpPacketMediaType type;
+    int priority;
+    uint64_t enqueue_order;
+    Timestamp enqueue_time = Timestamp::MinusInfinity();
+    std::multiset<Timestamp>::iterator enqueue_time_it;
+    DataSize payload_size = DataSize::Zero();
+    DataSize headers_size = DataSize::Zero();
+  };
+
+  using PriorityKey = std::pair<int, DataSize>;
+
+  struct Stream {
+    DataSize size = DataSize::Zero();
+    std::vector<Packet> packets;
+    bool scheduled = false;
+    std::multimap<PriorityKey, uint32_t>::iterator priority_it;
+  };
+
+  // Lower priority value first, then retransmissions, then push order.
+  static std::vector<Packet>::iterator TopPacket(Stream* stream) {
+    return std::min_element(
+        stream->packets.begin(), stream->packets.end(),
+        [](const Packet& a, const Packet& b) {
+          if (a.priority != b.priority)
+            return a.priority < b.priority;
+          bool a_rtx = a.type == RtpPacketMediaType::kRetransmission;
+          bool b_rtx = b.type == RtpPacketMediaType::kRetransmission;
+          if (a_rtx != b_rtx)
+            return a_rtx;
+          return a.enqueue_order < b.enqueue_order;
+        });
+  }
+
+  DataSize PacketSize(const Packet& packet) const {
+    DataSize packet_size = packet.payload_size;
+    if (include_overhead_)
+      packet_size += packet.headers_size + transport_overhead_per_packet_;
+    return packet_size;
+  }
+
+  void MaybePromoteSinglePacket() {
+    if (single_packet_) {
+      PushToStream(*single_packet_);
+      single_packet_.reset();
+    }
+  }
+
+  void PushToStream(Packet packet) {
+    Stream& stream = streams_[packet.ssrc];
+    if (!stream.scheduled) {
+      stream.priority_it = stream_priorities_.emplace(
+          std::make_pair(packet.priority, stream.size), packet.ssrc);
+      stream.scheduled = true;
+    } else if (packet.priority < stream.priority_it->first.first) {
+      stream_priorities_.erase(stream.priority_it);
+      stream.priority_it = stream_priorities_.emplace(
+          std::make_pair(packet.priority, stream.size), packet.ssrc);
+    }
+
+    if (packet.enqueue_time_it == enqueue_times_.end()) {
+      // Promotion from the single packet queue.
+      packet.enqueue_time_it = enqueue_times_.insert(packet.enqueue_time);
+    } else {
+      UpdateQueueTime(packet.enqueue_time);
+      packet.enqueue_time -= pause_time_sum_;
+      size_packets_ += 1;
+      size_ += PacketSize(packet);
+    }
+    stream.packets.push_back(packet);
+  }
+
+  DataSize transport_overhead_per_packet_ = DataSize::Zero();
+  Timestamp time_last_updated_;
+  bool paused_ = false;
+  size_t size_packets_ = 0;
+  DataSize size_ = DataSize::Zero();
+  DataSize max_size_ = kMaxLeadingSize;
+  TimeDelta queue_time_sum_ = TimeDelta::Zero();
+  TimeDelta pause_time_sum_ = TimeDelta::Zero();
+  bool include_overhead_ = false;
+
+  std::multimap<PriorityKey, uint32_t> stream_priorities_;
+  std::map<uint32_t, Stream> streams_;
+  std::multiset<Timestamp> enqueue_times_;
+  absl::optional<Packet> single_packet_;
+};
+
+void ExpectSameState(const RoundRobinPacketQueue& queue,
+                     ReferencePacketQueue* reference) {
+  ASSERT_EQ(queue.Empty(), reference->Empty());
+  ASSERT_EQ(queue.SizeInPackets(), reference->SizeInPackets());
+  ASSERT_EQ(queue.Size(), reference->Size());
+  ASSERT_EQ(queue.OldestEnqueueTime(), reference->OldestEnqueueTime());
+  ASSERT_EQ(queue.AverageQueueTime(), reference->AverageQueueTime());
+  ASSERT_EQ(queue.LeadingAudioPacketEnqueueTime(),
+            reference->LeadingAudioPacketEnqueueTime());
+}
+
+}  // namespace
+
+TEST(RoundRobinPacketQueueTest, SinglePacketIsNotChargedToItsStream) {
+  Timestamp now = Timestamp::Millis(1000);
+  RoundRobinPacketQueue queue(now, nullptr);
+  uint64_t enqueue_order = 0;
+
+  // A packet that passes through an empty queue does not count against
+  // its stream, so stream 1 stays ahead of stream 2 below.
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kVideo, kSsrc, 1, 1000));
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 1);
+
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kVideo, kSsrc + 1, 2, 1000));
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kVideo, kSsrc, 3, 1000));
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kVideo, kSsrc + 1, 4, 1000));
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kVideo, kSsrc, 5, 1000));
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 2);
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 3);
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 4);
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 5);
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(RoundRobinPacketQueueTest, PrioritizesRetransmissionsWithinPriority) {
+  Timestamp now = Timestamp::Millis(1000);
+  RoundRobinPacketQueue queue(now, nullptr);
+  uint64_t enqueue_order = 0;
+
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kVideo, kSsrc, 1, 100));
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kVideo, kSsrc, 2, 100));
+  queue.Push(3, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kRetransmission, kSsrc, 3, 100));
+  queue.Push(1, now, enqueue_order++,
+             CreatePacket(RtpPacketMediaType::kAudio, kSsrc, 4, 100));
+  EXPECT_EQ(queue.LeadingAudioPacketEnqueueTime(), now);
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 4);
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 3);
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 1);
+  EXPECT_EQ(queue.Pop()->SequenceNumber(), 2);
+}
+
+// Runs random sequences of pushes, pops, pauses, time updates and overhead
+// changes, and checks that the pop order and every statistic match the
+// reference implementation after each step.
+TEST(RoundRobinPacketQueueTest, MatchesReferenceImplementation) {
+  constexpr RtpPacketMediaType kTypes[] = {
+      RtpPacketMediaType::kAudio, RtpPacketMediaType::kVideo,
+      RtpPacketMediaType::kRetransmission,
+      RtpPacketMediaType::kForwardErrorCorrection,
+      RtpPacketMediaType::kPadding};
+  Random random(0x5eed);
+  for (int run = 0; run < 50; ++run) {
+    SCOPED_TRACE(run);
+    Timestamp now = Timestamp::Millis(1000);
+    RoundRobinPacketQueue queue(now, nullptr);
+    ReferencePacketQueue reference(now);
+    const int num_streams = random.Rand(1, 20);
+    uint64_t enqueue_order = 0;
+    uint16_t sequence_number = 0;
+    bool include_overhead = false;
+
+    for (int step = 0; step < 2000; ++step) {
+      const int action = random.Rand(0, 99);
+      if (action < 50) {
+        RtpPacketMediaType type = kTypes[random.Rand(0, 4)];
+        uint32_t ssrc = kSsrc + random.Rand(0, num_streams - 1);
+        // Mostly the pacer's mapping, sometimes any priority level.
+        int priority = random.Rand(0, 9) == 0 ? random.Rand(0, 7)
+                                              : PriorityForType(type);
+        auto packet =
+            CreatePacket(type, ssrc, sequence_number++, random.Rand(0, 1200));
+        reference.Push(priority, now, enqueue_order, *packet);
+        queue.Push(priority, now, enqueue_order, std::move(packet));
+        ++enqueue_order;
+      } else if (action < 85) {
+        if (reference.Empty())
+          continue;
+        std::pair<uint32_t, uint16_t> expected = reference.Pop();
+        std::unique_ptr<RtpPacketToSend> packet = queue.Pop();
+        ASSERT_TRUE(packet);
+        ASSERT_EQ(packet->Ssrc(), expected.first);
+        ASSERT_EQ(packet->SequenceNumber(), expected.second);
+      } else if (action < 92) {
+        now += TimeDelta::Micros(random.Rand(0, 20000));
+        reference.UpdateQueueTime(now);
+        queue.UpdateQueueTime(now);
+      } else if (action < 97) {
+        bool paused = random.Rand<bool>();
+        reference.SetPauseState(paused, now);
+        queue.SetPauseState(paused, now);
+      } else if (action < 99) {
+        DataSize overhead = DataSize::Bytes(random.Rand(0, 60));
+        reference.SetTransportOverhead(overhead);
+        queue.SetTransportOverhead(overhead);
+      } else if (!include_overhead) {
+        include_overhead = true;
+        reference.SetIncludeOverhead();
+        queue.SetIncludeOverhead();
+      }
+      ExpectSameState(queue, &reference);
+      if (::testing::Test::HasFatalFailure())
+        return;
+    }
+
+    while (!reference.Empty()) {
+      std::pair<uint32_t, uint16_t> expected = reference.Pop();
+      std::unique_ptr<RtpPacketToSend> packet = queue.Pop();
+      ASSERT_TRUE(packet);
+      ASSERT_EQ(packet->Ssrc(), expected.first);
+      ASSERT_EQ(packet->SequenceNumber(), expected.second);
+    }
+    EXPECT_TRUE(queue.Empty());
+  }
+}
+
+}  // namespace webrtc
@@ -218,7 +218,9 @@ void TaskQueuePacedSender::MaybeProcessPackets(
     next_process_time = pacing_controller_.NextSendTime();
   }
 
-  const TimeDelta min_sleep = pacing_controller_.IsProbing()
+  // Probes, and packets timed individually, are not held back.
+  const TimeDelta min_sleep = pacing_controller_.IsProbing() ||
+                                      pacing_controller_.IsPreciseTiming()
                                   ? PacingController::kMinSleepTime
                                   : hold_back_window_;
   next_process_time = std::max(now + min_sleep, next_process_time);
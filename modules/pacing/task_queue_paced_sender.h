@@ -44,7 +44,8 @@ class TaskQueuePacedSender : public RtpPacketPacer, public RtpPacketSender {
   // The |hold_back_window| parameter sets a lower bound on time to sleep if
   // there is currently a pacer queue and packets can't immediately be
   // processed. Increasing this reduces thread wakeups at the expense of higher
-  // latency.
+  // latency. It does not apply while probing, nor with the
+  // "WebRTC-Pacer-PreciseTiming" field trial.
   // TODO(bugs.webrtc.org/10809): Remove default value for hold_back_window.
   TaskQueuePacedSender(
       Clock* clock,
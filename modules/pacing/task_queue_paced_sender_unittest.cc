@@ -305,6 +305,41 @@ namespace test {
     time_controller.AdvanceTime(kCoalescingWindow - TimeDelta::Millis(1));
   }
 
+  TEST(TaskQueuePacedSenderTest, PreciseTimingOverridesCoalescingWindow) {
+    ScopedFieldTrials trial("WebRTC-Pacer-PreciseTiming/Enabled/");
+    const TimeDelta kCoalescingWindow = TimeDelta::Millis(5);
+    GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+    MockPacketRouter packet_router;
+    TaskQueuePacedSenderForTest pacer(
+        time_controller.GetClock(), &packet_router,
+        /*event_log=*/nullptr,
+        /*field_trials=*/nullptr, time_controller.GetTaskQueueFactory(),
+        kCoalescingWindow);
+
+    // Set rates so one packet adds two ms of buffer level.
+    const DataSize kPacketSize = DataSize::Bytes(kDefaultPacketSize);
+    const TimeDelta kPacketPacingTime = TimeDelta::Millis(2);
+    const DataRate kPacingDataRate = kPacketSize / kPacketPacingTime;
+
+    pacer.SetPacingRates(kPacingDataRate, DataRate::Zero());
+
+    EXPECT_CALL(packet_router, SendPacket);
+    pacer.EnqueuePackets(GeneratePackets(RtpPacketMediaType::kVideo, 10));
+    time_controller.AdvanceTime(TimeDelta::Zero());
+    ::testing::Mock::VerifyAndClearExpectations(&packet_router);
+
+    // Each packet is sent at its own time rather than at the end of the
+    // coalescing window.
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_CALL(packet_router, SendPacket).Times(0);
+      time_controller.AdvanceTime(kPacketPacingTime - TimeDelta::Millis(1));
+      ::testing::Mock::VerifyAndClearExpectations(&packet_router);
+      EXPECT_CALL(packet_router, SendPacket).Times(1);
+      time_controller.AdvanceTime(TimeDelta::Millis(1));
+      ::testing::Mock::VerifyAndClearExpectations(&packet_router);
+    }
+  }
+
   TEST(TaskQueuePacedSenderTest, RespectedMinTimeBetweenStatsUpdates) {
     const TimeDelta kCoalescingWindow = TimeDelta::Millis(5);
     GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
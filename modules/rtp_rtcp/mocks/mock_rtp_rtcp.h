@@ -98,6 +98,7 @@ class MockRtpRtcpInterface : public RtpRtcpInterface {
               TrySendPacket,
               (RtpPacketToSend * packet, const PacedPacketInfo& pacing_info),
               (override));
+  MOCK_METHOD(void, OnBatchComplete, (), (override));
   MOCK_METHOD(void,
               OnPacketsAcknowledged,
               (rtc::ArrayView<const uint16_t>),
@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <iterator>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/fec_test_helper.h"
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/random.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kMediaSsrc = 83542;
+constexpr size_t kPacketSize = 1200;
+// A typical keyframe slice of a 1080p stream with ~30% protection.
+constexpr int kNumMediaPackets = 12;
+constexpr uint8_t kProtectionFactor = 80;
+
+enum class XorKernel { kC = 0, kSSE2 = 1, kAVX2 = 2, kNEON = 3 };
+
+void BM_FecXorKernel(benchmark::State& state) {
+  void (*xor_function)(uint8_t*, const uint8_t*, size_t) = nullptr;
+  switch (static_cast<XorKernel>(state.range(0))) {
+    case XorKernel::kC:
+      xor_function = &XorBytes_C;
+      break;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    case XorKernel::kSSE2:
+      if (WebRtc_GetCPUInfo(kSSE2))
+        xor_function = &XorBytes_SSE2;
+      break;
+    case XorKernel::kAVX2:
+      if (WebRtc_GetCPUInfo(kAVX2))
+        xor_function = &XorBytes_AVX2;
+      break;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case XorKernel::kNEON:
+      xor_function = &XorBytes_NEON;
+      break;
+#endif
+    default:
+      break;
+  }
+  if (!xor_function) {
+    state.SkipWithError("Kernel not supported on this CPU.");
+    return;
+  }
+
+  std::vector<uint8_t> dst(kPacketSize, 0);
+  std::vector<uint8_t> src(kPacketSize, 0x5a);
+  for (auto s : state) {
+    xor_function(dst.data(), src.data(), kPacketSize);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * kPacketSize);
+}
+
+BENCHMARK(BM_FecXorKernel)
+    ->Arg(static_cast<int>(XorKernel::kC))
+    ->Arg(static_cast<int>(XorKernel::kSSE2))
+    ->Arg(static_cast<int>(XorKernel::kAVX2))
+    ->Arg(static_cast<int>(XorKernel::kNEON));
+
+// Generates ULPFEC packets for one set of 1200 byte media packets.
+void BM_UlpfecEncode(benchmark::State& state) {
+  Random random(0xfec);
+  test::fec::MediaPacketGenerator generator(kPacketSize, kPacketSize,
+                                            kMediaSsrc, &random);
+  ForwardErrorCorrection::PacketList media_packets =
+      generator.ConstructMediaPackets(kNumMediaPackets);
+  std::unique_ptr<ForwardErrorCorrection> fec =
+      ForwardErrorCorrection::CreateUlpfec(kMediaSsrc);
+
+  for (auto s : state) {
+    std::list<ForwardErrorCorrection::Packet*> fec_packets;
+    fec->EncodeFec(media_packets, kProtectionFactor, 0, false, kFecMaskBursty,
+                   &fec_packets);
+    benchmark::DoNotOptimize(fec_packets.size());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumMediaPackets);
+}
+
+BENCHMARK(BM_UlpfecEncode);
+
+// Recovers the first media packet of a protected set from the remaining media
+// packets and all FEC packets.
+void BM_UlpfecDecodeOneLoss(benchmark::State& state) {
+  Random random(0xfec);
+  test::fec::MediaPacketGenerator generator(kPacketSize, kPacketSize,
+                                            kMediaSsrc, &random);
+  ForwardErrorCorrection::PacketList media_packets =
+      generator.ConstructMediaPackets(kNumMediaPackets);
+  std::unique_ptr<ForwardErrorCorrection> fec =
+      ForwardErrorCorrection::CreateUlpfec(kMediaSsrc);
+  std::list<ForwardErrorCorrection::Packet*> fec_packets;
+  fec->EncodeFec(media_packets, kProtectionFactor, 0, false, kFecMaskBursty,
+                 &fec_packets);
+
+  // ULPFEC packets follow the media packets in the same sequence number space.
+  struct Received {
+    rtc::CopyOnWriteBuffer data;
+    bool is_fec;
+    uint16_t seq_num;
+  };
+  std::vector<Received> received;
+  for (auto it = std::next(media_packets.begin()); it != media_packets.end();
+       ++it) {
+    received.push_back({(*it)->data, false,
+                        ByteReader<uint16_t>::ReadBigEndian(&(*it)->data[2])});
+  }
+  uint16_t fec_seq_num = generator.GetNextSeqNum();
+  for (const auto* fec_packet : fec_packets) {
+    received.push_back({fec_packet->data, true, fec_seq_num++});
+  }
+
+  ForwardErrorCorrection::RecoveredPacketList recovered_packets;
+  for (auto s : state) {
+    // The decoder keeps references to the packets, so hand it new ones each
+    // time as a receiver would.
+    for (const Received& packet : received) {
+      ForwardErrorCorrection::ReceivedPacket received_packet;
+      received_packet.pkt = new ForwardErrorCorrection::Packet();
+      received_packet.pkt->data = packet.data;
+      received_packet.is_fec = packet.is_fec;
+      received_packet.ssrc = kMediaSsrc;
+      received_packet.seq_num = packet.seq_num;
+      fec->DecodeFec(received_packet, &recovered_packets);
+    }
+    if (recovered_packets.size() != media_packets.size()) {
+      state.SkipWithError("Failed to recover the lost packet.");
+      break;
+    }
+    fec->ResetState(&recovered_packets);
+  }
+  state.SetItemsProcessed(state.iterations() * received.size());
+}
+
+BENCHMARK(BM_UlpfecDecodeOneLoss);
+
+}  // namespace
+}  // namespace webrtc
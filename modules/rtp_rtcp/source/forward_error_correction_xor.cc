@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+#include <string.h>
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+using XorFunction = void (*)(uint8_t*, const uint8_t*, size_t);
+
+XorFunction SelectXorFunction() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    return &XorBytes_AVX2;
+  }
+#if defined(__SSE2__)
+  return &XorBytes_SSE2;
+#else
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    return &XorBytes_SSE2;
+  }
+  return &XorBytes_C;
+#endif
+#elif defined(WEBRTC_HAS_NEON)
+  return &XorBytes_NEON;
+#else
+  return &XorBytes_C;
+#endif
+}
+
+}  // namespace
+
+void XorBytes(uint8_t* dst, const uint8_t* src, size_t size) {
+  static const XorFunction xor_function = SelectXorFunction();
+  xor_function(dst, src, size);
+}
+
+void XorBytes_C(uint8_t* dst, const uint8_t* src, size_t size) {
+  // Work on 64 bit words; memcpy() keeps the unaligned accesses well defined
+  // and compiles to plain loads and stores.
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t d;
+    uint64_t s;
+    memcpy(&d, dst + i, sizeof(d));
+    memcpy(&s, src + i, sizeof(s));
+    d ^= s;
+    memcpy(dst + i, &d, sizeof(d));
+  }
+  for (; i < size; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,39 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_XOR_H_
+#define MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_XOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtc_base/system/arch.h"
+
+namespace webrtc {
+
+// XORs |size| bytes of |src| into |dst|, i.e. dst[i] ^= src[i]. The buffers
+// may be unaligned but must not overlap. Uses the fastest kernel supported by
+// the CPU, selected on first use.
+void XorBytes(uint8_t* dst, const uint8_t* src, size_t size);
+
+// The individual kernels, exposed for testing. All of them produce the same
+// result as the generic version.
+void XorBytes_C(uint8_t* dst, const uint8_t* src, size_t size);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void XorBytes_SSE2(uint8_t* dst, const uint8_t* src, size_t size);
+void XorBytes_AVX2(uint8_t* dst, const uint8_t* src, size_t size);
+#endif
+#if defined(WEBRTC_HAS_NEON)
+void XorBytes_NEON(uint8_t* dst, const uint8_t* src, size_t size);
+#endif
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_XOR_H_
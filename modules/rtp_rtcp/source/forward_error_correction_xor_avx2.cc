@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+namespace webrtc {
+
+void XorBytes_AVX2(uint8_t* dst, const uint8_t* src, size_t size) {
+  size_t i = 0;
+  for (; i + 128 <= size; i += 128) {
+    __m256i d0 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i d1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i + 32));
+    __m256i d2 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i + 64));
+    __m256i d3 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i + 96));
+    d0 = _mm256_xor_si256(
+        d0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    d1 = _mm256_xor_si256(
+        d1,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32)));
+    d2 = _mm256_xor_si256(
+        d2,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64)));
+    d3 = _mm256_xor_si256(
+        d3,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), d0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), d1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64), d2);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96), d3);
+  }
+  for (; i + 32 <= size; i += 32) {
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    d = _mm256_xor_si256(
+        d, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), d);
+  }
+  if (i + 16 <= size) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    d = _mm_xor_si128(
+        d, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d);
+    i += 16;
+  }
+  for (; i < size; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+}  // namespace webrtc
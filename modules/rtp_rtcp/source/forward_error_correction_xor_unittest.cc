@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+#include <string>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+using XorFunction = void (*)(uint8_t*, const uint8_t*, size_t);
+
+struct Kernel {
+  std::string name;
+  XorFunction function;
+};
+
+std::vector<Kernel> AvailableKernels() {
+  std::vector<Kernel> kernels = {{"Dispatched", &XorBytes},
+                                 {"C", &XorBytes_C}};
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    kernels.push_back({"SSE2", &XorBytes_SSE2});
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    kernels.push_back({"AVX2", &XorBytes_AVX2});
+  }
+#endif
+#if defined(WEBRTC_HAS_NEON)
+  kernels.push_back({"NEON", &XorBytes_NEON});
+#endif
+  return kernels;
+}
+
+void ReferenceXor(uint8_t* dst, const uint8_t* src, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+std::vector<uint8_t> RandomBytes(Random* random, size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (uint8_t& byte : bytes) {
+    byte = random->Rand<uint8_t>();
+  }
+  return bytes;
+}
+
+// Covers every tail length of every kernel's unrolled and single-vector loops,
+// with buffers at all alignments relative to each other.
+TEST(ForwardErrorCorrectionXorTest, KernelsMatchScalarXor) {
+  constexpr size_t kMaxSize = 300;
+  constexpr size_t kMaxOffset = 8;
+  // Guard bytes after the destination must be left untouched.
+  constexpr size_t kGuardSize = 64;
+  Random random(0x1234);
+  const std::vector<uint8_t> src =
+      RandomBytes(&random, kMaxSize + kMaxOffset);
+  const std::vector<uint8_t> dst =
+      RandomBytes(&random, kMaxSize + kMaxOffset + kGuardSize);
+
+  for (const Kernel& kernel : AvailableKernels()) {
+    SCOPED_TRACE(kernel.name);
+    for (size_t size = 0; size <= kMaxSize; ++size) {
+      for (size_t dst_offset = 0; dst_offset < kMaxOffset; dst_offset += 3) {
+        for (size_t src_offset = 0; src_offset < kMaxOffset; ++src_offset) {
+          std::vector<uint8_t> expected = dst;
+          std::vector<uint8_t> actual = dst;
+          ReferenceXor(&expected[dst_offset], &src[src_offset], size);
+          kernel.function(&actual[dst_offset], &src[src_offset], size);
+          ASSERT_EQ(expected, actual)
+              << "size " << size << ", dst offset " << dst_offset
+              << ", src offset " << src_offset;
+        }
+      }
+    }
+  }
+}
+
+TEST(ForwardErrorCorrectionXorTest, KernelsMatchScalarXorOnFullPackets) {
+  constexpr size_t kPayloadSizes[] = {1188, 1200, 1388};
+  Random random(0x5678);
+  for (size_t size : kPayloadSizes) {
+    // XOR several packets into one buffer, as when generating a FEC packet.
+    std::vector<std::vector<uint8_t>> media_payloads;
+    for (int i = 0; i < 8; ++i) {
+      media_payloads.push_back(RandomBytes(&random, size));
+    }
+    std::vector<uint8_t> expected(size, 0);
+    for (const auto& payload : media_payloads) {
+      ReferenceXor(expected.data(), payload.data(), size);
+    }
+
+    for (const Kernel& kernel : AvailableKernels()) {
+      SCOPED_TRACE(kernel.name);
+      std::vector<uint8_t> actual(size, 0);
+      for (const auto& payload : media_payloads) {
+        kernel.function(actual.data(), payload.data(), size);
+      }
+      EXPECT_EQ(expected, actual) << "size " << size;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
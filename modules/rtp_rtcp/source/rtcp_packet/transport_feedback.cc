@@ -368,6 +368,24 @@ TransportFeedback::GetAllPackets() const {
   return all_packets_;
 }
 
+void TransportFeedback::ForAllPackets(
+    rtc::FunctionView<void(uint16_t, TimeDelta)> handler) const {
+  TimeDelta delta_since_base = TimeDelta::Zero();
+  auto received_it = received_packets_.begin();
+  const uint16_t last_seq_num = base_seq_no_ + num_seq_no_;
+  for (uint16_t seq_num = base_seq_no_; seq_num != last_seq_num; ++seq_num) {
+    if (received_it != received_packets_.end() &&
+        received_it->sequence_number() == seq_num) {
+      delta_since_base += received_it->delta();
+      handler(seq_num, delta_since_base);
+      ++received_it;
+    } else {
+      handler(seq_num, TimeDelta::PlusInfinity());
+    }
+  }
+  RTC_DCHECK(received_it == received_packets_.end());
+}
+
 uint16_t TransportFeedback::GetBaseSequence() const {
   return base_seq_no_;
 }
@@ -426,9 +444,13 @@ bool TransportFeedback::Parse(const CommonHeader& packet) {
     return false;
   }
 
-  std::vector<uint8_t> delta_sizes;
-  delta_sizes.reserve(status_count);
-  while (delta_sizes.size() < status_count) {
+  // The chunks are decoded twice rather than into a vector of all the delta
+  // sizes: first to find where they end and how many receive delta bytes they
+  // announce, then to read the deltas.
+  size_t num_decoded = 0;
+  size_t num_received = 0;
+  size_t recv_delta_size = 0;
+  while (num_decoded < status_count) {
     if (index + kChunkSizeBytes > end_index) {
       RTC_LOG(LS_WARNING) << "Buffer overflow while parsing packet.";
       Clear();
@@ -438,23 +460,46 @@ bool TransportFeedback::Parse(const CommonHeader& packet) {
     uint16_t chunk = ByteReader<uint16_t>::ReadBigEndian(&payload[index]);
     index += kChunkSizeBytes;
     encoded_chunks_.push_back(chunk);
-    last_chunk_.Decode(chunk, status_count - delta_sizes.size());
-    last_chunk_.AppendTo(&delta_sizes);
+    last_chunk_.Decode(chunk, status_count - num_decoded);
+    for (size_t i = 0; i < last_chunk_.size(); ++i) {
+      DeltaSize delta_size = last_chunk_.delta_size(i);
+      recv_delta_size += delta_size;
+      if (delta_size > 0)
+        ++num_received;
+    }
+    num_decoded += last_chunk_.size();
   }
-  // Last chunk is stored in the |last_chunk_|.
-  encoded_chunks_.pop_back();
-  RTC_DCHECK_EQ(delta_sizes.size(), status_count);
+  RTC_DCHECK_EQ(num_decoded, status_count);
   num_seq_no_ = status_count;
-
-  uint16_t seq_no = base_seq_no_;
-  size_t recv_delta_size = 0;
-  for (size_t delta_size : delta_sizes) {
-    recv_delta_size += delta_size;
-  }
+  received_packets_.reserve(num_received);
+  if (include_lost_)
+    all_packets_.reserve(status_count);
 
   // Determine if timestamps, that is, recv_delta are included in the packet.
-  if (end_index >= index + recv_delta_size) {
-    for (size_t delta_size : delta_sizes) {
+  include_timestamps_ = end_index >= index + recv_delta_size;
+
+  uint16_t seq_no = base_seq_no_;
+  size_t num_remaining = status_count;
+  LastChunk chunk_decoder;
+  for (uint16_t chunk : encoded_chunks_) {
+    chunk_decoder.Decode(chunk, num_remaining);
+    num_remaining -= chunk_decoder.size();
+    for (size_t i = 0; i < chunk_decoder.size(); ++i, ++seq_no) {
+      DeltaSize delta_size = chunk_decoder.delta_size(i);
+      if (!include_timestamps_) {
+        // Use delta sizes to detect if packet was received.
+        if (delta_size > 0) {
+          received_packets_.emplace_back(seq_no, 0);
+        }
+        if (include_lost_) {
+          if (delta_size > 0) {
+            all_packets_.emplace_back(seq_no, 0);
+          } else {
+            all_packets_.emplace_back(seq_no);
+          }
+        }
+        continue;
+      }
       if (index + delta_size > end_index) {
         RTC_LOG(LS_WARNING) << "Buffer overflow while parsing packet.";
         Clear();
@@ -492,26 +537,10 @@ bool TransportFeedback::Parse(const CommonHeader& packet) {
           RTC_NOTREACHED();
           break;
       }
-      ++seq_no;
-    }
-  } else {
-    // The packet does not contain receive deltas.
-    include_timestamps_ = false;
-    for (size_t delta_size : delta_sizes) {
-      // Use delta sizes to detect if packet was received.
-      if (delta_size > 0) {
-        received_packets_.emplace_back(seq_no, 0);
-      }
-      if (include_lost_) {
-        if (delta_size > 0) {
-          all_packets_.emplace_back(seq_no, 0);
-        } else {
-          all_packets_.emplace_back(seq_no);
-        }
-      }
-      ++seq_no;
     }
   }
+  // Last chunk is stored in the |last_chunk_|.
+  encoded_chunks_.pop_back();
   size_bytes_ = RtcpPacket::kHeaderLength + index;
   RTC_DCHECK_LE(index, end_index);
   return true;
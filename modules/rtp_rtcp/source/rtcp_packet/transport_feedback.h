@@ -14,6 +14,7 @@
 #include <memory>
 #include <vector>
 
+#include "api/function_view.h"
 #include "api/units/time_delta.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/rtpfb.h"
 
@@ -71,6 +72,15 @@ class TransportFeedback : public Rtpfb {
   const std::vector<ReceivedPacket>& GetReceivedPackets() const;
   const std::vector<ReceivedPacket>& GetAllPackets() const;
 
+  // Calls |handler| for every packet (including missing) this feedback
+  // describes, in sequence number order, without building a vector of them.
+  // For received packets, |delta_since_base| is the receive time relative to
+  // the base time; for missing packets it is TimeDelta::PlusInfinity().
+  // Unlike GetAllPackets(), this works whether or not lost packets are kept.
+  void ForAllPackets(
+      rtc::FunctionView<void(uint16_t sequence_number,
+                             TimeDelta delta_since_base)> handler) const;
+
   uint16_t GetBaseSequence() const;
 
   // Returns number of packets (including missing) this feedback describes.
@@ -131,6 +141,11 @@ class TransportFeedback : public Rtpfb {
     void Decode(uint16_t chunk, size_t max_size);
     // Appends content of the Lastchunk to |deltas|.
     void AppendTo(std::vector<DeltaSize>* deltas) const;
+    // Returns the number of delta sizes stored, and the |index|th of them.
+    size_t size() const { return size_; }
+    DeltaSize delta_size(size_t index) const {
+      return all_same_ ? delta_sizes_[0] : delta_sizes_[index];
+    }
 
    private:
     static constexpr size_t kMaxRunLengthCapacity = 0x1fff;
@@ -111,6 +111,28 @@ class FeedbackTester {
     if (include_timestamps_) {
       EXPECT_THAT(actual_deltas_us, ElementsAreArray(expected_deltas_));
     }
+
+    // ForAllPackets() visits the same received packets, and the missing ones.
+    std::vector<uint16_t> visited_seq_nos;
+    std::vector<int64_t> visited_deltas_us;
+    size_t num_visited = 0;
+    TimeDelta last_delta_since_base = TimeDelta::Zero();
+    feedback_->ForAllPackets(
+        [&](uint16_t sequence_number, TimeDelta delta_since_base) {
+          EXPECT_EQ(static_cast<uint16_t>(feedback_->GetBaseSequence() +
+                                          num_visited),
+                    sequence_number);
+          ++num_visited;
+          if (delta_since_base.IsInfinite())
+            return;
+          visited_seq_nos.push_back(sequence_number);
+          visited_deltas_us.push_back(
+              (delta_since_base - last_delta_since_base).us());
+          last_delta_since_base = delta_since_base;
+        });
+    EXPECT_EQ(feedback_->GetPacketStatusCount(), num_visited);
+    EXPECT_THAT(visited_seq_nos, ElementsAreArray(actual_seq_nos));
+    EXPECT_THAT(visited_deltas_us, ElementsAreArray(actual_deltas_us));
   }
 
   void GenerateReceiveTimestamps(const uint16_t seq[],
@@ -602,5 +624,38 @@ TEST(TransportFeedbackTest, ReportsMissingPacketsWithoutTimestamps) {
   EXPECT_FALSE(packets[2].received());
   EXPECT_TRUE(packets[3].received());
 }
+
+TEST(TransportFeedbackTest, ForAllPacketsReportsMissingPacketsWithoutLost) {
+  const uint16_t kBaseSeqNo = 1000;
+  // A whole number of base time units, so that the first delta is zero.
+  const int64_t kBaseTimestampUs = 640000;
+  TransportFeedback feedback_builder(/*include_timestamps*/ true);
+  feedback_builder.SetBase(kBaseSeqNo, kBaseTimestampUs);
+  feedback_builder.AddReceivedPacket(kBaseSeqNo + 0, kBaseTimestampUs);
+  // Packet losses indicated by jump in sequence number.
+  feedback_builder.AddReceivedPacket(kBaseSeqNo + 3, kBaseTimestampUs + 2000);
+  rtc::Buffer coded = feedback_builder.Build();
+
+  rtcp::CommonHeader header;
+  header.Parse(coded.data(), coded.size());
+  TransportFeedback feedback(/*include_timestamps*/ true,
+                             /*include_lost*/ false);
+  ASSERT_TRUE(feedback.Parse(header));
+
+  std::vector<uint16_t> seq_nos;
+  std::vector<TimeDelta> deltas;
+  feedback.ForAllPackets(
+      [&](uint16_t sequence_number, TimeDelta delta_since_base) {
+        seq_nos.push_back(sequence_number);
+        deltas.push_back(delta_since_base);
+      });
+  const uint16_t kExpectedSeqNos[] = {kBaseSeqNo, kBaseSeqNo + 1,
+                                      kBaseSeqNo + 2, kBaseSeqNo + 3};
+  EXPECT_THAT(seq_nos, ElementsAreArray(kExpectedSeqNos));
+  EXPECT_THAT(deltas, ElementsAreArray({TimeDelta::Zero(),
+                                        TimeDelta::PlusInfinity(),
+                                        TimeDelta::PlusInfinity(),
+                                        TimeDelta::Millis(2)}));
+}
 }  // namespace
 }  // namespace webrtc
@@ -966,8 +966,11 @@ void RTCPReceiver::HandleFir(const CommonHeader& rtcp_block,
 void RTCPReceiver::HandleTransportFeedback(
     const CommonHeader& rtcp_block,
     PacketInformation* packet_information) {
+  // Observers iterate the packets with ForAllPackets(), so there is no need to
+  // keep a second list that includes the lost ones.
   std::unique_ptr<rtcp::TransportFeedback> transport_feedback(
-      new rtcp::TransportFeedback());
+      new rtcp::TransportFeedback(/*include_timestamps=*/true,
+                                  /*include_lost=*/false));
   if (!transport_feedback->Parse(rtcp_block)) {
     ++num_skipped_packets_;
     return;
@@ -68,6 +68,14 @@ RtpPacket::RtpPacket(const ExtensionManager* extensions, size_t capacity)
   Clear();
 }
 
+RtpPacket::RtpPacket(const ExtensionManager* extensions,
+                     rtc::CopyOnWriteBuffer buffer)
+    : extensions_(extensions ? *extensions : ExtensionManager()),
+      buffer_(std::move(buffer)) {
+  RTC_DCHECK_GE(buffer_.capacity(), kFixedHeaderSize);
+  Clear();
+}
+
 RtpPacket::~RtpPacket() {}
 
 void RtpPacket::IdentifyExtensions(const ExtensionManager& extensions) {
@@ -113,6 +121,18 @@ std::vector<uint32_t> RtpPacket::Csrcs() const {
 void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   RTC_DCHECK_GE(capacity(), packet.headers_size());
 
+  CopyHeaderFieldsFrom(packet);
+  buffer_ = packet.buffer_.Slice(0, packet.headers_size());
+}
+
+void RtpPacket::WriteHeaderFrom(const RtpPacket& packet) {
+  RTC_DCHECK_GE(capacity(), packet.capacity());
+
+  CopyHeaderFieldsFrom(packet);
+  buffer_.SetData(packet.data(), packet.headers_size());
+}
+
+void RtpPacket::CopyHeaderFieldsFrom(const RtpPacket& packet) {
   marker_ = packet.marker_;
   payload_type_ = packet.payload_type_;
   sequence_number_ = packet.sequence_number_;
@@ -122,7 +142,6 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   extensions_ = packet.extensions_;
   extension_entries_ = packet.extension_entries_;
   extensions_size_ = packet.extensions_size_;
-  buffer_ = packet.buffer_.Slice(0, packet.headers_size());
   // Reset payload and padding.
   payload_size_ = 0;
   padding_size_ = 0;
@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
@@ -34,6 +35,9 @@ class RtpPacket {
   explicit RtpPacket(const ExtensionManager* extensions);
   RtpPacket(const RtpPacket&);
   RtpPacket(const ExtensionManager* extensions, size_t capacity);
+  // Uses |buffer| as the packet storage, e.g. one taken from a buffer pool.
+  // Any data in |buffer| is discarded, its capacity is kept.
+  RtpPacket(const ExtensionManager* extensions, rtc::CopyOnWriteBuffer buffer);
   ~RtpPacket();
 
   RtpPacket& operator=(const RtpPacket&) = default;
@@ -86,6 +90,11 @@ class RtpPacket {
 
   // Header setters.
   void CopyHeaderFrom(const RtpPacket& packet);
+  // Same as CopyHeaderFrom(), but writes the header into this packet's own
+  // buffer rather than sharing the buffer of |packet|, so that the payload can
+  // be added without reallocating. Meant for packets built on an unshared
+  // buffer with at least the capacity of |packet|, e.g. one from a pool.
+  void WriteHeaderFrom(const RtpPacket& packet);
   void SetMarker(bool marker_bit);
   void SetPayloadType(uint8_t payload_type);
   void SetSequenceNumber(uint16_t seq_no);
@@ -160,6 +169,10 @@ class RtpPacket {
   // but does not touch packet own buffer, leaving packet in invalid state.
   bool ParseBuffer(const uint8_t* buffer, size_t size);
 
+  // Copies all header fields but the buffer from |packet|, and resets payload
+  // and padding.
+  void CopyHeaderFieldsFrom(const RtpPacket& packet);
+
   // Returns pointer to extension info for a given id. Returns nullptr if not
   // found.
   const ExtensionInfo* FindExtensionInfo(int id) const;
@@ -193,7 +206,9 @@ class RtpPacket {
   size_t payload_size_;
 
   ExtensionManager extensions_;
-  std::vector<ExtensionInfo> extension_entries_;
+  // Packets rarely carry more extensions than this, and keeping them inline
+  // makes copying a packet header allocation free.
+  absl::InlinedVector<ExtensionInfo, 8> extension_entries_;
   size_t extensions_size_ = 0;  // Unaligned.
   rtc::CopyOnWriteBuffer buffer_;
 };
@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtp_packet_buffer_pool.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+constexpr size_t RtpPacketBufferPool::kMinRetainedBuffers;
+
+// Released buffers, kept with a reference count of zero. Shared between the
+// pool and all buffers it has handed out, so that buffers released after the
+// pool is destroyed still have somewhere to go.
+class RtpPacketBufferPool::FreeList : public rtc::RefCountInterface {
+ public:
+  explicit FreeList(size_t max_pooled_buffers)
+      : max_pooled_buffers_(max_pooled_buffers) {}
+
+  // Hands out a buffer: returns a released one with at least |capacity| bytes
+  // of capacity, or nullptr if there is none and the caller should allocate
+  // it.
+  PooledBuffer* Pop(size_t capacity);
+  // Takes back a released buffer. Returns false if the list is full or
+  // closed, in which case the caller should delete the buffer.
+  bool Push(PooledBuffer* buffer);
+  // Deletes all released buffers and stops taking new ones.
+  void Close();
+
+  size_t size() const;
+
+ protected:
+  ~FreeList() override { RTC_DCHECK(buffers_.empty()); }
+
+ private:
+  const size_t max_pooled_buffers_;
+  mutable Mutex mutex_;
+  bool closed_ RTC_GUARDED_BY(mutex_) = false;
+  // Buffers handed out and not released yet.
+  size_t num_in_use_ RTC_GUARDED_BY(mutex_) = 0;
+  std::vector<PooledBuffer*> buffers_ RTC_GUARDED_BY(mutex_);
+};
+
+// Buffer storage that returns itself to its free list instead of being
+// deleted when the last reference is dropped.
+class RtpPacketBufferPool::PooledBuffer
+    : public rtc::RefCountedObject<rtc::Buffer> {
+ public:
+  PooledBuffer(size_t capacity, rtc::scoped_refptr<FreeList> free_list)
+      : rtc::RefCountedObject<rtc::Buffer>(0, capacity),
+        free_list_(std::move(free_list)) {}
+  ~PooledBuffer() override = default;
+
+  rtc::RefCountReleaseStatus Release() const override {
+    const auto status = ref_count_.DecRef();
+    if (status == rtc::RefCountReleaseStatus::kDroppedLastRef) {
+      // Nobody else can reach the buffer anymore, so it is safe to modify it
+      // even though this method is const.
+      PooledBuffer* buffer = const_cast<PooledBuffer*>(this);
+      buffer->Clear();
+      if (!free_list_->Push(buffer)) {
+        delete buffer;
+      }
+    }
+    return status;
+  }
+
+ private:
+  const rtc::scoped_refptr<FreeList> free_list_;
+};
+
+RtpPacketBufferPool::PooledBuffer* RtpPacketBufferPool::FreeList::Pop(
+    size_t capacity) {
+  std::vector<PooledBuffer*> to_delete;
+  PooledBuffer* buffer = nullptr;
+  {
+    MutexLock lock(&mutex_);
+    ++num_in_use_;
+    while (!buffers_.empty()) {
+      PooledBuffer* candidate = buffers_.back();
+      buffers_.pop_back();
+      if (candidate->capacity() >= capacity) {
+        buffer = candidate;
+        break;
+      }
+      to_delete.push_back(candidate);
+    }
+    // Give back the memory of a burst, but leave smaller surpluses be, so that
+    // buffers are not deleted and reallocated from one frame to the next.
+    const size_t retained = std::max(kMinRetainedBuffers, num_in_use_);
+    if (buffers_.size() > 2 * retained) {
+      to_delete.insert(to_delete.end(), buffers_.begin() + retained,
+                       buffers_.end());
+      buffers_.resize(retained);
+    }
+  }
+  // Deleting a buffer releases its reference to this list, so do it without
+  // holding the lock.
+  for (PooledBuffer* unused_buffer : to_delete) {
+    delete unused_buffer;
+  }
+  return buffer;
+}
+
+bool RtpPacketBufferPool::FreeList::Push(PooledBuffer* buffer) {
+  MutexLock lock(&mutex_);
+  RTC_DCHECK_GT(num_in_use_, 0);
+  --num_in_use_;
+  if (closed_ || buffers_.size() >= max_pooled_buffers_) {
+    return false;
+  }
+  buffers_.push_back(buffer);
+  return true;
+}
+
+void RtpPacketBufferPool::FreeList::Close() {
+  std::vector<PooledBuffer*> buffers;
+  {
+    MutexLock lock(&mutex_);
+    closed_ = true;
+    buffers.swap(buffers_);
+  }
+  for (PooledBuffer* buffer : buffers) {
+    delete buffer;
+  }
+}
+
+size_t RtpPacketBufferPool::FreeList::size() const {
+  MutexLock lock(&mutex_);
+  return buffers_.size();
+}
+
+RtpPacketBufferPool::RtpPacketBufferPool(size_t max_pooled_buffers)
+    : free_list_(new rtc::RefCountedObject<FreeList>(max_pooled_buffers)) {}
+
+RtpPacketBufferPool::~RtpPacketBufferPool() {
+  free_list_->Close();
+}
+
+rtc::CopyOnWriteBuffer RtpPacketBufferPool::GetBuffer(size_t capacity) {
+  RTC_DCHECK_GT(capacity, 0);
+  PooledBuffer* buffer = free_list_->Pop(capacity);
+  if (!buffer) {
+    buffer = new PooledBuffer(capacity, free_list_);
+    ++num_allocated_buffers_;
+  }
+  return rtc::CopyOnWriteBuffer(
+      rtc::scoped_refptr<rtc::RefCountedObject<rtc::Buffer>>(buffer));
+}
+
+size_t RtpPacketBufferPool::num_allocated_buffers() const {
+  return num_allocated_buffers_;
+}
+
+size_t RtpPacketBufferPool::num_pooled_buffers() const {
+  return free_list_->size();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_POOL_H_
+#define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_POOL_H_
+
+#include <stddef.h>
+
+#include "api/scoped_refptr.h"
+#include "rtc_base/copy_on_write_buffer.h"
+
+namespace webrtc {
+
+// Recycles the storage of outgoing RTP packets. A buffer handed out by
+// GetBuffer() goes back to the pool when the last CopyOnWriteBuffer
+// referencing it is destroyed, on whichever thread that happens (typically
+// when the packet is culled from the packet history), so a sender in steady
+// state does not allocate packet memory. Copies of a pooled buffer share its
+// storage as usual and writing to a shared copy still makes a private,
+// non-pooled copy.
+//
+// The pool keeps up to |max_pooled_buffers| released buffers, enough to
+// absorb a key frame, but gives back the memory of a burst once it has
+// passed: when the released buffers outnumber twice those still in use (and
+// kMinRetainedBuffers), the surplus is deleted.
+//
+// GetBuffer() is meant to be called from a single sequence, but the pool is
+// thread safe and buffers may outlive it.
+class RtpPacketBufferPool {
+ public:
+  // Number of released buffers that are always kept, however few are in use.
+  static constexpr size_t kMinRetainedBuffers = 64;
+
+  explicit RtpPacketBufferPool(size_t max_pooled_buffers);
+  RtpPacketBufferPool(const RtpPacketBufferPool&) = delete;
+  RtpPacketBufferPool& operator=(const RtpPacketBufferPool&) = delete;
+  ~RtpPacketBufferPool();
+
+  // Returns an empty buffer with at least |capacity| bytes of capacity.
+  // Pooled buffers that are too small are released.
+  rtc::CopyOnWriteBuffer GetBuffer(size_t capacity);
+
+  // Number of buffers the pool has allocated since it was created.
+  size_t num_allocated_buffers() const;
+  // Number of released buffers currently waiting to be reused.
+  size_t num_pooled_buffers() const;
+
+ private:
+  class PooledBuffer;
+  class FreeList;
+
+  const rtc::scoped_refptr<FreeList> free_list_;
+  size_t num_allocated_buffers_ = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_POOL_H_
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtp_packet_buffer_pool.h"
+
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kCapacity = 1216;
+
+TEST(RtpPacketBufferPoolTest, ReusesReleasedBuffer) {
+  RtpPacketBufferPool pool(/*max_pooled_buffers=*/4);
+  rtc::CopyOnWriteBuffer buffer = pool.GetBuffer(kCapacity);
+  EXPECT_EQ(buffer.size(), 0u);
+  EXPECT_GE(buffer.capacity(), kCapacity);
+  buffer.SetSize(100);
+  const uint8_t* storage = buffer.cdata();
+  buffer = rtc::CopyOnWriteBuffer();
+  EXPECT_EQ(pool.num_pooled_buffers(), 1u);
+
+  rtc::CopyOnWriteBuffer reused = pool.GetBuffer(kCapacity);
+  EXPECT_EQ(reused.size(), 0u);
+  EXPECT_EQ(reused.cdata(), storage);
+  EXPECT_EQ(pool.num_allocated_buffers(), 1u);
+  EXPECT_EQ(pool.num_pooled_buffers(), 0u);
+}
+
+TEST(RtpPacketBufferPoolTest, KeepsBufferWhileShared) {
+  RtpPacketBufferPool pool(/*max_pooled_buffers=*/4);
+  rtc::CopyOnWriteBuffer buffer = pool.GetBuffer(kCapacity);
+  buffer.SetData("abc", 3);
+  rtc::CopyOnWriteBuffer copy = buffer;
+  buffer = rtc::CopyOnWriteBuffer();
+  EXPECT_EQ(pool.num_pooled_buffers(), 0u);
+
+  rtc::CopyOnWriteBuffer other = pool.GetBuffer(kCapacity);
+  EXPECT_NE(other.cdata(), copy.cdata());
+  EXPECT_EQ(pool.num_allocated_buffers(), 2u);
+  EXPECT_EQ(copy, rtc::CopyOnWriteBuffer("abc", 3));
+
+  copy = rtc::CopyOnWriteBuffer();
+  EXPECT_EQ(pool.num_pooled_buffers(), 1u);
+}
+
+TEST(RtpPacketBufferPoolTest, ReplacesBuffersThatAreTooSmall) {
+  RtpPacketBufferPool pool(/*max_pooled_buffers=*/4);
+  pool.GetBuffer(kCapacity);
+  EXPECT_EQ(pool.num_pooled_buffers(), 1u);
+
+  rtc::CopyOnWriteBuffer buffer = pool.GetBuffer(2 * kCapacity);
+  EXPECT_GE(buffer.capacity(), 2 * kCapacity);
+  EXPECT_EQ(pool.num_allocated_buffers(), 2u);
+  EXPECT_EQ(pool.num_pooled_buffers(), 0u);
+}
+
+TEST(RtpPacketBufferPoolTest, PoolsAtMostMaxPooledBuffers) {
+  RtpPacketBufferPool pool(/*max_pooled_buffers=*/2);
+  {
+    rtc::CopyOnWriteBuffer buffers[] = {pool.GetBuffer(kCapacity),
+                                        pool.GetBuffer(kCapacity),
+                                        pool.GetBuffer(kCapacity)};
+  }
+  EXPECT_EQ(pool.num_pooled_buffers(), 2u);
+}
+
+TEST(RtpPacketBufferPoolTest, TrimsReleasedBuffersAfterBurst) {
+  constexpr size_t kBurstSize = 500;
+  RtpPacketBufferPool pool(/*max_pooled_buffers=*/1024);
+  {
+    std::vector<rtc::CopyOnWriteBuffer> burst;
+    for (size_t i = 0; i < kBurstSize; ++i) {
+      burst.push_back(pool.GetBuffer(kCapacity));
+    }
+  }
+  EXPECT_EQ(pool.num_pooled_buffers(), kBurstSize);
+
+  rtc::CopyOnWriteBuffer buffer = pool.GetBuffer(kCapacity);
+  EXPECT_EQ(pool.num_pooled_buffers(),
+            RtpPacketBufferPool::kMinRetainedBuffers);
+  EXPECT_EQ(pool.num_allocated_buffers(), kBurstSize);
+}
+
+TEST(RtpPacketBufferPoolTest, KeepsSurplusSmallerThanBuffersInUse) {
+  constexpr size_t kInUse = 200;
+  constexpr size_t kReleased = 300;
+  RtpPacketBufferPool pool(/*max_pooled_buffers=*/1024);
+  std::vector<rtc::CopyOnWriteBuffer> in_use;
+  for (size_t i = 0; i < kInUse; ++i) {
+    in_use.push_back(pool.GetBuffer(kCapacity));
+  }
+  {
+    std::vector<rtc::CopyOnWriteBuffer> released;
+    for (size_t i = 0; i < kReleased; ++i) {
+      released.push_back(pool.GetBuffer(kCapacity));
+    }
+  }
+
+  rtc::CopyOnWriteBuffer buffer = pool.GetBuffer(kCapacity);
+  EXPECT_EQ(pool.num_pooled_buffers(), kReleased - 1);
+}
+
+TEST(RtpPacketBufferPoolTest, BuffersMayOutlivePool) {
+  rtc::CopyOnWriteBuffer buffer;
+  {
+    RtpPacketBufferPool pool(/*max_pooled_buffers=*/4);
+    pool.GetBuffer(kCapacity);
+    buffer = pool.GetBuffer(kCapacity);
+  }
+  buffer.SetData("abc", 3);
+  EXPECT_EQ(buffer, rtc::CopyOnWriteBuffer("abc", 3));
+}
+
+// Builds packets the way RTPSenderVideo builds the middle packets of a frame
+// and keeps the latest ones alive the way the packet history does. Once the
+// history is full, sending more frames must not allocate any packet buffers.
+TEST(RtpPacketBufferPoolTest, PacketizingInSteadyStateDoesNotAllocate) {
+  constexpr int kPacketsPerFrame = 50;
+  constexpr size_t kHistorySize = 120;
+  constexpr size_t kPayloadSize = 1100;
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<TransmissionOffset>(1);
+  extensions.Register<TransportSequenceNumber>(2);
+  RtpPacketToSend packet_template(&extensions, kCapacity);
+  packet_template.SetPayloadType(96);
+  packet_template.SetSsrc(0x12345678);
+  packet_template.ReserveExtension<TransmissionOffset>();
+  packet_template.ReserveExtension<TransportSequenceNumber>();
+
+  RtpPacketBufferPool pool(/*max_pooled_buffers=*/kHistorySize);
+  std::deque<std::unique_ptr<RtpPacketToSend>> history;
+  size_t allocated_after_warmup = 0;
+  uint16_t sequence_number = 0;
+  for (int frame = 0; frame < 10; ++frame) {
+    if (frame == 5) {
+      allocated_after_warmup = pool.num_allocated_buffers();
+    }
+    packet_template.SetTimestamp(frame * 3000);
+    for (int i = 0; i < kPacketsPerFrame; ++i) {
+      auto packet = std::make_unique<RtpPacketToSend>(
+          nullptr, pool.GetBuffer(packet_template.capacity()));
+      packet->WriteHeaderFrom(packet_template);
+      packet->SetSequenceNumber(sequence_number++);
+      uint8_t* payload = packet->AllocatePayload(kPayloadSize);
+      ASSERT_TRUE(payload);
+      memset(payload, i, kPayloadSize);
+      EXPECT_TRUE(packet->SetExtension<TransportSequenceNumber>(i));
+
+      ASSERT_EQ(packet->headers_size(), packet_template.headers_size());
+      EXPECT_EQ(packet->Timestamp(), packet_template.Timestamp());
+      EXPECT_EQ(packet->Ssrc(), packet_template.Ssrc());
+      EXPECT_TRUE(packet->HasExtension<TransmissionOffset>());
+
+      // The pacer sends a copy; the history keeps the original.
+      RtpPacketToSend sent_packet = *packet;
+      EXPECT_EQ(sent_packet.data(), packet->data());
+      history.push_back(std::move(packet));
+      if (history.size() > kHistorySize) {
+        history.pop_front();
+      }
+    }
+  }
+  EXPECT_EQ(pool.num_allocated_buffers(), allocated_after_warmup);
+  EXPECT_LE(pool.num_allocated_buffers(), kHistorySize + 1);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -33,6 +33,27 @@ RtpPacketHistory::PacketState::PacketState() = default;
 RtpPacketHistory::PacketState::PacketState(const PacketState&) = default;
 RtpPacketHistory::PacketState::~PacketState() = default;
 
+namespace {
+// Smallest ring allocated once packets are stored.
+constexpr size_t kMinRingSize = 64;
+// The ring never needs to be larger than the sequence number space.
+constexpr size_t kMaxRingSize = 1 << 16;
+
+size_t RoundUpToPowerOfTwo(size_t n) {
+  size_t result = kMinRingSize;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+}  // namespace
+
+RtpPacketHistory::StoredPacket::StoredPacket()
+    : pending_transmission_(false),
+      in_padding_priority_(false),
+      insert_order_(0),
+      times_retransmitted_(0) {}
+
 RtpPacketHistory::StoredPacket::StoredPacket(
     std::unique_ptr<RtpPacketToSend> packet,
     absl::optional<int64_t> send_time_ms,
@@ -43,6 +64,7 @@ RtpPacketHistory::StoredPacket::StoredPacket(
       // be put in the pacer queue and later retrieved via
       // GetPacketAndSetSendTime().
       pending_transmission_(!send_time_ms.has_value()),
+      in_padding_priority_(false),
       insert_order_(insert_order),
       times_retransmitted_(0) {}
 
@@ -51,33 +73,14 @@ RtpPacketHistory::StoredPacket& RtpPacketHistory::StoredPacket::operator=(
     RtpPacketHistory::StoredPacket&&) = default;
 RtpPacketHistory::StoredPacket::~StoredPacket() = default;
 
-void RtpPacketHistory::StoredPacket::IncrementTimesRetransmitted(
-    PacketPrioritySet* priority_set) {
-  // Check if this StoredPacket is in the priority set. If so, we need to remove
-  // it before updating |times_retransmitted_| since that is used in sorting,
-  // and then add it back.
-  const bool in_priority_set = priority_set && priority_set->erase(this) > 0;
-  ++times_retransmitted_;
-  if (in_priority_set) {
-    auto it = priority_set->insert(this);
-    RTC_DCHECK(it.second)
-        << "ERROR: Priority set already contains matching packet! In set: "
-           "insert order = "
-        << (*it.first)->insert_order_
-        << ", times retransmitted = " << (*it.first)->times_retransmitted_
-        << ". Trying to add: insert order = " << insert_order_
-        << ", times retransmitted = " << times_retransmitted_;
-  }
-}
-
-bool RtpPacketHistory::MoreUseful::operator()(StoredPacket* lhs,
-                                              StoredPacket* rhs) const {
+bool RtpPacketHistory::MoreUseful(const PaddingCandidate& lhs,
+                                  const PaddingCandidate& rhs) {
   // Prefer to send packets we haven't already sent as padding.
-  if (lhs->times_retransmitted() != rhs->times_retransmitted()) {
-    return lhs->times_retransmitted() < rhs->times_retransmitted();
+  if (lhs.times_retransmitted != rhs.times_retransmitted) {
+    return lhs.times_retransmitted < rhs.times_retransmitted;
   }
   // All else being equal, prefer newer packets.
-  return lhs->insert_order() > rhs->insert_order();
+  return lhs.insert_order > rhs.insert_order;
 }
 
 RtpPacketHistory::RtpPacketHistory(Clock* clock, bool enable_padding_prio)
@@ -86,7 +89,10 @@ RtpPacketHistory::RtpPacketHistory(Clock* clock, bool enable_padding_prio)
       number_to_store_(0),
       mode_(StorageMode::kDisabled),
       rtt_ms_(-1),
-      packets_inserted_(0) {}
+      first_sequence_number_(0),
+      history_size_(0),
+      packets_inserted_(0),
+      num_padding_candidates_(0) {}
 
 RtpPacketHistory::~RtpPacketHistory() {}
 
@@ -98,6 +104,8 @@ void RtpPacketHistory::SetStorePacketsStatus(StorageMode mode,
     RTC_LOG(LS_WARNING) << "Purging packet history in order to re-set status.";
   }
   Reset();
+  // Release the ring, it is sized for |number_to_store| on the next insert.
+  std::vector<StoredPacket>().swap(packet_history_);
   mode_ = mode;
   number_to_store_ = std::min(kMaxCapacity, number_to_store);
 }
@@ -134,37 +142,38 @@ void RtpPacketHistory::PutRtpPacket(std::unique_ptr<RtpPacketToSend> packet,
   // Store packet.
   const uint16_t rtp_seq_no = packet->SequenceNumber();
   int packet_index = GetPacketIndex(rtp_seq_no);
-  if (packet_index >= 0u &&
-      static_cast<size_t>(packet_index) < packet_history_.size() &&
-      packet_history_[packet_index].packet_ != nullptr) {
+  if (packet_index >= 0 && static_cast<size_t>(packet_index) < history_size_ &&
+      Slot(packet_index).packet_ != nullptr) {
     RTC_LOG(LS_WARNING) << "Duplicate packet inserted: " << rtp_seq_no;
     // Remove previous packet to avoid inconsistent state.
     RemovePacket(packet_index);
     packet_index = GetPacketIndex(rtp_seq_no);
   }
 
-  // Packet to be inserted ahead of first packet, expand front.
-  for (; packet_index < 0; ++packet_index) {
-    packet_history_.emplace_front(nullptr, absl::nullopt, 0);
-  }
-  // Packet to be inserted behind last packet, expand back.
-  while (static_cast<int>(packet_history_.size()) <= packet_index) {
-    packet_history_.emplace_back(nullptr, absl::nullopt, 0);
-  }
-
-  RTC_DCHECK_GE(packet_index, 0);
-  RTC_DCHECK_LT(packet_index, packet_history_.size());
-  RTC_DCHECK(packet_history_[packet_index].packet_ == nullptr);
-
-  packet_history_[packet_index] =
+  if (history_size_ == 0) {
+    EnsureRingCapacity(1);
+    first_sequence_number_ = rtp_seq_no;
+    history_size_ = 1;
+    packet_index = 0;
+  } else if (packet_index < 0) {
+    // Packet to be inserted ahead of first packet, expand front.
+    EnsureRingCapacity(history_size_ - packet_index);
+    first_sequence_number_ = rtp_seq_no;
+    history_size_ -= packet_index;
+    packet_index = 0;
+  } else if (static_cast<size_t>(packet_index) >= history_size_) {
+    // Packet to be inserted behind last packet, expand back.
+    EnsureRingCapacity(packet_index + 1);
+    history_size_ = packet_index + 1;
+  }
+
+  StoredPacket& stored_packet = Slot(packet_index);
+  RTC_DCHECK(stored_packet.packet_ == nullptr);
+  stored_packet =
       StoredPacket(std::move(packet), send_time_ms, packets_inserted_++);
 
   if (enable_padding_prio_) {
-    if (padding_priority_.size() >= kMaxPaddingtHistory - 1) {
-      padding_priority_.erase(std::prev(padding_priority_.end()));
-    }
-    auto prio_it = padding_priority_.insert(&packet_history_[packet_index]);
-    RTC_DCHECK(prio_it.second) << "Failed to insert packet into prio set.";
+    AddPaddingCandidate(&stored_packet);
   }
 }
 
@@ -186,8 +195,7 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPacketAndSetSendTime(
   }
 
   if (packet->send_time_ms_) {
-    packet->IncrementTimesRetransmitted(
-        enable_padding_prio_ ? &padding_priority_ : nullptr);
+    IncrementTimesRetransmitted(packet);
   }
 
   // Update send-time and mark as no long in pacer queue.
@@ -257,8 +265,7 @@ void RtpPacketHistory::MarkPacketAsSent(uint16_t sequence_number) {
   // transmission count.
   packet->send_time_ms_ = clock_->TimeInMilliseconds();
   packet->pending_transmission_ = false;
-  packet->IncrementTimesRetransmitted(enable_padding_prio_ ? &padding_priority_
-                                                           : nullptr);
+  IncrementTimesRetransmitted(packet);
 }
 
 absl::optional<RtpPacketHistory::PacketState> RtpPacketHistory::GetPacketState(
@@ -269,11 +276,10 @@ absl::optional<RtpPacketHistory::PacketState> RtpPacketHistory::GetPacketState(
   }
 
   int packet_index = GetPacketIndex(sequence_number);
-  if (packet_index < 0 ||
-      static_cast<size_t>(packet_index) >= packet_history_.size()) {
+  if (packet_index < 0 || static_cast<size_t>(packet_index) >= history_size_) {
     return absl::nullopt;
   }
-  const StoredPacket& packet = packet_history_[packet_index];
+  const StoredPacket& packet = Slot(packet_index);
   if (packet.packet_ == nullptr) {
     return absl::nullopt;
   }
@@ -317,15 +323,13 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPayloadPaddingPacket(
   }
 
   StoredPacket* best_packet = nullptr;
-  if (enable_padding_prio_ && !padding_priority_.empty()) {
-    auto best_packet_it = padding_priority_.begin();
-    best_packet = *best_packet_it;
-  } else if (!enable_padding_prio_ && !packet_history_.empty()) {
+  if (enable_padding_prio_ && num_padding_candidates_ > 0) {
+    best_packet = GetPaddingCandidatePacket(padding_priority_[0]);
+  } else if (!enable_padding_prio_) {
     // Prioritization not available, pick the last packet.
-    for (auto it = packet_history_.rbegin(); it != packet_history_.rend();
-         ++it) {
-      if (it->packet_ != nullptr) {
-        best_packet = &(*it);
+    for (int i = static_cast<int>(history_size_) - 1; i >= 0; --i) {
+      if (Slot(i).packet_ != nullptr) {
+        best_packet = &Slot(i);
         break;
       }
     }
@@ -349,8 +353,7 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPayloadPaddingPacket(
   }
 
   best_packet->send_time_ms_ = clock_->TimeInMilliseconds();
-  best_packet->IncrementTimesRetransmitted(
-      enable_padding_prio_ ? &padding_priority_ : nullptr);
+  IncrementTimesRetransmitted(best_packet);
 
   return padding_packet;
 }
@@ -361,7 +364,7 @@ void RtpPacketHistory::CullAcknowledgedPackets(
   for (uint16_t sequence_number : sequence_numbers) {
     int packet_index = GetPacketIndex(sequence_number);
     if (packet_index < 0 ||
-        static_cast<size_t>(packet_index) >= packet_history_.size()) {
+        static_cast<size_t>(packet_index) >= history_size_) {
       continue;
     }
     RemovePacket(packet_index);
@@ -389,22 +392,25 @@ void RtpPacketHistory::Clear() {
 }
 
 void RtpPacketHistory::Reset() {
-  packet_history_.clear();
-  padding_priority_.clear();
+  for (size_t i = 0; i < history_size_; ++i) {
+    Slot(i) = StoredPacket();
+  }
+  history_size_ = 0;
+  num_padding_candidates_ = 0;
 }
 
 void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
   int64_t packet_duration_ms =
       std::max(kMinPacketDurationRtt * rtt_ms_, kMinPacketDurationMs);
-  while (!packet_history_.empty()) {
-    if (packet_history_.size() >= kMaxCapacity) {
+  while (history_size_ > 0) {
+    if (history_size_ >= kMaxCapacity) {
       // We have reached the absolute max capacity, remove one packet
       // unconditionally.
       RemovePacket(0);
       continue;
     }
 
-    const StoredPacket& stored_packet = packet_history_.front();
+    const StoredPacket& stored_packet = Slot(0);
     if (stored_packet.pending_transmission_) {
       // Don't remove packets in the pacer queue, pending tranmission.
       return;
@@ -415,7 +421,7 @@ void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
       return;
     }
 
-    if (packet_history_.size() >= number_to_store_ ||
+    if (history_size_ >= number_to_store_ ||
         *stored_packet.send_time_ms_ +
                 (packet_duration_ms * kPacketCullingDelayFactor) <=
             now_ms) {
@@ -431,19 +437,20 @@ void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
 
 std::unique_ptr<RtpPacketToSend> RtpPacketHistory::RemovePacket(
     int packet_index) {
+  StoredPacket& stored_packet = Slot(packet_index);
   // Move the packet out from the StoredPacket container.
   std::unique_ptr<RtpPacketToSend> rtp_packet =
-      std::move(packet_history_[packet_index].packet_);
+      std::move(stored_packet.packet_);
 
   // Erase from padding priority set, if eligible.
-  if (enable_padding_prio_) {
-    padding_priority_.erase(&packet_history_[packet_index]);
+  if (stored_packet.in_padding_priority_) {
+    RemovePaddingCandidate(&stored_packet);
   }
 
   if (packet_index == 0) {
-    while (!packet_history_.empty() &&
-           packet_history_.front().packet_ == nullptr) {
-      packet_history_.pop_front();
+    while (history_size_ > 0 && Slot(0).packet_ == nullptr) {
+      ++first_sequence_number_;
+      --history_size_;
     }
   }
 
@@ -451,12 +458,12 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::RemovePacket(
 }
 
 int RtpPacketHistory::GetPacketIndex(uint16_t sequence_number) const {
-  if (packet_history_.empty()) {
+  if (history_size_ == 0) {
     return 0;
   }
 
-  RTC_DCHECK(packet_history_.front().packet_ != nullptr);
-  int first_seq = packet_history_.front().packet_->SequenceNumber();
+  RTC_DCHECK(Slot(0).packet_ != nullptr);
+  int first_seq = first_sequence_number_;
   if (first_seq == sequence_number) {
     return 0;
   }
@@ -477,14 +484,113 @@ int RtpPacketHistory::GetPacketIndex(uint16_t sequence_number) const {
   return packet_index;
 }
 
+RtpPacketHistory::StoredPacket& RtpPacketHistory::Slot(int packet_index) {
+  RTC_DCHECK_GE(packet_index, 0);
+  RTC_DCHECK_LT(packet_index, history_size_);
+  return packet_history_[static_cast<uint16_t>(first_sequence_number_ +
+                                               packet_index) &
+                         (packet_history_.size() - 1)];
+}
+
+const RtpPacketHistory::StoredPacket& RtpPacketHistory::Slot(
+    int packet_index) const {
+  RTC_DCHECK_GE(packet_index, 0);
+  RTC_DCHECK_LT(packet_index, history_size_);
+  return packet_history_[static_cast<uint16_t>(first_sequence_number_ +
+                                               packet_index) &
+                         (packet_history_.size() - 1)];
+}
+
 RtpPacketHistory::StoredPacket* RtpPacketHistory::GetStoredPacket(
     uint16_t sequence_number) {
   int index = GetPacketIndex(sequence_number);
-  if (index < 0 || static_cast<size_t>(index) >= packet_history_.size() ||
-      packet_history_[index].packet_ == nullptr) {
+  if (index < 0 || static_cast<size_t>(index) >= history_size_ ||
+      Slot(index).packet_ == nullptr) {
     return nullptr;
   }
-  return &packet_history_[index];
+  return &Slot(index);
+}
+
+void RtpPacketHistory::EnsureRingCapacity(size_t history_size) {
+  RTC_DCHECK_LE(history_size, kMaxRingSize);
+  if (history_size <= packet_history_.size()) {
+    return;
+  }
+  std::vector<StoredPacket> ring(
+      RoundUpToPowerOfTwo(std::max(history_size, number_to_store_)));
+  const size_t mask = ring.size() - 1;
+  for (size_t i = 0; i < history_size_; ++i) {
+    ring[static_cast<uint16_t>(first_sequence_number_ + i) & mask] =
+        std::move(Slot(i));
+  }
+  packet_history_.swap(ring);
+}
+
+RtpPacketHistory::StoredPacket* RtpPacketHistory::GetPaddingCandidatePacket(
+    const PaddingCandidate& candidate) {
+  // Index the ring directly rather than through GetPacketIndex(), so that the
+  // lookup does not depend on the span of the history.
+  StoredPacket* packet =
+      &packet_history_[candidate.sequence_number & (packet_history_.size() - 1)];
+  RTC_DCHECK(packet->in_padding_priority_);
+  RTC_DCHECK_EQ(packet->insert_order(), candidate.insert_order);
+  return packet;
+}
+
+void RtpPacketHistory::AddPaddingCandidate(StoredPacket* packet) {
+  RTC_DCHECK(!packet->in_padding_priority_);
+  if (num_padding_candidates_ >= kMaxPaddingtHistory - 1) {
+    // Evict the least useful packet.
+    --num_padding_candidates_;
+    GetPaddingCandidatePacket(padding_priority_[num_padding_candidates_])
+        ->in_padding_priority_ = false;
+  }
+
+  const PaddingCandidate candidate = {packet->insert_order(),
+                                      packet->times_retransmitted(),
+                                      packet->packet_->SequenceNumber()};
+  auto begin = padding_priority_.begin();
+  auto end = begin + num_padding_candidates_;
+  // A new packet is normally more useful than all others, so this is the
+  // front of the array.
+  auto it = std::lower_bound(begin, end, candidate, MoreUseful);
+  std::move_backward(it, end, end + 1);
+  *it = candidate;
+  ++num_padding_candidates_;
+  packet->in_padding_priority_ = true;
+}
+
+void RtpPacketHistory::RemovePaddingCandidate(StoredPacket* packet) {
+  RTC_DCHECK(packet->in_padding_priority_);
+  auto begin = padding_priority_.begin();
+  auto end = begin + num_padding_candidates_;
+  const uint64_t insert_order = packet->insert_order();
+  auto it = std::find_if(begin, end, [&](const PaddingCandidate& candidate) {
+    return candidate.insert_order == insert_order;
+  });
+  RTC_DCHECK(it != end);
+  std::move(it + 1, end, it);
+  --num_padding_candidates_;
+  packet->in_padding_priority_ = false;
+}
+
+void RtpPacketHistory::IncrementTimesRetransmitted(StoredPacket* packet) {
+  packet->IncrementTimesRetransmitted();
+  if (!packet->in_padding_priority_) {
+    return;
+  }
+  // The packet can only have become less useful, move it towards the back.
+  size_t i = 0;
+  while (padding_priority_[i].insert_order != packet->insert_order()) {
+    ++i;
+    RTC_DCHECK_LT(i, num_padding_candidates_);
+  }
+  padding_priority_[i].times_retransmitted = packet->times_retransmitted();
+  for (; i + 1 < num_padding_candidates_ &&
+         MoreUseful(padding_priority_[i + 1], padding_priority_[i]);
+       ++i) {
+    std::swap(padding_priority_[i], padding_priority_[i + 1]);
+  }
 }
 
 RtpPacketHistory::PacketState RtpPacketHistory::StoredPacketToPacketState(
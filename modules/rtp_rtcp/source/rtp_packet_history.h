@@ -11,10 +11,8 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_HISTORY_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_HISTORY_H_
 
-#include <deque>
-#include <map>
+#include <array>
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "api/function_view.h"
@@ -136,12 +134,9 @@ class RtpPacketHistory {
   void Clear();
 
  private:
-  struct MoreUseful;
-  class StoredPacket;
-  using PacketPrioritySet = std::set<StoredPacket*, MoreUseful>;
-
   class StoredPacket {
    public:
+    StoredPacket();
     StoredPacket(std::unique_ptr<RtpPacketToSend> packet,
                  absl::optional<int64_t> send_time_ms,
                  uint64_t insert_order);
@@ -151,7 +146,7 @@ class RtpPacketHistory {
 
     uint64_t insert_order() const { return insert_order_; }
     size_t times_retransmitted() const { return times_retransmitted_; }
-    void IncrementTimesRetransmitted(PacketPrioritySet* priority_set);
+    void IncrementTimesRetransmitted() { ++times_retransmitted_; }
 
     // The time of last transmission, including retransmissions.
     absl::optional<int64_t> send_time_ms_;
@@ -162,6 +157,9 @@ class RtpPacketHistory {
     // True if the packet is currently in the pacer queue pending transmission.
     bool pending_transmission_;
 
+    // True if the packet is currently one of the |padding_priority_| entries.
+    bool in_padding_priority_;
+
    private:
     // Unique number per StoredPacket, incremented by one for each added
     // packet. Used to sort on insert order.
@@ -170,9 +168,18 @@ class RtpPacketHistory {
     // Number of times RE-transmitted, ie excluding the first transmission.
     size_t times_retransmitted_;
   };
-  struct MoreUseful {
-    bool operator()(StoredPacket* lhs, StoredPacket* rhs) const;
+
+  // Entry in |padding_priority_|. The sort keys are copied from the
+  // StoredPacket so that the array can be kept ordered without touching the
+  // packet history.
+  struct PaddingCandidate {
+    uint64_t insert_order;
+    size_t times_retransmitted;
+    uint16_t sequence_number;
   };
+  // Returns true if |lhs| is more likely to be useful as padding than |rhs|.
+  static bool MoreUseful(const PaddingCandidate& lhs,
+                         const PaddingCandidate& rhs);
 
   // Helper method used by GetPacketAndSetSendTime() and GetPacketState() to
   // check if packet has too recently been sent.
@@ -184,10 +191,33 @@ class RtpPacketHistory {
   // stored. Returns the RTP packet instance contained within the StoredPacket.
   std::unique_ptr<RtpPacketToSend> RemovePacket(int packet_index)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the position of |sequence_number| relative to the first packet in
+  // the history. May be negative or beyond the end of the history.
   int GetPacketIndex(uint16_t sequence_number) const
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the ring slot for a position returned by GetPacketIndex(), which
+  // must be in the range [0, history_size_).
+  StoredPacket& Slot(int packet_index) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  const StoredPacket& Slot(int packet_index) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   StoredPacket* GetStoredPacket(uint16_t sequence_number)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Makes room for |history_size| consecutive sequence numbers in the ring,
+  // re-laying out the stored packets if the ring has to grow.
+  void EnsureRingCapacity(size_t history_size)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  StoredPacket* GetPaddingCandidatePacket(const PaddingCandidate& candidate)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void AddPaddingCandidate(StoredPacket* packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void RemovePaddingCandidate(StoredPacket* packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Increments the retransmission counter of |packet| and moves it to its new
+  // position in |padding_priority_|, if it is there.
+  void IncrementTimesRetransmitted(StoredPacket* packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   static PacketState StoredPacketToPacketState(
       const StoredPacket& stored_packet);
 
@@ -198,19 +228,25 @@ class RtpPacketHistory {
   StorageMode mode_ RTC_GUARDED_BY(lock_);
   int64_t rtt_ms_ RTC_GUARDED_BY(lock_);
 
-  // Queue of stored packets, ordered by sequence number, with older packets in
-  // the front and new packets being added to the back. Note that there may be
-  // wrap-arounds so the back may have a lower sequence number.
-  // Packets may also be removed out-of-order, in which case there will be
-  // instances of StoredPacket with |packet_| set to nullptr. The first and last
-  // entry in the queue will however always be populated.
-  std::deque<StoredPacket> packet_history_ RTC_GUARDED_BY(lock_);
+  // Ring of stored packets, indexed by sequence number modulo the ring size,
+  // which is always a power of two no larger than the sequence number space.
+  // The history covers the |history_size_| consecutive sequence numbers
+  // starting at |first_sequence_number_|, with older packets first. Packets
+  // may be removed out-of-order, in which case there will be slots with
+  // |packet_| set to nullptr. The first slot is however always populated.
+  std::vector<StoredPacket> packet_history_ RTC_GUARDED_BY(lock_);
+  uint16_t first_sequence_number_ RTC_GUARDED_BY(lock_);
+  size_t history_size_ RTC_GUARDED_BY(lock_);
 
   // Total number of packets with inserted.
   uint64_t packets_inserted_ RTC_GUARDED_BY(lock_);
-  // Objects from |packet_history_| ordered by "most likely to be useful", used
-  // in GetPayloadPaddingPacket().
-  PacketPrioritySet padding_priority_ RTC_GUARDED_BY(lock_);
+  // The packets "most likely to be useful", used in GetPayloadPaddingPacket(),
+  // with the most useful packet first. Newly inserted packets are always the
+  // most useful, and a packet only ever becomes less useful, so keeping the
+  // few entries in a sorted array is cheaper than a tree.
+  std::array<PaddingCandidate, kMaxPaddingtHistory> padding_priority_
+      RTC_GUARDED_BY(lock_);
+  size_t num_padding_candidates_ RTC_GUARDED_BY(lock_);
 
   RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(RtpPacketHistory);
 };
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "modules/rtp_rtcp/source/rtp_packet_history.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kHistorySize = 500;
+constexpr size_t kPayloadSize = 1000;
+// One in 20 packets is lost and retransmitted, i.e. 5% loss.
+constexpr int kLossInterval = 20;
+// Packets are NACKed roughly one RTT after they were sent.
+constexpr int kNackDelayPackets = 30;
+constexpr int kPacketIntervalMs = 3;
+
+// Models the send side of a video stream with a 500 packet history: every
+// packet is stored as it is sent, every 20th packet is NACKed and
+// retransmitted, and the pacer asks for a payload padding packet after each
+// media packet. The argument enables padding prioritization.
+void BM_RtpPacketHistorySendWithLossAndPadding(benchmark::State& state) {
+  SimulatedClock clock(123456);
+  RtpPacketHistory history(&clock, /*enable_padding_prio=*/state.range(0));
+  history.SetStorePacketsStatus(RtpPacketHistory::StorageMode::kStoreAndCull,
+                                kHistorySize);
+  history.SetRtt(kNackDelayPackets * kPacketIntervalMs);
+
+  RtpPacketToSend prototype(nullptr);
+  prototype.SetPayloadSize(kPayloadSize);
+  prototype.set_allow_retransmission(true);
+
+  uint16_t sequence_number = 0;
+  for (auto s : state) {
+    auto packet = std::make_unique<RtpPacketToSend>(prototype);
+    packet->SetSequenceNumber(sequence_number);
+    history.PutRtpPacket(std::move(packet), clock.TimeInMilliseconds());
+
+    if (sequence_number % kLossInterval == 0) {
+      uint16_t lost = sequence_number - kNackDelayPackets;
+      if (history.GetPacketAndMarkAsPending(lost)) {
+        history.MarkPacketAsSent(lost);
+      }
+    }
+    benchmark::DoNotOptimize(history.GetPayloadPaddingPacket());
+
+    ++sequence_number;
+    clock.AdvanceTimeMilliseconds(kPacketIntervalMs);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RtpPacketHistorySendWithLossAndPadding)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace webrtc
@@ -10,11 +10,18 @@
 
 #include "modules/rtp_rtcp/source/rtp_packet_history.h"
 
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <memory>
+#include <set>
 #include <utility>
+#include <vector>
 
+#include "modules/include/module_common_types_public.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/random.h"
 #include "system_wrappers/include/clock.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -792,6 +799,28 @@ TEST_P(RtpPacketHistoryTest, OutOfOrderInsertRemoval) {
   }
 }
 
+TEST_P(RtpPacketHistoryTest, KeepsPacketsWhenGrowingBeyondNumberToStore) {
+  const size_t kHistorySize = 10;
+  const size_t kNumPackets = 1000;
+  hist_.SetStorePacketsStatus(StorageMode::kStoreAndCull, kHistorySize);
+
+  // Packets pending transmission are never culled, so the history has to grow
+  // past |kHistorySize|. Start close to the wrap-around point.
+  const uint16_t kFirstSeqNum = 0xFFFF - kNumPackets / 2;
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    hist_.PutRtpPacket(CreateRtpPacket(To16u(kFirstSeqNum + i)),
+                       absl::nullopt);
+  }
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    absl::optional<RtpPacketHistory::PacketState> packet_state =
+        hist_.GetPacketState(To16u(kFirstSeqNum + i));
+    ASSERT_TRUE(packet_state);
+    EXPECT_EQ(packet_state->rtp_sequence_number, To16u(kFirstSeqNum + i));
+  }
+  EXPECT_FALSE(hist_.GetPacketState(To16u(kFirstSeqNum - 1)));
+  EXPECT_FALSE(hist_.GetPacketState(To16u(kFirstSeqNum + kNumPackets)));
+}
+
 TEST_P(RtpPacketHistoryTest, UsesLastPacketAsPaddingWithPrioOff) {
   if (GetParam()) {
     // Padding prioritization is enabled, ignore this test.
@@ -835,6 +864,344 @@ TEST_P(RtpPacketHistoryTest, UsesLastPacketAsPaddingWithPrioOff) {
   EXPECT_EQ(hist_.GetPayloadPaddingPacket(), nullptr);
 }
 
+namespace {
+// Model of the deque and std::set based RtpPacketHistory that the ring buffer
+// replaced. Only the sequence numbers and the per-packet state are tracked.
+class ReferencePacketHistory {
+ public:
+  struct Packet {
+    bool stored = false;
+    uint16_t sequence_number = 0;
+    absl::optional<int64_t> send_time_ms;
+    bool pending_transmission = false;
+    uint64_t insert_order = 0;
+    size_t times_retransmitted = 0;
+  };
+
+  ReferencePacketHistory(Clock* clock, bool enable_padding_prio)
+      : clock_(clock),
+        enable_padding_prio_(enable_padding_prio),
+        padding_priority_(MoreUseful) {}
+
+  void SetStorePacketsStatus(size_t number_to_store) {
+    Clear();
+    number_to_store_ = std::min(RtpPacketHistory::kMaxCapacity,
+                                number_to_store);
+  }
+
+  void SetRtt(int64_t rtt_ms) {
+    rtt_ms_ = rtt_ms;
+    CullOldPackets(clock_->TimeInMilliseconds());
+  }
+
+  void PutRtpPacket(uint16_t sequence_number,
+                    absl::optional<int64_t> send_time_ms) {
+    CullOldPackets(clock_->TimeInMilliseconds());
+    int index = GetPacketIndex(sequence_number);
+    if (index >= 0 && static_cast<size_t>(index) < history_.size() &&
+        history_[index].stored) {
+      RemovePacket(index);
+      index = GetPacketIndex(sequence_number);
+    }
+    for (; index < 0; ++index)
+      history_.emplace_front();
+    while (static_cast<int>(history_.size()) <= index)
+      history_.emplace_back();
+
+    Packet& packet = history_[index];
+    packet.stored = true;
+    packet.sequence_number = sequence_number;
+    packet.send_time_ms = send_time_ms;
+    packet.pending_transmission = !send_time_ms.has_value();
+    packet.insert_order = packets_inserted_++;
+    packet.times_retransmitted = 0;
+    if (enable_padding_prio_) {
+      if (padding_priority_.size() >= RtpPacketHistory::kMaxPaddingtHistory - 1)
+        padding_priority_.erase(std::prev(padding_priority_.end()));
+      padding_priority_.insert(&packet);
+    }
+  }
+
+  absl::optional<uint16_t> GetPacketAndSetSendTime(uint16_t sequence_number) {
+    Packet* packet = GetPacket(sequence_number);
+    const int64_t now_ms = clock_->TimeInMilliseconds();
+    if (!packet || !VerifyRtt(*packet, now_ms))
+      return absl::nullopt;
+    if (packet->send_time_ms)
+      IncrementTimesRetransmitted(packet);
+    packet->send_time_ms = now_ms;
+    packet->pending_transmission = false;
+    return sequence_number;
+  }
+
+  absl::optional<uint16_t> GetPacketAndMarkAsPending(uint16_t sequence_number,
+                                                     bool encapsulate) {
+    Packet* packet = GetPacket(sequence_number);
+    if (!packet || packet->pending_transmission ||
+        !VerifyRtt(*packet, clock_->TimeInMilliseconds()) || !encapsulate) {
+      return absl::nullopt;
+    }
+    packet->pending_transmission = true;
+    return sequence_number;
+  }
+
+  void MarkPacketAsSent(uint16_t sequence_number) {
+    Packet* packet = GetPacket(sequence_number);
+    if (!packet)
+      return;
+    packet->send_time_ms = clock_->TimeInMilliseconds();
+    packet->pending_transmission = false;
+    IncrementTimesRetransmitted(packet);
+  }
+
+  const Packet* GetPacketState(uint16_t sequence_number) {
+    Packet* packet = GetPacket(sequence_number);
+    if (!packet || !VerifyRtt(*packet, clock_->TimeInMilliseconds()))
+      return nullptr;
+    return packet;
+  }
+
+  absl::optional<uint16_t> GetPayloadPaddingPacket(bool encapsulate) {
+    Packet* best_packet = nullptr;
+    if (enable_padding_prio_ && !padding_priority_.empty()) {
+      best_packet = *padding_priority_.begin();
+    } else if (!enable_padding_prio_) {
+      for (auto it = history_.rbegin(); it != history_.rend(); ++it) {
+        if (it->stored) {
+          best_packet = &*it;
+          break;
+        }
+      }
+    }
+    if (!best_packet || best_packet->pending_transmission || !encapsulate)
+      return absl::nullopt;
+    best_packet->send_time_ms = clock_->TimeInMilliseconds();
+    IncrementTimesRetransmitted(best_packet);
+    return best_packet->sequence_number;
+  }
+
+  void CullAcknowledgedPackets(const std::vector<uint16_t>& sequence_numbers) {
+    for (uint16_t sequence_number : sequence_numbers) {
+      int index = GetPacketIndex(sequence_number);
+      if (index >= 0 && static_cast<size_t>(index) < history_.size())
+        RemovePacket(index);
+    }
+  }
+
+  bool SetPendingTransmission(uint16_t sequence_number) {
+    Packet* packet = GetPacket(sequence_number);
+    if (!packet)
+      return false;
+    packet->pending_transmission = true;
+    return true;
+  }
+
+  void Clear() {
+    history_.clear();
+    padding_priority_.clear();
+  }
+
+ private:
+  static bool MoreUseful(const Packet* lhs, const Packet* rhs) {
+    if (lhs->times_retransmitted != rhs->times_retransmitted)
+      return lhs->times_retransmitted < rhs->times_retransmitted;
+    return lhs->insert_order > rhs->insert_order;
+  }
+
+  bool VerifyRtt(const Packet& packet, int64_t now_ms) const {
+    return !packet.send_time_ms || packet.times_retransmitted == 0 ||
+           now_ms >= *packet.send_time_ms + rtt_ms_;
+  }
+
+  void IncrementTimesRetransmitted(Packet* packet) {
+    const bool in_priority_set =
+        enable_padding_prio_ && padding_priority_.erase(packet) > 0;
+    ++packet->times_retransmitted;
+    if (in_priority_set)
+      padding_priority_.insert(packet);
+  }
+
+  void CullOldPackets(int64_t now_ms) {
+    const int64_t packet_duration_ms =
+        std::max(RtpPacketHistory::kMinPacketDurationRtt * rtt_ms_,
+                 RtpPacketHistory::kMinPacketDurationMs);
+    while (!history_.empty()) {
+      if (history_.size() >= RtpPacketHistory::kMaxCapacity) {
+        RemovePacket(0);
+        continue;
+      }
+      const Packet& packet = history_.front();
+      if (packet.pending_transmission ||
+          *packet.send_time_ms + packet_duration_ms > now_ms) {
+        return;
+      }
+      if (history_.size() >= number_to_store_ ||
+          *packet.send_time_ms +
+                  packet_duration_ms *
+                      RtpPacketHistory::kPacketCullingDelayFactor <=
+              now_ms) {
+        RemovePacket(0);
+      } else {
+        return;
+      }
+    }
+  }
+
+  void RemovePacket(int index) {
+    if (enable_padding_prio_)
+      padding_priority_.erase(&history_[index]);
+    history_[index].stored = false;
+    if (index == 0) {
+      while (!history_.empty() && !history_.front().stored)
+        history_.pop_front();
+    }
+  }
+
+  int GetPacketIndex(uint16_t sequence_number) const {
+    if (history_.empty())
+      return 0;
+    const int first_seq = history_.front().sequence_number;
+    int index = sequence_number - first_seq;
+    constexpr int kSeqNumSpan = std::numeric_limits<uint16_t>::max() + 1;
+    if (IsNewerSequenceNumber(sequence_number, first_seq)) {
+      if (sequence_number < first_seq)
+        index += kSeqNumSpan;
+    } else if (sequence_number > first_seq) {
+      index -= kSeqNumSpan;
+    }
+    return index;
+  }
+
+  Packet* GetPacket(uint16_t sequence_number) {
+    int index = GetPacketIndex(sequence_number);
+    if (index < 0 || static_cast<size_t>(index) >= history_.size() ||
+        !history_[index].stored) {
+      return nullptr;
+    }
+    return &history_[index];
+  }
+
+  Clock* const clock_;
+  const bool enable_padding_prio_;
+  size_t number_to_store_ = 0;
+  int64_t rtt_ms_ = -1;
+  uint64_t packets_inserted_ = 0;
+  // Elements are never moved by push/pop at the ends of a deque, so the
+  // priority set can point into it.
+  std::deque<Packet> history_;
+  std::set<Packet*, bool (*)(const Packet*, const Packet*)> padding_priority_;
+};
+}  // namespace
+
+// Drives the history and ReferencePacketHistory through the same random
+// sequence of calls, and checks that they return the same packets and keep
+// the same state for every packet near the current sequence number.
+TEST_P(RtpPacketHistoryTest, MatchesReferenceImplementation) {
+  constexpr int kNumRuns = 20;
+  constexpr int kNumSteps = 3000;
+  constexpr int kStateWindow = 200;
+  Random random(0x1234);
+  // The RTT is kept across runs, like in the history.
+  ReferencePacketHistory reference(&fake_clock_, GetParam());
+  for (int run = 0; run < kNumRuns; ++run) {
+    const size_t number_to_store = random.Rand(1, 150);
+    hist_.SetStorePacketsStatus(StorageMode::kStoreAndCull, number_to_store);
+    reference.SetStorePacketsStatus(number_to_store);
+    uint16_t next_seq = random.Rand<uint16_t>();
+
+    auto random_seq = [&] {
+      return To16u(next_seq - random.Rand(1, kStateWindow));
+    };
+    auto seq_of = [](const std::unique_ptr<RtpPacketToSend>& packet) {
+      return packet ? absl::optional<uint16_t>(packet->SequenceNumber())
+                    : absl::nullopt;
+    };
+
+    for (int step = 0; step < kNumSteps; ++step) {
+      const int action = random.Rand(0, 99);
+      if (action < 30) {
+        // Mostly in order, sometimes reordered or duplicated.
+        uint16_t seq = next_seq++;
+        if (random.Rand(0, 9) == 0)
+          seq = To16u(seq - random.Rand(0, 5));
+        absl::optional<int64_t> send_time_ms;
+        if (random.Rand<bool>())
+          send_time_ms = fake_clock_.TimeInMilliseconds();
+        hist_.PutRtpPacket(CreateRtpPacket(seq), send_time_ms);
+        reference.PutRtpPacket(seq, send_time_ms);
+      } else if (action < 45) {
+        const uint16_t seq = random_seq();
+        const bool encapsulate = random.Rand(0, 9) != 0;
+        EXPECT_EQ(seq_of(hist_.GetPacketAndMarkAsPending(
+                      seq,
+                      [&](const RtpPacketToSend& packet) {
+                        return encapsulate
+                                   ? std::make_unique<RtpPacketToSend>(packet)
+                                   : nullptr;
+                      })),
+                  reference.GetPacketAndMarkAsPending(seq, encapsulate));
+      } else if (action < 55) {
+        const uint16_t seq = random_seq();
+        const ReferencePacketHistory::Packet* packet =
+            reference.GetPacketState(seq);
+        if (packet && packet->send_time_ms) {
+          hist_.MarkPacketAsSent(seq);
+          reference.MarkPacketAsSent(seq);
+        }
+      } else if (action < 62) {
+        const uint16_t seq = random_seq();
+        EXPECT_EQ(seq_of(hist_.GetPacketAndSetSendTime(seq)),
+                  reference.GetPacketAndSetSendTime(seq));
+      } else if (action < 72) {
+        const bool encapsulate = random.Rand(0, 9) != 0;
+        EXPECT_EQ(seq_of(hist_.GetPayloadPaddingPacket(
+                      [&](const RtpPacketToSend& packet) {
+                        return encapsulate
+                                   ? std::make_unique<RtpPacketToSend>(packet)
+                                   : nullptr;
+                      })),
+                  reference.GetPayloadPaddingPacket(encapsulate));
+      } else if (action < 80) {
+        std::vector<uint16_t> acked;
+        const int num_acked = random.Rand(1, 10);
+        for (int i = 0; i < num_acked; ++i)
+          acked.push_back(random_seq());
+        hist_.CullAcknowledgedPackets(acked);
+        reference.CullAcknowledgedPackets(acked);
+      } else if (action < 85) {
+        const uint16_t seq = random_seq();
+        EXPECT_EQ(hist_.SetPendingTransmission(seq),
+                  reference.SetPendingTransmission(seq));
+      } else if (action < 88) {
+        const int64_t rtt_ms = random.Rand(0, 800);
+        hist_.SetRtt(rtt_ms);
+        reference.SetRtt(rtt_ms);
+      } else if (action < 89) {
+        hist_.Clear();
+        reference.Clear();
+      } else {
+        fake_clock_.AdvanceTimeMilliseconds(random.Rand(0, 200));
+      }
+
+      for (int i = -5; i <= kStateWindow; ++i) {
+        const uint16_t seq = To16u(next_seq - i);
+        absl::optional<RtpPacketHistory::PacketState> state =
+            hist_.GetPacketState(seq);
+        const ReferencePacketHistory::Packet* expected =
+            reference.GetPacketState(seq);
+        ASSERT_EQ(state.has_value(), expected != nullptr)
+            << "run " << run << " step " << step << " seq " << seq;
+        if (!expected)
+          continue;
+        EXPECT_EQ(state->send_time_ms, expected->send_time_ms);
+        EXPECT_EQ(state->times_retransmitted, expected->times_retransmitted);
+        ASSERT_EQ(state->pending_transmission, expected->pending_transmission)
+            << "run " << run << " step " << step << " seq " << seq;
+      }
+    }
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(WithAndWithoutPaddingPrio,
                          RtpPacketHistoryTest,
                          ::testing::Bool());
@@ -11,6 +11,7 @@
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 
 #include <cstdint>
+#include <utility>
 
 namespace webrtc {
 
@@ -19,6 +20,9 @@ RtpPacketToSend::RtpPacketToSend(const ExtensionManager* extensions)
 RtpPacketToSend::RtpPacketToSend(const ExtensionManager* extensions,
                                  size_t capacity)
     : RtpPacket(extensions, capacity) {}
+RtpPacketToSend::RtpPacketToSend(const ExtensionManager* extensions,
+                                 rtc::CopyOnWriteBuffer buffer)
+    : RtpPacket(extensions, std::move(buffer)) {}
 RtpPacketToSend::RtpPacketToSend(const RtpPacketToSend& packet) = default;
 RtpPacketToSend::RtpPacketToSend(RtpPacketToSend&& packet) = default;
 
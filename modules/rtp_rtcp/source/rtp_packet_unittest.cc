@@ -369,6 +369,51 @@ TEST(RtpPacketTest, SetReservedExtensionsAfterPayload) {
   EXPECT_TRUE(packet.SetExtension<TransmissionOffset>(kTimeOffset));
 }
 
+TEST(RtpPacketTest, CopyHeaderFromSharesHeaderBuffer) {
+  RtpPacketToSend::ExtensionManager extensions;
+  extensions.Register<TransmissionOffset>(kTransmissionOffsetExtensionId);
+  RtpPacketToSend packet(&extensions);
+  packet.SetPayloadType(kPayloadType);
+  packet.SetSequenceNumber(kSeqNum);
+  packet.SetTimestamp(kTimestamp);
+  packet.SetSsrc(kSsrc);
+  packet.SetExtension<TransmissionOffset>(kTimeOffset);
+  packet.SetPayloadSize(4);
+
+  RtpPacketToSend copy(nullptr);
+  copy.CopyHeaderFrom(packet);
+  EXPECT_EQ(copy.data(), packet.data());
+  EXPECT_EQ(copy.size(), packet.headers_size());
+  EXPECT_EQ(copy.payload_size(), 0u);
+  EXPECT_EQ(copy.Ssrc(), kSsrc);
+  EXPECT_EQ(copy.GetExtension<TransmissionOffset>(), kTimeOffset);
+}
+
+TEST(RtpPacketTest, WriteHeaderFromWritesIntoOwnBuffer) {
+  RtpPacketToSend::ExtensionManager extensions;
+  extensions.Register<TransmissionOffset>(kTransmissionOffsetExtensionId);
+  RtpPacketToSend packet(&extensions);
+  packet.SetPayloadType(kPayloadType);
+  packet.SetSequenceNumber(kSeqNum);
+  packet.SetTimestamp(kTimestamp);
+  packet.SetSsrc(kSsrc);
+  packet.SetExtension<TransmissionOffset>(kTimeOffset);
+  packet.SetPayloadSize(4);
+
+  RtpPacketToSend copy(nullptr, packet.capacity());
+  const uint8_t* buffer = copy.data();
+  copy.WriteHeaderFrom(packet);
+  EXPECT_EQ(copy.data(), buffer);
+  EXPECT_THAT(rtc::MakeArrayView(copy.data(), copy.size()),
+              ElementsAreArray(packet.data(), packet.headers_size()));
+  EXPECT_EQ(copy.payload_size(), 0u);
+  EXPECT_EQ(copy.GetExtension<TransmissionOffset>(), kTimeOffset);
+
+  // The payload is written in place.
+  copy.SetPayloadSize(packet.capacity() - packet.headers_size());
+  EXPECT_EQ(copy.data(), buffer);
+}
+
 TEST(RtpPacketTest, CreatePurePadding) {
   const size_t kPaddingSize = kMaxPaddingSize - 1;
   RtpPacketToSend packet(nullptr, 12 + kPaddingSize);
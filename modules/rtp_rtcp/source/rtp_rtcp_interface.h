@@ -144,6 +144,11 @@ class RtpRtcpInterface : public RtcpFeedbackSenderInterface {
     // overhead.
     bool enable_rtx_padding_prioritization = true;
 
+    // If true, the video packets that the pacer releases in one burst are held
+    // back until OnBatchComplete(), and then passed to the transport marked as
+    // batchable, so that the socket can send them with a single system call.
+    bool enable_send_packet_batching = false;
+
    private:
     RTC_DISALLOW_COPY_AND_ASSIGN(Configuration);
   };
@@ -293,6 +298,10 @@ class RtpRtcpInterface : public RtcpFeedbackSenderInterface {
   virtual bool TrySendPacket(RtpPacketToSend* packet,
                              const PacedPacketInfo& pacing_info) = 0;
 
+  // Called by the pacer once the current burst of packets has been passed to
+  // TrySendPacket(). Sends the packets held back for batching, if any.
+  virtual void OnBatchComplete() = 0;
+
   virtual void OnPacketsAcknowledged(
       rtc::ArrayView<const uint16_t> sequence_numbers) = 0;
 
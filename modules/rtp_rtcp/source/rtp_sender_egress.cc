@@ -51,6 +51,7 @@ void RtpSenderEgress::NonPacedPacketSender::EnqueuePackets(
     packet->ReserveExtension<AbsoluteSendTime>();
     sender_->SendPacket(packet.get(), PacedPacketInfo());
   }
+  sender_->OnBatchComplete();
 }
 
 RtpSenderEgress::RtpSenderEgress(const RtpRtcpInterface::Configuration& config,
@@ -68,6 +69,7 @@ RtpSenderEgress::RtpSenderEgress(const RtpRtcpInterface::Configuration& config,
       event_log_(config.event_log),
       is_audio_(config.audio),
       need_rtp_packet_infos_(config.need_rtp_packet_infos),
+      enable_send_packet_batching_(config.enable_send_packet_batching),
       transport_feedback_observer_(config.transport_feedback_callback),
       send_side_delay_observer_(config.send_side_delay_observer),
       send_packet_observer_(config.send_packet_observer),
@@ -185,8 +187,6 @@ void RtpSenderEgress::SendPacket(RtpPacketToSend* packet,
                        packet_ssrc);
   }
 
-  const bool send_success = SendPacketToNetwork(*packet, options, pacing_info);
-
   // Put packet in retransmission history or update pending status even if
   // actual sending fails.
   if (is_media && packet->allow_retransmission()) {
@@ -196,9 +196,31 @@ void RtpSenderEgress::SendPacket(RtpPacketToSend* packet,
     packet_history_->MarkPacketAsSent(*packet->retransmitted_sequence_number());
   }
 
-  if (send_success) {
+  if (enable_send_packet_batching_ && !is_audio_) {
+    options.batchable = true;
+    packets_to_send_.push_back(
+        PendingPacket{std::move(*packet), std::move(options), pacing_info});
+    return;
+  }
+  CompleteSendPacket(*packet, options, pacing_info);
+}
+
+void RtpSenderEgress::OnBatchComplete() {
+  if (packets_to_send_.empty())
+    return;
+  packets_to_send_.back().options.last_packet_in_batch = true;
+  for (const PendingPacket& pending : packets_to_send_) {
+    CompleteSendPacket(pending.packet, pending.options, pending.pacing_info);
+  }
+  packets_to_send_.clear();
+}
+
+void RtpSenderEgress::CompleteSendPacket(const RtpPacketToSend& packet,
+                                         const PacketOptions& options,
+                                         const PacedPacketInfo& pacing_info) {
+  if (SendPacketToNetwork(packet, options, pacing_info)) {
     rtc::CritScope lock(&lock_);
-    UpdateRtpStats(*packet);
+    UpdateRtpStats(packet);
     media_has_been_sent_ = true;
   }
 }
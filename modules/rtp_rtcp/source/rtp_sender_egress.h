@@ -51,8 +51,13 @@ class RtpSenderEgress {
                   RtpPacketHistory* packet_history);
   ~RtpSenderEgress() = default;
 
+  // With send packet batching enabled, video packets are moved from |packet|
+  // and held back until OnBatchComplete().
   void SendPacket(RtpPacketToSend* packet, const PacedPacketInfo& pacing_info)
       RTC_LOCKS_EXCLUDED(lock_);
+  // Sends the packets held back since the last call as one batch, the last of
+  // them flagged as the end of the batch.
+  void OnBatchComplete() RTC_LOCKS_EXCLUDED(lock_);
   uint32_t Ssrc() const { return ssrc_; }
   absl::optional<uint32_t> RtxSsrc() const { return rtx_ssrc_; }
   absl::optional<uint32_t> FlexFecSsrc() const { return flexfec_ssrc_; }
@@ -84,6 +89,12 @@ class RtpSenderEgress {
   // time.
   typedef std::map<int64_t, int> SendDelayMap;
 
+  struct PendingPacket {
+    RtpPacketToSend packet;
+    PacketOptions options;
+    PacedPacketInfo pacing_info;
+  };
+
   RtpSendRates GetSendRatesLocked() const RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   bool HasCorrectSsrc(const RtpPacketToSend& packet) const;
   void AddPacketToTransportFeedback(uint16_t packet_id,
@@ -102,6 +113,11 @@ class RtpSenderEgress {
                            const PacedPacketInfo& pacing_info);
   void UpdateRtpStats(const RtpPacketToSend& packet)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Sends |packet| to the network and updates the send statistics.
+  void CompleteSendPacket(const RtpPacketToSend& packet,
+                          const PacketOptions& options,
+                          const PacedPacketInfo& pacing_info)
+      RTC_LOCKS_EXCLUDED(lock_);
 
   const uint32_t ssrc_;
   const absl::optional<uint32_t> rtx_ssrc_;
@@ -114,6 +130,7 @@ class RtpSenderEgress {
   RtcEventLog* const event_log_;
   const bool is_audio_;
   const bool need_rtp_packet_infos_;
+  const bool enable_send_packet_batching_;
 
   TransportFeedbackObserver* const transport_feedback_observer_;
   SendSideDelayObserver* const send_side_delay_observer_;
@@ -142,6 +159,10 @@ class RtpSenderEgress {
   // 3. Whether the packet was the last in its frame.
   const std::unique_ptr<RtpSequenceNumberMap> rtp_sequence_number_map_
       RTC_GUARDED_BY(lock_);
+
+  // Packets held back until OnBatchComplete(). Only used on the thread that
+  // sends packets.
+  std::vector<PendingPacket> packets_to_send_;
 };
 
 }  // namespace webrtc
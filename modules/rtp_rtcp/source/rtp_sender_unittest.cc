@@ -512,6 +512,62 @@ TEST_P(RtpSenderTest, AssignSequenceNumberAllowsPaddingOnAudio) {
   EXPECT_EQ(kMinPaddingSize, GenerateAndSendPadding(kMinPaddingSize - 5));
 }
 
+TEST_P(RtpSenderTest, SendsVideoPacketsInBatchesWhenBatchingIsEnabled) {
+  MockTransport transport;
+  RtpRtcpInterface::Configuration config;
+  config.clock = &fake_clock_;
+  config.outgoing_transport = &transport;
+  config.paced_sender = &mock_paced_sender_;
+  config.local_media_ssrc = kSsrc;
+  config.event_log = &mock_rtc_event_log_;
+  config.retransmission_rate_limiter = &retransmission_rate_limiter_;
+  config.enable_send_packet_batching = true;
+  rtp_sender_context_ = std::make_unique<RtpSenderContext>(config);
+  rtp_sender()->SetTimestampOffset(0);
+
+  // The packets are held back until the batch is complete.
+  EXPECT_CALL(transport, SendRtp).Times(0);
+  std::vector<uint16_t> sequence_numbers;
+  for (int i = 0; i < 3; ++i) {
+    std::unique_ptr<RtpPacketToSend> packet =
+        BuildRtpPacket(kPayload, kMarkerBit, kTimestamp, /*capture_time_ms=*/0);
+    sequence_numbers.push_back(packet->SequenceNumber());
+    rtp_egress()->SendPacket(packet.get(), PacedPacketInfo());
+  }
+  ::testing::Mock::VerifyAndClearExpectations(&transport);
+
+  // Then sent in order, with the last one marked as the end of the batch.
+  std::vector<uint16_t> sent_sequence_numbers;
+  auto save_sequence_number = [&](const uint8_t* data, size_t size,
+                                  const PacketOptions& options) {
+    RtpPacketReceived packet;
+    EXPECT_TRUE(packet.Parse(data, size));
+    sent_sequence_numbers.push_back(packet.SequenceNumber());
+    return true;
+  };
+  {
+    ::testing::InSequence seq;
+    EXPECT_CALL(transport,
+                SendRtp(_, _,
+                        AllOf(Field(&PacketOptions::batchable, true),
+                              Field(&PacketOptions::last_packet_in_batch,
+                                    false))))
+        .Times(2)
+        .WillRepeatedly(save_sequence_number);
+    EXPECT_CALL(transport,
+                SendRtp(_, _,
+                        AllOf(Field(&PacketOptions::batchable, true),
+                              Field(&PacketOptions::last_packet_in_batch,
+                                    true))))
+        .WillOnce(save_sequence_number);
+  }
+  rtp_egress()->OnBatchComplete();
+  EXPECT_EQ(sent_sequence_numbers, sequence_numbers);
+
+  // Nothing is left to send.
+  rtp_egress()->OnBatchComplete();
+}
+
 TEST_P(RtpSenderTestWithoutPacer, AssignSequenceNumberSetPaddingTimestamps) {
   constexpr size_t kPaddingSize = 100;
   auto packet = rtp_sender()->AllocatePacket();
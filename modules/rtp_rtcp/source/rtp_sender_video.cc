@@ -44,6 +44,9 @@ namespace webrtc {
 namespace {
 constexpr size_t kRedForFecHeaderLength = 1;
 constexpr int64_t kMaxUnretransmittableFrameIntervalMs = 33 * 4;
+// Enough to recycle all packets of a 1 MB key frame, roughly 730 packets. The
+// pool trims itself once the burst has passed.
+constexpr size_t kMaxPooledPacketBuffers = 1024;
 
 void BuildRedPayload(const RtpPacketToSend& media_packet,
                      RtpPacketToSend* red_packet) {
@@ -138,6 +141,7 @@ RTPSenderVideo::RTPSenderVideo(const Config& config)
           config.field_trials->Lookup("WebRTC-GenericDescriptorAuth"),
           "Disabled")),
       absolute_capture_time_sender_(config.clock),
+      packet_buffer_pool_(kMaxPooledPacketBuffers),
       frame_transformer_delegate_(
           config.frame_transformer
               ? new rtc::RefCountedObject<
@@ -560,7 +564,13 @@ bool RTPSenderVideo::SendVideo(
       expected_payload_capacity =
           limits.max_payload_len - limits.last_packet_reduction_len;
     } else {
-      packet = std::make_unique<RtpPacketToSend>(*middle_packet);
+      // Middle packets make up the bulk of large frames. Build them in
+      // recycled buffers rather than in copies of the template, which would
+      // reallocate when the payload is written.
+      packet = std::make_unique<RtpPacketToSend>(
+          nullptr, packet_buffer_pool_.GetBuffer(middle_packet->capacity()));
+      packet->WriteHeaderFrom(*middle_packet);
+      packet->set_capture_time_ms(middle_packet->capture_time_ms());
       expected_payload_capacity = limits.max_payload_len;
     }
 
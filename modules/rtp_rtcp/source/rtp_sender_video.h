@@ -27,6 +27,7 @@
 #include "modules/include/module_common_types.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/absolute_capture_time_sender.h"
+#include "modules/rtp_rtcp/source/rtp_packet_buffer_pool.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "modules/rtp_rtcp/source/rtp_sender.h"
 #include "modules/rtp_rtcp/source/rtp_sender_video_frame_transformer_delegate.h"
@@ -215,6 +216,10 @@ class RTPSenderVideo {
 
   AbsoluteCaptureTimeSender absolute_capture_time_sender_;
 
+  // Storage for packets sent by SendVideo(). Buffers come back once the
+  // pacer and the packet history are done with them.
+  RtpPacketBufferPool packet_buffer_pool_;
+
   const rtc::scoped_refptr<RTPSenderVideoFrameTransformerDelegate>
       frame_transformer_delegate_;
 };
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <vector>
+
+#include "api/transport/field_trial_based_config.h"
+#include "api/video/video_frame_type.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_history.h"
+#include "modules/rtp_rtcp/source/rtp_rtcp_interface.h"
+#include "modules/rtp_rtcp/source/rtp_sender.h"
+#include "modules/rtp_rtcp/source/rtp_sender_video.h"
+#include "modules/rtp_rtcp/source/rtp_sender_video_test_helper.h"
+#include "modules/rtp_rtcp/source/rtp_video_header.h"
+#include "system_wrappers/include/clock.h"
+#include "test/allocation_counter.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using test::rtp_sender_video::kKeyFrameSize;
+using test::rtp_sender_video::kPayloadType;
+using test::rtp_sender_video::kSsrc;
+using test::rtp_sender_video::PacketSink;
+
+// Allocations per frame that don't depend on the number of packets, e.g. the
+// packetizer and the vector of packets passed to the pacer.
+constexpr int64_t kMaxAllocationsPerFrame = 32;
+
+TEST(RtpSenderVideoAllocationTest, KeyFrameAllocatesOncePerPacket) {
+  SimulatedClock clock(123456);
+  FieldTrialBasedConfig field_trials;
+  PacketSink packet_sink;
+  RtpPacketHistory packet_history(&clock, /*enable_padding_prio=*/false);
+
+  RtpRtcpInterface::Configuration config;
+  config.clock = &clock;
+  config.local_media_ssrc = kSsrc;
+  config.field_trials = &field_trials;
+  RTPSender rtp_sender(config, &packet_history, &packet_sink);
+  rtp_sender.RegisterRtpHeaderExtension(TransportSequenceNumber::kUri, 1);
+  rtp_sender.RegisterRtpHeaderExtension(AbsoluteSendTime::kUri, 2);
+  rtp_sender.RegisterRtpHeaderExtension(TransmissionOffset::kUri, 3);
+  rtp_sender.RegisterRtpHeaderExtension(VideoOrientation::kUri, 4);
+  rtp_sender.RegisterRtpHeaderExtension(PlayoutDelayLimits::kUri, 5);
+  rtp_sender.RegisterRtpHeaderExtension(VideoContentTypeExtension::kUri, 6);
+  rtp_sender.RegisterRtpHeaderExtension(VideoTimingExtension::kUri, 7);
+
+  RTPSenderVideo::Config video_config;
+  video_config.clock = &clock;
+  video_config.rtp_sender = &rtp_sender;
+  video_config.field_trials = &field_trials;
+  RTPSenderVideo rtp_sender_video(video_config);
+
+  const std::vector<uint8_t> frame(kKeyFrameSize, 0x5a);
+  RTPVideoHeader video_header;
+  video_header.frame_type = VideoFrameType::kVideoFrameKey;
+  video_header.width = 1920;
+  video_header.height = 1080;
+  uint32_t rtp_timestamp = 0;
+  auto send_frame = [&] {
+    ASSERT_TRUE(rtp_sender_video.SendVideo(
+        kPayloadType, kVideoCodecGeneric, rtp_timestamp,
+        clock.TimeInMilliseconds(), frame, nullptr, video_header,
+        /*expected_retransmission_time_ms=*/100));
+    rtp_timestamp += 3000;
+    clock.AdvanceTimeMilliseconds(33);
+  };
+
+  // Fill the buffer pool and the packet sink.
+  for (int i = 0; i < 3; ++i) {
+    send_frame();
+  }
+
+  const size_t packets_before = packet_sink.num_packets();
+  const int64_t allocations_before = test::NumAllocations();
+  send_frame();
+  const int64_t allocations = test::NumAllocations() - allocations_before;
+  const int64_t num_packets = packet_sink.num_packets() - packets_before;
+
+  // A key frame of this size is several hundred packets. The only allocation
+  // left per packet is the RtpPacketToSend object itself.
+  ASSERT_GT(num_packets, 500);
+  EXPECT_LE(allocations, num_packets + kMaxAllocationsPerFrame);
+}
+
+}  // namespace
+}  // namespace webrtc
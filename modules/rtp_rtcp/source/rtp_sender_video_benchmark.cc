@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <vector>
+
+#include "api/transport/field_trial_based_config.h"
+#include "api/video/video_frame_type.h"
+#include "benchmark/benchmark.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_history.h"
+#include "modules/rtp_rtcp/source/rtp_rtcp_interface.h"
+#include "modules/rtp_rtcp/source/rtp_sender.h"
+#include "modules/rtp_rtcp/source/rtp_sender_video.h"
+#include "modules/rtp_rtcp/source/rtp_sender_video_test_helper.h"
+#include "modules/rtp_rtcp/source/rtp_video_header.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+namespace {
+
+using test::rtp_sender_video::kKeyFrameSize;
+using test::rtp_sender_video::kPayloadType;
+using test::rtp_sender_video::kSsrc;
+using test::rtp_sender_video::PacketSink;
+
+// Packetizes a 1 MB key frame with the usual set of video header extensions.
+void BM_RtpSenderVideoSendKeyFrame(benchmark::State& state) {
+  SimulatedClock clock(123456);
+  FieldTrialBasedConfig field_trials;
+  PacketSink packet_sink;
+  RtpPacketHistory packet_history(&clock, /*enable_padding_prio=*/false);
+
+  RtpRtcpInterface::Configuration config;
+  config.clock = &clock;
+  config.local_media_ssrc = kSsrc;
+  config.field_trials = &field_trials;
+  RTPSender rtp_sender(config, &packet_history, &packet_sink);
+  rtp_sender.RegisterRtpHeaderExtension(TransportSequenceNumber::kUri, 1);
+  rtp_sender.RegisterRtpHeaderExtension(AbsoluteSendTime::kUri, 2);
+  rtp_sender.RegisterRtpHeaderExtension(TransmissionOffset::kUri, 3);
+  rtp_sender.RegisterRtpHeaderExtension(VideoOrientation::kUri, 4);
+  rtp_sender.RegisterRtpHeaderExtension(PlayoutDelayLimits::kUri, 5);
+  rtp_sender.RegisterRtpHeaderExtension(VideoContentTypeExtension::kUri, 6);
+  rtp_sender.RegisterRtpHeaderExtension(VideoTimingExtension::kUri, 7);
+
+  RTPSenderVideo::Config video_config;
+  video_config.clock = &clock;
+  video_config.rtp_sender = &rtp_sender;
+  video_config.field_trials = &field_trials;
+  RTPSenderVideo rtp_sender_video(video_config);
+
+  const std::vector<uint8_t> frame(kKeyFrameSize, 0x5a);
+  RTPVideoHeader video_header;
+  video_header.frame_type = VideoFrameType::kVideoFrameKey;
+  video_header.width = 1920;
+  video_header.height = 1080;
+  uint32_t rtp_timestamp = 0;
+  for (auto s : state) {
+    if (!rtp_sender_video.SendVideo(kPayloadType, kVideoCodecGeneric,
+                                    rtp_timestamp, clock.TimeInMilliseconds(),
+                                    frame, nullptr, video_header,
+                                    /*expected_retransmission_time_ms=*/100)) {
+      state.SkipWithError("Failed to send frame.");
+      break;
+    }
+    rtp_timestamp += 3000;
+    clock.AdvanceTimeMilliseconds(33);
+  }
+  state.SetItemsProcessed(packet_sink.num_packets());
+  state.SetBytesProcessed(state.iterations() * kKeyFrameSize);
+}
+
+BENCHMARK(BM_RtpSenderVideoSendKeyFrame);
+
+}  // namespace
+}  // namespace webrtc
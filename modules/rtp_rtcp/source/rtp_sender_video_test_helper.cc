@@ -0,0 +1,33 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtp_sender_video_test_helper.h"
+
+#include <utility>
+
+namespace webrtc {
+namespace test {
+namespace rtp_sender_video {
+
+PacketSink::PacketSink() : packets_(kHistorySize) {}
+
+PacketSink::~PacketSink() = default;
+
+void PacketSink::EnqueuePackets(
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets) {
+  for (auto& packet : packets) {
+    packets_[num_packets_ % kHistorySize] = std::move(packet);
+    ++num_packets_;
+  }
+}
+
+}  // namespace rtp_sender_video
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_RTP_SENDER_VIDEO_TEST_HELPER_H_
+#define MODULES_RTP_RTCP_SOURCE_RTP_SENDER_VIDEO_TEST_HELPER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "modules/rtp_rtcp/include/rtp_packet_sender.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+
+namespace webrtc {
+namespace test {
+namespace rtp_sender_video {
+
+constexpr uint32_t kSsrc = 1234;
+constexpr int kPayloadType = 96;
+constexpr size_t kKeyFrameSize = 1024 * 1024;
+// Number of sent packets kept alive, as by the packet history.
+constexpr size_t kHistorySize = 600;
+
+// Stands in for the pacer and the packet history: keeps the most recently
+// enqueued packets alive, in a ring that doesn't allocate once full.
+class PacketSink : public RtpPacketSender {
+ public:
+  PacketSink();
+  ~PacketSink() override;
+
+  void EnqueuePackets(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets) override;
+
+  size_t num_packets() const { return num_packets_; }
+
+ private:
+  std::vector<std::unique_ptr<RtpPacketToSend>> packets_;
+  size_t num_packets_ = 0;
+};
+
+}  // namespace rtp_sender_video
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_RTP_SENDER_VIDEO_TEST_HELPER_H_
@@ -0,0 +1,171 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_ADDRESS_HASH_TABLE_H_
+#define P2P_BASE_ADDRESS_HASH_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/socket_address.h"
+
+namespace cricket {
+
+// Maps remote addresses to objects it does not own, for the lookups done for
+// every received packet. Unlike std::map, a lookup hashes the address once
+// and then mostly compares it with a single entry: the table is open
+// addressed, with linear probing, and kept at most half full.
+template <typename T>
+class AddressHashTable {
+ public:
+  AddressHashTable() = default;
+  AddressHashTable(const AddressHashTable&) = delete;
+  AddressHashTable& operator=(const AddressHashTable&) = delete;
+
+  // Returns the value of |address|, or null.
+  T* Find(const rtc::SocketAddress& address) const {
+    if (size_ == 0) {
+      return nullptr;
+    }
+    const Slot& slot = slots_[FindSlot(address, Mix(address.Hash()))];
+    return slot.value;
+  }
+
+  // Maps |address| to |value|, which must not be null, replacing any value it
+  // had.
+  void Set(const rtc::SocketAddress& address, T* value) {
+    RTC_DCHECK(value);
+    if ((size_ + 1) * 2 > slots_.size()) {
+      Grow();
+    }
+    uint64_t hash = Mix(address.Hash());
+    Slot& slot = slots_[FindSlot(address, hash)];
+    if (!slot.value) {
+      slot.hash = hash;
+      slot.address = address;
+      ++size_;
+    }
+    slot.value = value;
+  }
+
+  // Returns false if |address| was not in the table.
+  bool Erase(const rtc::SocketAddress& address) {
+    if (size_ == 0) {
+      return false;
+    }
+    size_t index = FindSlot(address, Mix(address.Hash()));
+    if (!slots_[index].value) {
+      return false;
+    }
+    EraseSlot(index);
+    return true;
+  }
+
+  // Erases all the addresses that map to |value|.
+  void EraseValue(const T* value) {
+    std::vector<rtc::SocketAddress> addresses;
+    for (const Slot& slot : slots_) {
+      if (slot.value == value) {
+        addresses.push_back(slot.address);
+      }
+    }
+    for (const rtc::SocketAddress& address : addresses) {
+      Erase(address);
+    }
+  }
+
+  void Clear() {
+    slots_.clear();
+    shift_ = 64;
+    size_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  struct Slot {
+    uint64_t hash = 0;
+    rtc::SocketAddress address;
+    // Null if the slot is free.
+    T* value = nullptr;
+  };
+
+  // SocketAddress::Hash() is a plain xor of the IP and the port, whose low
+  // bits are poorly spread, so the index is taken from the top bits of a
+  // Fibonacci hash instead.
+  static uint64_t Mix(size_t hash) {
+    return static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ull;
+  }
+
+  size_t HomeIndex(uint64_t hash) const {
+    return static_cast<size_t>(hash >> shift_);
+  }
+
+  // Returns the index of the slot of |address|, or of the free slot where it
+  // would go.
+  size_t FindSlot(const rtc::SocketAddress& address, uint64_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t index = HomeIndex(hash);; index = (index + 1) & mask) {
+      const Slot& slot = slots_[index];
+      if (!slot.value || (slot.hash == hash && slot.address == address)) {
+        return index;
+      }
+    }
+  }
+
+  // Frees the slot at |index| and moves back the entries after it that would
+  // otherwise no longer be found, so that no tombstones are needed.
+  void EraseSlot(size_t index) {
+    const size_t mask = slots_.size() - 1;
+    size_t free = index;
+    for (size_t next = (free + 1) & mask; slots_[next].value;
+         next = (next + 1) & mask) {
+      // An entry can fill the free slot if the free slot lies on its probe
+      // sequence, i.e. between its home slot and where it is now.
+      size_t home = HomeIndex(slots_[next].hash);
+      if (((next - home) & mask) >= ((next - free) & mask)) {
+        slots_[free] = std::move(slots_[next]);
+        free = next;
+      }
+    }
+    slots_[free] = Slot();
+    --size_;
+  }
+
+  void Grow() {
+    const size_t num_slots = slots_.empty() ? 8 : slots_.size() * 2;
+    std::vector<Slot> old_slots(num_slots);
+    old_slots.swap(slots_);
+    shift_ = 64;
+    for (size_t n = num_slots; n > 1; n >>= 1) {
+      --shift_;
+    }
+    for (Slot& slot : old_slots) {
+      if (slot.value) {
+        slots_[FindSlot(slot.address, slot.hash)] = std::move(slot);
+      }
+    }
+  }
+
+  // Always a power of two, or empty.
+  std::vector<Slot> slots_;
+  // 64 - log2(slots_.size()).
+  int shift_ = 64;
+  size_t size_ = 0;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_ADDRESS_HASH_TABLE_H_
@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/address_hash_table.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/stun_port.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/network.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kLocalAddress("192.168.1.2", 0);
+
+// |num_addresses| remote addresses, as many peers behind NATs would have: a
+// few ports on each of many IPs.
+std::vector<rtc::SocketAddress> RemoteAddresses(int num_addresses) {
+  std::vector<rtc::SocketAddress> addresses;
+  for (int i = 0; i < num_addresses; ++i) {
+    addresses.emplace_back(rtc::IPAddress(0x0b000000 + i / 4), 50000 + i % 4);
+  }
+  return addresses;
+}
+
+// The order packets arrive in, from addresses picked at random.
+std::vector<rtc::SocketAddress> LookupOrder(
+    const std::vector<rtc::SocketAddress>& addresses) {
+  std::vector<rtc::SocketAddress> order = addresses;
+  std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+  return order;
+}
+
+void BM_MapFind(benchmark::State& state) {
+  std::vector<rtc::SocketAddress> addresses = RemoteAddresses(state.range(0));
+  std::map<rtc::SocketAddress, Connection*> map;
+  for (const rtc::SocketAddress& address : addresses) {
+    map[address] = reinterpret_cast<Connection*>(&map);
+  }
+  std::vector<rtc::SocketAddress> order = LookupOrder(addresses);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(order[i++ % order.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MapFind)->Arg(10)->Arg(10000);
+
+void BM_AddressHashTableFind(benchmark::State& state) {
+  std::vector<rtc::SocketAddress> addresses = RemoteAddresses(state.range(0));
+  AddressHashTable<Connection> table;
+  for (const rtc::SocketAddress& address : addresses) {
+    table.Set(address, reinterpret_cast<Connection*>(&table));
+  }
+  std::vector<rtc::SocketAddress> order = LookupOrder(addresses);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.Find(order[i++ % order.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddressHashTableFind)->Arg(10)->Arg(10000);
+
+// Lookups of addresses with no connection, as for the first check from a
+// peer.
+void BM_AddressHashTableFindMissing(benchmark::State& state) {
+  std::vector<rtc::SocketAddress> addresses = RemoteAddresses(state.range(0));
+  AddressHashTable<Connection> table;
+  for (const rtc::SocketAddress& address : addresses) {
+    table.Set(address, reinterpret_cast<Connection*>(&table));
+  }
+  std::vector<rtc::SocketAddress> order = LookupOrder(addresses);
+  for (rtc::SocketAddress& address : order) {
+    address.SetPort(address.port() + 1000);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.Find(order[i++ % order.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddressHashTableFindMissing)->Arg(10)->Arg(10000);
+
+// A UDPPort with a connection to each of |num_connections| remote addresses.
+class PortFixture {
+ public:
+  explicit PortFixture(int num_connections)
+      : thread_(&socket_server_),
+        socket_factory_(&thread_),
+        network_("unittest", "unittest", kLocalAddress.ipaddr(), 32),
+        addresses_(RemoteAddresses(num_connections)) {
+    network_.AddIP(kLocalAddress.ipaddr());
+    port_ = UDPPort::Create(&thread_, &socket_factory_, &network_, 0, 0,
+                            "lfrag", "lpass", std::string(), false,
+                            absl::nullopt);
+    RTC_CHECK(port_);
+    port_->PrepareAddress();
+    for (const rtc::SocketAddress& address : addresses_) {
+      Candidate remote(ICE_CANDIDATE_COMPONENT_DEFAULT, UDP_PROTOCOL_NAME,
+                       address, 1000, "rfrag", "rpass", LOCAL_PORT_TYPE,
+                       /*generation=*/0, /*foundation=*/"1");
+      RTC_CHECK(port_->CreateConnection(remote, PortInterface::ORIGIN_MESSAGE));
+    }
+  }
+
+  UDPPort* port() { return port_.get(); }
+  const std::vector<rtc::SocketAddress>& addresses() const {
+    return addresses_;
+  }
+
+ private:
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  const std::vector<rtc::SocketAddress> addresses_;
+  std::unique_ptr<UDPPort> port_;
+};
+
+// Packets from all the remote addresses in turn.
+void BM_PortGetConnection(benchmark::State& state) {
+  PortFixture fixture(state.range(0));
+  std::vector<rtc::SocketAddress> order = LookupOrder(fixture.addresses());
+  size_t i = 0;
+  for (auto _ : state) {
+    Connection* conn =
+        fixture.port()->GetConnection(order[i++ % order.size()]);
+    RTC_DCHECK(conn);
+    benchmark::DoNotOptimize(conn);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PortGetConnection)->Arg(10)->Arg(10000);
+
+// Packets from one remote address, as on the selected connection of a port
+// that shares its socket with many others.
+void BM_PortGetConnectionSameAddress(benchmark::State& state) {
+  PortFixture fixture(state.range(0));
+  const rtc::SocketAddress address = fixture.addresses().back();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.port()->GetConnection(address));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PortGetConnectionSameAddress)->Arg(10)->Arg(10000);
+
+}  // namespace
+}  // namespace cricket
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/address_hash_table.h"
+
+#include <map>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "rtc_base/socket_address.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+struct Value {
+  int id;
+};
+
+rtc::SocketAddress Address(uint32_t ip, int port) {
+  return rtc::SocketAddress(rtc::IPAddress(ip), port);
+}
+
+TEST(AddressHashTableTest, FindsWhatWasSet) {
+  AddressHashTable<Value> table;
+  Value a{1};
+  Value b{2};
+  EXPECT_EQ(nullptr, table.Find(Address(0x0a000001, 1000)));
+  EXPECT_FALSE(table.Erase(Address(0x0a000001, 1000)));
+
+  table.Set(Address(0x0a000001, 1000), &a);
+  table.Set(Address(0x0a000001, 1001), &b);
+  EXPECT_EQ(2u, table.size());
+  EXPECT_EQ(&a, table.Find(Address(0x0a000001, 1000)));
+  EXPECT_EQ(&b, table.Find(Address(0x0a000001, 1001)));
+  EXPECT_EQ(nullptr, table.Find(Address(0x0a000002, 1000)));
+
+  table.Set(Address(0x0a000001, 1000), &b);
+  EXPECT_EQ(2u, table.size());
+  EXPECT_EQ(&b, table.Find(Address(0x0a000001, 1000)));
+
+  EXPECT_TRUE(table.Erase(Address(0x0a000001, 1000)));
+  EXPECT_FALSE(table.Erase(Address(0x0a000001, 1000)));
+  EXPECT_EQ(nullptr, table.Find(Address(0x0a000001, 1000)));
+  EXPECT_EQ(&b, table.Find(Address(0x0a000001, 1001)));
+  EXPECT_EQ(1u, table.size());
+
+  table.Clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, table.Find(Address(0x0a000001, 1001)));
+}
+
+TEST(AddressHashTableTest, DistinguishesFamiliesAndHostnames) {
+  AddressHashTable<Value> table;
+  Value v4{4};
+  Value v6{6};
+  Value host{0};
+  rtc::IPAddress ipv6;
+  ASSERT_TRUE(rtc::IPFromString("2001:db8::1", &ipv6));
+  table.Set(Address(0x0a000001, 1000), &v4);
+  table.Set(rtc::SocketAddress(ipv6, 1000), &v6);
+  table.Set(rtc::SocketAddress("example.local", 1000), &host);
+  EXPECT_EQ(&v4, table.Find(Address(0x0a000001, 1000)));
+  EXPECT_EQ(&v6, table.Find(rtc::SocketAddress(ipv6, 1000)));
+  EXPECT_EQ(&host, table.Find(rtc::SocketAddress("example.local", 1000)));
+  EXPECT_EQ(nullptr, table.Find(rtc::SocketAddress("other.local", 1000)));
+}
+
+TEST(AddressHashTableTest, EraseValue) {
+  AddressHashTable<Value> table;
+  Value a{1};
+  Value b{2};
+  for (int port = 1000; port < 1100; ++port) {
+    table.Set(Address(0x0a000001, port), port % 2 ? &a : &b);
+  }
+  table.EraseValue(&a);
+  EXPECT_EQ(50u, table.size());
+  for (int port = 1000; port < 1100; ++port) {
+    EXPECT_EQ(port % 2 ? nullptr : &b, table.Find(Address(0x0a000001, port)));
+  }
+}
+
+// Compares the table with a std::map through random operations, on few
+// enough addresses that they often share probe sequences, so that erasing
+// moves the entries after the erased ones.
+TEST(AddressHashTableTest, MatchesMapThroughRandomOperations) {
+  AddressHashTable<Value> table;
+  std::map<rtc::SocketAddress, Value*> map;
+  std::vector<Value> values(16);
+  webrtc::Random random(1234);
+  for (int i = 0; i < 100000; ++i) {
+    rtc::SocketAddress address =
+        Address(0x0a000000 + random.Rand(15), random.Rand(1000, 1015));
+    switch (random.Rand(2)) {
+      case 0: {
+        Value* value = &values[random.Rand(15)];
+        table.Set(address, value);
+        map[address] = value;
+        break;
+      }
+      case 1:
+        EXPECT_EQ(map.erase(address) == 1, table.Erase(address));
+        break;
+      case 2: {
+        auto it = map.find(address);
+        EXPECT_EQ(it == map.end() ? nullptr : it->second,
+                  table.Find(address));
+        break;
+      }
+    }
+    ASSERT_EQ(map.size(), table.size());
+  }
+  for (const auto& kv : map) {
+    EXPECT_EQ(kv.second, table.Find(kv.first));
+  }
+}
+
+}  // namespace
+}  // namespace cricket
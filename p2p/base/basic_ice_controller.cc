@@ -10,6 +10,9 @@
 
 #include "p2p/base/basic_ice_controller.h"
 
+#include <functional>
+#include <iterator>
+
 namespace {
 
 // The minimum improvement in RTT that justifies a switch.
@@ -76,13 +79,17 @@ void BasicIceController::SetSelectedConnection(
 
 void BasicIceController::AddConnection(const Connection* connection) {
   connections_.push_back(connection);
+  connection_ranks_.push_back(absl::nullopt);
   unpinged_connections_.insert(connection);
 }
 
 void BasicIceController::OnConnectionDestroyed(const Connection* connection) {
   pinged_connections_.erase(connection);
   unpinged_connections_.erase(connection);
-  connections_.erase(absl::c_find(connections_, connection));
+  auto it = absl::c_find(connections_, connection);
+  connection_ranks_.erase(connection_ranks_.begin() +
+                          (it - connections_.begin()));
+  connections_.erase(it);
 }
 
 bool BasicIceController::HasPingableConnection() const {
@@ -94,6 +101,12 @@ bool BasicIceController::HasPingableConnection() const {
 
 IceControllerInterface::PingResult BasicIceController::SelectConnectionToPing(
     int64_t last_ping_sent_ms) {
+  // An ICE-lite agent doesn't ping, but is still asked again once in a while so
+  // that the states of its connections are updated.
+  if (config_.ice_lite) {
+    return PingResult(nullptr, check_receiving_interval());
+  }
+
   // When the selected connection is not receiving or not writable, or any
   // active connection has not been pinged enough times, use the weak ping
   // interval.
@@ -183,22 +196,35 @@ const Connection* BasicIceController::FindNextPingableConnection() {
   }
 
   // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<const Connection*> pingable_connections;
-  absl::c_copy_if(
-      unpinged_connections_, std::back_inserter(pingable_connections),
-      [this, now](const Connection* conn) { return IsPingable(conn, now); });
+  // Their positions in |connections_| are taken along, so that breaking a tie
+  // doesn't need a search. They are still visited in the order of
+  // |unpinged_connections_|, since "more pingable" isn't transitive when the
+  // most likely candidate pairs are prioritized.
+  std::vector<std::pair<const Connection*, size_t>> pingable_connections;
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    const Connection* conn = connections_[i];
+    if (unpinged_connections_.count(conn) && IsPingable(conn, now)) {
+      pingable_connections.emplace_back(conn, i);
+    }
+  }
+  absl::c_sort(pingable_connections,
+               [](const std::pair<const Connection*, size_t>& a,
+                  const std::pair<const Connection*, size_t>& b) {
+                 return std::less<const Connection*>()(a.first, b.first);
+               });
   auto iter = absl::c_max_element(
       pingable_connections,
-      [this](const Connection* conn1, const Connection* conn2) {
+      [this](const std::pair<const Connection*, size_t>& a,
+             const std::pair<const Connection*, size_t>& b) {
         // Some implementations of max_element
         // compare an element with itself.
-        if (conn1 == conn2) {
+        if (a.first == b.first) {
           return false;
         }
-        return MorePingable(conn1, conn2) == conn2;
+        return MorePingable(a.first, a.second, b.first, b.second) == b.first;
       });
   if (iter != pingable_connections.end()) {
-    return *iter;
+    return iter->first;
   }
   return nullptr;
 }
@@ -323,7 +349,9 @@ bool BasicIceController::IsBackupConnection(const Connection* conn) const {
 }
 
 const Connection* BasicIceController::MorePingable(const Connection* conn1,
-                                                   const Connection* conn2) {
+                                                   size_t position1,
+                                                   const Connection* conn2,
+                                                   size_t position2) {
   RTC_DCHECK(conn1 != conn2);
   if (config_.prioritize_most_likely_candidate_pairs) {
     const Connection* most_likely_to_work_conn = MostLikelyToWork(conn1, conn2);
@@ -340,11 +368,9 @@ const Connection* BasicIceController::MorePingable(const Connection* conn1,
 
   // During the initial state when nothing has been pinged yet, return the first
   // one in the ordered |connections_|.
-  auto connections = connections_;
-  return *(std::find_if(connections.begin(), connections.end(),
-                        [conn1, conn2](const Connection* conn) {
-                          return conn == conn1 || conn == conn2;
-                        }));
+  RTC_DCHECK_EQ(connections_[position1], conn1);
+  RTC_DCHECK_EQ(connections_[position2], conn2);
+  return position1 < position2 ? conn1 : conn2;
 }
 
 const Connection* BasicIceController::MostLikelyToWork(
@@ -528,7 +554,8 @@ BasicIceController::SortAndSwitchConnection(IceControllerEvent reason) {
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
   // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  absl::c_stable_sort(
+  RankConnections();
+  RTC_DCHECK(absl::c_is_sorted(
       connections_, [this](const Connection* a, const Connection* b) {
         int cmp = CompareConnections(a, b, absl::nullopt, nullptr);
         if (cmp != 0) {
@@ -536,12 +563,15 @@ BasicIceController::SortAndSwitchConnection(IceControllerEvent reason) {
         }
         // Otherwise, sort based on latency estimate.
         return a->rtt() < b->rtt();
-      });
-
-  RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
-                      << " available connections";
-  for (size_t i = 0; i < connections_.size(); ++i) {
-    RTC_LOG(LS_VERBOSE) << connections_[i]->ToString();
+      }));
+
+  // Describing every connection is costly, so skip it unless it is logged.
+  if (RTC_LOG_CHECK_LEVEL(LS_VERBOSE)) {
+    RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
+                        << " available connections";
+    for (size_t i = 0; i < connections_.size(); ++i) {
+      RTC_LOG(LS_VERBOSE) << connections_[i]->ToString();
+    }
   }
 
   const Connection* top_connection =
@@ -550,6 +580,132 @@ BasicIceController::SortAndSwitchConnection(IceControllerEvent reason) {
   return ShouldSwitchConnection(reason, top_connection);
 }
 
+bool BasicIceController::ConnectionRank::operator==(
+    const ConnectionRank& other) const {
+  return writable == other.writable && write_state == other.write_state &&
+         receiving == other.receiving && connected == other.connected &&
+         remote_nomination == other.remote_nomination &&
+         last_data_received == other.last_data_received &&
+         uses_preferred_network == other.uses_preferred_network &&
+         network_cost == other.network_cost && priority == other.priority &&
+         generation == other.generation && pruned == other.pruned &&
+         rtt == other.rtt;
+}
+
+BasicIceController::ConnectionRank BasicIceController::GetConnectionRank(
+    const Connection* conn,
+    bool controlled) const {
+  ConnectionRank rank;
+  rank.writable = conn->writable() || PresumedWritable(conn);
+  rank.write_state = conn->write_state();
+  rank.receiving = conn->receiving();
+  rank.connected = conn->connected();
+  if (controlled) {
+    rank.remote_nomination = conn->remote_nomination();
+    rank.last_data_received = conn->last_data_received();
+  }
+  rank.uses_preferred_network =
+      LocalCandidateUsesPreferredNetwork(conn, config_.network_preference);
+  rank.network_cost = conn->ComputeNetworkCost();
+  rank.priority = conn->priority();
+  rank.generation = conn->remote_candidate().generation() + conn->generation();
+  rank.pruned = is_connection_pruned_func_(conn);
+  rank.rtt = conn->rtt();
+  return rank;
+}
+
+// Mirrors CompareConnections() without a receiving threshold.
+int BasicIceController::CompareConnectionRanks(const ConnectionRank& a,
+                                               const ConnectionRank& b) {
+  if (a.writable != b.writable) {
+    return a.writable ? a_is_better : b_is_better;
+  }
+  if (a.write_state != b.write_state) {
+    return a.write_state < b.write_state ? a_is_better : b_is_better;
+  }
+  if (a.receiving != b.receiving) {
+    return a.receiving ? a_is_better : b_is_better;
+  }
+  if (a.write_state == Connection::STATE_WRITABLE &&
+      a.connected != b.connected) {
+    return a.connected ? a_is_better : b_is_better;
+  }
+  if (a.remote_nomination != b.remote_nomination) {
+    return a.remote_nomination > b.remote_nomination ? a_is_better
+                                                     : b_is_better;
+  }
+  if (a.last_data_received != b.last_data_received) {
+    return a.last_data_received > b.last_data_received ? a_is_better
+                                                       : b_is_better;
+  }
+  if (a.uses_preferred_network != b.uses_preferred_network) {
+    return a.uses_preferred_network ? a_is_better : b_is_better;
+  }
+  if (a.network_cost != b.network_cost) {
+    return a.network_cost < b.network_cost ? a_is_better : b_is_better;
+  }
+  if (a.priority != b.priority) {
+    return a.priority > b.priority ? a_is_better : b_is_better;
+  }
+  int cmp = a.generation - b.generation;
+  if (cmp != 0) {
+    return cmp;
+  }
+  if (a.pruned != b.pruned) {
+    return !a.pruned ? a_is_better : b_is_better;
+  }
+  return a_and_b_equal;
+}
+
+void BasicIceController::RankConnections() {
+  bool controlled = ice_role_func_() == ICEROLE_CONTROLLED;
+  std::vector<ConnectionRank> ranks;
+  ranks.reserve(connections_.size());
+  for (const Connection* conn : connections_) {
+    ranks.push_back(GetConnectionRank(conn, controlled));
+  }
+
+  // Connections are referred to by their position before sorting, which also
+  // breaks ties the way a stable sort does.
+  auto before = [&ranks](size_t a, size_t b) {
+    int cmp = CompareConnectionRanks(ranks[a], ranks[b]);
+    if (cmp != 0) {
+      return cmp > 0;
+    }
+    return ranks[a].rtt < ranks[b].rtt;
+  };
+
+  // The connections that kept their rank are still sorted, so only the others
+  // need sorting before both are merged.
+  std::vector<size_t> unchanged;
+  std::vector<size_t> changed;
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    if (connection_ranks_[i] == ranks[i]) {
+      unchanged.push_back(i);
+    } else {
+      changed.push_back(i);
+    }
+  }
+  if (changed.empty()) {
+    return;
+  }
+  absl::c_stable_sort(changed, before);
+  std::vector<size_t> order;
+  order.reserve(connections_.size());
+  std::merge(unchanged.begin(), unchanged.end(), changed.begin(), changed.end(),
+             std::back_inserter(order), [&before](size_t a, size_t b) {
+               return before(a, b) || (!before(b, a) && a < b);
+             });
+
+  std::vector<const Connection*> connections;
+  connections.reserve(order.size());
+  for (size_t i : order) {
+    connection_ranks_[connections.size()] = ranks[i];
+    connections.push_back(connections_[i]);
+  }
+  connections_.swap(connections);
+}
+
 bool BasicIceController::ReadyToSend(const Connection* connection) const {
   // Note that we allow sending on an unreliable connection, because it's
   // possible that it became unreliable simply due to bad chance.
@@ -561,8 +717,15 @@ bool BasicIceController::ReadyToSend(const Connection* connection) const {
 }
 
 bool BasicIceController::PresumedWritable(const Connection* conn) const {
-  return (conn->write_state() == Connection::STATE_WRITE_INIT &&
-          config_.presume_writable_when_fully_relayed &&
+  if (conn->write_state() != Connection::STATE_WRITE_INIT) {
+    return false;
+  }
+  // An ICE-lite agent never checks a candidate pair, but knows it works once
+  // the full agent checked it.
+  if (config_.ice_lite) {
+    return conn->last_ping_received() > 0;
+  }
+  return (config_.presume_writable_when_fully_relayed &&
           conn->local_candidate().type() == RELAY_PORT_TYPE &&
           (conn->remote_candidate().type() == RELAY_PORT_TYPE ||
            conn->remote_candidate().type() == PRFLX_PORT_TYPE));
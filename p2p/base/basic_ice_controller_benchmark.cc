@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/basic_ice_controller.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/p2p_transport_channel_ice_field_trials.h"
+#include "p2p/base/stun_port.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/network.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kLocalAddress("192.168.1.2", 0);
+
+// A BasicIceController with |num_connections| connections from one UDP port
+// to as many remote host candidates, as P2PTransportChannel would hand it.
+class IceControllerFixture {
+ public:
+  explicit IceControllerFixture(int num_connections)
+      : thread_(&socket_server_),
+        socket_factory_(&thread_),
+        network_("unittest", "unittest", kLocalAddress.ipaddr(), 32) {
+    network_.AddIP(kLocalAddress.ipaddr());
+    port_ = UDPPort::Create(&thread_, &socket_factory_, &network_, 0, 0,
+                            "lfrag", "lpass", std::string(), false,
+                            absl::nullopt);
+    RTC_CHECK(port_);
+    port_->SetIceRole(ICEROLE_CONTROLLING);
+    port_->PrepareAddress();
+    RTC_CHECK(!port_->Candidates().empty());
+
+    IceControllerFactoryArgs args{
+        [] { return IceTransportState::STATE_CONNECTING; },
+        [] { return ICEROLE_CONTROLLING; },
+        [](const Connection*) { return false; }, &field_trials_};
+    controller_ = std::make_unique<BasicIceController>(args);
+    controller_->SetIceConfig(IceConfig());
+
+    for (int i = 0; i < num_connections; ++i) {
+      Candidate remote(ICE_CANDIDATE_COMPONENT_DEFAULT, UDP_PROTOCOL_NAME,
+                       rtc::SocketAddress("10.0.0.1", 10000 + i),
+                       // Every fourth candidate has the same priority.
+                       1000 + i / 4, "rfrag", "rpass", LOCAL_PORT_TYPE,
+                       /*generation=*/0, /*foundation=*/"1");
+      Connection* conn =
+          port_->CreateConnection(remote, PortInterface::ORIGIN_MESSAGE);
+      RTC_CHECK(conn);
+      connections_.push_back(conn);
+      controller_->AddConnection(conn);
+    }
+    controller_->SortAndSwitchConnection(
+        IceControllerEvent::NEW_CONNECTION_FROM_LOCAL_CANDIDATE);
+  }
+
+  BasicIceController* controller() { return controller_.get(); }
+  const std::vector<Connection*>& connections() const { return connections_; }
+
+ private:
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  IceFieldTrials field_trials_;
+  std::unique_ptr<UDPPort> port_;
+  std::unique_ptr<BasicIceController> controller_;
+  std::vector<Connection*> connections_;
+};
+
+// A ping response changes the RTT and states of one connection, after which
+// P2PTransportChannel sorts the connections again.
+void BM_SortAfterPingResponse(benchmark::State& state) {
+  IceControllerFixture fixture(state.range(0));
+  const std::vector<Connection*>& connections = fixture.connections();
+  size_t i = 0;
+  for (auto _ : state) {
+    Connection* conn = connections[i % connections.size()];
+    conn->ReceivedPingResponse(10 + static_cast<int>(i % 97), "id");
+    benchmark::DoNotOptimize(fixture.controller()->SortAndSwitchConnection(
+        IceControllerEvent::CONNECT_STATE_CHANGE));
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SortAfterPingResponse)->Arg(50)->Arg(500);
+
+// Picks connections to ping while none has been pinged yet, which is when
+// ties between connections are broken by their order.
+void BM_SelectConnectionToPing(benchmark::State& state) {
+  IceControllerFixture fixture(state.range(0));
+  for (auto _ : state) {
+    IceControllerInterface::PingResult result =
+        fixture.controller()->SelectConnectionToPing(0);
+    RTC_CHECK(result.connection.value_or(nullptr));
+    fixture.controller()->MarkConnectionPinged(*result.connection);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SelectConnectionToPing)->Arg(50)->Arg(500);
+
+}  // namespace
+}  // namespace cricket
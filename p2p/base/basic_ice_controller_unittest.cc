@@ -0,0 +1,197 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/basic_ice_controller.h"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/units/time_delta.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/p2p_transport_channel_ice_field_trials.h"
+#include "p2p/base/stun_port.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/network.h"
+#include "rtc_base/random.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kLocalAddress("192.168.1.2", 0);
+
+// A connection with a priority set by the test, as if its candidates had been
+// replaced by ones of another type.
+class TestConnection : public ProxyConnection {
+ public:
+  TestConnection(Port* port, const Candidate& remote_candidate)
+      : ProxyConnection(port, 0, remote_candidate) {}
+
+  uint64_t priority() const override { return priority_; }
+  void set_priority(uint64_t priority) { priority_ = priority; }
+
+ private:
+  uint64_t priority_ = 0;
+};
+
+class BasicIceControllerTest : public ::testing::Test {
+ protected:
+  BasicIceControllerTest()
+      : thread_(&socket_server_),
+        socket_factory_(&thread_),
+        network_("unittest", "unittest", kLocalAddress.ipaddr(), 32) {
+    network_.AddIP(kLocalAddress.ipaddr());
+    port_ = UDPPort::Create(&thread_, &socket_factory_, &network_, 0, 0,
+                            "lfrag", "lpass", std::string(), false,
+                            absl::nullopt);
+    port_->SetIceRole(ICEROLE_CONTROLLING);
+    port_->PrepareAddress();
+    // The connections of the test are not known to the port, which would
+    // otherwise destroy itself for having none.
+    port_->KeepAliveUntilPruned();
+
+    IceControllerFactoryArgs args{
+        [] { return IceTransportState::STATE_CONNECTING; },
+        [] { return ICEROLE_CONTROLLING; },
+        [this](const Connection* conn) { return pruned_.count(conn) > 0; },
+        &field_trials_};
+    controller_ = std::make_unique<BasicIceController>(args);
+    controller_->SetIceConfig(IceConfig());
+  }
+
+  TestConnection* AddConnection(int index) {
+    Candidate remote(ICE_CANDIDATE_COMPONENT_DEFAULT, UDP_PROTOCOL_NAME,
+                     rtc::SocketAddress("10.0.0.1", 10000 + index), 1000,
+                     "rfrag", "rpass", LOCAL_PORT_TYPE, /*generation=*/0,
+                     /*foundation=*/"1");
+    connections_.push_back(
+        std::make_unique<TestConnection>(port_.get(), remote));
+    controller_->AddConnection(connections_.back().get());
+    return connections_.back().get();
+  }
+
+  // The order that sorting all of |connections| with CompareConnections()
+  // and the RTT gives, for the connections of this test. They differ only in
+  // their states, priority, pruning and RTT.
+  std::vector<const Connection*> FullSort(
+      std::vector<const Connection*> connections) const {
+    std::stable_sort(
+        connections.begin(), connections.end(),
+        [this](const Connection* a, const Connection* b) {
+          if (a->write_state() != b->write_state())
+            return a->write_state() < b->write_state();
+          if (a->receiving() != b->receiving())
+            return a->receiving();
+          if (a->writable() && a->connected() != b->connected())
+            return a->connected();
+          if (a->priority() != b->priority())
+            return a->priority() > b->priority();
+          bool a_pruned = pruned_.count(a) > 0;
+          bool b_pruned = pruned_.count(b) > 0;
+          if (a_pruned != b_pruned)
+            return !a_pruned;
+          return a->rtt() < b->rtt();
+        });
+    return connections;
+  }
+
+  rtc::ScopedFakeClock clock_;
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  IceFieldTrials field_trials_;
+  std::unique_ptr<UDPPort> port_;
+  std::set<const Connection*> pruned_;
+  std::unique_ptr<BasicIceController> controller_;
+  std::vector<std::unique_ptr<TestConnection>> connections_;
+};
+
+// RankConnections() only re-sorts the connections whose rank changed and
+// merges them back. Compare the order that this keeps with sorting all
+// connections again, with the ties that a stable sort of the previous order
+// gives, while priorities, write states, receiving, pruning and RTTs change.
+TEST_F(BasicIceControllerTest, IncrementalRankingMatchesFullSort) {
+  constexpr int kNumConnections = 12;
+  constexpr int kNumSteps = 3000;
+  webrtc::Random random(0x1ce);
+  for (int i = 0; i < kNumConnections; ++i) {
+    // Few distinct priorities, so that there are many ties.
+    AddConnection(i)->set_priority(random.Rand(1, 4));
+  }
+  controller_->SortAndSwitchConnection(
+      IceControllerEvent::NEW_CONNECTION_FROM_LOCAL_CANDIDATE);
+  std::vector<const Connection*> expected;
+  for (const auto& conn : connections_)
+    expected.push_back(conn.get());
+  expected = FullSort(expected);
+  ASSERT_EQ(expected, std::vector<const Connection*>(
+                          controller_->connections().begin(),
+                          controller_->connections().end()));
+
+  for (int step = 0; step < kNumSteps; ++step) {
+    clock_.AdvanceTime(webrtc::TimeDelta::Millis(random.Rand(0, 800)));
+    int64_t now = rtc::TimeMillis();
+    // Change one to a few connections before sorting again.
+    int num_changes = random.Rand(1, 3);
+    for (int i = 0; i < num_changes; ++i) {
+      TestConnection* conn =
+          connections_[random.Rand(0, kNumConnections - 1)].get();
+      switch (random.Rand(0, 7)) {
+        case 0:
+          conn->set_priority(random.Rand(1, 4));
+          break;
+        case 1:
+          // Becomes writable and receiving, and changes its RTT.
+          conn->ReceivedPingResponse(random.Rand(1, 5) * 100, "id");
+          break;
+        case 2:
+        case 3:
+        case 4:
+          // Pinged more often than anything else, so that connections run
+          // into the unwritable and write timeouts.
+          conn->Ping(now);
+          break;
+        case 5:
+        case 6:
+          // Loses writability or receiving once enough pings went unanswered
+          // or nothing was received for long enough. Only connections that
+          // received something recently enough not to be destroyed by it.
+          if (conn->last_received() > 0 &&
+              now <= conn->last_received() + DEAD_CONNECTION_RECEIVE_TIMEOUT) {
+            conn->UpdateState(now);
+          }
+          break;
+        case 7:
+          if (!pruned_.erase(conn))
+            pruned_.insert(conn);
+          break;
+      }
+    }
+
+    controller_->SortAndSwitchConnection(
+        IceControllerEvent::CONNECT_STATE_CHANGE);
+    expected = FullSort(expected);
+    ASSERT_EQ(expected, std::vector<const Connection*>(
+                            controller_->connections().begin(),
+                            controller_->connections().end()))
+        << "step " << step;
+  }
+}
+
+}  // namespace
+}  // namespace cricket
@@ -18,6 +18,7 @@
 #include "rtc_base/async_tcp_socket.h"
 #include "rtc_base/async_udp_socket.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/net_helpers.h"
 #include "rtc_base/socket.h"
@@ -25,8 +26,28 @@
 #include "rtc_base/socket_server.h"
 #include "rtc_base/ssl_adapter.h"
 #include "rtc_base/thread.h"
+#include "system_wrappers/include/field_trial.h"
 
 namespace rtc {
+namespace {
+
+constexpr int kMaxUdpReceiveBatchSize = 64;
+
+// Number of datagrams a UDP socket reads per read event, configured with e.g.
+// "WebRTC-UdpReceiveBatching/size:16/". 1, the default, reads one datagram
+// per read event.
+size_t GetUdpReceiveBatchSize() {
+  webrtc::FieldTrialParameter<int> size("size", 1);
+  webrtc::ParseFieldTrial(
+      {&size}, webrtc::field_trial::FindFullName("WebRTC-UdpReceiveBatching"));
+  if (size.Get() < 1 || size.Get() > kMaxUdpReceiveBatchSize) {
+    RTC_LOG(LS_WARNING) << "Ignoring UDP receive batch size " << size.Get();
+    return 1;
+  }
+  return size.Get();
+}
+
+}  // namespace
 
 BasicPacketSocketFactory::BasicPacketSocketFactory()
     : thread_(Thread::Current()), socket_factory_(NULL) {}
@@ -55,7 +76,12 @@ AsyncPacketSocket* BasicPacketSocketFactory::CreateUdpSocket(
     delete socket;
     return NULL;
   }
-  return new AsyncUDPSocket(socket);
+  AsyncUDPSocket* udp_socket = new AsyncUDPSocket(socket);
+  const size_t receive_batch_size = GetUdpReceiveBatchSize();
+  if (receive_batch_size > 1) {
+    udp_socket->SetReceiveBatchSize(receive_batch_size);
+  }
+  return udp_socket;
 }
 
 AsyncPacketSocket* BasicPacketSocketFactory::CreateServerTcpSocket(
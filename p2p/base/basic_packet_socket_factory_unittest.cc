@@ -0,0 +1,66 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/basic_packet_socket_factory.h"
+
+#include <memory>
+
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/field_trial.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+std::unique_ptr<AsyncUDPSocket> CreateUdpSocket(
+    BasicPacketSocketFactory* factory) {
+  return std::unique_ptr<AsyncUDPSocket>(static_cast<AsyncUDPSocket*>(
+      factory->CreateUdpSocket(SocketAddress("127.0.0.1", 0), 0, 0)));
+}
+
+TEST(BasicPacketSocketFactoryTest, UdpSocketReadsOneDatagramByDefault) {
+  VirtualSocketServer socket_server;
+  AutoSocketServerThread thread(&socket_server);
+  BasicPacketSocketFactory factory(&socket_server);
+
+  std::unique_ptr<AsyncUDPSocket> socket = CreateUdpSocket(&factory);
+  ASSERT_TRUE(socket);
+  EXPECT_EQ(socket->receive_batch_size(), 0u);
+}
+
+TEST(BasicPacketSocketFactoryTest, UdpSocketReadsBatchSizeFromFieldTrial) {
+  webrtc::test::ScopedFieldTrials field_trials(
+      "WebRTC-UdpReceiveBatching/size:16/");
+  VirtualSocketServer socket_server;
+  AutoSocketServerThread thread(&socket_server);
+  BasicPacketSocketFactory factory(&socket_server);
+
+  std::unique_ptr<AsyncUDPSocket> socket = CreateUdpSocket(&factory);
+  ASSERT_TRUE(socket);
+  EXPECT_EQ(socket->receive_batch_size(), 16u);
+}
+
+TEST(BasicPacketSocketFactoryTest, UdpSocketIgnoresInvalidBatchSize) {
+  webrtc::test::ScopedFieldTrials field_trials(
+      "WebRTC-UdpReceiveBatching/size:1000/");
+  VirtualSocketServer socket_server;
+  AutoSocketServerThread thread(&socket_server);
+  BasicPacketSocketFactory factory(&socket_server);
+
+  std::unique_ptr<AsyncUDPSocket> socket = CreateUdpSocket(&factory);
+  ASSERT_TRUE(socket);
+  EXPECT_EQ(socket->receive_batch_size(), 0u);
+}
+
+}  // namespace
+}  // namespace rtc
@@ -17,7 +17,6 @@
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
 #include "absl/strings/match.h"
 #include "p2p/base/port_allocator.h"
 #include "rtc_base/checks.h"
@@ -39,7 +38,7 @@ namespace {
 // Determines whether we have seen at least the given maximum number of
 // pings fail to have a response.
 inline bool TooManyFailures(
-    const std::vector<cricket::Connection::SentPing>& pings_since_last_response,
+    const cricket::PingHistory& pings_since_last_response,
     uint32_t maximum_failures,
     int rtt_estimate,
     int64_t now) {
@@ -50,20 +49,19 @@ inline bool TooManyFailures(
   // Check if the window in which we would expect a response to the ping has
   // already elapsed.
   int64_t expected_response_time =
-      pings_since_last_response[maximum_failures - 1].sent_time + rtt_estimate;
+      pings_since_last_response.sent_time(maximum_failures - 1) + rtt_estimate;
   return now > expected_response_time;
 }
 
 // Determines whether we have gone too long without seeing any response.
 inline bool TooLongWithoutResponse(
-    const std::vector<cricket::Connection::SentPing>& pings_since_last_response,
+    const cricket::PingHistory& pings_since_last_response,
     int64_t maximum_time,
     int64_t now) {
-  if (pings_since_last_response.size() == 0)
+  if (pings_since_last_response.empty())
     return false;
 
-  auto first = pings_since_last_response[0];
-  return now > (first.sent_time + maximum_time);
+  return now > (pings_since_last_response.first_sent_time() + maximum_time);
 }
 
 // Helper methods for converting string values of log description fields to
@@ -294,7 +292,6 @@ Connection::Connection(Port* port,
       pruned_(false),
       use_candidate_attr_(false),
       remote_ice_mode_(ICEMODE_FULL),
-      requests_(port->thread()),
       rtt_(DEFAULT_RTT),
       last_ping_sent_(0),
       last_ping_received_(0),
@@ -307,8 +304,6 @@ Connection::Connection(Port* port,
       rtt_estimate_(DEFAULT_RTT_ESTIMATE_HALF_TIME_MS) {
   // All of our connections start in WAITING state.
   // TODO(mallinath) - Start connections from STATE_FROZEN.
-  // Wire up to send stun packets
-  requests_.SignalSendPacket.connect(this, &Connection::OnSendStunPacket);
   RTC_LOG(LS_INFO) << ToString() << ": Connection created";
 }
 
@@ -504,9 +499,10 @@ void Connection::OnReadPacket(const char* data,
       // id's match.
       case STUN_BINDING_RESPONSE:
       case STUN_BINDING_ERROR_RESPONSE:
-        if (msg->ValidateMessageIntegrity(data, size,
+        if (requests_ &&
+            msg->ValidateMessageIntegrity(data, size,
                                           remote_candidate().password())) {
-          requests_.CheckResponse(msg.get());
+          requests_->CheckResponse(msg.get());
         }
         // Otherwise silently discard the response message.
         break;
@@ -522,9 +518,10 @@ void Connection::OnReadPacket(const char* data,
         break;
       case GOOG_PING_RESPONSE:
       case GOOG_PING_ERROR_RESPONSE:
-        if (msg->ValidateMessageIntegrity32(data, size,
+        if (requests_ &&
+            msg->ValidateMessageIntegrity32(data, size,
                                             remote_candidate().password())) {
-          requests_.CheckResponse(msg.get());
+          requests_->CheckResponse(msg.get());
         }
         break;
       default:
@@ -683,7 +680,9 @@ void Connection::SendStunBindingResponse(const StunMessage* request) {
     }
   }
 
-  response.AddMessageIntegrity(local_candidate().password());
+  // The local candidate has the port's password, which the port keeps as an
+  // HMAC key.
+  response.AddMessageIntegrity(port_->password_key());
   response.AddFingerprint();
 
   SendResponseMessage(response);
@@ -696,7 +695,7 @@ void Connection::SendGoogPingResponse(const StunMessage* request) {
   StunMessage response;
   response.SetType(GOOG_PING_RESPONSE);
   response.SetTransactionID(request->transaction_id());
-  response.AddMessageIntegrity32(local_candidate().password());
+  response.AddMessageIntegrity32(port_->password_key());
   SendResponseMessage(response);
 }
 
@@ -739,7 +738,9 @@ void Connection::Prune() {
   if (!pruned_ || active()) {
     RTC_LOG(LS_INFO) << ToString() << ": Connection pruned";
     pruned_ = true;
-    requests_.Clear();
+    if (requests_) {
+      requests_->Clear();
+    }
     set_write_state(STATE_WRITE_TIMEOUT);
   }
 }
@@ -767,16 +768,13 @@ void Connection::FailAndPrune() {
 
 void Connection::PrintPingsSinceLastResponse(std::string* s, size_t max) {
   rtc::StringBuilder oss;
-  if (pings_since_last_response_.size() > max) {
-    for (size_t i = 0; i < max; i++) {
-      const SentPing& ping = pings_since_last_response_[i];
-      oss << rtc::hex_encode(ping.id) << " ";
-    }
-    oss << "... " << (pings_since_last_response_.size() - max) << " more";
-  } else {
-    for (const SentPing& ping : pings_since_last_response_) {
-      oss << rtc::hex_encode(ping.id) << " ";
-    }
+  size_t printed = std::min(max, pings_since_last_response_.kept());
+  for (size_t i = 0; i < printed; i++) {
+    absl::string_view id = pings_since_last_response_.kept_ping(i).id();
+    oss << rtc::hex_encode(id.data(), id.size()) << " ";
+  }
+  if (pings_since_last_response_.size() > printed) {
+    oss << "... " << (pings_since_last_response_.size() - printed) << " more";
   }
   *s = oss.str();
 }
@@ -813,7 +811,7 @@ void Connection::UpdateState(int64_t now) {
     uint32_t max_pings = unwritable_min_checks();
     RTC_LOG(LS_INFO) << ToString() << ": Unwritable after " << max_pings
                      << " ping failures and "
-                     << now - pings_since_last_response_[0].sent_time
+                     << now - pings_since_last_response_.first_sent_time()
                      << " ms without a response,"
                         " ms since last received ping="
                      << now - last_ping_received_
@@ -826,7 +824,7 @@ void Connection::UpdateState(int64_t now) {
       TooLongWithoutResponse(pings_since_last_response_, inactive_timeout(),
                              now)) {
     RTC_LOG(LS_INFO) << ToString() << ": Timed out after "
-                     << now - pings_since_last_response_[0].sent_time
+                     << now - pings_since_last_response_.first_sent_time()
                      << " ms without a response, rtt=" << rtt;
     set_write_state(STATE_WRITE_TIMEOUT);
   }
@@ -848,15 +846,24 @@ void Connection::Ping(int64_t now) {
   if (nomination_ > 0) {
     nomination = nomination_;
   }
-  pings_since_last_response_.push_back(SentPing(req->id(), now, nomination));
+  pings_since_last_response_.Add(req->id(), now, nomination);
   RTC_LOG(LS_VERBOSE) << ToString() << ": Sending STUN ping, id="
                       << rtc::hex_encode(req->id())
                       << ", nomination=" << nomination_;
-  requests_.Send(req);
+  requests().Send(req);
   state_ = IceCandidatePairState::IN_PROGRESS;
   num_pings_sent_++;
 }
 
+StunRequestManager& Connection::requests() {
+  if (!requests_) {
+    requests_ = std::make_unique<StunRequestManager>(port_->thread());
+    // Wire up to send stun packets
+    requests_->SignalSendPacket.connect(this, &Connection::OnSendStunPacket);
+  }
+  return *requests_;
+}
+
 void Connection::ReceivedPing(const absl::optional<std::string>& request_id) {
   last_ping_received_ = rtc::TimeMillis();
   last_ping_id_received_ = request_id;
@@ -870,16 +877,14 @@ void Connection::HandlePiggybackCheckAcknowledgementIfAny(StunMessage* msg) {
       msg->GetByteString(STUN_ATTR_LAST_ICE_CHECK_RECEIVED);
   if (last_ice_check_received_attr) {
     const std::string request_id = last_ice_check_received_attr->GetString();
-    auto iter = absl::c_find_if(
-        pings_since_last_response_,
-        [&request_id](const SentPing& ping) { return ping.id == request_id; });
-    if (iter != pings_since_last_response_.end()) {
+    const PingHistory::Ping* ping = pings_since_last_response_.Find(request_id);
+    if (ping) {
       rtc::LoggingSeverity sev = !writable() ? rtc::LS_INFO : rtc::LS_VERBOSE;
       RTC_LOG_V(sev) << ToString()
                      << ": Received piggyback STUN ping response, id="
                      << rtc::hex_encode(request_id);
-      const int64_t rtt = rtc::TimeMillis() - iter->sent_time;
-      ReceivedPingResponse(rtt, request_id, iter->nomination);
+      const int64_t rtt = rtc::TimeMillis() - ping->sent_time;
+      ReceivedPingResponse(rtt, request_id, ping->nomination);
     }
   }
 }
@@ -903,7 +908,7 @@ void Connection::ReceivedPingResponse(
   current_round_trip_time_ms_ = static_cast<uint32_t>(rtt);
   rtt_estimate_.AddSample(now, rtt);
 
-  pings_since_last_response_.clear();
+  pings_since_last_response_.Clear();
   last_ping_response_received_ = now;
   UpdateReceiving(last_ping_response_received_);
   set_write_state(STATE_WRITABLE);
@@ -936,7 +941,7 @@ bool Connection::dead(int64_t now) const {
     if (!pings_since_last_response_.empty()) {
       // Outstanding pings: let it live until the ping is unreplied for
       // DEAD_CONNECTION_RECEIVE_TIMEOUT.
-      return now > (pings_since_last_response_[0].sent_time +
+      return now > (pings_since_last_response_.first_sent_time() +
                     DEAD_CONNECTION_RECEIVE_TIMEOUT);
     }
 
@@ -1088,11 +1093,14 @@ void Connection::OnConnectionRequestResponse(ConnectionRequest* request,
   }
   absl::optional<uint32_t> nomination;
   const std::string request_id = request->id();
-  auto iter = absl::c_find_if(
-      pings_since_last_response_,
-      [&request_id](const SentPing& ping) { return ping.id == request_id; });
-  if (iter != pings_since_last_response_.end()) {
-    nomination.emplace(iter->nomination);
+  const PingHistory::Ping* ping = pings_since_last_response_.Find(request_id);
+  if (ping) {
+    nomination.emplace(ping->nomination);
+  } else if (const StunUInt32Attribute* nomination_attr =
+                 request->msg()->GetUInt32(STUN_ATTR_NOMINATION)) {
+    // Only the most recent pings are kept, but the request still carries the
+    // nomination that it was sent with.
+    nomination.emplace(nomination_attr->value());
   }
   ReceivedPingResponse(rtt, request_id, nomination);
 
@@ -1225,24 +1233,33 @@ int64_t Connection::last_received() const {
 }
 
 ConnectionInfo Connection::stats() {
-  stats_.recv_bytes_second = round(recv_rate_tracker_.ComputeRate());
-  stats_.recv_total_bytes = recv_rate_tracker_.TotalSampleCount();
-  stats_.sent_bytes_second = round(send_rate_tracker_.ComputeRate());
-  stats_.sent_total_bytes = send_rate_tracker_.TotalSampleCount();
-  stats_.receiving = receiving_;
-  stats_.writable = write_state_ == STATE_WRITABLE;
-  stats_.timeout = write_state_ == STATE_WRITE_TIMEOUT;
-  stats_.new_connection = !reported_;
-  stats_.rtt = rtt_;
-  stats_.key = this;
-  stats_.state = state_;
-  stats_.priority = priority();
-  stats_.nominated = nominated();
-  stats_.total_round_trip_time_ms = total_round_trip_time_ms_;
-  stats_.current_round_trip_time_ms = current_round_trip_time_ms_;
-  stats_.local_candidate = local_candidate();
-  stats_.remote_candidate = remote_candidate();
-  return stats_;
+  ConnectionInfo info;
+  info.sent_discarded_packets = stats_.sent_discarded_packets;
+  info.sent_total_packets = stats_.sent_total_packets;
+  info.sent_ping_requests_total = stats_.sent_ping_requests_total;
+  info.sent_ping_requests_before_first_response =
+      stats_.sent_ping_requests_before_first_response;
+  info.sent_ping_responses = stats_.sent_ping_responses;
+  info.recv_ping_requests = stats_.recv_ping_requests;
+  info.recv_ping_responses = stats_.recv_ping_responses;
+  info.recv_bytes_second = round(recv_rate_tracker_.ComputeRate());
+  info.recv_total_bytes = recv_rate_tracker_.TotalSampleCount();
+  info.sent_bytes_second = round(send_rate_tracker_.ComputeRate());
+  info.sent_total_bytes = send_rate_tracker_.TotalSampleCount();
+  info.receiving = receiving_;
+  info.writable = write_state_ == STATE_WRITABLE;
+  info.timeout = write_state_ == STATE_WRITE_TIMEOUT;
+  info.new_connection = !reported_;
+  info.rtt = rtt_;
+  info.key = this;
+  info.state = state_;
+  info.priority = priority();
+  info.nominated = nominated();
+  info.total_round_trip_time_ms = total_round_trip_time_ms_;
+  info.current_round_trip_time_ms = current_round_trip_time_ms_;
+  info.local_candidate = local_candidate();
+  info.remote_candidate = remote_candidate();
+  return info;
 }
 
 void Connection::MaybeUpdateLocalCandidate(ConnectionRequest* request,
@@ -1319,7 +1336,7 @@ bool Connection::missing_responses(int64_t now) const {
     return false;
   }
 
-  int64_t waiting = now - pings_since_last_response_[0].sent_time;
+  int64_t waiting = now - pings_since_last_response_.first_sent_time();
   return waiting > 2 * rtt();
 }
 
@@ -1353,11 +1370,13 @@ bool Connection::ShouldSendGoogPing(const StunMessage* message) {
 
 void Connection::ForgetLearnedState() {
   RTC_LOG(LS_INFO) << ToString() << ": Connection forget learned state";
-  requests_.Clear();
+  if (requests_) {
+    requests_->Clear();
+  }
   receiving_ = false;
   write_state_ = STATE_WRITE_INIT;
   rtt_estimate_.Reset();
-  pings_since_last_response_.clear();
+  pings_since_last_response_.Clear();
 }
 
 ProxyConnection::ProxyConnection(Port* port,
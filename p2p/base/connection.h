@@ -22,6 +22,7 @@
 #include "p2p/base/candidate_pair_interface.h"
 #include "p2p/base/connection_info.h"
 #include "p2p/base/p2p_transport_channel_ice_field_trials.h"
+#include "p2p/base/ping_history.h"
 #include "p2p/base/stun_request.h"
 #include "p2p/base/transport_description.h"
 #include "rtc_base/async_packet_socket.h"
@@ -74,15 +75,6 @@ class Connection : public CandidatePairInterface,
                    public rtc::MessageHandler,
                    public sigslot::has_slots<> {
  public:
-  struct SentPing {
-    SentPing(const std::string id, int64_t sent_time, uint32_t nomination)
-        : id(id), sent_time(sent_time), nomination(nomination) {}
-
-    std::string id;
-    int64_t sent_time;
-    uint32_t nomination;
-  };
-
   ~Connection() override;
 
   // A unique ID assigned when the connection is created.
@@ -375,7 +367,19 @@ class Connection : public CandidatePairInterface,
   size_t local_candidate_index_;
   Candidate remote_candidate_;
 
-  ConnectionInfo stats_;
+  // The counters that stats() reports. The rest of the ConnectionInfo is
+  // filled in when stats() is called, rather than kept, since it has copies
+  // of both candidates.
+  struct Counters {
+    size_t sent_discarded_packets = 0;
+    size_t sent_total_packets = 0;
+    size_t sent_ping_requests_total = 0;
+    size_t sent_ping_requests_before_first_response = 0;
+    size_t sent_ping_responses = 0;
+    size_t recv_ping_requests = 0;
+    size_t recv_ping_responses = 0;
+  };
+  Counters stats_;
   rtc::RateTracker recv_rate_tracker_;
   rtc::RateTracker send_rate_tracker_;
 
@@ -393,6 +397,10 @@ class Connection : public CandidatePairInterface,
   // to last message ack:ed STUN_BINDING_REQUEST.
   bool ShouldSendGoogPing(const StunMessage* message);
 
+  // Creates |requests_| when the first request is sent, since most
+  // connections of a large deployment never send one, or not for a while.
+  StunRequestManager& requests();
+
   WriteState write_state_;
   bool receiving_;
   bool connected_;
@@ -417,7 +425,7 @@ class Connection : public CandidatePairInterface,
   uint32_t remote_nomination_ = 0;
 
   IceMode remote_ice_mode_;
-  StunRequestManager requests_;
+  std::unique_ptr<StunRequestManager> requests_;
   int rtt_;
   int rtt_samples_ = 0;
   // https://w3c.github.io/webrtc-stats/#dom-rtcicecandidatepairstats-totalroundtriptime
@@ -430,7 +438,7 @@ class Connection : public CandidatePairInterface,
   int64_t last_data_received_;
   int64_t last_ping_response_received_;
   int64_t receiving_unchanged_since_ = 0;
-  std::vector<SentPing> pings_since_last_response_;
+  PingHistory pings_since_last_response_;
   // Transaction ID of the last connectivity check received. Null if having not
   // received a ping yet.
   absl::optional<std::string> last_ping_id_received_;
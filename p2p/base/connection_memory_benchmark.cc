@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/stun_port.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/network.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/allocation_counter.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kLocalAddress("192.168.1.2", 0);
+
+enum class ConnectionUse {
+  // Created, but never pinged, as most pairs of a large deployment are until
+  // the ICE controller gets to them.
+  kNew,
+  // Pinged, answered and asked for stats, as the selected pair is.
+  kActive,
+  // Pinged without an answer and then pruned, as the losing pairs end up.
+  kPruned,
+};
+
+// Reports the bytes taken by each of |state.range(1)| connections from one
+// UDP port, after they have been used as given by |state.range(0)|.
+void BM_ConnectionMemory(benchmark::State& state) {
+  const ConnectionUse use = static_cast<ConnectionUse>(state.range(0));
+  const int num_connections = state.range(1);
+  rtc::VirtualSocketServer socket_server;
+  rtc::AutoSocketServerThread thread(&socket_server);
+  rtc::BasicPacketSocketFactory socket_factory(&thread);
+  rtc::Network network("unittest", "unittest", kLocalAddress.ipaddr(), 32);
+  network.AddIP(kLocalAddress.ipaddr());
+  std::unique_ptr<UDPPort> port =
+      UDPPort::Create(&thread, &socket_factory, &network, 0, 0, "lfrag",
+                      "lpass", std::string(), false, absl::nullopt);
+  RTC_CHECK(port);
+  port->SetIceRole(ICEROLE_CONTROLLING);
+  port->PrepareAddress();
+  RTC_CHECK(!port->Candidates().empty());
+
+  int64_t bytes_per_connection = 0;
+  for (auto _ : state) {
+    const int64_t allocated_before = webrtc::test::AllocatedBytes();
+    std::vector<Connection*> connections;
+    for (int i = 0; i < num_connections; ++i) {
+      Candidate remote(ICE_CANDIDATE_COMPONENT_DEFAULT, UDP_PROTOCOL_NAME,
+                       rtc::SocketAddress("10.0.0.1", 10000 + i), 1000,
+                       "rfrag", "rpass", LOCAL_PORT_TYPE, /*generation=*/0,
+                       /*foundation=*/"1");
+      Connection* conn =
+          port->CreateConnection(remote, PortInterface::ORIGIN_MESSAGE);
+      RTC_CHECK(conn);
+      connections.push_back(conn);
+    }
+    int64_t now = rtc::TimeMillis();
+    for (Connection* conn : connections) {
+      switch (use) {
+        case ConnectionUse::kNew:
+          break;
+        case ConnectionUse::kActive:
+          for (int i = 0; i < 3; ++i) {
+            conn->Ping(now);
+          }
+          conn->ReceivedPingResponse(10, "id");
+          conn->Ping(now);
+          benchmark::DoNotOptimize(conn->stats());
+          break;
+        case ConnectionUse::kPruned:
+          for (int i = 0; i < 8; ++i) {
+            conn->Ping(now);
+          }
+          conn->Prune();
+          break;
+      }
+    }
+    bytes_per_connection =
+        (webrtc::test::AllocatedBytes() - allocated_before) / num_connections;
+
+    state.PauseTiming();
+    for (Connection* conn : connections) {
+      conn->Destroy();
+    }
+    thread.ProcessMessages(0);
+    state.ResumeTiming();
+  }
+  state.counters["bytes_per_connection"] =
+      static_cast<double>(bytes_per_connection);
+  state.SetItemsProcessed(state.iterations() * num_connections);
+}
+BENCHMARK(BM_ConnectionMemory)
+    ->Args({static_cast<int>(ConnectionUse::kNew), 1000})
+    ->Args({static_cast<int>(ConnectionUse::kActive), 1000})
+    ->Args({static_cast<int>(ConnectionUse::kPruned), 1000})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace cricket
@@ -141,6 +141,7 @@ class DtlsTransport : public DtlsTransportInternal {
   bool GetOption(rtc::Socket::Option opt, int* value) override;
 
   bool SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version) override;
+  void SetSessionCache(rtc::SSLSessionCache* cache) override;
 
   // Find out which TLS version was negotiated
   bool GetSslVersionBytes(int* version) const override;
@@ -235,6 +236,7 @@ class DtlsTransport : public DtlsTransportInternal {
   rtc::scoped_refptr<rtc::RTCCertificate> local_certificate_;
   absl::optional<rtc::SSLRole> dtls_role_;
   rtc::SSLProtocolVersion ssl_max_version_;
+  rtc::SSLSessionCache* session_cache_ = nullptr;
   webrtc::CryptoOptions crypto_options_;
   rtc::Buffer remote_fingerprint_value_;
   std::string remote_fingerprint_algorithm_;
@@ -109,6 +109,11 @@ class DtlsTransportInternal : public rtc::PacketTransportInternal {
 
   virtual bool SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version) = 0;
 
+  // Resume DTLS sessions from, and store new sessions in, |cache|, which must
+  // outlive the transport. Must be called before the handshake starts.
+  // Transports that can't resume sessions ignore the cache.
+  virtual void SetSessionCache(rtc::SSLSessionCache* cache) {}
+
   // Expose the underneath IceTransport.
   virtual IceTransportInternal* ice_transport() = 0;
 
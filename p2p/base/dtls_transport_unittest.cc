@@ -74,8 +74,14 @@ class DtlsTestClient : public sigslot::has_slots<> {
   void SetupMaxProtocolVersion(rtc::SSLProtocolVersion version) {
     ssl_max_version_ = version;
   }
+  void SetupSessionCache(rtc::SSLSessionCache* session_cache) {
+    session_cache_ = session_cache;
+  }
   // Set up fake ICE transport and real DTLS transport under test.
   void SetupTransports(IceRole role, int async_delay_ms = 0) {
+    // The DTLS transport of an earlier setup uses the ICE transport until it
+    // is destroyed.
+    dtls_transport_.reset();
     fake_ice_transport_.reset(new FakeIceTransport("fake", 0));
     fake_ice_transport_->SetAsync(true);
     fake_ice_transport_->SetAsyncDelay(async_delay_ms);
@@ -90,6 +96,7 @@ class DtlsTestClient : public sigslot::has_slots<> {
                                                       webrtc::CryptoOptions(),
                                                       /*event_log=*/nullptr);
     dtls_transport_->SetSslMaxProtocolVersion(ssl_max_version_);
+    dtls_transport_->SetSessionCache(session_cache_);
     // Note: Certificate may be null here if testing passthrough.
     dtls_transport_->SetLocalCertificate(certificate_);
     dtls_transport_->SignalWritableState.connect(
@@ -121,6 +128,10 @@ class DtlsTestClient : public sigslot::has_slots<> {
     return received_dtls_server_hellos_;
   }
 
+  int received_dtls_certificates() const {
+    return received_dtls_certificates_;
+  }
+
   void CheckRole(rtc::SSLRole role) {
     if (role == rtc::SSL_CLIENT) {
       ASSERT_EQ(0, received_dtls_client_hellos_);
@@ -271,6 +282,7 @@ class DtlsTestClient : public sigslot::has_slots<> {
       } else if (data[13] == 2) {
         ++received_dtls_server_hellos_;
       }
+      CountCertificates(data, size);
     } else if (dtls_transport_->IsDtlsActive() &&
                !(data[0] >= 20 && data[0] <= 22)) {
       ASSERT_TRUE(data[0] == 23 || IsRtpLeadByte(data[0]));
@@ -282,6 +294,20 @@ class DtlsTestClient : public sigslot::has_slots<> {
     }
   }
 
+  // Counts the Certificate messages in the handshake records of a packet.
+  void CountCertificates(const char* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    const size_t kRecordHeaderSize = 13;
+    size_t offset = 0;
+    while (offset + kRecordHeaderSize < size) {
+      if (bytes[offset] == 22 && bytes[offset + kRecordHeaderSize] == 11) {
+        ++received_dtls_certificates_;
+      }
+      offset += kRecordHeaderSize +
+                ((bytes[offset + 11] << 8) | bytes[offset + 12]);
+    }
+  }
+
  private:
   std::string name_;
   rtc::scoped_refptr<rtc::RTCCertificate> certificate_;
@@ -290,8 +316,10 @@ class DtlsTestClient : public sigslot::has_slots<> {
   size_t packet_size_ = 0u;
   std::set<int> received_;
   rtc::SSLProtocolVersion ssl_max_version_ = rtc::SSL_PROTOCOL_DTLS_12;
+  rtc::SSLSessionCache* session_cache_ = nullptr;
   int received_dtls_client_hellos_ = 0;
   int received_dtls_server_hellos_ = 0;
+  int received_dtls_certificates_ = 0;
   rtc::SentPacket sent_packet_;
 };
 
@@ -549,6 +577,31 @@ TEST_F(DtlsTransportTest, TestCertificatesAfterConnect) {
             certificate1->GetSSLCertificate().ToPEMString());
 }
 
+// Test that recreating the transports, as when a peer reconnects, resumes the
+// DTLS session, so that no certificates are exchanged again.
+TEST_F(DtlsTransportTest, TestReconnectResumesSession) {
+  std::unique_ptr<rtc::SSLSessionCache> session_cache1 =
+      rtc::SSLSessionCache::Create(rtc::SSL_MODE_DTLS);
+  std::unique_ptr<rtc::SSLSessionCache> session_cache2 =
+      rtc::SSLSessionCache::Create(rtc::SSL_MODE_DTLS);
+  client1_.SetupSessionCache(session_cache1.get());
+  client2_.SetupSessionCache(session_cache2.get());
+  PrepareDtls(rtc::KT_DEFAULT);
+  ASSERT_TRUE(Connect());
+  EXPECT_GT(client1_.received_dtls_certificates(), 0);
+  EXPECT_GT(client2_.received_dtls_certificates(), 0);
+  int certificates1 = client1_.received_dtls_certificates();
+  int certificates2 = client2_.received_dtls_certificates();
+
+  ASSERT_TRUE(Connect());
+  EXPECT_EQ(certificates1, client1_.received_dtls_certificates());
+  EXPECT_EQ(certificates2, client2_.received_dtls_certificates());
+  // Both sides still know each other's certificate.
+  EXPECT_TRUE(client1_.dtls_transport()->GetRemoteSSLCertChain());
+  EXPECT_TRUE(client2_.dtls_transport()->GetRemoteSSLCertChain());
+  TestTransfer(1000, 100, /*srtp=*/false);
+}
+
 // Test that packets are retransmitted according to the expected schedule.
 // Each time a timeout occurs, the retransmission timer should be doubled up to
 // 60 seconds. The timer defaults to 1 second, but for WebRTC we should be
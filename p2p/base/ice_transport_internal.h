@@ -101,6 +101,12 @@ struct IceConfig {
   // candidate pairs will succeed, even before a binding response is received.
   bool presume_writable_when_fully_relayed = false;
 
+  // If true, the ICE transport acts as an ICE-lite implementation (RFC 8445,
+  // section 2.5), as a server does: it never sends connectivity checks, only
+  // answers them, and a candidate pair becomes writable once a check is
+  // received on it. The transport should be given the controlled role.
+  bool ice_lite = false;
+
   // If true, after the ICE transport type (as the candidate filter used by the
   // port allocator) is changed such that new types of ICE candidates are
   // allowed by the new filter, e.g. from CF_RELAY to CF_ALL, candidates that
@@ -568,6 +568,16 @@ void P2PTransportChannel::SetIceConfig(const IceConfig& config) {
     }
   }
 
+  if (config_.ice_lite != config.ice_lite) {
+    if (!connections().empty()) {
+      RTC_LOG(LS_ERROR) << "Trying to change 'ICE lite' "
+                           "while connections already exist!";
+    } else {
+      config_.ice_lite = config.ice_lite;
+      RTC_LOG(LS_INFO) << "Set ICE lite to " << config_.ice_lite;
+    }
+  }
+
   config_.surface_ice_candidates_on_ice_transport_type_changed =
       config.surface_ice_candidates_on_ice_transport_type_changed;
   if (config_.surface_ice_candidates_on_ice_transport_type_changed &&
@@ -1126,7 +1136,8 @@ void P2PTransportChannel::OnNominated(Connection* conn) {
     return;
   }
 
-  if (field_trials_.send_ping_on_nomination_ice_controlled && conn != nullptr) {
+  if (field_trials_.send_ping_on_nomination_ice_controlled && conn != nullptr &&
+      !config_.ice_lite) {
     PingConnection(conn);
     MarkConnectionPinged(conn);
   }
@@ -1644,8 +1655,15 @@ bool P2PTransportChannel::IsRemoteCandidatePruned(const Candidate& cand) const {
 
 bool P2PTransportChannel::PresumedWritable(const Connection* conn) const {
   RTC_DCHECK_RUN_ON(network_thread_);
-  return (conn->write_state() == Connection::STATE_WRITE_INIT &&
-          config_.presume_writable_when_fully_relayed &&
+  if (conn->write_state() != Connection::STATE_WRITE_INIT) {
+    return false;
+  }
+  // An ICE-lite agent never checks a candidate pair, but knows it works once
+  // the full agent checked it.
+  if (config_.ice_lite) {
+    return conn->last_ping_received() > 0;
+  }
+  return (config_.presume_writable_when_fully_relayed &&
           conn->local_candidate().type() == RELAY_PORT_TYPE &&
           (conn->remote_candidate().type() == RELAY_PORT_TYPE ||
            conn->remote_candidate().type() == PRFLX_PORT_TYPE));
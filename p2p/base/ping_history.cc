@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/ping_history.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+
+namespace cricket {
+
+namespace {
+
+// Connections that are answered keep room for this many checks, which is
+// enough when they are answered in time, and give up the rest.
+constexpr size_t kRetainedCapacity = 2;
+
+}  // namespace
+
+PingHistory::PingHistory() = default;
+PingHistory::~PingHistory() = default;
+
+void PingHistory::Add(absl::string_view id,
+                      int64_t sent_time,
+                      uint32_t nomination) {
+  Ping ping;
+  ping.sent_time = sent_time;
+  ping.nomination = nomination;
+  RTC_DCHECK_LE(id.size(), sizeof(ping.id_));
+  ping.id_size_ = static_cast<uint8_t>(std::min(id.size(), sizeof(ping.id_)));
+  memcpy(ping.id_, id.data(), ping.id_size_);
+
+  if (count_ == 0) {
+    first_sent_time_ = sent_time;
+  }
+  ++count_;
+  if (pings_.size() < kCapacity) {
+    pings_.push_back(ping);
+  } else {
+    pings_[oldest_] = ping;
+    oldest_ = (oldest_ + 1) % kCapacity;
+  }
+}
+
+void PingHistory::Clear() {
+  count_ = 0;
+  oldest_ = 0;
+  if (pings_.capacity() > kRetainedCapacity) {
+    std::vector<Ping>().swap(pings_);
+  } else {
+    pings_.clear();
+  }
+}
+
+int64_t PingHistory::sent_time(size_t index) const {
+  RTC_DCHECK_LT(index, count_);
+  if (index == 0) {
+    return first_sent_time_;
+  }
+  // The checks before the kept ones have been dropped.
+  size_t dropped = count_ - pings_.size();
+  return kept_ping(index < dropped ? 0 : index - dropped).sent_time;
+}
+
+const PingHistory::Ping* PingHistory::Find(absl::string_view id) const {
+  for (const Ping& ping : pings_) {
+    if (ping.id() == id) {
+      return &ping;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace cricket
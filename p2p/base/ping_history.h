@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_PING_HISTORY_H_
+#define P2P_BASE_PING_HISTORY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace cricket {
+
+// The connectivity checks a Connection has sent since it last got a response.
+// All of them are counted, but only the most recent kCapacity are kept, in a
+// ring buffer, so that a connection whose checks go unanswered for a long time
+// does not keep growing. Responses are nearly always to one of the most
+// recent checks, since older ones have been given up on by then.
+class PingHistory {
+ public:
+  static constexpr size_t kCapacity = 32;
+
+  struct Ping {
+    absl::string_view id() const { return absl::string_view(id_, id_size_); }
+
+    int64_t sent_time;
+    uint32_t nomination;
+
+   private:
+    friend class PingHistory;
+    // STUN transaction IDs, which are 12 bytes, or 16 for RFC 3489.
+    char id_[16];
+    uint8_t id_size_;
+  };
+
+  PingHistory();
+  ~PingHistory();
+
+  void Add(absl::string_view id, int64_t sent_time, uint32_t nomination);
+  // Forgets all checks, as when a response comes in.
+  void Clear();
+
+  // The number of checks sent since the last response.
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  // When the first check since the last response was sent.
+  int64_t first_sent_time() const { return first_sent_time_; }
+  // When the check at |index|, counting from the first since the last
+  // response, was sent. Must be less than size(). If that check is no longer
+  // kept, returns when the oldest check that is kept was sent, which is later.
+  int64_t sent_time(size_t index) const;
+
+  // Returns the check with |id| if it is kept, or null.
+  const Ping* Find(absl::string_view id) const;
+
+  // The checks that are kept, oldest first.
+  size_t kept() const { return pings_.size(); }
+  const Ping& kept_ping(size_t index) const {
+    return pings_[(oldest_ + index) % pings_.size()];
+  }
+
+ private:
+  std::vector<Ping> pings_;
+  // Index of the oldest check in |pings_| once it is full.
+  size_t oldest_ = 0;
+  size_t count_ = 0;
+  int64_t first_sent_time_ = 0;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_PING_HISTORY_H_
@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/ping_history.h"
+
+#include <string>
+
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+std::string Id(int i) {
+  std::string id = "id0123456789";
+  id[0] = static_cast<char>('a' + i % 26);
+  id[1] = static_cast<char>('a' + i / 26);
+  return id;
+}
+
+TEST(PingHistoryTest, FindsWhatWasAdded) {
+  PingHistory pings;
+  EXPECT_TRUE(pings.empty());
+  EXPECT_EQ(nullptr, pings.Find(Id(0)));
+
+  pings.Add(Id(0), 1000, 0);
+  pings.Add(Id(1), 1100, 2);
+  EXPECT_EQ(2u, pings.size());
+  EXPECT_EQ(1000, pings.first_sent_time());
+  EXPECT_EQ(1100, pings.sent_time(1));
+
+  const PingHistory::Ping* ping = pings.Find(Id(1));
+  ASSERT_NE(nullptr, ping);
+  EXPECT_EQ(Id(1), ping->id());
+  EXPECT_EQ(1100, ping->sent_time);
+  EXPECT_EQ(2u, ping->nomination);
+  EXPECT_EQ(nullptr, pings.Find(Id(2)));
+
+  pings.Clear();
+  EXPECT_TRUE(pings.empty());
+  EXPECT_EQ(nullptr, pings.Find(Id(0)));
+}
+
+TEST(PingHistoryTest, KeepsOnlyTheMostRecent) {
+  PingHistory pings;
+  const int count = PingHistory::kCapacity + 10;
+  for (int i = 0; i < count; ++i) {
+    pings.Add(Id(i), 1000 + i, 0);
+  }
+  EXPECT_EQ(static_cast<size_t>(count), pings.size());
+  EXPECT_EQ(PingHistory::kCapacity, pings.kept());
+  EXPECT_EQ(1000, pings.first_sent_time());
+
+  // The oldest checks are dropped, but still counted.
+  EXPECT_EQ(nullptr, pings.Find(Id(9)));
+  ASSERT_NE(nullptr, pings.Find(Id(10)));
+  ASSERT_NE(nullptr, pings.Find(Id(count - 1)));
+  EXPECT_EQ(Id(10), pings.kept_ping(0).id());
+  EXPECT_EQ(Id(count - 1), pings.kept_ping(pings.kept() - 1).id());
+
+  // A dropped check reports the send time of the oldest one kept.
+  EXPECT_EQ(1010, pings.sent_time(5));
+  EXPECT_EQ(1010, pings.sent_time(10));
+  EXPECT_EQ(1000 + count - 1, pings.sent_time(count - 1));
+}
+
+TEST(PingHistoryTest, StartsOverAfterClear) {
+  PingHistory pings;
+  for (int i = 0; i < 40; ++i) {
+    pings.Add(Id(i), 1000 + i, 0);
+  }
+  pings.Clear();
+  pings.Add(Id(50), 2000, 1);
+  EXPECT_EQ(1u, pings.size());
+  EXPECT_EQ(1u, pings.kept());
+  EXPECT_EQ(2000, pings.first_sent_time());
+  EXPECT_EQ(Id(50), pings.kept_ping(0).id());
+  EXPECT_EQ(nullptr, pings.Find(Id(39)));
+}
+
+TEST(PingHistoryTest, KeepsShortIds) {
+  PingHistory pings;
+  // RFC 3489 transaction IDs are 16 bytes.
+  const std::string long_id = "0123456789abcdef";
+  pings.Add(long_id, 1000, 0);
+  pings.Add("short", 1001, 0);
+  ASSERT_NE(nullptr, pings.Find(long_id));
+  EXPECT_EQ(long_id, pings.Find(long_id)->id());
+  EXPECT_EQ(nullptr, pings.Find("0123456789ab"));
+  ASSERT_NE(nullptr, pings.Find("short"));
+}
+
+}  // namespace
+}  // namespace cricket
@@ -19,6 +19,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
 #include "p2p/base/connection.h"
 #include "p2p/base/port_allocator.h"
 #include "rtc_base/checks.h"
@@ -57,6 +58,22 @@ rtc::PacketInfoProtocolType ConvertProtocolTypeToPacketInfoProtocolType(
 // it to a little higher than a total STUN timeout.
 const int kPortTimeoutDelay = cricket::STUN_TOTAL_TIMEOUT + 5000;
 
+// Splits a STUN username of the form RFRAG:LFRAG. The packet must include a
+// username that either begins or ends with our fragment. It should begin with
+// our fragment if it is a request and it should end with our fragment if it is
+// a response.
+bool SplitStunUsername(absl::string_view username,
+                       std::string* local_ufrag,
+                       std::string* remote_ufrag) {
+  size_t colon_pos = username.find(':');
+  if (colon_pos == absl::string_view::npos) {
+    return false;
+  }
+  *local_ufrag = std::string(username.substr(0, colon_pos));
+  *remote_ufrag = std::string(username.substr(colon_pos + 1));
+  return true;
+}
+
 }  // namespace
 
 namespace cricket {
@@ -178,6 +195,7 @@ void Port::Construct() {
     ice_username_fragment_ = rtc::CreateRandomString(ICE_UFRAG_LENGTH);
     password_ = rtc::CreateRandomString(ICE_PWD_LENGTH);
   }
+  password_key_ = std::make_unique<rtc::HmacSha1>(password_);
   network_->SignalTypeChanged.connect(this, &Port::OnNetworkTypeChanged);
   network_cost_ = network_->GetCost();
 
@@ -235,6 +253,7 @@ void Port::SetIceParameters(int component,
   component_ = component;
   ice_username_fragment_ = username_fragment;
   password_ = password;
+  password_key_ = std::make_unique<rtc::HmacSha1>(password_);
   for (Candidate& c : candidates_) {
     c.set_component(component);
     c.set_username(username_fragment);
@@ -247,11 +266,15 @@ const std::vector<Candidate>& Port::Candidates() const {
 }
 
 Connection* Port::GetConnection(const rtc::SocketAddress& remote_addr) {
-  AddressMap::const_iterator iter = connections_.find(remote_addr);
-  if (iter != connections_.end())
-    return iter->second;
-  else
-    return NULL;
+  if (last_found_connection_ && last_found_address_ == remote_addr) {
+    return last_found_connection_;
+  }
+  Connection* conn = connections_by_address_.Find(remote_addr);
+  if (conn) {
+    last_found_connection_ = conn;
+    last_found_address_ = remote_addr;
+  }
+  return conn;
 }
 
 void Port::AddAddress(const rtc::SocketAddress& address,
@@ -352,8 +375,12 @@ void Port::AddOrReplaceConnection(Connection* conn) {
         << conn->remote_candidate().ToSensitiveString();
     ret.first->second->SignalDestroyed.disconnect(this);
     ret.first->second->Destroy();
+    if (last_found_connection_ == ret.first->second) {
+      last_found_connection_ = nullptr;
+    }
     ret.first->second = conn;
   }
+  connections_by_address_.Set(conn->remote_candidate().address(), conn);
   conn->SignalDestroyed.connect(this, &Port::OnConnectionDestroyed);
   SignalConnectionCreated(this, conn);
 }
@@ -430,9 +457,6 @@ bool Port::GetStunMessage(const char* data,
                           const rtc::SocketAddress& addr,
                           std::unique_ptr<IceMessage>* out_msg,
                           std::string* out_username) {
-  // NOTE: This could clearly be optimized to avoid allocating any memory.
-  //       However, at the data rates we'll be looking at on the client side,
-  //       this probably isn't worth worrying about.
   RTC_DCHECK(out_msg != NULL);
   RTC_DCHECK(out_username != NULL);
   out_username->clear();
@@ -448,58 +472,75 @@ bool Port::GetStunMessage(const char* data,
   }
 
   // Parse the request message.  If the packet is not a complete and correct
-  // STUN message, then ignore it.
-  std::unique_ptr<IceMessage> stun_msg(new IceMessage());
-  rtc::ByteBufferReader buf(data, size);
-  if (!stun_msg->Read(&buf) || (buf.Length() > 0)) {
+  // STUN message, then ignore it. The message is parsed in place first, so
+  // that the checks on the wire format below don't need to copy it.
+  StunMessageView view;
+  if (!view.Parse(data, size)) {
     return false;
   }
 
-  // Get list of attributes in the "comprehension-required" range that were not
-  // comprehended. If one or more is found, the behavior differs based on the
-  // type of the incoming message; see below.
-  std::vector<uint16_t> unknown_attributes =
-      stun_msg->GetNonComprehendedAttributes();
+  std::string remote_ufrag;
+  if (view.type() == STUN_BINDING_REQUEST) {
+    // The checks of a binding request are done on the view. A request that
+    // fails them is answered from its type and transaction ID alone, without
+    // building an IceMessage.
+    auto send_error_response = [&](int error_code, const std::string& reason) {
+      StunMessage request;
+      request.SetType(view.type());
+      request.SetTransactionID(std::string(view.transaction_id()));
+      SendBindingErrorResponse(&request, addr, error_code, reason);
+    };
 
-  if (stun_msg->type() == STUN_BINDING_REQUEST) {
     // Check for the presence of USERNAME and MESSAGE-INTEGRITY (if ICE) first.
     // If not present, fail with a 400 Bad Request.
-    if (!stun_msg->GetByteString(STUN_ATTR_USERNAME) ||
-        !stun_msg->GetByteString(STUN_ATTR_MESSAGE_INTEGRITY)) {
+    if (!view.HasAttribute(STUN_ATTR_USERNAME) ||
+        !view.HasAttribute(STUN_ATTR_MESSAGE_INTEGRITY)) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
-                        << StunMethodToString(stun_msg->type())
+                        << StunMethodToString(view.type())
                         << " without username/M-I from: "
                         << addr.ToSensitiveString();
-      SendBindingErrorResponse(stun_msg.get(), addr, STUN_ERROR_BAD_REQUEST,
-                               STUN_ERROR_REASON_BAD_REQUEST);
+      send_error_response(STUN_ERROR_BAD_REQUEST,
+                          STUN_ERROR_REASON_BAD_REQUEST);
       return true;
     }
 
     // If the username is bad or unknown, fail with a 401 Unauthorized.
     std::string local_ufrag;
-    std::string remote_ufrag;
-    if (!ParseStunUsername(stun_msg.get(), &local_ufrag, &remote_ufrag) ||
+    if (!ParseStunUsername(view, &local_ufrag, &remote_ufrag) ||
         local_ufrag != username_fragment()) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
-                        << StunMethodToString(stun_msg->type())
+                        << StunMethodToString(view.type())
                         << " with bad local username " << local_ufrag
                         << " from " << addr.ToSensitiveString();
-      SendBindingErrorResponse(stun_msg.get(), addr, STUN_ERROR_UNAUTHORIZED,
-                               STUN_ERROR_REASON_UNAUTHORIZED);
+      send_error_response(STUN_ERROR_UNAUTHORIZED,
+                          STUN_ERROR_REASON_UNAUTHORIZED);
       return true;
     }
 
     // If ICE, and the MESSAGE-INTEGRITY is bad, fail with a 401 Unauthorized
-    if (!stun_msg->ValidateMessageIntegrity(data, size, password_)) {
+    if (!view.ValidateMessageIntegrity(*password_key_)) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
-                        << StunMethodToString(stun_msg->type())
+                        << StunMethodToString(view.type())
                         << " with bad M-I from " << addr.ToSensitiveString()
                         << ", password_=" << password_;
-      SendBindingErrorResponse(stun_msg.get(), addr, STUN_ERROR_UNAUTHORIZED,
-                               STUN_ERROR_REASON_UNAUTHORIZED);
+      send_error_response(STUN_ERROR_UNAUTHORIZED,
+                          STUN_ERROR_REASON_UNAUTHORIZED);
       return true;
     }
+  }
+
+  std::unique_ptr<IceMessage> stun_msg(new IceMessage());
+  if (!stun_msg->Read(view)) {
+    return false;
+  }
+
+  // Get list of attributes in the "comprehension-required" range that were not
+  // comprehended. If one or more is found, the behavior differs based on the
+  // type of the incoming message; see below.
+  std::vector<uint16_t> unknown_attributes =
+      stun_msg->GetNonComprehendedAttributes();
 
+  if (stun_msg->type() == STUN_BINDING_REQUEST) {
     // If a request contains unknown comprehension-required attributes, reply
     // with an error. See RFC5389 section 7.3.1.
     if (!unknown_attributes.empty()) {
@@ -556,7 +597,7 @@ bool Port::GetStunMessage(const char* data,
     // No stun attributes will be verified, if it's stun indication message.
     // Returning from end of the this method.
   } else if (stun_msg->type() == GOOG_PING_REQUEST) {
-    if (!stun_msg->ValidateMessageIntegrity32(data, size, password_)) {
+    if (!view.ValidateMessageIntegrity32(*password_key_)) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
                         << StunMethodToString(stun_msg->type())
                         << " with bad M-I from " << addr.ToSensitiveString()
@@ -612,26 +653,25 @@ rtc::DiffServCodePoint Port::StunDscpValue() const {
 bool Port::ParseStunUsername(const StunMessage* stun_msg,
                              std::string* local_ufrag,
                              std::string* remote_ufrag) const {
-  // The packet must include a username that either begins or ends with our
-  // fragment.  It should begin with our fragment if it is a request and it
-  // should end with our fragment if it is a response.
   local_ufrag->clear();
   remote_ufrag->clear();
   const StunByteStringAttribute* username_attr =
       stun_msg->GetByteString(STUN_ATTR_USERNAME);
   if (username_attr == NULL)
     return false;
+  return SplitStunUsername(username_attr->GetString(), local_ufrag,
+                           remote_ufrag);
+}
 
-  // RFRAG:LFRAG
-  const std::string username = username_attr->GetString();
-  size_t colon_pos = username.find(':');
-  if (colon_pos == std::string::npos) {
+bool Port::ParseStunUsername(const StunMessageView& stun_msg,
+                             std::string* local_ufrag,
+                             std::string* remote_ufrag) const {
+  local_ufrag->clear();
+  remote_ufrag->clear();
+  absl::string_view username;
+  if (!stun_msg.GetByteString(STUN_ATTR_USERNAME, &username))
     return false;
-  }
-
-  *local_ufrag = username.substr(0, colon_pos);
-  *remote_ufrag = username.substr(colon_pos + 1, username.size());
-  return true;
+  return SplitStunUsername(username, local_ufrag, remote_ufrag);
 }
 
 bool Port::MaybeIceRoleConflict(const rtc::SocketAddress& addr,
@@ -745,9 +785,9 @@ void Port::SendBindingErrorResponse(StunMessage* request,
       error_code != STUN_ERROR_UNAUTHORIZED &&
       request->type() != GOOG_PING_REQUEST) {
     if (request->type() == STUN_BINDING_REQUEST) {
-      response.AddMessageIntegrity(password_);
+      response.AddMessageIntegrity(*password_key_);
     } else {
-      response.AddMessageIntegrity32(password_);
+      response.AddMessageIntegrity32(*password_key_);
     }
   }
 
@@ -791,7 +831,7 @@ void Port::SendUnknownAttributesErrorResponse(
   }
   response.AddAttribute(std::move(unknown_attr));
 
-  response.AddMessageIntegrity(password_);
+  response.AddMessageIntegrity(*password_key_);
   response.AddFingerprint();
 
   // Send the response message.
@@ -876,6 +916,10 @@ void Port::OnConnectionDestroyed(Connection* conn) {
       connections_.find(conn->remote_candidate().address());
   RTC_DCHECK(iter != connections_.end());
   connections_.erase(iter);
+  connections_by_address_.Erase(conn->remote_candidate().address());
+  if (last_found_connection_ == conn) {
+    last_found_connection_ = nullptr;
+  }
   HandleConnectionDestroyed(conn);
 
   // Ports time out after all connections fail if it is not marked as
@@ -26,6 +26,7 @@
 #include "logging/rtc_event_log/events/rtc_event_ice_candidate_pair.h"
 #include "logging/rtc_event_log/events/rtc_event_ice_candidate_pair_config.h"
 #include "logging/rtc_event_log/ice_logger.h"
+#include "p2p/base/address_hash_table.h"
 #include "p2p/base/candidate_pair_interface.h"
 #include "p2p/base/connection.h"
 #include "p2p/base/connection_info.h"
@@ -34,6 +35,7 @@
 #include "p2p/base/stun_request.h"
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/hmac_sha1.h"
 #include "rtc_base/net_helper.h"
 #include "rtc_base/network.h"
 #include "rtc_base/proxy_info.h"
@@ -238,6 +240,8 @@ class Port : public PortInterface,
 
   const std::string username_fragment() const;
   const std::string& password() const { return password_; }
+  // |password()| as an HMAC key, for signing and checking STUN messages.
+  const rtc::HmacSha1& password_key() const { return *password_key_; }
 
   // May be called when this port was initially created by a pooled
   // PortAllocatorSession, and is now being assigned to an ICE transport.
@@ -327,6 +331,9 @@ class Port : public PortInterface,
   bool ParseStunUsername(const StunMessage* stun_msg,
                          std::string* local_username,
                          std::string* remote_username) const;
+  bool ParseStunUsername(const StunMessageView& stun_msg,
+                         std::string* local_username,
+                         std::string* remote_username) const;
   void CreateStunUsername(const std::string& remote_username,
                           std::string* stun_username_attr_str) const;
 
@@ -455,8 +462,17 @@ class Port : public PortInterface,
   // username_fragment().
   std::string ice_username_fragment_;
   std::string password_;
+  std::unique_ptr<rtc::HmacSha1> password_key_;
   std::vector<Candidate> candidates_;
   AddressMap connections_;
+  // Indexes |connections_| for GetConnection(), which is called for every
+  // received packet.
+  AddressHashTable<Connection> connections_by_address_;
+  // The connection GetConnection() found last, and its remote address. Most
+  // packets come from the one remote address that the selected connection is
+  // to, so this mostly saves the lookup altogether.
+  Connection* last_found_connection_ = nullptr;
+  rtc::SocketAddress last_found_address_;
   int timeout_delay_;
   bool enable_port_packets_;
   IceRole ice_role_;
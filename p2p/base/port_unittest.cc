@@ -27,6 +27,7 @@
 #include "api/units/time_delta.h"
 #include "p2p/base/basic_packet_socket_factory.h"
 #include "p2p/base/p2p_constants.h"
+#include "p2p/base/ping_history.h"
 #include "p2p/base/port_allocator.h"
 #include "p2p/base/port_interface.h"
 #include "p2p/base/stun_port.h"
@@ -1907,6 +1908,48 @@ TEST_F(PortTest, TestNomination) {
   EXPECT_EQ(rconn->nominated(), rconn->stats().nominated);
 }
 
+// A response to a ping that is no longer kept in the ping history, because
+// more pings were sent since, still acknowledges the nomination it carried.
+TEST_F(PortTest, TestNominationAcknowledgedByResponseToOldPing) {
+  auto lport = CreateTestPort(kLocalAddr1, "lfrag", "lpass");
+  auto rport = CreateTestPort(kLocalAddr2, "rfrag", "rpass");
+  lport->SetIceRole(cricket::ICEROLE_CONTROLLING);
+  lport->SetIceTiebreaker(kTiebreaker1);
+  rport->SetIceRole(cricket::ICEROLE_CONTROLLED);
+  rport->SetIceTiebreaker(kTiebreaker2);
+
+  lport->PrepareAddress();
+  rport->PrepareAddress();
+  ASSERT_FALSE(lport->Candidates().empty());
+  ASSERT_FALSE(rport->Candidates().empty());
+  Connection* lconn =
+      lport->CreateConnection(rport->Candidates()[0], Port::ORIGIN_MESSAGE);
+  Connection* rconn =
+      rport->CreateConnection(lport->Candidates()[0], Port::ORIGIN_MESSAGE);
+
+  uint32_t nomination = 1234;
+  lconn->set_nomination(nomination);
+  lconn->Ping(0);
+  ASSERT_TRUE_WAIT(lport->last_stun_msg(), kDefaultTimeout);
+  ASSERT_TRUE(lport->last_stun_buf());
+  rconn->OnReadPacket(lport->last_stun_buf()->data<char>(),
+                      lport->last_stun_buf()->size(), /* packet_time_us */ -1);
+  ASSERT_TRUE_WAIT(rport->last_stun_msg(), kDefaultTimeout);
+  ASSERT_TRUE(rport->last_stun_buf());
+  rtc::Buffer response(rport->last_stun_buf()->data(),
+                       rport->last_stun_buf()->size());
+
+  // Push the first ping out of the history before its response arrives.
+  for (size_t i = 0; i < PingHistory::kCapacity; ++i) {
+    lconn->Ping(0);
+  }
+  EXPECT_EQ(0U, lconn->acked_nomination());
+  lconn->OnReadPacket(response.data<char>(), response.size(),
+                      /* packet_time_us */ -1);
+  EXPECT_EQ(nomination, lconn->acked_nomination());
+  EXPECT_TRUE(lconn->nominated());
+}
+
 TEST_F(PortTest, TestRoundTripTime) {
   rtc::ScopedFakeClock clock;
 
@@ -2229,6 +2272,33 @@ TEST_F(PortTest, TestHandleStunMessageBadMessageIntegrity) {
   // Change this test to pass in data via Connection::OnReadPacket instead.
 }
 
+// Test that a binding request rejected by its checks, which are done before
+// the request is fully parsed, is answered with its own transaction ID.
+TEST_F(PortTest, TestHandleStunMessageErrorResponseMatchesRequest) {
+  // Our port will act as the "remote" port.
+  auto port = CreateTestPort(kLocalAddr2, "rfrag", "rpass");
+
+  std::unique_ptr<IceMessage> in_msg, out_msg;
+  auto buf = std::make_unique<ByteBufferWriter>();
+  rtc::SocketAddress addr(kLocalAddr1);
+  std::string username;
+
+  in_msg = CreateStunMessageWithUsername(STUN_BINDING_REQUEST, "rfrag:lfrag");
+  in_msg->AddMessageIntegrity("invalid");
+  in_msg->AddFingerprint();
+  WriteStunMessage(*in_msg, buf.get());
+  EXPECT_TRUE(port->GetStunMessage(buf->Data(), buf->Length(), addr, &out_msg,
+                                   &username));
+  EXPECT_TRUE(out_msg.get() == NULL);
+  ASSERT_TRUE(port->last_stun_msg() != NULL);
+  EXPECT_EQ(STUN_BINDING_ERROR_RESPONSE, port->last_stun_msg()->type());
+  EXPECT_EQ(in_msg->transaction_id(), port->last_stun_msg()->transaction_id());
+  EXPECT_EQ(STUN_ERROR_UNAUTHORIZED, port->last_stun_error_code());
+  EXPECT_TRUE(StunMessage::ValidateFingerprint(
+      reinterpret_cast<const char*>(port->last_stun_buf()->data()),
+      port->last_stun_buf()->size()));
+}
+
 // Test handling STUN messages with missing or malformed FINGERPRINT.
 TEST_F(PortTest, TestHandleStunMessageBadFingerprint) {
   // Our port will act as the "remote" port.
@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <string>
+
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace cricket {
+
+std::unique_ptr<ShardedTurnServer> ShardedTurnServer::Create(
+    const Config& config) {
+  RTC_DCHECK_GT(config.num_shards, 0);
+  std::unique_ptr<ShardedTurnServer> server(new ShardedTurnServer());
+  server->internal_address_ = config.internal_address;
+  for (int i = 0; i < config.num_shards; ++i) {
+    server->shards_.emplace_back();
+    Shard& shard = server->shards_.back();
+    shard.thread = rtc::Thread::CreateWithSocketServer();
+    shard.thread->SetName("TurnShard" + std::to_string(i), nullptr);
+    shard.thread->Start();
+    if (!server->StartShard(config, &shard)) {
+      RTC_LOG(LS_ERROR) << "Failed to start TURN shard " << i << " on "
+                        << server->internal_address_.ToString();
+      return nullptr;
+    }
+  }
+  return server;
+}
+
+ShardedTurnServer::~ShardedTurnServer() {
+  for (Shard& shard : shards_) {
+    shard.thread->Invoke<void>(RTC_FROM_HERE, [&shard] {
+      shard.server.reset();
+    });
+    shard.thread->Stop();
+  }
+}
+
+std::vector<size_t> ShardedTurnServer::GetAllocationCounts() const {
+  std::vector<size_t> counts;
+  for (const Shard& shard : shards_) {
+    counts.push_back(shard.thread->Invoke<size_t>(RTC_FROM_HERE, [&shard] {
+      return shard.server->allocations().size();
+    }));
+  }
+  return counts;
+}
+
+bool ShardedTurnServer::StartShard(const Config& config, Shard* shard) {
+  rtc::Thread* thread = shard->thread.get();
+  return thread->Invoke<bool>(RTC_FROM_HERE, [&] {
+    rtc::AsyncSocket* socket = thread->socketserver()->CreateAsyncSocket(
+        internal_address_.family(), SOCK_DGRAM);
+    if (!socket)
+      return false;
+    if (socket->SetOption(rtc::Socket::OPT_REUSEPORT, 1) != 0 ||
+        socket->Bind(internal_address_) != 0) {
+      delete socket;
+      return false;
+    }
+    // The following shards bind the port picked for the first one.
+    internal_address_ = socket->GetLocalAddress();
+
+    shard->server = std::make_unique<TurnServer>(thread);
+    shard->server->set_realm(config.realm);
+    shard->server->set_software(config.software);
+    shard->server->set_auth_hook(config.auth_hook);
+    shard->server->AddInternalSocket(new rtc::AsyncUDPSocket(socket),
+                                     PROTO_UDP);
+    shard->server->SetExternalSocketFactory(
+        new rtc::BasicPacketSocketFactory(thread),
+        rtc::SocketAddress(config.external_ip, 0));
+    return true;
+  });
+}
+
+}  // namespace cricket
@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_SHARDED_TURN_SERVER_H_
+#define P2P_BASE_SHARDED_TURN_SERVER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "p2p/base/turn_server.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+// Runs a number of independent TurnServers, the shards, each on its own thread
+// with its own allocation table. Every shard listens on a UDP socket bound to
+// the same internal address with SO_REUSEPORT, so the kernel spreads clients
+// over the shards by hashing the 5-tuple of their packets. All packets of a
+// client, and thus all of its allocation, stay on one shard.
+//
+// Only UDP is supported, and only where the platform has SO_REUSEPORT.
+class ShardedTurnServer {
+ public:
+  struct Config {
+    // Port 0 picks a free port, which all shards then share.
+    rtc::SocketAddress internal_address;
+    rtc::IPAddress external_ip;
+    std::string realm;
+    std::string software;
+    // Not owned. Called on all the shard threads, so it must be thread safe.
+    TurnAuthInterface* auth_hook = nullptr;
+    int num_shards = 1;
+  };
+
+  // Returns null if the shards could not be set up, e.g. if the address is
+  // already in use or SO_REUSEPORT is not supported.
+  static std::unique_ptr<ShardedTurnServer> Create(const Config& config);
+
+  ShardedTurnServer(const ShardedTurnServer&) = delete;
+  ShardedTurnServer& operator=(const ShardedTurnServer&) = delete;
+  // Destroys the servers on their threads, and stops the threads.
+  ~ShardedTurnServer();
+
+  int num_shards() const { return static_cast<int>(shards_.size()); }
+  const rtc::SocketAddress& internal_address() const {
+    return internal_address_;
+  }
+
+  // Returns the number of allocations on each shard. Blocks on the shard
+  // threads.
+  std::vector<size_t> GetAllocationCounts() const;
+
+ private:
+  struct Shard {
+    std::unique_ptr<rtc::Thread> thread;
+    // Only touched on |thread|.
+    std::unique_ptr<TurnServer> server;
+  };
+
+  ShardedTurnServer() = default;
+  // Creates the socket and server of |shard| on its thread. Updates
+  // |internal_address_| with the port picked for the first shard.
+  bool StartShard(const Config& config, Shard* shard);
+
+  rtc::SocketAddress internal_address_;
+  std::vector<Shard> shards_;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_SHARDED_TURN_SERVER_H_
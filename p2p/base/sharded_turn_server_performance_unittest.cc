@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "api/transport/stun.h"
+#include "p2p/base/sharded_turn_server.h"
+#include "p2p/base/test_turn_load_generator.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+#if defined(WEBRTC_LINUX)
+
+constexpr int kNumAllocations = 2000;
+constexpr int kPacketsPerAllocation = 50;
+constexpr size_t kPayloadSize = 160;
+// Packets sent but not yet seen by the peer. Keeps the socket buffers from
+// overflowing, so that the relay rate rather than the loss is measured.
+constexpr int kMaxPacketsInFlight = 128;
+// Packets missing for this long are counted as lost.
+constexpr int64_t kStallTimeoutMs = 1000;
+constexpr int kAllocationBatchSize = 100;
+constexpr int kAllocationTimeoutMs = 10000;
+constexpr char kUsername[] = "user";
+
+class TestTurnAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(username, realm, username, key);
+  }
+};
+
+class ShardedTurnServerPerformanceTest : public ::testing::TestWithParam<int>,
+                                         public sigslot::has_slots<> {
+ protected:
+  ShardedTurnServerPerformanceTest() : thread_(&socket_server_) {
+    peer_.reset(rtc::AsyncUDPSocket::Create(
+        &socket_server_, rtc::SocketAddress("127.0.0.1", 0)));
+    peer_->SignalReadPacket.connect(
+        this, &ShardedTurnServerPerformanceTest::OnPeerPacket);
+  }
+
+  void OnPeerPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    ++num_peer_packets_;
+  }
+
+  rtc::PhysicalSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  TestTurnAuth auth_;
+  std::unique_ptr<rtc::AsyncPacketSocket> peer_;
+  int num_peer_packets_ = 0;
+};
+
+TEST_P(ShardedTurnServerPerformanceTest, RelayChannelData) {
+  const int num_shards = GetParam();
+  ShardedTurnServer::Config config;
+  config.internal_address = rtc::SocketAddress("127.0.0.1", 0);
+  config.external_ip = rtc::IPAddress(INADDR_LOOPBACK);
+  config.realm = "realm";
+  config.auth_hook = &auth_;
+  config.num_shards = num_shards;
+  std::unique_ptr<ShardedTurnServer> server = ShardedTurnServer::Create(config);
+  ASSERT_TRUE(server);
+
+  TestTurnLoadGenerator generator(&thread_, server->internal_address(),
+                                  peer_->GetLocalAddress(), kUsername,
+                                  kUsername);
+  int64_t start_ms = rtc::TimeMillis();
+  // The generator does not retransmit, so allocate in batches that fit the
+  // socket buffers.
+  for (int started = 0; started < kNumAllocations;
+       started += kAllocationBatchSize) {
+    generator.StartAllocations(kAllocationBatchSize);
+    ASSERT_EQ_WAIT(started + kAllocationBatchSize, generator.num_ready(),
+                   kAllocationTimeoutMs);
+  }
+  int64_t allocation_ms = rtc::TimeMillis() - start_ms;
+
+  const int num_packets = kNumAllocations * kPacketsPerAllocation;
+  int num_sent = 0;
+  int num_lost = 0;
+  int last_received = 0;
+  start_ms = rtc::TimeMillis();
+  int64_t last_progress_ms = start_ms;
+  while (num_peer_packets_ + num_lost < num_packets) {
+    int in_flight = num_sent - num_peer_packets_ - num_lost;
+    if (num_sent < num_packets && in_flight < kMaxPacketsInFlight) {
+      num_sent += generator.SendChannelData(
+          std::min(kMaxPacketsInFlight - in_flight, num_packets - num_sent),
+          kPayloadSize);
+    }
+    thread_.ProcessMessages(0);
+    int64_t now_ms = rtc::TimeMillis();
+    if (num_peer_packets_ != last_received) {
+      last_received = num_peer_packets_;
+      last_progress_ms = now_ms;
+    } else if (now_ms - last_progress_ms > kStallTimeoutMs) {
+      num_lost += num_sent - num_peer_packets_ - num_lost;
+      last_progress_ms = now_ms;
+    }
+  }
+  int64_t relay_ms = std::max<int64_t>(rtc::TimeMillis() - start_ms, 1);
+
+  const std::string story = "shards_" + std::to_string(num_shards);
+  webrtc::test::PrintResult("turn_allocations", "", story,
+                            kNumAllocations * 1000.0 / allocation_ms,
+                            "allocations_per_second", false);
+  webrtc::test::PrintResult("turn_relayed_packets", "", story,
+                            num_peer_packets_ * 1000.0 / relay_ms,
+                            "packets_per_second", false);
+  webrtc::test::PrintResult("turn_lost_packets", "", story, num_lost,
+                            "packets", false);
+}
+
+INSTANTIATE_TEST_SUITE_P(ShardCounts,
+                         ShardedTurnServerPerformanceTest,
+                         ::testing::Values(1, 2, 4, 8));
+
+#endif  // defined(WEBRTC_LINUX)
+
+}  // namespace
+}  // namespace cricket
@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "api/transport/stun.h"
+#include "p2p/base/test_turn_load_generator.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+// SO_REUSEPORT hashes the 5-tuple onto the sockets on Linux only.
+#if defined(WEBRTC_LINUX)
+
+constexpr int kTimeoutMs = 10000;
+constexpr char kUsername[] = "user";
+constexpr char kRealm[] = "realm";
+
+// Accepts any user whose password is the same as the username.
+class TestTurnAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(username, realm, username, key);
+  }
+};
+
+class ShardedTurnServerTest : public ::testing::Test,
+                              public sigslot::has_slots<> {
+ protected:
+  ShardedTurnServerTest() : thread_(&socket_server_) {
+    peer_.reset(rtc::AsyncUDPSocket::Create(
+        &socket_server_, rtc::SocketAddress("127.0.0.1", 0)));
+    peer_->SignalReadPacket.connect(this,
+                                    &ShardedTurnServerTest::OnPeerPacket);
+  }
+
+  std::unique_ptr<ShardedTurnServer> CreateServer(int num_shards) {
+    ShardedTurnServer::Config config;
+    config.internal_address = rtc::SocketAddress("127.0.0.1", 0);
+    config.external_ip = rtc::IPAddress(INADDR_LOOPBACK);
+    config.realm = kRealm;
+    config.auth_hook = &auth_;
+    config.num_shards = num_shards;
+    return ShardedTurnServer::Create(config);
+  }
+
+  std::unique_ptr<TestTurnLoadGenerator> CreateLoadGenerator(
+      const ShardedTurnServer& server) {
+    return std::make_unique<TestTurnLoadGenerator>(
+        &thread_, server.internal_address(), peer_->GetLocalAddress(),
+        kUsername, kUsername);
+  }
+
+  void OnPeerPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    ++num_peer_packets_;
+  }
+
+  rtc::PhysicalSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  TestTurnAuth auth_;
+  std::unique_ptr<rtc::AsyncPacketSocket> peer_;
+  int num_peer_packets_ = 0;
+};
+
+TEST_F(ShardedTurnServerTest, ShardsShareOnePort) {
+  std::unique_ptr<ShardedTurnServer> server = CreateServer(4);
+  ASSERT_TRUE(server);
+  EXPECT_EQ(server->num_shards(), 4);
+  EXPECT_NE(server->internal_address().port(), 0);
+  EXPECT_EQ(server->GetAllocationCounts(), std::vector<size_t>(4, 0));
+}
+
+TEST_F(ShardedTurnServerTest, SpreadsAllocationsOverShards) {
+  constexpr int kNumAllocations = 100;
+  std::unique_ptr<ShardedTurnServer> server = CreateServer(4);
+  ASSERT_TRUE(server);
+  auto generator = CreateLoadGenerator(*server);
+  generator->StartAllocations(kNumAllocations);
+  ASSERT_EQ_WAIT(kNumAllocations, generator->num_ready(), kTimeoutMs);
+  EXPECT_EQ(generator->num_failed(), 0);
+
+  std::vector<size_t> counts = server->GetAllocationCounts();
+  EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), size_t{0}),
+            static_cast<size_t>(kNumAllocations));
+  for (size_t count : counts)
+    EXPECT_GT(count, 0u);
+}
+
+TEST_F(ShardedTurnServerTest, RelaysChannelDataOnAllShards) {
+  constexpr int kNumAllocations = 20;
+  std::unique_ptr<ShardedTurnServer> server = CreateServer(2);
+  ASSERT_TRUE(server);
+  auto generator = CreateLoadGenerator(*server);
+  generator->StartAllocations(kNumAllocations);
+  ASSERT_EQ_WAIT(kNumAllocations, generator->num_ready(), kTimeoutMs);
+
+  EXPECT_EQ(generator->SendChannelData(kNumAllocations, 100), kNumAllocations);
+  EXPECT_EQ_WAIT(kNumAllocations, num_peer_packets_, kTimeoutMs);
+}
+
+#endif  // defined(WEBRTC_LINUX)
+
+}  // namespace
+}  // namespace cricket
@@ -10,6 +10,7 @@
 
 #include "p2p/base/stun_port.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -33,6 +34,10 @@ const int RETRY_TIMEOUT = 50 * 1000;  // 50 seconds
 // |kSendErrorLogLimit| messages. Start again after a successful send.
 const int kSendErrorLogLimit = 5;
 
+// The most batchable packets that UDPPort::SendTo holds back before handing
+// them to the socket, even if the last packet of the batch has not been seen.
+const size_t kMaxPendingBatchSize = 64;
+
 // Handles a binding request sent to the STUN server.
 class StunBindingRequest : public StunRequest {
  public:
@@ -298,22 +303,75 @@ int UDPPort::SendTo(const void* data,
                     bool payload) {
   rtc::PacketOptions modified_options(options);
   CopyPortInformationToPacketInfo(&modified_options.info_signaled_after_sent);
+  if (options.batchable) {
+    // Hold the packet back until the rest of the burst has arrived, so that
+    // the whole burst can be handed to the socket at once. The caller's buffer
+    // is only valid for the duration of this call.
+    if (pending_batch_data_.size() <= pending_batch_.size())
+      pending_batch_data_.emplace_back();
+    rtc::Buffer& buffer = pending_batch_data_[pending_batch_.size()];
+    buffer.SetData(static_cast<const uint8_t*>(data), size);
+    pending_batch_.emplace_back(buffer.data(), size, addr, modified_options);
+    if (options.last_packet_in_batch ||
+        pending_batch_.size() >= kMaxPendingBatchSize) {
+      SendPendingBatch();
+    } else if (!batch_flush_posted_) {
+      // Makes sure that the packets are sent even if the packet that ends the
+      // batch never comes this way, e.g. because it was sent on another
+      // connection.
+      batch_flush_posted_ = true;
+      thread()->Post(RTC_FROM_HERE, this, MSG_SEND_PENDING_BATCH);
+    }
+    return static_cast<int>(size);
+  }
+
+  // Keep the packets in the order they were sent.
+  SendPendingBatch();
   int sent = socket_->SendTo(data, size, addr, modified_options);
   if (sent < 0) {
-    error_ = socket_->GetError();
-    // Rate limiting added for crbug.com/856088.
-    // TODO(webrtc:9622): Use general rate limiting mechanism once it exists.
-    if (send_error_count_ < kSendErrorLogLimit) {
-      ++send_error_count_;
-      RTC_LOG(LS_ERROR) << ToString() << ": UDP send of " << size
-                        << " bytes failed with error " << error_;
-    }
+    OnSendError(size);
   } else {
     send_error_count_ = 0;
   }
   return sent;
 }
 
+void UDPPort::SendPendingBatch() {
+  if (pending_batch_.empty())
+    return;
+  pending_batch_.back().options.last_packet_in_batch = true;
+  int sent = socket_->SendToBatch(pending_batch_);
+  if (sent < static_cast<int>(pending_batch_.size())) {
+    size_t size = 0;
+    for (size_t i = std::max(sent, 0); i < pending_batch_.size(); ++i)
+      size += pending_batch_[i].size;
+    OnSendError(size);
+  } else {
+    send_error_count_ = 0;
+  }
+  pending_batch_.clear();
+}
+
+void UDPPort::OnSendError(size_t size) {
+  error_ = socket_->GetError();
+  // Rate limiting added for crbug.com/856088.
+  // TODO(webrtc:9622): Use general rate limiting mechanism once it exists.
+  if (send_error_count_ < kSendErrorLogLimit) {
+    ++send_error_count_;
+    RTC_LOG(LS_ERROR) << ToString() << ": UDP send of " << size
+                      << " bytes failed with error " << error_;
+  }
+}
+
+void UDPPort::OnMessage(rtc::Message* pmsg) {
+  if (pmsg->message_id == MSG_SEND_PENDING_BATCH) {
+    batch_flush_posted_ = false;
+    SendPendingBatch();
+    return;
+  }
+  Port::OnMessage(pmsg);
+}
+
 void UDPPort::UpdateNetworkCost() {
   Port::UpdateNetworkCost();
   stun_keepalive_lifetime_ = GetStunKeepaliveLifetime();
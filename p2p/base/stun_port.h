@@ -14,11 +14,13 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "p2p/base/port.h"
 #include "p2p/base/stun_request.h"
 #include "rtc_base/async_packet_socket.h"
+#include "rtc_base/buffer.h"
 
 // TODO(mallinath) - Rename stunport.cc|h to udpport.cc|h.
 
@@ -150,6 +152,8 @@ class UDPPort : public Port {
 
   rtc::DiffServCodePoint StunDscpValue() const override;
 
+  void OnMessage(rtc::Message* pmsg) override;
+
   void OnLocalAddressReady(rtc::AsyncPacketSocket* socket,
                            const rtc::SocketAddress& address);
 
@@ -178,6 +182,8 @@ class UDPPort : public Port {
   bool MaybeSetDefaultLocalAddress(rtc::SocketAddress* addr) const;
 
  private:
+  enum { MSG_SEND_PENDING_BATCH = MSG_FIRST_AVAILABLE };
+
   // A helper class which can be called repeatedly to resolve multiple
   // addresses, as opposed to rtc::AsyncResolverInterface, which can only
   // resolve one address per instance.
@@ -225,6 +231,11 @@ class UDPPort : public Port {
   // Sends STUN requests to the server.
   void OnSendPacket(const void* data, size_t size, StunRequest* req);
 
+  // Hands the batchable packets that SendTo() has held back to the socket in
+  // one SendToBatch() call.
+  void SendPendingBatch();
+  void OnSendError(size_t size);
+
   // TODO(mallinaht) - Move this up to cricket::Port when SignalAddressReady is
   // changed to SignalPortReady.
   void MaybeSetPortCompleteOrError();
@@ -247,6 +258,11 @@ class UDPPort : public Port {
   rtc::AsyncPacketSocket* socket_;
   int error_;
   int send_error_count_ = 0;
+  // Batchable packets waiting for the last packet of their batch, and the
+  // copies of their payloads, which are reused from batch to batch.
+  std::vector<rtc::BatchedPacket> pending_batch_;
+  std::vector<rtc::Buffer> pending_batch_data_;
+  bool batch_flush_posted_ = false;
   std::unique_ptr<AddressResolver> resolver_;
   bool ready_;
   int stun_keepalive_delay_;
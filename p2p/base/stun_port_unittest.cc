@@ -13,6 +13,7 @@
 #include <memory>
 
 #include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/connection.h"
 #include "p2p/base/test_stun_server.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/helpers.h"
@@ -24,6 +25,8 @@
 using cricket::ServerAddresses;
 using rtc::SocketAddress;
 using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Invoke;
 using ::testing::Return;
 
 static const SocketAddress kLocalAddr("127.0.0.1", 0);
@@ -31,6 +34,7 @@ static const SocketAddress kStunAddr1("127.0.0.1", 5000);
 static const SocketAddress kStunAddr2("127.0.0.1", 4000);
 static const SocketAddress kStunAddr3("127.0.0.1", 3000);
 static const SocketAddress kBadAddr("0.0.0.1", 5000);
+static const SocketAddress kRemoteAddr("127.0.0.1", 6000);
 static const SocketAddress kStunHostnameAddr("localhost", 5000);
 static const SocketAddress kBadHostnameAddr("not-a-real-hostname", 5000);
 // STUN timeout (with all retries) is cricket::STUN_TOTAL_TIMEOUT.
@@ -426,6 +430,10 @@ class MockAsyncPacketSocket : public rtc::AsyncPacketSocket {
                const SocketAddress& addr,
                const rtc::PacketOptions& options),
               (override));
+  MOCK_METHOD(int,
+              SendToBatch,
+              (rtc::ArrayView<const rtc::BatchedPacket> packets),
+              (override));
   MOCK_METHOD(int, Close, (), (override));
   MOCK_METHOD(State, GetState, (), (const, override));
   MOCK_METHOD(int,
@@ -462,3 +470,94 @@ TEST_F(StunPortTest, TestStunPacketsHaveDscpPacketOption) {
       .WillRepeatedly(Return(100));
   EXPECT_TRUE_SIMULATED_WAIT(done(), kTimeoutMs, fake_clock);
 }
+
+class StunPortBatchingTest : public StunPortTest {
+ protected:
+  // Creates a UDP port on a mock socket, and a connection from it to
+  // |kRemoteAddr|.
+  MockAsyncPacketSocket* CreatePortAndConnection() {
+    MockAsyncPacketSocket* socket = new MockAsyncPacketSocket();
+    CreateSharedUdpPort(kStunAddr1, socket);
+    EXPECT_CALL(*socket, GetLocalAddress()).WillRepeatedly(Return(kLocalAddr));
+    EXPECT_CALL(*socket, GetState())
+        .WillRepeatedly(Return(rtc::AsyncPacketSocket::STATE_BOUND));
+    EXPECT_CALL(*socket, SendTo(_, _, kStunAddr1, _))
+        .WillRepeatedly(Return(100));
+    PrepareAddress();
+
+    cricket::Candidate remote_candidate;
+    remote_candidate.set_address(kRemoteAddr);
+    remote_candidate.set_protocol(cricket::UDP_PROTOCOL_NAME);
+    connection_ = port()->CreateConnection(
+        remote_candidate, cricket::PortInterface::ORIGIN_MESSAGE);
+    EXPECT_TRUE(connection_ != nullptr);
+    return socket;
+  }
+
+  cricket::Connection* connection_ = nullptr;
+};
+
+// Test that the batchable packets of a burst are held back until the last one,
+// and then handed to the socket together.
+TEST_F(StunPortBatchingTest, SendsBatchablePacketsInOneBatch) {
+  MockAsyncPacketSocket* socket = CreatePortAndConnection();
+  ASSERT_TRUE(connection_ != nullptr);
+  EXPECT_CALL(*socket, SendTo(_, _, kRemoteAddr, _)).Times(0);
+  EXPECT_CALL(*socket, SendToBatch(_))
+      .WillOnce(Invoke([](rtc::ArrayView<const rtc::BatchedPacket> packets) {
+        EXPECT_EQ(packets.size(), 3u);
+        for (size_t i = 0; i < packets.size(); ++i) {
+          EXPECT_EQ(packets[i].addr, kRemoteAddr);
+          EXPECT_EQ(packets[i].size, i + 1);
+          EXPECT_EQ(static_cast<const char*>(packets[i].data)[0], 'a' + i);
+          EXPECT_EQ(packets[i].options.last_packet_in_batch,
+                    i == packets.size() - 1);
+        }
+        return static_cast<int>(packets.size());
+      }));
+
+  rtc::PacketOptions options;
+  options.batchable = true;
+  // The packets are copied, the caller's buffer may be reused right away.
+  char data[3];
+  data[0] = 'a';
+  EXPECT_EQ(connection_->Send(data, 1, options), 1);
+  data[0] = 'b';
+  EXPECT_EQ(connection_->Send(data, 2, options), 2);
+  data[0] = 'c';
+  options.last_packet_in_batch = true;
+  EXPECT_EQ(connection_->Send(data, 3, options), 3);
+}
+
+// Test that packets held back for a batch are sent before a packet that is not
+// batchable, and that a batch which is never ended is sent anyway.
+TEST_F(StunPortBatchingTest, SendsUnfinishedBatch) {
+  MockAsyncPacketSocket* socket = CreatePortAndConnection();
+  ASSERT_TRUE(connection_ != nullptr);
+  const char kData[] = "data";
+  rtc::PacketOptions batchable_options;
+  batchable_options.batchable = true;
+  {
+    InSequence s;
+    EXPECT_CALL(*socket, SendToBatch(_))
+        .WillOnce(Invoke([](rtc::ArrayView<const rtc::BatchedPacket> packets) {
+          EXPECT_EQ(packets.size(), 2u);
+          return static_cast<int>(packets.size());
+        }));
+    EXPECT_CALL(*socket, SendTo(_, _, kRemoteAddr, _)).WillOnce(Return(4));
+  }
+  connection_->Send(kData, 4, batchable_options);
+  connection_->Send(kData, 4, batchable_options);
+  EXPECT_EQ(connection_->Send(kData, 4, rtc::PacketOptions()), 4);
+
+  bool sent = false;
+  EXPECT_CALL(*socket, SendToBatch(_))
+      .WillOnce(Invoke([&](rtc::ArrayView<const rtc::BatchedPacket> packets) {
+        EXPECT_EQ(packets.size(), 1u);
+        EXPECT_TRUE(packets[0].options.last_packet_in_batch);
+        sent = true;
+        return 1;
+      }));
+  connection_->Send(kData, 4, batchable_options);
+  EXPECT_TRUE_SIMULATED_WAIT(sent, kTimeoutMs, fake_clock);
+}
@@ -0,0 +1,262 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/test_turn_load_generator.h"
+
+#include <utility>
+
+#include "api/transport/stun.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/helpers.h"
+
+namespace cricket {
+namespace {
+
+// Every allocation binds the first channel number to the peer.
+constexpr uint16_t kChannelNumber = 0x4000;
+constexpr size_t kChannelDataHeaderSize = 4;
+
+}  // namespace
+
+TestTurnLoadGenerator::TestTurnLoadGenerator(
+    rtc::Thread* thread,
+    const rtc::SocketAddress& server_address,
+    const rtc::SocketAddress& peer_address,
+    const std::string& username,
+    const std::string& password)
+    : thread_(thread),
+      server_address_(server_address),
+      peer_address_(peer_address),
+      username_(username),
+      password_(password) {}
+
+TestTurnLoadGenerator::~TestTurnLoadGenerator() = default;
+
+void TestTurnLoadGenerator::StartAllocations(int count) {
+  RTC_DCHECK(thread_->IsCurrent());
+  for (int i = 0; i < count; ++i) {
+    auto client = std::make_unique<Client>();
+    client->socket.reset(rtc::AsyncUDPSocket::Create(
+        thread_->socketserver(),
+        rtc::SocketAddress(server_address_.ipaddr(), 0)));
+    if (!client->socket) {
+      ++num_failed_;
+      continue;
+    }
+    client->socket->SignalReadPacket.connect(this,
+                                             &TestTurnLoadGenerator::OnPacket);
+    clients_by_socket_[client->socket.get()] = client.get();
+    // The first request is rejected with the realm and nonce to use.
+    SendAllocateRequest(client.get());
+    clients_.push_back(std::move(client));
+  }
+}
+
+int TestTurnLoadGenerator::SendChannelData(int max_packets,
+                                           size_t payload_size) {
+  RTC_DCHECK(thread_->IsCurrent());
+  std::vector<char> packet(kChannelDataHeaderSize + payload_size, 0);
+  rtc::SetBE16(&packet[0], kChannelNumber);
+  rtc::SetBE16(&packet[2], static_cast<uint16_t>(payload_size));
+  return SendToReadyClients(packet, max_packets);
+}
+
+int TestTurnLoadGenerator::SendIndications(int max_packets,
+                                           size_t payload_size) {
+  RTC_DCHECK(thread_->IsCurrent());
+  // Indications are not retransmitted, so the same transaction ID can be used
+  // for all of them.
+  TurnMessage msg;
+  msg.SetType(TURN_SEND_INDICATION);
+  msg.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+  msg.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+      STUN_ATTR_XOR_PEER_ADDRESS, peer_address_));
+  msg.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_DATA, std::string(payload_size, '\0')));
+  rtc::ByteBufferWriter buf;
+  msg.Write(&buf);
+  return SendToReadyClients(
+      std::vector<char>(buf.Data(), buf.Data() + buf.Length()), max_packets);
+}
+
+void TestTurnLoadGenerator::RefreshAllocations() {
+  RTC_DCHECK(thread_->IsCurrent());
+  for (const auto& client : clients_) {
+    if (client->state == State::kReady)
+      SendRefreshRequest(client.get());
+  }
+}
+
+void TestTurnLoadGenerator::RefreshChannels() {
+  RTC_DCHECK(thread_->IsCurrent());
+  for (const auto& client : clients_) {
+    if (client->state == State::kReady)
+      SendChannelBindRequest(client.get());
+  }
+}
+
+std::vector<rtc::SocketAddress> TestTurnLoadGenerator::GetRelayedAddresses()
+    const {
+  std::vector<rtc::SocketAddress> addresses;
+  for (const auto& client : clients_) {
+    if (client->state == State::kReady)
+      addresses.push_back(client->relayed_address);
+  }
+  return addresses;
+}
+
+int TestTurnLoadGenerator::SendToReadyClients(const std::vector<char>& packet,
+                                              int max_packets) {
+  if (num_ready_ == 0)
+    return 0;
+  rtc::PacketOptions options;
+  int num_sent = 0;
+  for (size_t i = 0; i < clients_.size() && num_sent < max_packets; ++i) {
+    Client* client = clients_[next_sender_].get();
+    next_sender_ = (next_sender_ + 1) % clients_.size();
+    if (client->state != State::kReady)
+      continue;
+    if (client->socket->SendTo(packet.data(), packet.size(), server_address_,
+                               options) > 0) {
+      ++num_sent;
+    }
+  }
+  return num_sent;
+}
+
+void TestTurnLoadGenerator::SendAllocateRequest(Client* client) {
+  TurnMessage msg;
+  msg.SetType(STUN_ALLOCATE_REQUEST);
+  auto transport_attr =
+      StunAttribute::CreateUInt32(STUN_ATTR_REQUESTED_TRANSPORT);
+  transport_attr->SetValue(IPPROTO_UDP << 24);
+  msg.AddAttribute(std::move(transport_attr));
+  if (!client->key.empty())
+    AddAuthentication(client, &msg);
+  Send(client, &msg);
+}
+
+void TestTurnLoadGenerator::SendChannelBindRequest(Client* client) {
+  TurnMessage msg;
+  msg.SetType(TURN_CHANNEL_BIND_REQUEST);
+  msg.AddAttribute(std::make_unique<StunUInt32Attribute>(
+      STUN_ATTR_CHANNEL_NUMBER, kChannelNumber << 16));
+  msg.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+      STUN_ATTR_XOR_PEER_ADDRESS, peer_address_));
+  AddAuthentication(client, &msg);
+  Send(client, &msg);
+}
+
+void TestTurnLoadGenerator::SendRefreshRequest(Client* client) {
+  TurnMessage msg;
+  msg.SetType(TURN_REFRESH_REQUEST);
+  AddAuthentication(client, &msg);
+  Send(client, &msg);
+}
+
+void TestTurnLoadGenerator::AddAuthentication(Client* client,
+                                              TurnMessage* msg) {
+  msg->AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, username_));
+  msg->AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_REALM, client->realm));
+  msg->AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_NONCE, client->nonce));
+}
+
+void TestTurnLoadGenerator::Send(Client* client, TurnMessage* msg) {
+  msg->SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+  if (!client->key.empty())
+    msg->AddMessageIntegrity(client->key);
+  rtc::ByteBufferWriter buf;
+  msg->Write(&buf);
+  rtc::PacketOptions options;
+  client->socket->SendTo(buf.Data(), buf.Length(), server_address_, options);
+}
+
+void TestTurnLoadGenerator::OnPacket(rtc::AsyncPacketSocket* socket,
+                                     const char* data,
+                                     size_t size,
+                                     const rtc::SocketAddress& remote_addr,
+                                     const int64_t& /* packet_time_us */) {
+  auto it = clients_by_socket_.find(socket);
+  RTC_DCHECK(it != clients_by_socket_.end());
+  Client* client = it->second;
+
+  if (size >= kChannelDataHeaderSize &&
+      rtc::GetBE16(data) == kChannelNumber) {
+    ++num_channel_data_received_;
+    return;
+  }
+
+  TurnMessage msg;
+  rtc::ByteBufferReader buf(data, size);
+  if (!msg.Read(&buf))
+    return;
+
+  switch (msg.type()) {
+    case STUN_ALLOCATE_ERROR_RESPONSE: {
+      const StunByteStringAttribute* realm = msg.GetByteString(STUN_ATTR_REALM);
+      const StunByteStringAttribute* nonce = msg.GetByteString(STUN_ATTR_NONCE);
+      int code = msg.GetErrorCodeValue();
+      bool retry = (code == STUN_ERROR_UNAUTHORIZED &&
+                    client->state == State::kUnauthorized) ||
+                   code == STUN_ERROR_STALE_NONCE;
+      if (!retry || !realm || !nonce) {
+        Fail(client);
+        return;
+      }
+      client->realm = realm->GetString();
+      client->nonce = nonce->GetString();
+      ComputeStunCredentialHash(username_, client->realm, password_,
+                                &client->key);
+      client->state = State::kAllocating;
+      SendAllocateRequest(client);
+      return;
+    }
+    case STUN_ALLOCATE_RESPONSE: {
+      const StunAddressAttribute* relayed_address =
+          msg.GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS);
+      if (!relayed_address) {
+        Fail(client);
+        return;
+      }
+      client->relayed_address = relayed_address->GetAddress();
+      client->state = State::kBindingChannel;
+      SendChannelBindRequest(client);
+      return;
+    }
+    case TURN_CHANNEL_BIND_RESPONSE:
+      // Responses to RefreshChannels() leave ready allocations as they are.
+      if (client->state == State::kBindingChannel) {
+        client->state = State::kReady;
+        ++num_ready_;
+      }
+      return;
+    case TURN_CHANNEL_BIND_ERROR_RESPONSE:
+    case TURN_REFRESH_ERROR_RESPONSE:
+      Fail(client);
+      return;
+  }
+}
+
+void TestTurnLoadGenerator::Fail(Client* client) {
+  if (client->state == State::kFailed)
+    return;
+  if (client->state == State::kReady)
+    --num_ready_;
+  client->state = State::kFailed;
+  ++num_failed_;
+}
+
+}  // namespace cricket
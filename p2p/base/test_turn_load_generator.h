@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_TEST_TURN_LOAD_GENERATOR_H_
+#define P2P_BASE_TEST_TURN_LOAD_GENERATOR_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+class TurnMessage;
+
+// Drives many UDP TURN allocations against a server, for load tests. Each
+// allocation uses its own local socket, authenticates with a long-term
+// credential, and binds a channel to a single peer address, after which
+// ChannelData can be sent through it. Must be used on |thread|, which handles
+// the socket events.
+class TestTurnLoadGenerator : public sigslot::has_slots<> {
+ public:
+  TestTurnLoadGenerator(rtc::Thread* thread,
+                        const rtc::SocketAddress& server_address,
+                        const rtc::SocketAddress& peer_address,
+                        const std::string& username,
+                        const std::string& password);
+  ~TestTurnLoadGenerator() override;
+
+  // Starts |count| more allocations. Progress is made as |thread| processes
+  // messages.
+  void StartAllocations(int count);
+
+  // Allocations that have a channel bound to the peer.
+  int num_ready() const { return num_ready_; }
+  // Allocations that got an error response.
+  int num_failed() const { return num_failed_; }
+
+  // Sends up to |max_packets| ChannelData messages with |payload_size| bytes,
+  // going round robin over the ready allocations. Returns the number of
+  // messages sent.
+  int SendChannelData(int max_packets, size_t payload_size);
+  // Same as above, but sends the data to the peer in Send indications.
+  int SendIndications(int max_packets, size_t payload_size);
+
+  // Sends a Refresh request on every ready allocation, which restarts its
+  // lifetime but not that of its channel.
+  void RefreshAllocations();
+  // Binds the channel again on every ready allocation, which refreshes the
+  // channel and the permission of the peer.
+  void RefreshChannels();
+
+  // The relayed addresses of the ready allocations, to which the peer can
+  // send data.
+  std::vector<rtc::SocketAddress> GetRelayedAddresses() const;
+  // ChannelData messages received from the peer on all allocations.
+  int num_channel_data_received() const { return num_channel_data_received_; }
+
+ private:
+  enum class State {
+    kUnauthorized,
+    kAllocating,
+    kBindingChannel,
+    kReady,
+    kFailed
+  };
+  struct Client {
+    std::unique_ptr<rtc::AsyncPacketSocket> socket;
+    State state = State::kUnauthorized;
+    std::string realm;
+    std::string nonce;
+    std::string key;
+    rtc::SocketAddress relayed_address;
+  };
+
+  void SendAllocateRequest(Client* client);
+  void SendChannelBindRequest(Client* client);
+  void SendRefreshRequest(Client* client);
+  void AddAuthentication(Client* client, TurnMessage* msg);
+  void Send(Client* client, TurnMessage* msg);
+  int SendToReadyClients(const std::vector<char>& packet, int max_packets);
+  void OnPacket(rtc::AsyncPacketSocket* socket,
+                const char* data,
+                size_t size,
+                const rtc::SocketAddress& remote_addr,
+                const int64_t& packet_time_us);
+  void Fail(Client* client);
+
+  rtc::Thread* const thread_;
+  const rtc::SocketAddress server_address_;
+  const rtc::SocketAddress peer_address_;
+  const std::string username_;
+  const std::string password_;
+  std::vector<std::unique_ptr<Client>> clients_;
+  std::map<rtc::AsyncPacketSocket*, Client*> clients_by_socket_;
+  size_t next_sender_ = 0;
+  int num_ready_ = 0;
+  int num_failed_ = 0;
+  int num_channel_data_received_ = 0;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_TEST_TURN_LOAD_GENERATOR_H_
@@ -10,6 +10,9 @@
 
 #include "p2p/base/turn_server.h"
 
+#include <string.h>
+
+#include <functional>
 #include <memory>
 #include <tuple>  // for std::tie
 #include <utility>
@@ -98,6 +101,41 @@ class TurnServerAllocation::Channel : public rtc::MessageHandler {
   rtc::SocketAddress peer_;
 };
 
+// Finds the peer address and data of a Send indication in place. Returns false
+// unless the message is well formed and has no other attributes than those and
+// SOFTWARE or FINGERPRINT, leaving anything unusual to TurnMessage.
+static bool ParseSendIndication(const char* data,
+                                size_t size,
+                                rtc::SocketAddress* peer,
+                                const char** payload,
+                                size_t* payload_size) {
+  StunMessageView msg;
+  if (!msg.Parse(data, size) || msg.type() != TURN_SEND_INDICATION ||
+      msg.IsLegacy()) {
+    return false;
+  }
+  for (const StunMessageView::Attribute& attribute : msg) {
+    switch (attribute.type) {
+      case STUN_ATTR_XOR_PEER_ADDRESS:
+      case STUN_ATTR_DATA:
+      case STUN_ATTR_SOFTWARE:
+      case STUN_ATTR_FINGERPRINT:
+        break;
+      default:
+        return false;
+    }
+  }
+  // Like TurnMessage, use the first instance of an attribute.
+  StunMessageView::Attribute payload_attribute;
+  if (!msg.GetXorAddress(STUN_ATTR_XOR_PEER_ADDRESS, peer) ||
+      !msg.GetAttribute(STUN_ATTR_DATA, &payload_attribute)) {
+    return false;
+  }
+  *payload = reinterpret_cast<const char*>(payload_attribute.value.data());
+  *payload_size = payload_attribute.value.size();
+  return true;
+}
+
 static bool InitResponse(const StunMessage* req, StunMessage* resp) {
   int resp_type = (req) ? GetStunSuccessResponseType(req->type()) : -1;
   if (resp_type == -1)
@@ -207,11 +245,20 @@ void TurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
   if (size < TURN_CHANNEL_HEADER_SIZE) {
     return;
   }
+  uint16_t msg_type = rtc::GetBE16(data);
+  if (IsTurnChannelData(msg_type) &&
+      RelayChannelData(socket, addr, data, size)) {
+    return;
+  }
   InternalSocketMap::iterator iter = server_sockets_.find(socket);
   RTC_DCHECK(iter != server_sockets_.end());
   TurnServerConnection conn(addr, iter->second, socket);
-  uint16_t msg_type = rtc::GetBE16(data);
   if (!IsTurnChannelData(msg_type)) {
+    // The observer wants to see every parsed message.
+    if (msg_type == TURN_SEND_INDICATION && !stun_message_observer_ &&
+        RelaySendIndication(&conn, data, size)) {
+      return;
+    }
     // This is a STUN message.
     HandleStunMessage(&conn, data, size);
   } else {
@@ -226,6 +273,53 @@ void TurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
   }
 }
 
+bool TurnServer::RelayChannelData(rtc::AsyncPacketSocket* socket,
+                                  const rtc::SocketAddress& addr,
+                                  const char* data,
+                                  size_t size) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  auto it = channel_routes_.find({socket, addr, rtc::GetBE16(data)});
+  if (it == channel_routes_.end())
+    return false;
+  rtc::PacketOptions options;
+  it->second.external_socket->SendTo(data + TURN_CHANNEL_HEADER_SIZE,
+                                     size - TURN_CHANNEL_HEADER_SIZE,
+                                     it->second.peer, options);
+  if (stun_message_observer_ != nullptr) {
+    stun_message_observer_->ReceivedChannelData(data, size);
+  }
+  return true;
+}
+
+bool TurnServer::RelaySendIndication(TurnServerConnection* conn,
+                                     const char* data,
+                                     size_t size) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  rtc::SocketAddress peer;
+  const char* payload;
+  size_t payload_size;
+  if (!ParseSendIndication(data, size, &peer, &payload, &payload_size))
+    return false;
+  TurnServerAllocation* allocation = FindAllocation(conn);
+  return allocation && allocation->RelayToPeer(peer, payload, payload_size);
+}
+
+void TurnServer::AddChannelRoute(TurnServerAllocation* allocation,
+                                 int channel_id,
+                                 const rtc::SocketAddress& peer) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  TurnServerConnection* conn = allocation->conn();
+  channel_routes_[{conn->socket(), conn->src(), channel_id}] = {
+      allocation->external_socket(), peer};
+}
+
+void TurnServer::RemoveChannelRoute(TurnServerAllocation* allocation,
+                                    int channel_id) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  TurnServerConnection* conn = allocation->conn();
+  channel_routes_.erase({conn->socket(), conn->src(), channel_id});
+}
+
 void TurnServer::HandleStunMessage(TurnServerConnection* conn,
                                    const char* data,
                                    size_t size) {
@@ -537,9 +631,28 @@ void TurnServer::SendStun(TurnServerConnection* conn, StunMessage* msg) {
 
 void TurnServer::Send(TurnServerConnection* conn,
                       const rtc::ByteBufferWriter& buf) {
+  Send(conn, buf.Data(), buf.Length());
+}
+
+void TurnServer::Send(TurnServerConnection* conn,
+                      const char* data,
+                      size_t size) {
   RTC_DCHECK(thread_checker_.IsCurrent());
   rtc::PacketOptions options;
-  conn->socket()->SendTo(buf.Data(), buf.Length(), conn->src(), options);
+  conn->socket()->SendTo(data, size, conn->src(), options);
+}
+
+void TurnServer::SendChannelData(TurnServerConnection* conn,
+                                 int channel_id,
+                                 const char* data,
+                                 size_t size) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  channel_data_buffer_.resize(TURN_CHANNEL_HEADER_SIZE + size);
+  char* buffer = channel_data_buffer_.data();
+  rtc::SetBE16(buffer, static_cast<uint16_t>(channel_id));
+  rtc::SetBE16(buffer + 2, static_cast<uint16_t>(size));
+  memcpy(buffer + TURN_CHANNEL_HEADER_SIZE, data, size);
+  Send(conn, buffer, channel_data_buffer_.size());
 }
 
 void TurnServer::OnAllocationDestroyed(TurnServerAllocation* allocation) {
@@ -588,10 +701,26 @@ TurnServerConnection::TurnServerConnection(const rtc::SocketAddress& src,
                                            ProtocolType proto,
                                            rtc::AsyncPacketSocket* socket)
     : src_(src),
-      dst_(socket->GetRemoteAddress()),
+      // UDP sockets are shared by all the clients, and not connected.
+      dst_(proto == PROTO_UDP ? rtc::SocketAddress()
+                              : socket->GetRemoteAddress()),
       proto_(proto),
       socket_(socket) {}
 
+size_t TurnServer::ChannelRouteKey::Hash::operator()(
+    const ChannelRouteKey& key) const {
+  size_t hash = std::hash<rtc::AsyncPacketSocket*>()(key.socket);
+  hash = hash * 31 + key.src.Hash();
+  return hash * 31 + key.channel_id;
+}
+
+size_t TurnServerConnection::Hash::operator()(
+    const TurnServerConnection& conn) const {
+  size_t hash = conn.src_.Hash();
+  hash = hash * 31 + conn.dst_.Hash();
+  return hash * 31 + conn.proto_;
+}
+
 bool TurnServerConnection::operator==(const TurnServerConnection& c) const {
   return src_ == c.src_ && dst_ == c.dst_ && proto_ == c.proto_;
 }
@@ -625,6 +754,7 @@ TurnServerAllocation::TurnServerAllocation(TurnServer* server,
 TurnServerAllocation::~TurnServerAllocation() {
   for (ChannelList::iterator it = channels_.begin(); it != channels_.end();
        ++it) {
+    server_->RemoveChannelRoute(this, (*it)->id());
     delete *it;
   }
   for (PermissionList::iterator it = perms_.begin(); it != perms_.end(); ++it) {
@@ -810,6 +940,7 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
     channel1->SignalDestroyed.connect(
         this, &TurnServerAllocation::OnChannelDestroyed);
     channels_.push_back(channel1);
+    server_->AddChannelRoute(this, channel_id, peer_attr->GetAddress());
   } else {
     channel1->Refresh();
   }
@@ -841,6 +972,15 @@ void TurnServerAllocation::HandleChannelData(const char* data, size_t size) {
   }
 }
 
+bool TurnServerAllocation::RelayToPeer(const rtc::SocketAddress& peer,
+                                       const char* data,
+                                       size_t size) {
+  if (!HasPermission(peer.ipaddr()))
+    return false;
+  SendExternal(data, size, peer);
+  return true;
+}
+
 void TurnServerAllocation::OnExternalPacket(
     rtc::AsyncPacketSocket* socket,
     const char* data,
@@ -851,11 +991,7 @@ void TurnServerAllocation::OnExternalPacket(
   Channel* channel = FindChannel(addr);
   if (channel) {
     // There is a channel bound to this address. Send as a channel message.
-    rtc::ByteBufferWriter buf;
-    buf.WriteUInt16(channel->id());
-    buf.WriteUInt16(static_cast<uint16_t>(size));
-    buf.WriteBytes(data, size);
-    server_->Send(&conn_, buf);
+    server_->SendChannelData(&conn_, channel->id(), data, size);
   } else if (!server_->enable_permission_checks_ ||
              HasPermission(addr.ipaddr())) {
     // No channel, but a permission exists. Send as a data indication.
@@ -969,6 +1105,7 @@ void TurnServerAllocation::OnChannelDestroyed(Channel* channel) {
   auto it = absl::c_find(channels_, channel);
   RTC_DCHECK(it != channels_.end());
   channels_.erase(it);
+  server_->RemoveChannelRoute(this, channel->id());
 }
 
 TurnServerAllocation::Permission::Permission(rtc::Thread* thread,
@@ -16,6 +16,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -44,6 +45,10 @@ const int TURN_SERVER_PORT = 3478;
 // Encapsulates the client's connection to the server.
 class TurnServerConnection {
  public:
+  struct Hash {
+    size_t operator()(const TurnServerConnection& conn) const;
+  };
+
   TurnServerConnection() : proto_(PROTO_UDP), socket_(NULL) {}
   TurnServerConnection(const rtc::SocketAddress& src,
                        ProtocolType proto,
@@ -77,6 +82,7 @@ class TurnServerAllocation : public rtc::MessageHandler,
   ~TurnServerAllocation() override;
 
   TurnServerConnection* conn() { return &conn_; }
+  rtc::AsyncPacketSocket* external_socket() { return external_socket_.get(); }
   const std::string& key() const { return key_; }
   const std::string& transaction_id() const { return transaction_id_; }
   const std::string& username() const { return username_; }
@@ -88,6 +94,11 @@ class TurnServerAllocation : public rtc::MessageHandler,
 
   void HandleTurnMessage(const TurnMessage* msg);
   void HandleChannelData(const char* data, size_t size);
+  // Sends the data of a Send indication to |peer| if there is a permission
+  // for it. Returns false, without logging, if there is none.
+  bool RelayToPeer(const rtc::SocketAddress& peer,
+                   const char* data,
+                   size_t size);
 
   sigslot::signal1<TurnServerAllocation*> SignalDestroyed;
 
@@ -175,7 +186,9 @@ class StunMessageObserver {
 // Not yet wired up: TCP support.
 class TurnServer : public sigslot::has_slots<> {
  public:
-  typedef std::map<TurnServerConnection, std::unique_ptr<TurnServerAllocation>>
+  typedef std::unordered_map<TurnServerConnection,
+                             std::unique_ptr<TurnServerAllocation>,
+                             TurnServerConnection::Hash>
       AllocationMap;
 
   explicit TurnServer(rtc::Thread* thread);
@@ -303,8 +316,31 @@ class TurnServer : public sigslot::has_slots<> {
                                             const StunMessage* req,
                                             const rtc::SocketAddress& addr);
 
+  // Fast paths for data from the clients, which relay it without parsing a
+  // TurnMessage. They return false if the packet is to be handled by the
+  // generic path instead.
+  bool RelayChannelData(rtc::AsyncPacketSocket* socket,
+                        const rtc::SocketAddress& addr,
+                        const char* data,
+                        size_t size);
+  bool RelaySendIndication(TurnServerConnection* conn,
+                           const char* data,
+                           size_t size);
+
+  // Keep |channel_routes_| in sync with the channels of the allocations.
+  void AddChannelRoute(TurnServerAllocation* allocation,
+                       int channel_id,
+                       const rtc::SocketAddress& peer);
+  void RemoveChannelRoute(TurnServerAllocation* allocation, int channel_id);
+
   void SendStun(TurnServerConnection* conn, StunMessage* msg);
   void Send(TurnServerConnection* conn, const rtc::ByteBufferWriter& buf);
+  void Send(TurnServerConnection* conn, const char* data, size_t size);
+  // Sends |data| from a peer to the client as ChannelData.
+  void SendChannelData(TurnServerConnection* conn,
+                       int channel_id,
+                       const char* data,
+                       size_t size);
 
   void OnAllocationDestroyed(TurnServerAllocation* allocation);
   void DestroyInternalSocket(rtc::AsyncPacketSocket* socket);
@@ -315,6 +351,30 @@ class TurnServer : public sigslot::has_slots<> {
   typedef std::map<rtc::AsyncPacketSocket*, ProtocolType> InternalSocketMap;
   typedef std::map<rtc::AsyncSocket*, ProtocolType> ServerSocketMap;
 
+  // A channel, as identified by the ChannelData sent on it: the internal
+  // socket and client address it arrives from, and its channel number.
+  struct ChannelRouteKey {
+    struct Hash {
+      size_t operator()(const ChannelRouteKey& key) const;
+    };
+    bool operator==(const ChannelRouteKey& o) const {
+      return socket == o.socket && channel_id == o.channel_id && src == o.src;
+    }
+
+    rtc::AsyncPacketSocket* socket;
+    rtc::SocketAddress src;
+    int channel_id;
+  };
+  // Where the data on a channel goes.
+  struct ChannelRoute {
+    rtc::AsyncPacketSocket* external_socket;
+    rtc::SocketAddress peer;
+  };
+  typedef std::unordered_map<ChannelRouteKey,
+                             ChannelRoute,
+                             ChannelRouteKey::Hash>
+      ChannelRouteMap;
+
   rtc::Thread* thread_;
   rtc::ThreadChecker thread_checker_;
   std::string nonce_key_;
@@ -336,7 +396,13 @@ class TurnServer : public sigslot::has_slots<> {
   std::unique_ptr<rtc::PacketSocketFactory> external_socket_factory_;
   rtc::SocketAddress external_addr_;
 
+  // Every bound channel of |allocations_|, so that ChannelData can be relayed
+  // with a single lookup. Declared first, as the allocations remove their
+  // channels when destroyed.
+  ChannelRouteMap channel_routes_;
   AllocationMap allocations_;
+  // Reused to frame the ChannelData sent to the clients.
+  std::vector<char> channel_data_buffer_;
 
   rtc::AsyncInvoker invoker_;
 
@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/transport/stun.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/test_turn_load_generator.h"
+#include "p2p/base/turn_server.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+
+namespace cricket {
+namespace {
+
+constexpr int kNumAllocations = 100;
+constexpr size_t kPayloadSize = 160;
+const rtc::SocketAddress kServerAddress("99.99.99.1", 3478);
+const rtc::SocketAddress kPeerAddress("99.99.99.2", 5000);
+constexpr char kUsername[] = "user";
+
+class TestTurnAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(username, realm, username, key);
+  }
+};
+
+// A TurnServer, set up the way examples/turnserver does, with
+// |kNumAllocations| ready allocations, all bound to one peer. Runs over a
+// VirtualSocketServer, so that mostly the cost of the server is measured.
+class TurnServerRelay : public sigslot::has_slots<> {
+ public:
+  TurnServerRelay() : thread_(&socket_server_), server_(&thread_) {
+    server_.set_realm("realm");
+    server_.set_software("libjingle TurnServer");
+    server_.set_auth_hook(&auth_);
+    server_.AddInternalSocket(
+        rtc::AsyncUDPSocket::Create(&socket_server_, kServerAddress),
+        PROTO_UDP);
+    server_.SetExternalSocketFactory(
+        new rtc::BasicPacketSocketFactory(&thread_),
+        rtc::SocketAddress(kServerAddress.ipaddr(), 0));
+    peer_.reset(rtc::AsyncUDPSocket::Create(&socket_server_, kPeerAddress));
+    peer_->SignalReadPacket.connect(this, &TurnServerRelay::OnPeerPacket);
+
+    generator_ = std::make_unique<TestTurnLoadGenerator>(
+        &thread_, kServerAddress, kPeerAddress, kUsername, kUsername);
+    generator_->StartAllocations(kNumAllocations);
+    while (generator_->num_ready() + generator_->num_failed() <
+           kNumAllocations) {
+      thread_.ProcessMessages(0);
+    }
+    RTC_CHECK_EQ(generator_->num_ready(), kNumAllocations);
+    relayed_addresses_ = generator_->GetRelayedAddresses();
+  }
+
+  // Sends a packet on every allocation, and waits for the peer to get them.
+  void RelayChannelData() {
+    int expected = num_peer_packets_ +
+                   generator_->SendChannelData(kNumAllocations, kPayloadSize);
+    while (num_peer_packets_ < expected)
+      thread_.ProcessMessages(0);
+  }
+
+  void RelaySendIndications() {
+    int expected = num_peer_packets_ +
+                   generator_->SendIndications(kNumAllocations, kPayloadSize);
+    while (num_peer_packets_ < expected)
+      thread_.ProcessMessages(0);
+  }
+
+  // Sends a packet from the peer to every allocation, and waits for the
+  // clients to get them as ChannelData.
+  void RelayToClients() {
+    const std::vector<char> payload(kPayloadSize, 0);
+    rtc::PacketOptions options;
+    for (const rtc::SocketAddress& address : relayed_addresses_)
+      peer_->SendTo(payload.data(), payload.size(), address, options);
+    int expected = num_client_packets_ + kNumAllocations;
+    while (generator_->num_channel_data_received() < expected)
+      thread_.ProcessMessages(0);
+    num_client_packets_ = expected;
+  }
+
+ private:
+  void OnPeerPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    ++num_peer_packets_;
+  }
+
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  TestTurnAuth auth_;
+  TurnServer server_;
+  std::unique_ptr<rtc::AsyncPacketSocket> peer_;
+  std::unique_ptr<TestTurnLoadGenerator> generator_;
+  std::vector<rtc::SocketAddress> relayed_addresses_;
+  int num_peer_packets_ = 0;
+  int num_client_packets_ = 0;
+};
+
+void BM_TurnServerRelayChannelData(benchmark::State& state) {
+  TurnServerRelay relay;
+  for (auto _ : state)
+    relay.RelayChannelData();
+  state.SetItemsProcessed(state.iterations() * kNumAllocations);
+}
+BENCHMARK(BM_TurnServerRelayChannelData);
+
+void BM_TurnServerRelaySendIndication(benchmark::State& state) {
+  TurnServerRelay relay;
+  for (auto _ : state)
+    relay.RelaySendIndications();
+  state.SetItemsProcessed(state.iterations() * kNumAllocations);
+}
+BENCHMARK(BM_TurnServerRelaySendIndication);
+
+void BM_TurnServerRelayToClient(benchmark::State& state) {
+  TurnServerRelay relay;
+  for (auto _ : state)
+    relay.RelayToClients();
+  state.SetItemsProcessed(state.iterations() * kNumAllocations);
+}
+BENCHMARK(BM_TurnServerRelayToClient);
+
+}  // namespace
+}  // namespace cricket
@@ -10,12 +10,25 @@
 
 #include "p2p/base/turn_server.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/transport/stun.h"
+#include "api/units/time_delta.h"
 #include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/test_turn_load_generator.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/virtual_socket_server.h"
+#include "test/gmock.h"
 #include "test/gtest.h"
 
 // NOTE: This is a work in progress. Currently this file only has tests for
-// TurnServerConnection, a primitive class used by TurnServer.
+// TurnServerConnection, a primitive class used by TurnServer, and for the
+// relaying of data from the clients to the peers.
 
 namespace cricket {
 
@@ -64,4 +77,195 @@ TEST_F(TurnServerConnectionTest, ComparisonOperators) {
   ExpectNotEqual(connection1, connection4);
 }
 
+namespace {
+
+const rtc::SocketAddress kServerAddress("99.99.99.1", 3478);
+const rtc::SocketAddress kPeerAddress("99.99.99.2", 5000);
+constexpr char kUsername[] = "user";
+constexpr size_t kPayloadSize = 100;
+constexpr uint16_t kChannelNumber = 0x4000;
+constexpr size_t kChannelDataHeaderSize = 4;
+
+class TestTurnAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(username, realm, username, key);
+  }
+};
+
+class CountingStunMessageObserver : public StunMessageObserver {
+ public:
+  explicit CountingStunMessageObserver(int* num_channel_data)
+      : num_channel_data_(num_channel_data) {}
+  void ReceivedMessage(const TurnMessage* msg) override {}
+  void ReceivedChannelData(const char* data, size_t size) override {
+    ++*num_channel_data_;
+  }
+
+ private:
+  int* const num_channel_data_;
+};
+
+}  // namespace
+
+// Tests the relaying of ChannelData and Send indications from the clients to
+// the peer, which usually bypasses the parsing of a TurnMessage.
+class TurnServerRelayTest : public ::testing::Test,
+                            public sigslot::has_slots<> {
+ public:
+  TurnServerRelayTest() : thread_(&vss_), server_(&thread_) {
+    fake_clock_.AdvanceTime(webrtc::TimeDelta::Seconds(1));
+    server_.set_realm("realm");
+    server_.set_auth_hook(&auth_);
+    server_.AddInternalSocket(
+        rtc::AsyncUDPSocket::Create(&vss_, kServerAddress), PROTO_UDP);
+    server_.SetExternalSocketFactory(
+        new rtc::BasicPacketSocketFactory(&thread_),
+        rtc::SocketAddress(kServerAddress.ipaddr(), 0));
+    peer_.reset(rtc::AsyncUDPSocket::Create(&vss_, kPeerAddress));
+    peer_->SignalReadPacket.connect(this, &TurnServerRelayTest::OnPeerPacket);
+  }
+
+  void CreateAllocations(int count) {
+    generator_ = std::make_unique<TestTurnLoadGenerator>(
+        &thread_, kServerAddress, kPeerAddress, kUsername, kUsername);
+    generator_->StartAllocations(count);
+    ProcessMessages();
+    ASSERT_EQ(generator_->num_ready(), count);
+  }
+
+  void ProcessMessages() { thread_.ProcessMessages(0); }
+
+  void AdvanceTime(webrtc::TimeDelta delta) {
+    fake_clock_.AdvanceTime(delta);
+    ProcessMessages();
+  }
+
+  // Sends ChannelData on every allocation and returns the number of packets
+  // that reached the peer.
+  int RelayChannelData() {
+    peer_packets_.clear();
+    generator_->SendChannelData(generator_->num_ready(), kPayloadSize);
+    ProcessMessages();
+    return static_cast<int>(peer_packets_.size());
+  }
+
+  int RelaySendIndications() {
+    peer_packets_.clear();
+    generator_->SendIndications(generator_->num_ready(), kPayloadSize);
+    ProcessMessages();
+    return static_cast<int>(peer_packets_.size());
+  }
+
+ protected:
+  void OnPeerPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    EXPECT_EQ(size, kPayloadSize);
+    peer_packets_.push_back(remote_addr);
+  }
+
+  rtc::ScopedFakeClock fake_clock_;
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  TestTurnAuth auth_;
+  TurnServer server_;
+  std::unique_ptr<rtc::AsyncPacketSocket> peer_;
+  std::unique_ptr<TestTurnLoadGenerator> generator_;
+  // The source addresses of the packets received by the peer.
+  std::vector<rtc::SocketAddress> peer_packets_;
+};
+
+TEST_F(TurnServerRelayTest, RelaysChannelDataFromTheAllocationOfTheClient) {
+  CreateAllocations(3);
+  // All clients use the same channel number, so the packets have to be told
+  // apart by the address they come from.
+  EXPECT_EQ(RelayChannelData(), 3);
+  EXPECT_THAT(peer_packets_, ::testing::UnorderedElementsAreArray(
+                                 generator_->GetRelayedAddresses()));
+}
+
+TEST_F(TurnServerRelayTest, RelaysSendIndications) {
+  CreateAllocations(3);
+  EXPECT_EQ(RelaySendIndications(), 3);
+  EXPECT_THAT(peer_packets_, ::testing::UnorderedElementsAreArray(
+                                 generator_->GetRelayedAddresses()));
+}
+
+TEST_F(TurnServerRelayTest, DropsChannelDataFromAddressWithoutAllocation) {
+  CreateAllocations(1);
+  std::unique_ptr<rtc::AsyncPacketSocket> other_client(
+      rtc::AsyncUDPSocket::Create(
+          &vss_, rtc::SocketAddress(kServerAddress.ipaddr(), 0)));
+  std::vector<char> packet(kChannelDataHeaderSize + kPayloadSize, 0);
+  rtc::SetBE16(&packet[0], kChannelNumber);
+  rtc::SetBE16(&packet[2], kPayloadSize);
+  rtc::PacketOptions options;
+  other_client->SendTo(packet.data(), packet.size(), kServerAddress, options);
+  ProcessMessages();
+  EXPECT_TRUE(peer_packets_.empty());
+}
+
+TEST_F(TurnServerRelayTest, OnlyChannelDataIsRelayedAfterPermissionExpires) {
+  CreateAllocations(1);
+  // The permission installed by the channel binding expires after 5 minutes,
+  // the channel after 10.
+  AdvanceTime(webrtc::TimeDelta::Seconds(6 * 60));
+  EXPECT_EQ(RelayChannelData(), 1);
+  EXPECT_EQ(RelaySendIndications(), 0);
+
+  generator_->RefreshChannels();
+  ProcessMessages();
+  EXPECT_EQ(RelaySendIndications(), 1);
+}
+
+TEST_F(TurnServerRelayTest, StopsRelayingChannelDataWhenChannelExpires) {
+  CreateAllocations(2);
+  AdvanceTime(webrtc::TimeDelta::Seconds(9 * 60));
+  generator_->RefreshAllocations();
+  ProcessMessages();
+  AdvanceTime(webrtc::TimeDelta::Seconds(2 * 60));
+  ASSERT_EQ(generator_->num_ready(), 2);
+  EXPECT_EQ(RelayChannelData(), 0);
+
+  // Binding the channel again restores the route.
+  generator_->RefreshChannels();
+  ProcessMessages();
+  EXPECT_EQ(RelayChannelData(), 2);
+}
+
+TEST_F(TurnServerRelayTest, KeepsRelayingChannelDataWhenChannelIsRefreshed) {
+  CreateAllocations(2);
+  for (int i = 0; i < 3; ++i) {
+    AdvanceTime(webrtc::TimeDelta::Seconds(4 * 60));
+    generator_->RefreshAllocations();
+    generator_->RefreshChannels();
+    ProcessMessages();
+    EXPECT_EQ(RelayChannelData(), 2);
+  }
+}
+
+TEST_F(TurnServerRelayTest, StopsRelayingWhenAllocationExpires) {
+  CreateAllocations(2);
+  AdvanceTime(webrtc::TimeDelta::Seconds(11 * 60));
+  EXPECT_EQ(RelayChannelData(), 0);
+  EXPECT_EQ(RelaySendIndications(), 0);
+}
+
+TEST_F(TurnServerRelayTest, RelaysThroughStunMessageObserver) {
+  int num_channel_data = 0;
+  server_.SetStunMessageObserver(
+      std::make_unique<CountingStunMessageObserver>(&num_channel_data));
+  CreateAllocations(2);
+  // Send indications are parsed for the observer, ChannelData is only passed
+  // on to it.
+  EXPECT_EQ(RelaySendIndications(), 2);
+  EXPECT_EQ(RelayChannelData(), 2);
+  EXPECT_EQ(num_channel_data, 2);
+}
+
 }  // namespace cricket
@@ -0,0 +1,358 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/client/shared_socket_port_allocator.h"
+
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "api/transport/stun.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace cricket {
+
+namespace {
+
+// Returns the ufrag of the agent a connectivity check is addressed to, which
+// is the first part of its USERNAME.
+bool GetLocalUfrag(const char* data, size_t size, absl::string_view* ufrag) {
+  StunMessageView msg;
+  absl::string_view username;
+  if (!msg.Parse(data, size) || msg.type() != STUN_BINDING_REQUEST ||
+      !msg.GetByteString(STUN_ATTR_USERNAME, &username)) {
+    return false;
+  }
+  size_t colon = username.find(':');
+  if (colon == absl::string_view::npos) {
+    return false;
+  }
+  *ufrag = username.substr(0, colon);
+  return true;
+}
+
+}  // namespace
+
+class SharedSocketPortAllocator::SessionSocket : public rtc::AsyncPacketSocket {
+ public:
+  explicit SessionSocket(SharedSocketPortAllocator* allocator)
+      : allocator_(allocator) {
+    allocator_->session_sockets_.insert(this);
+  }
+  ~SessionSocket() override { allocator_->session_sockets_.erase(this); }
+
+  rtc::SocketAddress GetLocalAddress() const override {
+    return allocator_->socket_->GetLocalAddress();
+  }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    RTC_NOTREACHED();
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    return allocator_->SendTo(this, pv, cb, addr, options);
+  }
+  int SendToBatch(rtc::ArrayView<const rtc::BatchedPacket> packets) override {
+    return allocator_->SendToBatch(this, packets);
+  }
+  // The shared socket stays open.
+  int Close() override { return 0; }
+  State GetState() const override { return allocator_->socket_->GetState(); }
+  // Options are those of the shared socket.
+  int GetOption(rtc::Socket::Option opt, int* value) override {
+    return allocator_->socket_->GetOption(opt, value);
+  }
+  int SetOption(rtc::Socket::Option opt, int value) override {
+    return allocator_->socket_->SetOption(opt, value);
+  }
+  int GetError() const override { return allocator_->socket_->GetError(); }
+  void SetError(int error) override { allocator_->socket_->SetError(error); }
+
+ private:
+  SharedSocketPortAllocator* const allocator_;
+};
+
+SharedSocketPortAllocator::SharedSocketPortAllocator(
+    rtc::Thread* network_thread,
+    rtc::PacketSocketFactory* socket_factory,
+    rtc::Network* network,
+    std::unique_ptr<rtc::AsyncPacketSocket> socket)
+    : network_thread_(network_thread),
+      socket_factory_(socket_factory),
+      network_(network),
+      socket_(std::move(socket)) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  RTC_DCHECK(socket_);
+  socket_->SignalReadPacket.connect(this,
+                                    &SharedSocketPortAllocator::OnReadPacket);
+  socket_->SignalSentPacket.connect(this,
+                                    &SharedSocketPortAllocator::OnSentPacket);
+  socket_->SignalReadyToSend.connect(this,
+                                     &SharedSocketPortAllocator::OnReadyToSend);
+  Initialize();
+}
+
+SharedSocketPortAllocator::~SharedSocketPortAllocator() {
+  CheckRunOnValidThreadIfInitialized();
+  // Sessions are removed as they are destroyed.
+  DiscardCandidatePool();
+}
+
+PortAllocatorSession* SharedSocketPortAllocator::CreateSessionInternal(
+    const std::string& content_name,
+    int component,
+    const std::string& ice_ufrag,
+    const std::string& ice_pwd) {
+  CheckRunOnValidThreadAndInitialized();
+  return new SharedSocketPortAllocatorSession(this, content_name, component,
+                                              ice_ufrag, ice_pwd);
+}
+
+void SharedSocketPortAllocator::AddSession(
+    SharedSocketPortAllocatorSession* session) {
+  auto result = sessions_by_ufrag_.insert(
+      std::make_pair(session->ice_ufrag(), session));
+  if (!result.second) {
+    RTC_LOG(LS_WARNING) << "Two allocator sessions with ufrag "
+                        << session->ice_ufrag()
+                        << ", checks go to the newer one.";
+    result.first->second = session;
+  }
+}
+
+void SharedSocketPortAllocator::RemoveSession(
+    SharedSocketPortAllocatorSession* session,
+    const std::string& ice_ufrag) {
+  auto it = sessions_by_ufrag_.find(ice_ufrag);
+  if (it != sessions_by_ufrag_.end() && it->second == session) {
+    sessions_by_ufrag_.erase(it);
+  }
+  sessions_by_remote_address_.EraseValue(session);
+}
+
+std::unique_ptr<rtc::AsyncPacketSocket>
+SharedSocketPortAllocator::CreateSessionSocket() {
+  return std::make_unique<SessionSocket>(this);
+}
+
+int SharedSocketPortAllocator::SendTo(SessionSocket* from,
+                                      const void* data,
+                                      size_t size,
+                                      const rtc::SocketAddress& addr,
+                                      const rtc::PacketOptions& options) {
+  sending_socket_ = from;
+  int result = socket_->SendTo(data, size, addr, options);
+  sending_socket_ = nullptr;
+  return result;
+}
+
+int SharedSocketPortAllocator::SendToBatch(
+    SessionSocket* from,
+    rtc::ArrayView<const rtc::BatchedPacket> packets) {
+  sending_socket_ = from;
+  int result = socket_->SendToBatch(packets);
+  sending_socket_ = nullptr;
+  return result;
+}
+
+void SharedSocketPortAllocator::OnReadPacket(
+    rtc::AsyncPacketSocket* socket,
+    const char* data,
+    size_t size,
+    const rtc::SocketAddress& remote_addr,
+    const int64_t& packet_time_us) {
+  RTC_DCHECK(socket == socket_.get());
+  SharedSocketPortAllocatorSession* session = nullptr;
+  // A connectivity check is for the session it names, which also lets a peer
+  // move to another session on an ICE restart.
+  absl::string_view ufrag;
+  bool is_check = GetLocalUfrag(data, size, &ufrag);
+  if (is_check) {
+    auto it = sessions_by_ufrag_.find(std::string(ufrag));
+    if (it != sessions_by_ufrag_.end()) {
+      session = it->second;
+    }
+  }
+  if (!session) {
+    session = sessions_by_remote_address_.Find(remote_addr);
+  }
+  if (!session) {
+    ++num_dropped_packets_;
+    return;
+  }
+  // Only a check the port accepted decides where the sender's packets go, so
+  // that a forged check can't take them away from their session.
+  if (session->HandleIncomingPacket(data, size, remote_addr, packet_time_us) &&
+      is_check) {
+    sessions_by_remote_address_.Set(remote_addr, session);
+  }
+}
+
+void SharedSocketPortAllocator::OnSentPacket(
+    rtc::AsyncPacketSocket* socket,
+    const rtc::SentPacket& sent_packet) {
+  if (sending_socket_) {
+    sending_socket_->SignalSentPacket(sending_socket_, sent_packet);
+  }
+}
+
+void SharedSocketPortAllocator::OnReadyToSend(rtc::AsyncPacketSocket* socket) {
+  // Copied, since the sessions may go away when their ports can send again.
+  std::vector<SessionSocket*> session_sockets(session_sockets_.begin(),
+                                              session_sockets_.end());
+  for (SessionSocket* session_socket : session_sockets) {
+    if (session_sockets_.count(session_socket)) {
+      session_socket->SignalReadyToSend(session_socket);
+    }
+  }
+}
+
+SharedSocketPortAllocatorSession::SharedSocketPortAllocatorSession(
+    SharedSocketPortAllocator* allocator,
+    const std::string& content_name,
+    int component,
+    const std::string& ice_ufrag,
+    const std::string& ice_pwd)
+    : PortAllocatorSession(content_name,
+                           component,
+                           ice_ufrag,
+                           ice_pwd,
+                           allocator->flags()),
+      allocator_(allocator),
+      registered_ufrag_(ice_ufrag),
+      socket_(allocator->CreateSessionSocket()) {
+  allocator_->AddSession(this);
+}
+
+SharedSocketPortAllocatorSession::~SharedSocketPortAllocatorSession() {
+  allocator_->RemoveSession(this, registered_ufrag_);
+}
+
+void SharedSocketPortAllocatorSession::SetCandidateFilter(uint32_t filter) {
+  candidate_filter_ = filter;
+}
+
+void SharedSocketPortAllocatorSession::StartGettingPorts() {
+  running_ = true;
+  if (port_) {
+    return;
+  }
+  port_ = UDPPort::Create(allocator_->network_thread_,
+                          allocator_->socket_factory_, allocator_->network_,
+                          socket_.get(), username(), password(), std::string(),
+                          /*emit_local_for_anyaddress=*/false,
+                          /*stun_keepalive_interval=*/absl::nullopt);
+  if (!port_) {
+    RTC_LOG(LS_ERROR) << "Failed to create a port for ufrag " << username();
+    allocation_done_ = true;
+    SignalCandidatesAllocationDone(this);
+    return;
+  }
+  port_->set_component(component());
+  port_->set_generation(generation());
+  port_->SignalPortComplete.connect(
+      this, &SharedSocketPortAllocatorSession::OnPortComplete);
+  port_->SignalDestroyed.connect(
+      this, &SharedSocketPortAllocatorSession::OnPortDestroyed);
+  port_->PrepareAddress();
+  SignalPortReady(this, port_.get());
+  port_->KeepAliveUntilPruned();
+}
+
+void SharedSocketPortAllocatorSession::StopGettingPorts() {
+  running_ = false;
+}
+
+bool SharedSocketPortAllocatorSession::IsGettingPorts() {
+  return running_;
+}
+
+void SharedSocketPortAllocatorSession::ClearGettingPorts() {
+  cleared_ = true;
+}
+
+bool SharedSocketPortAllocatorSession::IsCleared() const {
+  return cleared_;
+}
+
+std::vector<PortInterface*> SharedSocketPortAllocatorSession::ReadyPorts()
+    const {
+  std::vector<PortInterface*> ports;
+  if (port_) {
+    ports.push_back(port_.get());
+  }
+  return ports;
+}
+
+std::vector<Candidate> SharedSocketPortAllocatorSession::ReadyCandidates()
+    const {
+  return CandidatePassesFilter() ? candidates_ : std::vector<Candidate>();
+}
+
+bool SharedSocketPortAllocatorSession::CandidatesAllocationDone() const {
+  return allocation_done_;
+}
+
+void SharedSocketPortAllocatorSession::PruneAllPorts() {
+  if (port_) {
+    port_->Prune();
+  }
+}
+
+bool SharedSocketPortAllocatorSession::HandleIncomingPacket(
+    const char* data,
+    size_t size,
+    const rtc::SocketAddress& remote_addr,
+    int64_t packet_time_us) {
+  if (!port_) {
+    return false;
+  }
+  port_->HandleIncomingPacket(socket_.get(), data, size, remote_addr,
+                              packet_time_us);
+  // The port may have been destroyed meanwhile.
+  return port_ && port_->GetConnection(remote_addr) != nullptr;
+}
+
+void SharedSocketPortAllocatorSession::UpdateIceParametersInternal() {
+  allocator_->RemoveSession(this, registered_ufrag_);
+  registered_ufrag_ = ice_ufrag();
+  allocator_->AddSession(this);
+  if (port_) {
+    port_->SetIceParameters(component(), ice_ufrag(), ice_pwd());
+  }
+}
+
+void SharedSocketPortAllocatorSession::OnPortComplete(Port* port) {
+  candidates_ = port->Candidates();
+  if (CandidatePassesFilter()) {
+    SignalCandidatesReady(this, candidates_);
+  }
+  allocation_done_ = true;
+  SignalCandidatesAllocationDone(this);
+}
+
+void SharedSocketPortAllocatorSession::OnPortDestroyed(PortInterface* port) {
+  RTC_DCHECK_EQ(port, port_.get());
+  // The port deletes itself.
+  port_.release();
+}
+
+bool SharedSocketPortAllocatorSession::CandidatePassesFilter() const {
+  return (candidate_filter_ & CF_HOST) != 0;
+}
+
+}  // namespace cricket
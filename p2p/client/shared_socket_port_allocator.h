@@ -0,0 +1,164 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_CLIENT_SHARED_SOCKET_PORT_ALLOCATOR_H_
+#define P2P_CLIENT_SHARED_SOCKET_PORT_ALLOCATOR_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "api/array_view.h"
+#include "api/packet_socket_factory.h"
+#include "p2p/base/address_hash_table.h"
+#include "p2p/base/port_allocator.h"
+#include "p2p/base/stun_port.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/network.h"
+#include "rtc_base/network/sent_packet.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+class SharedSocketPortAllocatorSession;
+
+// A port allocator for servers that terminate ICE for many peers, as ICE-lite
+// agents (see IceConfig::ice_lite). All sessions gather the same host
+// candidate, on one UDP socket. Every session still gets its own UDPPort, and
+// the packets received on the socket are handed to the port of the session
+// whose ufrag a connectivity check is addressed to, or otherwise to the port
+// of the session with a connection to the sender.
+class RTC_EXPORT SharedSocketPortAllocator : public PortAllocator {
+ public:
+  // |socket| has to be a bound UDP socket. The allocator and its sessions
+  // must be used on |network_thread|, where the allocator is created.
+  SharedSocketPortAllocator(rtc::Thread* network_thread,
+                            rtc::PacketSocketFactory* socket_factory,
+                            rtc::Network* network,
+                            std::unique_ptr<rtc::AsyncPacketSocket> socket);
+  ~SharedSocketPortAllocator() override;
+
+  // The allocator only gathers on |network|.
+  void SetNetworkIgnoreMask(int network_ignore_mask) override {}
+
+  rtc::SocketAddress local_address() const {
+    return socket_->GetLocalAddress();
+  }
+  size_t num_sessions() const { return sessions_by_ufrag_.size(); }
+  // Packets that were received for no session.
+  int64_t num_dropped_packets() const { return num_dropped_packets_; }
+
+ protected:
+  PortAllocatorSession* CreateSessionInternal(
+      const std::string& content_name,
+      int component,
+      const std::string& ice_ufrag,
+      const std::string& ice_pwd) override;
+
+ private:
+  friend class SharedSocketPortAllocatorSession;
+  // Stands in for the shared socket in the port of one session, so that the
+  // sent packets are reported to that port only.
+  class SessionSocket;
+
+  void AddSession(SharedSocketPortAllocatorSession* session);
+  void RemoveSession(SharedSocketPortAllocatorSession* session,
+                     const std::string& ice_ufrag);
+  std::unique_ptr<rtc::AsyncPacketSocket> CreateSessionSocket();
+  int SendTo(SessionSocket* from,
+             const void* data,
+             size_t size,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options);
+  int SendToBatch(SessionSocket* from,
+                  rtc::ArrayView<const rtc::BatchedPacket> packets);
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us);
+  void OnSentPacket(rtc::AsyncPacketSocket* socket,
+                    const rtc::SentPacket& sent_packet);
+  void OnReadyToSend(rtc::AsyncPacketSocket* socket);
+
+  rtc::Thread* const network_thread_;
+  rtc::PacketSocketFactory* const socket_factory_;
+  rtc::Network* const network_;
+  const std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::map<std::string, SharedSocketPortAllocatorSession*> sessions_by_ufrag_;
+  // Learned from the connectivity checks that created a connection.
+  AddressHashTable<SharedSocketPortAllocatorSession>
+      sessions_by_remote_address_;
+  std::set<SessionSocket*> session_sockets_;
+  // The socket that is sending, while it is.
+  SessionSocket* sending_socket_ = nullptr;
+  int64_t num_dropped_packets_ = 0;
+};
+
+class RTC_EXPORT SharedSocketPortAllocatorSession
+    : public PortAllocatorSession {
+ public:
+  SharedSocketPortAllocatorSession(SharedSocketPortAllocator* allocator,
+                                   const std::string& content_name,
+                                   int component,
+                                   const std::string& ice_ufrag,
+                                   const std::string& ice_pwd);
+  ~SharedSocketPortAllocatorSession() override;
+
+  // PortAllocatorSession overrides.
+  void SetCandidateFilter(uint32_t filter) override;
+  void StartGettingPorts() override;
+  void StopGettingPorts() override;
+  bool IsGettingPorts() override;
+  void ClearGettingPorts() override;
+  bool IsCleared() const override;
+  std::vector<PortInterface*> ReadyPorts() const override;
+  std::vector<Candidate> ReadyCandidates() const override;
+  bool CandidatesAllocationDone() const override;
+  void PruneAllPorts() override;
+
+  // Hands a packet received on the shared socket to the port. Returns true if
+  // the port has a connection to |remote_addr| afterwards.
+  bool HandleIncomingPacket(const char* data,
+                            size_t size,
+                            const rtc::SocketAddress& remote_addr,
+                            int64_t packet_time_us);
+
+ protected:
+  void UpdateIceParametersInternal() override;
+
+ private:
+  void OnPortComplete(Port* port);
+  void OnPortDestroyed(PortInterface* port);
+  bool CandidatePassesFilter() const;
+
+  SharedSocketPortAllocator* const allocator_;
+  // The ufrag the session is known by to |allocator_|.
+  std::string registered_ufrag_;
+  // Declared before |port_|, which uses it.
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::unique_ptr<UDPPort> port_;
+  std::vector<Candidate> candidates_;
+  uint32_t candidate_filter_ = CF_ALL;
+  bool running_ = false;
+  bool allocation_done_ = false;
+  bool cleared_ = false;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_CLIENT_SHARED_SOCKET_PORT_ALLOCATOR_H_
@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/transport/stun.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/p2p_transport_channel.h"
+#include "p2p/client/shared_socket_port_allocator.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/memory_usage.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+constexpr int kNumAgents = 1000;
+constexpr int kPacketsPerAgent = 20;
+// How long the connected transports are left alone, to measure what they
+// cost while idle.
+constexpr int kIdleDurationMs = 10000;
+constexpr int kTimeoutMs = 10000;
+constexpr char kServerPassword[] = "serverpasswordserverpa";
+constexpr char kAgentPassword[] = "agentpasswordagentpass";
+const rtc::SocketAddress kServerAddress("10.0.0.1", 3478);
+
+std::string ServerUfrag(int i) {
+  return "server" + std::to_string(i);
+}
+
+std::string AgentUfrag(int i) {
+  return "agent" + std::to_string(i);
+}
+
+// A remote full ICE agent, which nominates the one candidate pair it has with
+// the server and sends data on it.
+class SimulatedAgent : public sigslot::has_slots<> {
+ public:
+  SimulatedAgent(rtc::SocketServer* socket_server, int index)
+      : socket_(rtc::AsyncUDPSocket::Create(
+            socket_server,
+            rtc::SocketAddress(
+                rtc::IPAddress(0x0b000000 + static_cast<uint32_t>(index) + 1),
+                5000))),
+        index_(index) {
+    socket_->SignalReadPacket.connect(this, &SimulatedAgent::OnReadPacket);
+  }
+
+  void SendCheck() {
+    IceMessage msg;
+    msg.SetType(STUN_BINDING_REQUEST);
+    msg.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+    msg.AddAttribute(std::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, ServerUfrag(index_) + ":" + AgentUfrag(index_)));
+    msg.AddAttribute(
+        std::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 0x7e0000ff));
+    msg.AddAttribute(std::make_unique<StunUInt64Attribute>(
+        STUN_ATTR_ICE_CONTROLLING, 0x0123456789abcdefULL));
+    msg.AddAttribute(StunAttribute::CreateByteString(STUN_ATTR_USE_CANDIDATE));
+    msg.AddMessageIntegrity(kServerPassword);
+    msg.AddFingerprint();
+    rtc::ByteBufferWriter buf;
+    msg.Write(&buf);
+    socket_->SendTo(buf.Data(), buf.Length(), kServerAddress,
+                    rtc::PacketOptions());
+  }
+
+  void SendData() {
+    const char kData[160] = "\x80\x00";
+    socket_->SendTo(kData, sizeof(kData), kServerAddress,
+                    rtc::PacketOptions());
+  }
+
+  bool connected() const { return connected_; }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    StunMessageView msg;
+    if (msg.Parse(data, size) && msg.type() == STUN_BINDING_RESPONSE) {
+      connected_ = true;
+    }
+  }
+
+  std::unique_ptr<rtc::AsyncUDPSocket> socket_;
+  const int index_;
+  bool connected_ = false;
+};
+
+class SharedSocketPortAllocatorPerformanceTest
+    : public ::testing::Test,
+      public sigslot::has_slots<> {
+ protected:
+  SharedSocketPortAllocatorPerformanceTest()
+      : thread_(&socket_server_),
+        socket_factory_(&thread_),
+        network_("test", "test", kServerAddress.ipaddr(), 24) {
+    network_.AddIP(kServerAddress.ipaddr());
+  }
+
+  // The ICE-lite transport the agent |index| connects to.
+  std::unique_ptr<P2PTransportChannel> CreateChannel(
+      SharedSocketPortAllocator* allocator,
+      int index) {
+    auto channel = std::make_unique<P2PTransportChannel>("data", 1, allocator);
+    IceConfig config;
+    config.ice_lite = true;
+    channel->SetIceConfig(config);
+    channel->SetIceRole(ICEROLE_CONTROLLED);
+    channel->SetIceParameters(
+        IceParameters(ServerUfrag(index), kServerPassword, false));
+    channel->SetRemoteIceParameters(
+        IceParameters(AgentUfrag(index), kAgentPassword, false));
+    channel->SignalReadPacket.connect(
+        this, &SharedSocketPortAllocatorPerformanceTest::OnReadPacket);
+    channel->MaybeStartGathering();
+    return channel;
+  }
+
+  void OnReadPacket(rtc::PacketTransportInternal* transport,
+                    const char* data,
+                    size_t len,
+                    const int64_t& packet_time_us,
+                    int flags) {
+    ++num_packets_;
+  }
+
+  rtc::ScopedFakeClock clock_;
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  int num_packets_ = 0;
+};
+
+TEST_F(SharedSocketPortAllocatorPerformanceTest, ThousandIceLiteTransports) {
+  std::vector<std::unique_ptr<SimulatedAgent>> agents;
+  for (int i = 0; i < kNumAgents; ++i) {
+    agents.push_back(std::make_unique<SimulatedAgent>(&socket_server_, i));
+  }
+
+  const int64_t start_rss = rtc::GetProcessResidentSizeBytes();
+  int64_t start_cpu = rtc::GetProcessCpuTimeNanos();
+  SharedSocketPortAllocator allocator(
+      &thread_, &socket_factory_, &network_,
+      std::unique_ptr<rtc::AsyncPacketSocket>(
+          socket_factory_.CreateUdpSocket(kServerAddress, 0, 0)));
+  std::vector<std::unique_ptr<P2PTransportChannel>> channels;
+  for (int i = 0; i < kNumAgents; ++i) {
+    channels.push_back(CreateChannel(&allocator, i));
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumAgents), allocator.num_sessions());
+
+  for (auto& agent : agents) {
+    agent->SendCheck();
+  }
+  for (int i = 0; i < kNumAgents; ++i) {
+    ASSERT_TRUE_SIMULATED_WAIT(
+        agents[i]->connected() && channels[i]->writable(), kTimeoutMs, clock_);
+  }
+  const int64_t connect_cpu = rtc::GetProcessCpuTimeNanos() - start_cpu;
+  const int64_t rss = rtc::GetProcessResidentSizeBytes() - start_rss;
+
+  start_cpu = rtc::GetProcessCpuTimeNanos();
+  SIMULATED_WAIT(false, kIdleDurationMs, clock_);
+  const int64_t idle_cpu = rtc::GetProcessCpuTimeNanos() - start_cpu;
+
+  start_cpu = rtc::GetProcessCpuTimeNanos();
+  for (int n = 0; n < kPacketsPerAgent; ++n) {
+    for (auto& agent : agents) {
+      agent->SendData();
+    }
+  }
+  EXPECT_EQ_SIMULATED_WAIT(kNumAgents * kPacketsPerAgent, num_packets_,
+                           kTimeoutMs, clock_);
+  const int64_t receive_cpu = rtc::GetProcessCpuTimeNanos() - start_cpu;
+  EXPECT_EQ(0, allocator.num_dropped_packets());
+
+  webrtc::test::PrintResult("ice_lite_memory_per_connection", "", "shared",
+                            static_cast<double>(rss) / kNumAgents, "bytes",
+                            false);
+  webrtc::test::PrintResult("ice_lite_connect_cpu_per_connection", "",
+                            "shared", connect_cpu / 1000.0 / kNumAgents, "us",
+                            false);
+  webrtc::test::PrintResult(
+      "ice_lite_idle_cpu_per_connection", "", "shared",
+      idle_cpu / 1000.0 / kNumAgents / (kIdleDurationMs / 1000), "us/s",
+      false);
+  webrtc::test::PrintResult(
+      "ice_lite_receive_cpu_per_packet", "", "shared",
+      receive_cpu / 1000.0 / (kNumAgents * kPacketsPerAgent), "us", false);
+}
+
+}  // namespace
+}  // namespace cricket
@@ -0,0 +1,261 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/client/shared_socket_port_allocator.h"
+
+#include <memory>
+#include <string>
+
+#include "api/transport/stun.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/p2p_transport_channel.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kServerAddress("10.0.0.1", 3478);
+const rtc::SocketAddress kAgentAddress1("11.0.0.1", 5000);
+const rtc::SocketAddress kAgentAddress2("11.0.0.2", 5000);
+constexpr int kTimeoutMs = 1000;
+constexpr char kAgentPassword[] = "agentpasswordagentpass";
+
+// A full ICE agent, as far as an ICE-lite server can tell: sends nominating
+// checks and data from its own socket, and counts what comes back.
+class SimulatedAgent : public sigslot::has_slots<> {
+ public:
+  SimulatedAgent(rtc::SocketServer* socket_server,
+                 const rtc::SocketAddress& address,
+                 const std::string& ufrag)
+      : socket_(rtc::AsyncUDPSocket::Create(socket_server, address)),
+        ufrag_(ufrag) {
+    socket_->SignalReadPacket.connect(this, &SimulatedAgent::OnReadPacket);
+  }
+
+  void SendCheck(const rtc::SocketAddress& server_address,
+                 const std::string& server_ufrag,
+                 const std::string& server_password) {
+    IceMessage msg;
+    msg.SetType(STUN_BINDING_REQUEST);
+    msg.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+    msg.AddAttribute(std::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, server_ufrag + ":" + ufrag_));
+    msg.AddAttribute(
+        std::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 0x7e0000ff));
+    msg.AddAttribute(std::make_unique<StunUInt64Attribute>(
+        STUN_ATTR_ICE_CONTROLLING, 0x0123456789abcdefULL));
+    msg.AddAttribute(StunAttribute::CreateByteString(STUN_ATTR_USE_CANDIDATE));
+    msg.AddMessageIntegrity(server_password);
+    msg.AddFingerprint();
+    rtc::ByteBufferWriter buf;
+    msg.Write(&buf);
+    socket_->SendTo(buf.Data(), buf.Length(), server_address,
+                    rtc::PacketOptions());
+  }
+
+  void SendData(const rtc::SocketAddress& server_address) {
+    const char kData[] = "\x80\x00 media";
+    socket_->SendTo(kData, sizeof(kData), server_address,
+                    rtc::PacketOptions());
+  }
+
+  int num_responses() const { return num_responses_; }
+  int num_error_responses() const { return num_error_responses_; }
+  int num_requests() const { return num_requests_; }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    StunMessageView msg;
+    if (!msg.Parse(data, size)) {
+      return;
+    }
+    if (msg.type() == STUN_BINDING_RESPONSE) {
+      ++num_responses_;
+    } else if (msg.type() == STUN_BINDING_ERROR_RESPONSE) {
+      ++num_error_responses_;
+    } else if (msg.type() == STUN_BINDING_REQUEST) {
+      ++num_requests_;
+    }
+  }
+
+  std::unique_ptr<rtc::AsyncUDPSocket> socket_;
+  const std::string ufrag_;
+  int num_responses_ = 0;
+  int num_error_responses_ = 0;
+  int num_requests_ = 0;
+};
+
+class SharedSocketPortAllocatorTest : public ::testing::Test,
+                                      public sigslot::has_slots<> {
+ protected:
+  SharedSocketPortAllocatorTest()
+      : thread_(&socket_server_),
+        socket_factory_(&thread_),
+        network_("test", "test", kServerAddress.ipaddr(), 24) {
+    network_.AddIP(kServerAddress.ipaddr());
+    allocator_ = std::make_unique<SharedSocketPortAllocator>(
+        &thread_, &socket_factory_, &network_,
+        std::unique_ptr<rtc::AsyncPacketSocket>(
+            socket_factory_.CreateUdpSocket(kServerAddress, 0, 0)));
+  }
+
+  // An ICE-lite transport, which expects checks from an agent with the ufrag
+  // |remote_ufrag|.
+  std::unique_ptr<P2PTransportChannel> CreateChannel(
+      const std::string& ufrag,
+      const std::string& password,
+      const std::string& remote_ufrag) {
+    auto channel =
+        std::make_unique<P2PTransportChannel>("data", 1, allocator_.get());
+    IceConfig config;
+    config.ice_lite = true;
+    channel->SetIceConfig(config);
+    channel->SetIceRole(ICEROLE_CONTROLLED);
+    channel->SetIceParameters(IceParameters(ufrag, password, false));
+    channel->SetRemoteIceParameters(
+        IceParameters(remote_ufrag, kAgentPassword, false));
+    channel->SignalReadPacket.connect(
+        this, &SharedSocketPortAllocatorTest::OnReadPacket);
+    channel->MaybeStartGathering();
+    return channel;
+  }
+
+  void OnReadPacket(rtc::PacketTransportInternal* transport,
+                    const char* data,
+                    size_t len,
+                    const int64_t& packet_time_us,
+                    int flags) {
+    ++num_packets_[transport];
+  }
+
+  rtc::ScopedFakeClock clock_;
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  std::unique_ptr<SharedSocketPortAllocator> allocator_;
+  std::map<rtc::PacketTransportInternal*, int> num_packets_;
+};
+
+TEST_F(SharedSocketPortAllocatorTest, SessionsGatherTheSharedAddress) {
+  std::unique_ptr<PortAllocatorSession> session1 =
+      allocator_->CreateSession("data", 1, "ufrag1", "password1password1pa");
+  std::unique_ptr<PortAllocatorSession> session2 =
+      allocator_->CreateSession("data", 1, "ufrag2", "password2password2pa");
+  session1->StartGettingPorts();
+  session2->StartGettingPorts();
+  EXPECT_EQ(2u, allocator_->num_sessions());
+
+  ASSERT_TRUE(session1->CandidatesAllocationDone());
+  ASSERT_TRUE(session2->CandidatesAllocationDone());
+  ASSERT_EQ(1u, session1->ReadyCandidates().size());
+  ASSERT_EQ(1u, session2->ReadyCandidates().size());
+  EXPECT_EQ(kServerAddress, session1->ReadyCandidates()[0].address());
+  EXPECT_EQ(kServerAddress, session2->ReadyCandidates()[0].address());
+  EXPECT_EQ(LOCAL_PORT_TYPE, session1->ReadyCandidates()[0].type());
+  EXPECT_NE(session1->ReadyPorts()[0], session2->ReadyPorts()[0]);
+
+  session1.reset();
+  EXPECT_EQ(1u, allocator_->num_sessions());
+}
+
+TEST_F(SharedSocketPortAllocatorTest, RoutesChecksByUfragAndDataByAddress) {
+  std::unique_ptr<P2PTransportChannel> channel1 =
+      CreateChannel("ufrag1", "password1password1pa", "agent1");
+  std::unique_ptr<P2PTransportChannel> channel2 =
+      CreateChannel("ufrag2", "password2password2pa", "agent2");
+  SimulatedAgent agent1(&socket_server_, kAgentAddress1, "agent1");
+  SimulatedAgent agent2(&socket_server_, kAgentAddress2, "agent2");
+
+  agent1.SendCheck(kServerAddress, "ufrag1", "password1password1pa");
+  agent2.SendCheck(kServerAddress, "ufrag2", "password2password2pa");
+  EXPECT_EQ_SIMULATED_WAIT(1, agent1.num_responses(), kTimeoutMs, clock_);
+  EXPECT_EQ_SIMULATED_WAIT(1, agent2.num_responses(), kTimeoutMs, clock_);
+
+  // The checks nominated the connections, which are writable for an ICE-lite
+  // agent without checking them.
+  EXPECT_TRUE_SIMULATED_WAIT(channel1->writable() && channel2->writable(),
+                             kTimeoutMs, clock_);
+  ASSERT_TRUE(channel1->selected_connection());
+  EXPECT_EQ(kAgentAddress1,
+            channel1->selected_connection()->remote_candidate().address());
+  ASSERT_TRUE(channel2->selected_connection());
+  EXPECT_EQ(kAgentAddress2,
+            channel2->selected_connection()->remote_candidate().address());
+
+  agent1.SendData(kServerAddress);
+  agent1.SendData(kServerAddress);
+  agent2.SendData(kServerAddress);
+  EXPECT_EQ_SIMULATED_WAIT(2, num_packets_[channel1.get()], kTimeoutMs,
+                           clock_);
+  EXPECT_EQ_SIMULATED_WAIT(1, num_packets_[channel2.get()], kTimeoutMs,
+                           clock_);
+  EXPECT_EQ(0, allocator_->num_dropped_packets());
+}
+
+TEST_F(SharedSocketPortAllocatorTest, IceLiteChannelDoesNotPing) {
+  std::unique_ptr<P2PTransportChannel> channel =
+      CreateChannel("ufrag1", "password1password1pa", "agent1");
+  SimulatedAgent agent(&socket_server_, kAgentAddress1, "agent1");
+  agent.SendCheck(kServerAddress, "ufrag1", "password1password1pa");
+  EXPECT_TRUE_SIMULATED_WAIT(channel->writable(), kTimeoutMs, clock_);
+
+  // A full agent would ping the connection a few times by now.
+  SIMULATED_WAIT(false, 10000, clock_);
+  EXPECT_EQ(1, agent.num_responses());
+  EXPECT_EQ(0, agent.num_requests());
+}
+
+TEST_F(SharedSocketPortAllocatorTest, DropsPacketsForNoSession) {
+  std::unique_ptr<P2PTransportChannel> channel =
+      CreateChannel("ufrag1", "password1password1pa", "agent1");
+  SimulatedAgent agent(&socket_server_, kAgentAddress1, "agent1");
+  agent.SendCheck(kServerAddress, "unknown", "password1password1pa");
+  agent.SendData(kServerAddress);
+  EXPECT_EQ_SIMULATED_WAIT(2, allocator_->num_dropped_packets(), kTimeoutMs,
+                           clock_);
+  EXPECT_EQ(0, agent.num_responses());
+  EXPECT_EQ(0, num_packets_[channel.get()]);
+}
+
+TEST_F(SharedSocketPortAllocatorTest, ForgedCheckDoesNotMoveTheSender) {
+  std::unique_ptr<P2PTransportChannel> channel1 =
+      CreateChannel("ufrag1", "password1password1pa", "agent1");
+  std::unique_ptr<P2PTransportChannel> channel2 =
+      CreateChannel("ufrag2", "password2password2pa", "agent1");
+  SimulatedAgent agent(&socket_server_, kAgentAddress1, "agent1");
+  agent.SendCheck(kServerAddress, "ufrag1", "password1password1pa");
+  EXPECT_TRUE_SIMULATED_WAIT(channel1->writable(), kTimeoutMs, clock_);
+
+  // A check for the other session, without its password, is rejected there,
+  // and data from the sender keeps going to the first session.
+  agent.SendCheck(kServerAddress, "ufrag2", "wrongpasswordwrongpas");
+  EXPECT_EQ_SIMULATED_WAIT(1, agent.num_error_responses(), kTimeoutMs,
+                           clock_);
+  agent.SendData(kServerAddress);
+  EXPECT_EQ_SIMULATED_WAIT(1, num_packets_[channel1.get()], kTimeoutMs,
+                           clock_);
+  EXPECT_EQ(0, num_packets_[channel2.get()]);
+  EXPECT_FALSE(channel2->selected_connection());
+}
+
+}  // namespace
+}  // namespace cricket
@@ -487,6 +487,7 @@ JsepTransportController::CreateDtlsTransport(
 
   RTC_DCHECK(dtls);
   dtls->SetSslMaxProtocolVersion(config_.ssl_max_version);
+  dtls->SetSessionCache(config_.dtls_session_cache);
   dtls->ice_transport()->SetIceRole(ice_role_);
   dtls->ice_transport()->SetIceTiebreaker(ice_tiebreaker_);
   dtls->ice_transport()->SetIceConfig(ice_config_);
@@ -551,6 +552,9 @@ JsepTransportController::CreateSdesTransport(
   }
   if (config_.enable_external_auth) {
     srtp_transport->EnableExternalAuth();
+  } else if (config_.srtp_crypto_worker_count > 0) {
+    srtp_transport->EnableCryptoWorkers(config_.task_queue_factory,
+                                        config_.srtp_crypto_worker_count);
   }
   return srtp_transport;
 }
@@ -565,6 +569,9 @@ JsepTransportController::CreateDtlsSrtpTransport(
       rtcp_dtls_transport == nullptr);
   if (config_.enable_external_auth) {
     dtls_srtp_transport->EnableExternalAuth();
+  } else if (config_.srtp_crypto_worker_count > 0) {
+    dtls_srtp_transport->EnableCryptoWorkers(config_.task_queue_factory,
+                                             config_.srtp_crypto_worker_count);
   }
 
   dtls_srtp_transport->SetDtlsTransports(rtp_dtls_transport,
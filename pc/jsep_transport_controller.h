@@ -22,6 +22,7 @@
 #include "api/ice_transport_factory.h"
 #include "api/peer_connection_interface.h"
 #include "api/rtc_event_log/rtc_event_log.h"
+#include "api/task_queue/task_queue_factory.h"
 #include "api/transport/media/media_transport_config.h"
 #include "media/sctp/sctp_transport_internal.h"
 #include "p2p/base/dtls_transport.h"
@@ -80,6 +81,9 @@ class JsepTransportController : public sigslot::has_slots<> {
     // restart.
     bool redetermine_role_on_ice_restart = true;
     rtc::SSLProtocolVersion ssl_max_version = rtc::SSL_PROTOCOL_DTLS_12;
+    // If set, DTLS transports resume sessions from this cache, which must
+    // outlive the controller.
+    rtc::SSLSessionCache* dtls_session_cache = nullptr;
     // |crypto_options| is used to determine if created DTLS transports
     // negotiate GCM crypto suites or not.
     webrtc::CryptoOptions crypto_options;
@@ -89,6 +93,10 @@ class JsepTransportController : public sigslot::has_slots<> {
         PeerConnectionInterface::kRtcpMuxPolicyRequire;
     bool disable_encryption = false;
     bool enable_external_auth = false;
+    // If positive, outgoing RTP packets are protected on this many threads,
+    // created with |task_queue_factory|. Ignored with external auth.
+    int srtp_crypto_worker_count = 0;
+    TaskQueueFactory* task_queue_factory = nullptr;
     // Used to inject the ICE/DTLS transports created externally.
     webrtc::IceTransportFactory* ice_transport_factory = nullptr;
     cricket::DtlsTransportFactory* dtls_transport_factory = nullptr;
@@ -922,6 +922,7 @@ bool PeerConnectionInterface::RTCConfiguration::operator==(
     absl::optional<bool> use_datagram_transport_for_data_channels;
     absl::optional<bool> use_datagram_transport_for_data_channels_receive_only;
     absl::optional<CryptoOptions> crypto_options;
+    int srtp_crypto_worker_count;
     bool offer_extmap_allow_mixed;
     std::string turn_logging_id;
     bool enable_implicit_rollback;
@@ -990,6 +991,7 @@ bool PeerConnectionInterface::RTCConfiguration::operator==(
          use_datagram_transport_for_data_channels_receive_only ==
              o.use_datagram_transport_for_data_channels_receive_only &&
          crypto_options == o.crypto_options &&
+         srtp_crypto_worker_count == o.srtp_crypto_worker_count &&
          offer_extmap_allow_mixed == o.offer_extmap_allow_mixed &&
          turn_logging_id == o.turn_logging_id &&
          enable_implicit_rollback == o.enable_implicit_rollback &&
@@ -1231,6 +1233,9 @@ bool PeerConnection::Initialize(
   config.redetermine_role_on_ice_restart =
       configuration.redetermine_role_on_ice_restart;
   config.ssl_max_version = factory_->options().ssl_max_version;
+  if (options.enable_dtls_session_resumption) {
+    config.dtls_session_cache = factory_->dtls_session_cache();
+  }
   config.disable_encryption = options.disable_encryption;
   config.bundle_policy = configuration.bundle_policy;
   config.rtcp_mux_policy = configuration.rtcp_mux_policy;
@@ -1264,6 +1269,8 @@ bool PeerConnection::Initialize(
   config.enable_external_auth = true;
 #endif
   config.active_reset_srtp_params = configuration.active_reset_srtp_params;
+  config.srtp_crypto_worker_count = configuration.srtp_crypto_worker_count;
+  config.task_queue_factory = factory_->task_queue_factory();
 
   use_datagram_transport_ = datagram_transport_config_.enabled &&
                             configuration.use_datagram_transport.value_or(
@@ -153,6 +153,14 @@ bool PeerConnectionFactory::Initialize() {
 
 void PeerConnectionFactory::SetOptions(const Options& options) {
   options_ = options;
+  // Kept once created, as PeerConnections created earlier may still use it.
+  if (options_.enable_dtls_session_resumption && !dtls_session_cache_) {
+    dtls_session_cache_ = rtc::SSLSessionCache::Create(rtc::SSL_MODE_DTLS);
+  }
+  if (options_.certificate_pool && !certificate_pool_) {
+    certificate_pool_ = std::make_unique<rtc::RTCCertificatePool>(
+        task_queue_factory_.get(), *options_.certificate_pool);
+  }
 }
 
 RtpCapabilities PeerConnectionFactory::GetRtpSenderCapabilities(
@@ -249,8 +257,8 @@ PeerConnectionFactory::CreatePeerConnection(
   // Set internal defaults if optional dependencies are not set.
   if (!dependencies.cert_generator) {
     dependencies.cert_generator =
-        std::make_unique<rtc::RTCCertificateGenerator>(signaling_thread_,
-                                                       network_thread_);
+        std::make_unique<rtc::RTCCertificateGenerator>(
+            signaling_thread_, network_thread_, certificate_pool_.get());
   }
   if (!dependencies.allocator) {
     rtc::PacketSocketFactory* packet_socket_factory;
@@ -22,6 +22,8 @@
 #include "media/sctp/sctp_transport_internal.h"
 #include "pc/channel_manager.h"
 #include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/rtc_certificate_pool.h"
+#include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/thread.h"
 
 namespace rtc {
@@ -91,6 +93,19 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
     return media_transport_factory_.get();
   }
 
+  TaskQueueFactory* task_queue_factory() { return task_queue_factory_.get(); }
+
+  // Shared by the DTLS transports of all PeerConnections created with
+  // Options::enable_dtls_session_resumption; null until that is set.
+  rtc::SSLSessionCache* dtls_session_cache() {
+    return dtls_session_cache_.get();
+  }
+
+  // Null unless Options::certificate_pool was set.
+  rtc::RTCCertificatePool* certificate_pool() {
+    return certificate_pool_.get();
+  }
+
  protected:
   // This structure allows simple management of all new dependencies being added
   // to the PeerConnectionFactory.
@@ -117,6 +132,9 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
   std::unique_ptr<rtc::Thread> owned_worker_thread_;
   const std::unique_ptr<TaskQueueFactory> task_queue_factory_;
   Options options_;
+  std::unique_ptr<rtc::SSLSessionCache> dtls_session_cache_;
+  // Outlives the PeerConnections, which hold a reference to the factory.
+  std::unique_ptr<rtc::RTCCertificatePool> certificate_pool_;
   std::unique_ptr<cricket::ChannelManager> channel_manager_;
   std::unique_ptr<rtc::BasicNetworkManager> default_network_manager_;
   std::unique_ptr<rtc::BasicPacketSocketFactory> default_socket_factory_;
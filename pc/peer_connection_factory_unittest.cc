@@ -38,7 +38,12 @@
 #include "p2p/base/port_interface.h"
 #include "pc/test/fake_audio_capture_module.h"
 #include "pc/test/fake_video_track_source.h"
+#include "pc/test/mock_peer_connection_observers.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/socket_address.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/metrics.h"
 #include "test/gtest.h"
 
 #ifdef WEBRTC_ANDROID
@@ -78,6 +83,9 @@ static const char kStunIceServerWithIPv6Address[] = "stun:[2401:fa00:4::]:1234";
 static const char kStunIceServerWithIPv6AddressWithoutPort[] =
     "stun:[2401:fa00:4::]";
 static const char kTurnIceServerWithIPv6Address[] = "turn:[2401:fa00:4::]:1234";
+static const char kCertificatePoolHitMetric[] =
+    "WebRTC.PeerConnection.CertificatePoolHit";
+static const int kDefaultTimeoutMs = 10000;
 
 class NullPeerConnectionObserver : public PeerConnectionObserver {
  public:
@@ -146,6 +154,32 @@ class PeerConnectionFactoryTest : public ::testing::Test {
     }
   }
 
+  // Creates a PeerConnection with the default certificate generator and
+  // returns the time until its first offer is created, which waits for the
+  // certificate.
+  int64_t TimeToFirstOfferUs() {
+    int64_t start_us = rtc::TimeMicros();
+    webrtc::PeerConnectionDependencies dependencies(&observer_);
+    dependencies.allocator = std::make_unique<cricket::FakePortAllocator>(
+        rtc::Thread::Current(), nullptr);
+    PeerConnectionInterface::RTCConfiguration config;
+    config.sdp_semantics = webrtc::SdpSemantics::kUnifiedPlan;
+    rtc::scoped_refptr<PeerConnectionInterface> pc =
+        factory_->CreatePeerConnection(config, std::move(dependencies));
+    EXPECT_TRUE(pc);
+    if (!pc) {
+      return 0;
+    }
+    rtc::scoped_refptr<webrtc::MockCreateSessionDescriptionObserver>
+        offer_observer(new rtc::RefCountedObject<
+                       webrtc::MockCreateSessionDescriptionObserver>());
+    pc->CreateOffer(offer_observer,
+                    PeerConnectionInterface::RTCOfferAnswerOptions());
+    EXPECT_TRUE_WAIT(offer_observer->called(), kDefaultTimeoutMs);
+    EXPECT_TRUE(offer_observer->result()) << offer_observer->error();
+    return rtc::TimeMicros() - start_us;
+  }
+
   void VerifyAudioCodecCapability(const webrtc::RtpCodecCapability& codec) {
     EXPECT_EQ(codec.kind, cricket::MEDIA_TYPE_AUDIO);
     EXPECT_FALSE(codec.name.empty());
@@ -481,3 +515,32 @@ TEST_F(PeerConnectionFactoryTest, LocalRendering) {
   EXPECT_EQ(3, local_renderer.num_rendered_frames());
   EXPECT_FALSE(local_renderer.black_frame());
 }
+
+// Compares the time from CreatePeerConnection() to the first offer with and
+// without a pool of certificates that were generated ahead of time.
+TEST_F(PeerConnectionFactoryTest, CreatePCTakesCertificateFromPool) {
+  webrtc::metrics::Reset();
+  const int64_t without_pool_us = TimeToFirstOfferUs();
+  EXPECT_EQ(0, webrtc::metrics::NumSamples(kCertificatePoolHitMetric));
+
+  PeerConnectionFactoryInterface::Options options;
+  options.certificate_pool.emplace();
+  options.certificate_pool->low_watermark = 1;
+  options.certificate_pool->high_watermark = 2;
+  factory_->SetOptions(options);
+
+  // The pool is filled in the background, so the first PeerConnections may
+  // not find a certificate in it yet.
+  int64_t with_pool_us = -1;
+  const int64_t start_ms = rtc::TimeMillis();
+  while (with_pool_us < 0 && rtc::TimeMillis() - start_ms < kDefaultTimeoutMs) {
+    int64_t time_us = TimeToFirstOfferUs();
+    if (webrtc::metrics::NumEvents(kCertificatePoolHitMetric, 1) > 0) {
+      with_pool_us = time_us;
+    }
+  }
+  ASSERT_GE(with_pool_us, 0) << "No PeerConnection took a pooled certificate.";
+  RTC_LOG(LS_INFO) << "Time to first offer: " << without_pool_us
+                   << " us without a certificate pool, " << with_pool_us
+                   << " us with one.";
+}
@@ -0,0 +1,275 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/srtp_crypto_worker_pool.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "media/base/rtp_utils.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/synchronization/sequence_checker.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+namespace {
+
+// Jobs in the inbox of a worker at which it is woken up right away. Large
+// enough to amortize the wake-up, small enough to keep the workers busy while
+// a burst is still being submitted.
+constexpr size_t kWakeUpJobCount = 16;
+
+}  // namespace
+
+SrtpCryptoWorkerPool::Worker::Worker(
+    std::unique_ptr<TaskQueueBase, TaskQueueDeleter> task_queue)
+    : queue(std::move(task_queue)) {}
+
+SrtpCryptoWorkerPool::SrtpCryptoWorkerPool(
+    TaskQueueFactory* task_queue_factory,
+    int num_workers,
+    SendPacketCallback send_packet)
+    : owner_thread_(rtc::Thread::Current()),
+      send_packet_(std::move(send_packet)) {
+  RTC_DCHECK(owner_thread_);
+  RTC_DCHECK(task_queue_factory);
+  RTC_DCHECK_GT(num_workers, 0);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.push_back(
+        std::make_unique<Worker>(task_queue_factory->CreateTaskQueue(
+            "SrtpCryptoWorker" + std::to_string(i),
+            TaskQueueFactory::Priority::HIGH)));
+  }
+}
+
+SrtpCryptoWorkerPool::~SrtpCryptoWorkerPool() {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  // Stop the workers before anything they use goes away. Packets that were
+  // not sent yet are dropped.
+  workers_.clear();
+}
+
+void SrtpCryptoWorkerPool::SetSendKey(int cs,
+                                      const uint8_t* key,
+                                      int key_len,
+                                      const std::vector<int>& extension_ids) {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    Job job;
+    job.is_key_change = true;
+    job.key = std::make_unique<SendKey>();
+    job.key->cs = cs;
+    job.key->key.SetData(key, key_len);
+    job.key->extension_ids = extension_ids;
+    PostJob(worker.get(), std::move(job));
+  }
+}
+
+void SrtpCryptoWorkerPool::ResetSendKey() {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    Job job;
+    job.is_key_change = true;
+    PostJob(worker.get(), std::move(job));
+  }
+}
+
+void SrtpCryptoWorkerPool::ProtectAndSendRtp(rtc::CopyOnWriteBuffer packet,
+                                             const rtc::PacketOptions& options,
+                                             int flags) {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  uint32_t ssrc = 0;
+  cricket::GetRtpSsrc(packet.cdata(), packet.size(), &ssrc);
+
+  Job job;
+  job.id = first_pending_id_ + pending_.size();
+  job.packet = std::move(packet);
+  pending_.emplace_back();
+  pending_.back().options = options;
+  pending_.back().flags = flags;
+  PostJob(workers_[ssrc % workers_.size()].get(), std::move(job));
+}
+
+bool SrtpCryptoWorkerPool::SendInOrder(bool rtcp,
+                                       rtc::CopyOnWriteBuffer packet,
+                                       const rtc::PacketOptions& options,
+                                       int flags) {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  if (pending_.empty())
+    return send_packet_(rtcp, &packet, options, flags);
+
+  pending_.emplace_back();
+  PendingPacket& pending = pending_.back();
+  pending.packet = std::move(packet);
+  pending.options = options;
+  pending.flags = flags;
+  pending.rtcp = rtcp;
+  pending.done = true;
+  pending.ok = true;
+  return true;
+}
+
+size_t SrtpCryptoWorkerPool::num_pending() const {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  return pending_.size();
+}
+
+void SrtpCryptoWorkerPool::PostJob(Worker* worker, Job job) {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  {
+    rtc::CritScope cs(&worker->lock);
+    worker->inbox.push_back(std::move(job));
+    if (worker->drain_posted)
+      return;
+    if (worker->inbox.size() >= kWakeUpJobCount) {
+      WakeUp(worker);
+      return;
+    }
+  }
+  if (!wake_up_posted_) {
+    wake_up_posted_ = true;
+    owner_thread_->PostTask(
+        ToQueuedTask(safety_.flag(), [this] { WakeUpWorkers(); }));
+  }
+}
+
+void SrtpCryptoWorkerPool::WakeUpWorkers() {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  wake_up_posted_ = false;
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    rtc::CritScope cs(&worker->lock);
+    if (!worker->drain_posted && !worker->inbox.empty())
+      WakeUp(worker.get());
+  }
+}
+
+void SrtpCryptoWorkerPool::WakeUp(Worker* worker) {
+  worker->drain_posted = true;
+  worker->queue.PostTask([this, worker] { DrainInbox(worker); });
+}
+
+void SrtpCryptoWorkerPool::DrainInbox(Worker* worker) {
+  RTC_DCHECK(worker->queue.IsCurrent());
+  // Swapping the vectors keeps their capacity in use, so that draining does
+  // not allocate once the pool has warmed up.
+  std::vector<Job>& jobs = worker->jobs;
+  {
+    rtc::CritScope cs(&worker->lock);
+    jobs.swap(worker->inbox);
+    worker->drain_posted = false;
+  }
+
+  // Protect the packets between key changes with one SrtpSession call.
+  auto begin = jobs.begin();
+  while (begin != jobs.end()) {
+    auto end = std::find_if(begin, jobs.end(),
+                            [](const Job& job) { return job.is_key_change; });
+    ProtectJobs(worker, begin, end);
+    if (end == jobs.end())
+      break;
+    if (!end->key) {
+      worker->session = nullptr;
+    } else {
+      const SendKey& key = *end->key;
+      bool ret;
+      if (!worker->session) {
+        worker->session = std::make_unique<cricket::SrtpSession>();
+        ret = worker->session->SetSend(key.cs, key.key.data(), key.key.size(),
+                                       key.extension_ids);
+      } else {
+        ret = worker->session->UpdateSend(key.cs, key.key.data(),
+                                          key.key.size(), key.extension_ids);
+      }
+      if (!ret) {
+        RTC_LOG(LS_ERROR) << "Failed to set the SRTP send key of a worker.";
+        worker->session = nullptr;
+      }
+    }
+    begin = end + 1;
+  }
+
+  bool was_empty;
+  {
+    rtc::CritScope cs(&done_lock_);
+    was_empty = done_jobs_.empty();
+    for (Job& job : jobs) {
+      if (!job.is_key_change)
+        done_jobs_.push_back(std::move(job));
+    }
+  }
+  jobs.clear();
+  if (was_empty) {
+    owner_thread_->PostTask(
+        ToQueuedTask(safety_.flag(), [this] { OnProtected(); }));
+  }
+}
+
+void SrtpCryptoWorkerPool::ProtectJobs(Worker* worker,
+                                       std::vector<Job>::iterator begin,
+                                       std::vector<Job>::iterator end) {
+  if (begin == end || !worker->session)
+    return;
+  TRACE_EVENT0("webrtc", "SRTP Encode");
+  cricket::ProtectRtpBuffers(
+      worker->session.get(), rtc::ArrayView<Job>(&*begin, end - begin),
+      [](Job& job) { return &job.packet; }, &worker->batch);
+  for (auto it = begin; it != end; ++it)
+    it->ok = worker->batch[it - begin].ok;
+}
+
+void SrtpCryptoWorkerPool::OnProtected() {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  {
+    rtc::CritScope cs(&done_lock_);
+    protected_jobs_.swap(done_jobs_);
+  }
+  for (Job& job : protected_jobs_) {
+    RTC_DCHECK_GE(job.id, first_pending_id_);
+    RTC_DCHECK_LT(job.id - first_pending_id_, pending_.size());
+    PendingPacket& pending = pending_[job.id - first_pending_id_];
+    pending.packet = std::move(job.packet);
+    pending.done = true;
+    pending.ok = job.ok;
+  }
+  protected_jobs_.clear();
+  SendDonePackets();
+}
+
+void SrtpCryptoWorkerPool::SendDonePackets() {
+  RTC_DCHECK_RUN_ON(owner_thread_);
+  while (!pending_.empty() && pending_.front().done) {
+    PendingPacket& pending = pending_.front();
+    if (pending.ok) {
+      send_packet_(pending.rtcp, &pending.packet, pending.options,
+                   pending.flags);
+    } else {
+      if (cricket::ShouldLogSrtpFailure(protect_failure_count_)) {
+        int seq_num = -1;
+        uint32_t ssrc = 0;
+        cricket::GetRtpSeqNum(pending.packet.cdata(), pending.packet.size(),
+                              &seq_num);
+        cricket::GetRtpSsrc(pending.packet.cdata(), pending.packet.size(),
+                            &ssrc);
+        RTC_LOG(LS_ERROR) << "Failed to protect RTP packet: size="
+                          << pending.packet.size() << ", seqnum=" << seq_num
+                          << ", SSRC=" << ssrc << ", previous failure count: "
+                          << protect_failure_count_;
+      }
+      ++protect_failure_count_;
+    }
+    pending_.pop_front();
+    ++first_pending_id_;
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef PC_SRTP_CRYPTO_WORKER_POOL_H_
+#define PC_SRTP_CRYPTO_WORKER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_factory.h"
+#include "pc/srtp_session.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/task_utils/pending_task_safety_flag.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Protects outgoing RTP packets on a pool of worker threads, for senders that
+// encrypt more than one core can keep up with.
+//
+// Every worker has its own SrtpSession, and the packets of an SSRC always go
+// to the same worker, so the per-SSRC state of libsrtp is only ever used by
+// one thread and the packets of an SSRC are protected in order. Protected
+// packets are handed back on the thread that created the pool, in the order
+// they were submitted, so that the order on the wire, and with it the order of
+// the transport-wide sequence numbers and SentPacket signals, is the same as
+// without the pool.
+class SrtpCryptoWorkerPool {
+ public:
+  // Sends a packet that is protected and next in line. Called on the thread
+  // that created the pool.
+  using SendPacketCallback = std::function<bool(bool rtcp,
+                                                rtc::CopyOnWriteBuffer* packet,
+                                                const rtc::PacketOptions&,
+                                                int flags)>;
+
+  SrtpCryptoWorkerPool(TaskQueueFactory* task_queue_factory,
+                       int num_workers,
+                       SendPacketCallback send_packet);
+  ~SrtpCryptoWorkerPool();
+
+  int num_workers() const { return static_cast<int>(workers_.size()); }
+
+  // Sets the send key of all workers, the first time with SrtpSession::SetSend
+  // and after that with UpdateSend. Packets submitted before the call are
+  // protected with the previous key. The parameters are expected to have been
+  // validated by setting them on a SrtpSession already.
+  void SetSendKey(int cs,
+                  const uint8_t* key,
+                  int key_len,
+                  const std::vector<int>& extension_ids);
+  // Packets submitted after this fail to be protected, until the next
+  // SetSendKey().
+  void ResetSendKey();
+
+  // Protects |packet| on the worker of its SSRC, and then sends it. Packets
+  // that fail to be protected are dropped.
+  void ProtectAndSendRtp(rtc::CopyOnWriteBuffer packet,
+                         const rtc::PacketOptions& options,
+                         int flags);
+
+  // Sends a packet that needs no protection by the pool, such as an RTCP
+  // packet, right after the packets submitted before it. Returns the result of
+  // sending if that happens right away, and true otherwise.
+  bool SendInOrder(bool rtcp,
+                   rtc::CopyOnWriteBuffer packet,
+                   const rtc::PacketOptions& options,
+                   int flags);
+
+  // The number of packets submitted and not yet sent.
+  size_t num_pending() const;
+
+ private:
+  struct SendKey {
+    int cs = 0;
+    rtc::ZeroOnFreeBuffer<uint8_t> key;
+    std::vector<int> extension_ids;
+  };
+
+  // A packet to protect, or a key change, in the inbox of a worker.
+  struct Job {
+    uint64_t id = 0;
+    rtc::CopyOnWriteBuffer packet;
+    bool ok = false;
+    // For key changes. No key means that the key is reset.
+    bool is_key_change = false;
+    std::unique_ptr<SendKey> key;
+  };
+
+  struct Worker {
+    rtc::CriticalSection lock;
+    std::vector<Job> inbox RTC_GUARDED_BY(lock);
+    // Whether a DrainInbox() task is posted that has not taken the inbox yet.
+    bool drain_posted RTC_GUARDED_BY(lock) = false;
+
+    // Only used on |queue|.
+    std::unique_ptr<cricket::SrtpSession> session;
+    std::vector<Job> jobs;
+    std::vector<cricket::SrtpBatchPacket> batch;
+
+    // Declared last, so that it is destroyed, and done running tasks, before
+    // the rest goes away.
+    rtc::TaskQueue queue;
+
+    explicit Worker(
+        std::unique_ptr<TaskQueueBase, TaskQueueDeleter> task_queue);
+  };
+
+  struct PendingPacket {
+    rtc::CopyOnWriteBuffer packet;
+    rtc::PacketOptions options;
+    int flags = 0;
+    bool rtcp = false;
+    bool done = false;
+    bool ok = false;
+  };
+
+  // Adds |job| to the inbox of |worker|. Workers are woken up when their
+  // inbox has filled up, or else once the current task of |owner_thread_| is
+  // done, so that a burst of packets costs a few task posts rather than one
+  // per packet.
+  void PostJob(Worker* worker, Job job);
+  void WakeUpWorkers();
+  void WakeUp(Worker* worker) RTC_EXCLUSIVE_LOCKS_REQUIRED(worker->lock);
+  void DrainInbox(Worker* worker);
+  void ProtectJobs(Worker* worker,
+                   std::vector<Job>::iterator begin,
+                   std::vector<Job>::iterator end);
+  void OnProtected();
+  void SendDonePackets();
+
+  rtc::Thread* const owner_thread_;
+  const SendPacketCallback send_packet_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Packets in submission order. The id of the front packet is
+  // |first_pending_id_|.
+  std::deque<PendingPacket> pending_ RTC_GUARDED_BY(owner_thread_);
+  uint64_t first_pending_id_ RTC_GUARDED_BY(owner_thread_) = 0;
+  int protect_failure_count_ RTC_GUARDED_BY(owner_thread_) = 0;
+  std::vector<Job> protected_jobs_ RTC_GUARDED_BY(owner_thread_);
+  bool wake_up_posted_ RTC_GUARDED_BY(owner_thread_) = false;
+
+  // Jobs done by the workers, waiting to be picked up on |owner_thread_|.
+  rtc::CriticalSection done_lock_;
+  std::vector<Job> done_jobs_ RTC_GUARDED_BY(done_lock_);
+
+  ScopedTaskSafety safety_;
+};
+
+}  // namespace webrtc
+
+#endif  // PC_SRTP_CRYPTO_WORKER_POOL_H_
@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "benchmark/benchmark.h"
+#include "pc/srtp_crypto_worker_pool.h"
+#include "pc/srtp_session.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/thread.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kRtpPacketSize = 1200;
+constexpr size_t kMaxTagSize = 16;
+// A forwarding server sending the same streams to many subscribers.
+constexpr int kNumSsrcs = 64;
+// Packets submitted per benchmark iteration, then waited for.
+constexpr int kBurstSize = 1024;
+constexpr uint8_t kKey[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234";
+const std::vector<int> kNoExtensionIds;
+
+class PacketSource {
+ public:
+  rtc::CopyOnWriteBuffer Next() {
+    rtc::CopyOnWriteBuffer packet(kRtpPacketSize, kRtpPacketSize + kMaxTagSize);
+    uint8_t* data = packet.data();
+    memset(data, 0xab, kRtpPacketSize);
+    data[0] = 0x80;
+    data[1] = 0x00;
+    const uint32_t ssrc = 1 + next_ % kNumSsrcs;
+    const uint16_t seq_num = static_cast<uint16_t>(next_ / kNumSsrcs);
+    rtc::SetBE16(data + 2, seq_num);
+    rtc::SetBE32(data + 4, seq_num * 960u);
+    rtc::SetBE32(data + 8, ssrc);
+    ++next_;
+    return packet;
+  }
+
+ private:
+  uint32_t next_ = 0;
+};
+
+void SetBitRate(benchmark::State& state) {
+  const int64_t packets = state.iterations() * kBurstSize;
+  state.SetItemsProcessed(packets);
+  state.SetBytesProcessed(packets * kRtpPacketSize);
+  state.counters["Gbps"] = benchmark::Counter(
+      packets * kRtpPacketSize * 8 / 1e9, benchmark::Counter::kIsRate);
+}
+
+// Protects on the sending thread, as SrtpTransport does without workers.
+void BM_SrtpProtectInline(benchmark::State& state) {
+  cricket::SrtpSession session;
+  RTC_CHECK(session.SetSend(rtc::SRTP_AES128_CM_SHA1_80, kKey, sizeof(kKey) - 1,
+                            kNoExtensionIds));
+  PacketSource source;
+  for (auto _ : state) {
+    for (int i = 0; i < kBurstSize; ++i) {
+      rtc::CopyOnWriteBuffer packet = source.Next();
+      int len = static_cast<int>(packet.size());
+      RTC_CHECK(session.ProtectRtp(packet.data(), len,
+                                   static_cast<int>(packet.capacity()), &len));
+      packet.SetSize(len);
+      benchmark::DoNotOptimize(packet.cdata());
+    }
+  }
+  SetBitRate(state);
+}
+BENCHMARK(BM_SrtpProtectInline)->UseRealTime();
+
+// Arg: number of workers.
+void BM_SrtpCryptoWorkerPool(benchmark::State& state) {
+  rtc::AutoThread main_thread;
+  std::unique_ptr<TaskQueueFactory> task_queue_factory =
+      CreateDefaultTaskQueueFactory();
+  int num_sent = 0;
+  int expected = 0;
+  SrtpCryptoWorkerPool pool(
+      task_queue_factory.get(), static_cast<int>(state.range(0)),
+      [&](bool rtcp, rtc::CopyOnWriteBuffer* packet,
+          const rtc::PacketOptions& options, int flags) {
+        benchmark::DoNotOptimize(packet->cdata());
+        if (++num_sent == expected)
+          main_thread.Quit();
+        return true;
+      });
+  pool.SetSendKey(rtc::SRTP_AES128_CM_SHA1_80, kKey, sizeof(kKey) - 1,
+                  kNoExtensionIds);
+  PacketSource source;
+  rtc::PacketOptions options;
+  for (auto _ : state) {
+    expected += kBurstSize;
+    for (int i = 0; i < kBurstSize; ++i)
+      pool.ProtectAndSendRtp(source.Next(), options, 0);
+    main_thread.ProcessMessages(rtc::Thread::kForever);
+    main_thread.Restart();
+  }
+  RTC_CHECK_EQ(num_sent, expected);
+  SetBitRate(state);
+}
+BENCHMARK(BM_SrtpCryptoWorkerPool)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace webrtc
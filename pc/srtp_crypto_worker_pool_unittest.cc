@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/srtp_crypto_worker_pool.h"
+
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "media/base/fake_rtp.h"
+#include "media/base/rtp_utils.h"
+#include "pc/srtp_session.h"
+#include "pc/test/srtp_test_util.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kTimeoutMs = 5000;
+constexpr int kNumWorkers = 4;
+const std::vector<int> kNoExtensionIds;
+
+struct SentPacket {
+  bool rtcp;
+  rtc::CopyOnWriteBuffer packet;
+};
+
+class SrtpCryptoWorkerPoolTest : public ::testing::Test {
+ protected:
+  SrtpCryptoWorkerPoolTest()
+      : task_queue_factory_(CreateDefaultTaskQueueFactory()),
+        pool_(task_queue_factory_.get(),
+              kNumWorkers,
+              [this](bool rtcp, rtc::CopyOnWriteBuffer* packet,
+                     const rtc::PacketOptions& options, int flags) {
+                sent_.push_back({rtcp, *packet});
+                return true;
+              }) {}
+
+  static rtc::CopyOnWriteBuffer CreateRtpPacket(uint32_t ssrc,
+                                                uint16_t seq_num) {
+    rtc::CopyOnWriteBuffer packet(
+        kPcmuFrame, sizeof(kPcmuFrame),
+        sizeof(kPcmuFrame) +
+            rtc::rtp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80));
+    rtc::SetBE16(packet.data() + 2, seq_num);
+    rtc::SetBE32(packet.data() + 8, ssrc);
+    return packet;
+  }
+
+  rtc::AutoThread main_thread_;
+  std::unique_ptr<TaskQueueFactory> task_queue_factory_;
+  std::vector<SentPacket> sent_;
+  SrtpCryptoWorkerPool pool_;
+};
+
+TEST_F(SrtpCryptoWorkerPoolTest, SendsInSubmissionOrder) {
+  constexpr int kNumSsrcs = 8;
+  constexpr int kPacketsPerSsrc = 16;
+  pool_.SetSendKey(rtc::SRTP_AES128_CM_SHA1_80, rtc::kTestKey1,
+                   rtc::kTestKeyLen, kNoExtensionIds);
+
+  // Interleave the SSRCs, with an RTCP packet in the middle.
+  std::vector<rtc::CopyOnWriteBuffer> rtp_packets;
+  for (int i = 0; i < kPacketsPerSsrc; ++i) {
+    for (int ssrc = 1; ssrc <= kNumSsrcs; ++ssrc) {
+      rtp_packets.push_back(CreateRtpPacket(ssrc, i + 1));
+      pool_.ProtectAndSendRtp(rtp_packets.back(), rtc::PacketOptions(), 0);
+    }
+    if (i == kPacketsPerSsrc / 2) {
+      EXPECT_TRUE(pool_.SendInOrder(/*rtcp=*/true,
+                                    rtc::CopyOnWriteBuffer(kRtcpReport,
+                                                           sizeof(kRtcpReport)),
+                                    rtc::PacketOptions(), 0));
+    }
+  }
+  const size_t num_packets = rtp_packets.size() + 1;
+  EXPECT_EQ_WAIT(num_packets, sent_.size(), kTimeoutMs);
+  EXPECT_EQ(0u, pool_.num_pending());
+
+  cricket::SrtpSession receiver;
+  ASSERT_TRUE(receiver.SetRecv(rtc::SRTP_AES128_CM_SHA1_80, rtc::kTestKey1,
+                               rtc::kTestKeyLen, kNoExtensionIds));
+  size_t next_rtp = 0;
+  for (size_t i = 0; i < sent_.size(); ++i) {
+    if (i == (kPacketsPerSsrc / 2 + 1) * kNumSsrcs) {
+      EXPECT_TRUE(sent_[i].rtcp);
+      continue;
+    }
+    ASSERT_FALSE(sent_[i].rtcp);
+    rtc::CopyOnWriteBuffer& packet = sent_[i].packet;
+    const rtc::CopyOnWriteBuffer& expected = rtp_packets[next_rtp++];
+    int len = static_cast<int>(packet.size());
+    ASSERT_TRUE(receiver.UnprotectRtp(packet.data(), len, &len));
+    ASSERT_EQ(expected.size(), static_cast<size_t>(len));
+    EXPECT_EQ(0, memcmp(expected.cdata(), packet.cdata(), len));
+  }
+}
+
+TEST_F(SrtpCryptoWorkerPoolTest, DropsPacketsWithoutKey) {
+  pool_.ProtectAndSendRtp(CreateRtpPacket(1, 1), rtc::PacketOptions(), 0);
+  EXPECT_TRUE(pool_.SendInOrder(
+      /*rtcp=*/true, rtc::CopyOnWriteBuffer(kRtcpReport, sizeof(kRtcpReport)),
+      rtc::PacketOptions(), 0));
+  EXPECT_EQ_WAIT(0u, pool_.num_pending(), kTimeoutMs);
+  ASSERT_EQ(1u, sent_.size());
+  EXPECT_TRUE(sent_[0].rtcp);
+
+  pool_.SetSendKey(rtc::SRTP_AES128_CM_SHA1_80, rtc::kTestKey1,
+                   rtc::kTestKeyLen, kNoExtensionIds);
+  pool_.ProtectAndSendRtp(CreateRtpPacket(1, 2), rtc::PacketOptions(), 0);
+  pool_.ResetSendKey();
+  pool_.ProtectAndSendRtp(CreateRtpPacket(1, 3), rtc::PacketOptions(), 0);
+  EXPECT_EQ_WAIT(0u, pool_.num_pending(), kTimeoutMs);
+  ASSERT_EQ(2u, sent_.size());
+  int seq_num = 0;
+  cricket::GetRtpSeqNum(sent_[1].packet.cdata(), sent_[1].packet.size(),
+                        &seq_num);
+  EXPECT_EQ(2, seq_num);
+}
+
+}  // namespace
+}  // namespace webrtc
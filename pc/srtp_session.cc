@@ -27,6 +27,13 @@ namespace cricket {
 // in srtp.h.
 constexpr int kSrtpErrorCodeBoundary = 28;
 
+// Only every |kFailureLogThrottleCount|th failure is logged.
+constexpr int kFailureLogThrottleCount = 100;
+
+bool ShouldLogSrtpFailure(int previous_failure_count) {
+  return previous_failure_count % kFailureLogThrottleCount == 0;
+}
+
 SrtpSession::SrtpSession() {}
 
 SrtpSession::~SrtpSession() {
@@ -139,10 +146,7 @@ bool SrtpSession::UnprotectRtp(void* p, int in_len, int* out_len) {
   *out_len = in_len;
   int err = srtp_unprotect(session_, p, out_len);
   if (err != srtp_err_status_ok) {
-    // Limit the error logging to avoid excessive logs when there are lots of
-    // bad packets.
-    const int kFailureLogThrottleCount = 100;
-    if (decryption_failure_count_ % kFailureLogThrottleCount == 0) {
+    if (ShouldLogSrtpFailure(decryption_failure_count_)) {
       RTC_LOG(LS_WARNING) << "Failed to unprotect SRTP packet, err=" << err
                           << ", previous failure count: "
                           << decryption_failure_count_;
@@ -155,6 +159,54 @@ bool SrtpSession::UnprotectRtp(void* p, int in_len, int* out_len) {
   return true;
 }
 
+int SrtpSession::ProtectRtp(rtc::ArrayView<SrtpBatchPacket> packets) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  for (SrtpBatchPacket& packet : packets)
+    packet.ok = false;
+  if (!session_) {
+    RTC_LOG(LS_WARNING) << "Failed to protect " << packets.size()
+                        << " SRTP packets: no SRTP Session";
+    return 0;
+  }
+
+  int num_protected = 0;
+  const SrtpBatchPacket* last_protected = nullptr;
+  const SrtpBatchPacket* first_failed = nullptr;
+  int first_err = srtp_err_status_ok;
+  for (SrtpBatchPacket& packet : packets) {
+    int len = packet.len;
+    int err = packet.max_len < packet.len + rtp_auth_tag_len_
+                  ? srtp_err_status_bad_param
+                  : srtp_protect(session_, packet.data, &len);
+    if (err != srtp_err_status_ok) {
+      if (!first_failed) {
+        first_failed = &packet;
+        first_err = err;
+      }
+      continue;
+    }
+    packet.len = len;
+    packet.ok = true;
+    last_protected = &packet;
+    ++num_protected;
+  }
+
+  if (first_failed) {
+    int seq_num = -1;
+    GetRtpSeqNum(first_failed->data, first_failed->len, &seq_num);
+    RTC_LOG(LS_WARNING) << "Failed to protect "
+                        << packets.size() - num_protected << " of "
+                        << packets.size() << " SRTP packets, first seqnum="
+                        << seq_num << ", err=" << first_err
+                        << ", last seqnum=" << last_send_seq_num_;
+  }
+  if (last_protected) {
+    GetRtpSeqNum(last_protected->data, last_protected->len,
+                 &last_send_seq_num_);
+  }
+  return num_protected;
+}
+
 bool SrtpSession::UnprotectRtcp(void* p, int in_len, int* out_len) {
   RTC_DCHECK(thread_checker_.IsCurrent());
   if (!session_) {
@@ -13,7 +13,10 @@
 
 #include <vector>
 
+#include "api/array_view.h"
 #include "api/scoped_refptr.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/thread_checker.h"
 
 // Forward declaration to avoid pulling in libsrtp headers here
@@ -27,6 +30,21 @@ namespace cricket {
 // before creating an SRTP session with WebRTC.
 void ProhibitLibsrtpInitialization();
 
+// A packet of a batched SrtpSession call, protected in place.
+struct SrtpBatchPacket {
+  void* data = nullptr;
+  // Updated to the protected length on success.
+  int len = 0;
+  // Size of the buffer at |data|.
+  int max_len = 0;
+  bool ok = false;
+};
+
+// Returns whether an SRTP failure should be logged, given the number of
+// failures before it. Limits the error logging to avoid excessive logs when
+// there are lots of bad packets.
+bool ShouldLogSrtpFailure(int previous_failure_count);
+
 // Class that wraps a libSRTP session.
 class SrtpSession {
  public:
@@ -70,6 +88,12 @@ class SrtpSession {
   bool UnprotectRtp(void* data, int in_len, int* out_len);
   bool UnprotectRtcp(void* data, int in_len, int* out_len);
 
+  // Batched version of ProtectRtp, for bursts of RTP packets such as a pacer
+  // send batch. The checks, bookkeeping and logging are done once per batch
+  // rather than per packet. Sets |ok| of every packet and returns the number
+  // of packets that were protected.
+  int ProtectRtp(rtc::ArrayView<SrtpBatchPacket> packets);
+
   // Helper method to get authentication params.
   bool GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len);
 
@@ -131,6 +155,33 @@ class SrtpSession {
   RTC_DISALLOW_COPY_AND_ASSIGN(SrtpSession);
 };
 
+// Protects the RTP packets in |packets| in place with the batched
+// SrtpSession::ProtectRtp, where |get_buffer| returns the
+// rtc::CopyOnWriteBuffer* of a packet, and sets the size of every protected
+// buffer to include its auth tag. |batch| is reused between calls to avoid an
+// allocation per burst; afterwards (*batch)[i].ok tells whether packets[i] was
+// protected. Returns the number of packets that were protected.
+template <typename T, typename GetBuffer>
+int ProtectRtpBuffers(SrtpSession* session,
+                      rtc::ArrayView<T> packets,
+                      GetBuffer get_buffer,
+                      std::vector<SrtpBatchPacket>* batch) {
+  batch->resize(packets.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    rtc::CopyOnWriteBuffer* buffer = get_buffer(packets[i]);
+    (*batch)[i].data = buffer->data();
+    (*batch)[i].len = rtc::checked_cast<int>(buffer->size());
+    (*batch)[i].max_len = static_cast<int>(buffer->capacity());
+  }
+  int num_protected = session->ProtectRtp(*batch);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    // Update the length of the packet now that we've added the auth tag.
+    if ((*batch)[i].ok)
+      get_buffer(packets[i])->SetSize((*batch)[i].len);
+  }
+  return num_protected;
+}
+
 }  // namespace cricket
 
 #endif  // PC_SRTP_SESSION_H_
@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "api/array_view.h"
+#include "benchmark/benchmark.h"
+#include "pc/srtp_session.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ssl_stream_adapter.h"
+
+namespace cricket {
+namespace {
+
+constexpr size_t kRtpPacketSize = 1200;
+constexpr size_t kRtpHeaderSize = 12;
+// Large enough for the longest auth tag.
+constexpr size_t kMaxTagSize = 16;
+// Packets protected ahead of an unprotect run. Less than the replay window,
+// so that all of them are accepted.
+constexpr int kUnprotectPoolSize = 512;
+
+// Long enough for any of the suites benchmarked; the suite decides how much
+// of it is used.
+constexpr uint8_t kKey[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890ABCDEFGHIJ";
+
+int KeyLength(int crypto_suite) {
+  int key_len = 0;
+  int salt_len = 0;
+  RTC_CHECK(rtc::GetSrtpKeyAndSaltLengths(crypto_suite, &key_len, &salt_len));
+  return key_len + salt_len;
+}
+
+// Buffers of |kRtpPacketSize| byte RTP packets, with room for the tag.
+class PacketPool {
+ public:
+  explicit PacketPool(int size)
+      : buffers_(size, std::vector<uint8_t>(kRtpPacketSize + kMaxTagSize)),
+        packets_(size) {
+    for (std::vector<uint8_t>& buffer : buffers_) {
+      buffer[0] = 0x80;  // Version 2.
+      buffer[1] = 0x00;  // Payload type 0.
+      rtc::SetBE32(&buffer[8], 0x12345678);
+      memset(&buffer[kRtpHeaderSize], 0xab, kRtpPacketSize - kRtpHeaderSize);
+    }
+  }
+
+  // Resets the packets in [begin, begin + count) to unprotected packets with
+  // the next sequence numbers.
+  rtc::ArrayView<SrtpBatchPacket> Reset(int begin, int count) {
+    for (int i = begin; i < begin + count; ++i) {
+      rtc::SetBE16(&buffers_[i][2], next_seq_num_);
+      rtc::SetBE32(&buffers_[i][4], next_seq_num_ * 960u);
+      ++next_seq_num_;
+      packets_[i].data = buffers_[i].data();
+      packets_[i].len = kRtpPacketSize;
+      packets_[i].max_len = static_cast<int>(buffers_[i].size());
+    }
+    return View(begin, count);
+  }
+
+  rtc::ArrayView<SrtpBatchPacket> View(int begin, int count) {
+    return rtc::ArrayView<SrtpBatchPacket>(&packets_[begin], count);
+  }
+
+ private:
+  std::vector<std::vector<uint8_t>> buffers_;
+  std::vector<SrtpBatchPacket> packets_;
+  uint16_t next_seq_num_ = 1;
+};
+
+void SetBitRate(benchmark::State& state, int64_t packets) {
+  state.SetItemsProcessed(packets);
+  state.SetBytesProcessed(packets * kRtpPacketSize);
+  // Gbit/s of RTP on the one core the benchmark runs on.
+  state.counters["Gbps"] = benchmark::Counter(
+      packets * kRtpPacketSize * 8 / 1e9, benchmark::Counter::kIsRate);
+}
+
+// Args: crypto suite, packets per SrtpSession call.
+void BM_SrtpProtectRtp(benchmark::State& state) {
+  const int crypto_suite = static_cast<int>(state.range(0));
+  const int batch_size = static_cast<int>(state.range(1));
+  state.SetLabel(rtc::SrtpCryptoSuiteToName(crypto_suite));
+  SrtpSession session;
+  RTC_CHECK(session.SetSend(crypto_suite, kKey, KeyLength(crypto_suite),
+                            std::vector<int>()));
+  PacketPool pool(batch_size);
+  for (auto _ : state) {
+    rtc::ArrayView<SrtpBatchPacket> batch = pool.Reset(0, batch_size);
+    RTC_CHECK_EQ(session.ProtectRtp(batch), batch_size);
+  }
+  SetBitRate(state, state.iterations() * batch_size);
+}
+BENCHMARK(BM_SrtpProtectRtp)
+    ->Args({rtc::SRTP_AES128_CM_SHA1_80, 1})
+    ->Args({rtc::SRTP_AES128_CM_SHA1_80, 16})
+    ->Args({rtc::SRTP_AEAD_AES_128_GCM, 1})
+    ->Args({rtc::SRTP_AEAD_AES_128_GCM, 16});
+
+// Args: crypto suite.
+void BM_SrtpUnprotectRtp(benchmark::State& state) {
+  const int crypto_suite = static_cast<int>(state.range(0));
+  state.SetLabel(rtc::SrtpCryptoSuiteToName(crypto_suite));
+  SrtpSession sender;
+  SrtpSession receiver;
+  RTC_CHECK(sender.SetSend(crypto_suite, kKey, KeyLength(crypto_suite),
+                           std::vector<int>()));
+  RTC_CHECK(receiver.SetRecv(crypto_suite, kKey, KeyLength(crypto_suite),
+                             std::vector<int>()));
+  PacketPool pool(kUnprotectPoolSize);
+  int next_packet = kUnprotectPoolSize;
+  for (auto _ : state) {
+    if (next_packet == kUnprotectPoolSize) {
+      state.PauseTiming();
+      RTC_CHECK_EQ(sender.ProtectRtp(pool.Reset(0, kUnprotectPoolSize)),
+                   kUnprotectPoolSize);
+      next_packet = 0;
+      state.ResumeTiming();
+    }
+    SrtpBatchPacket& packet = pool.View(next_packet++, 1)[0];
+    int out_len;
+    RTC_CHECK(receiver.UnprotectRtp(packet.data, packet.len, &out_len));
+  }
+  SetBitRate(state, state.iterations());
+}
+BENCHMARK(BM_SrtpUnprotectRtp)
+    ->Arg(rtc::SRTP_AES128_CM_SHA1_80)
+    ->Arg(rtc::SRTP_AEAD_AES_128_GCM);
+
+}  // namespace
+}  // namespace cricket
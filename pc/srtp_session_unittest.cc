@@ -28,6 +28,8 @@ using ::testing::Pair;
 
 namespace rtc {
 
+using cricket::SrtpBatchPacket;
+
 std::vector<int> kEncryptedHeaderExtensionIds;
 
 class SrtpSessionTest : public ::testing::Test {
@@ -190,6 +192,42 @@ TEST_F(SrtpSessionTest, TestBuffersTooSmall) {
                                sizeof(rtcp_packet_) - 14, &out_len));
 }
 
+TEST_F(SrtpSessionTest, TestProtectBatch) {
+  constexpr int kNumPackets = 4;
+  const int tag_len = rtp_auth_tag_len(CS_AES_CM_128_HMAC_SHA1_80);
+  EXPECT_TRUE(s1_.SetSend(SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen,
+                          kEncryptedHeaderExtensionIds));
+  EXPECT_TRUE(s2_.SetRecv(SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen,
+                          kEncryptedHeaderExtensionIds));
+
+  char packets[kNumPackets][sizeof(kPcmuFrame) + 10];
+  SrtpBatchPacket batch[kNumPackets];
+  for (int i = 0; i < kNumPackets; ++i) {
+    memcpy(packets[i], kPcmuFrame, rtp_len_);
+    SetBE16(reinterpret_cast<uint8_t*>(packets[i]) + 2, i + 1);
+    batch[i].data = packets[i];
+    batch[i].len = rtp_len_;
+    batch[i].max_len = sizeof(packets[i]);
+  }
+  // The last packet does not have room for the tag.
+  batch[kNumPackets - 1].max_len = rtp_len_;
+
+  EXPECT_EQ(kNumPackets - 1, s1_.ProtectRtp(batch));
+  for (int i = 0; i < kNumPackets - 1; ++i) {
+    EXPECT_TRUE(batch[i].ok);
+    EXPECT_EQ(rtp_len_ + tag_len, batch[i].len);
+  }
+  EXPECT_FALSE(batch[kNumPackets - 1].ok);
+  EXPECT_EQ(rtp_len_, batch[kNumPackets - 1].len);
+
+  for (int i = 0; i < kNumPackets - 1; ++i) {
+    int out_len;
+    EXPECT_TRUE(s2_.UnprotectRtp(packets[i], batch[i].len, &out_len));
+    EXPECT_EQ(rtp_len_, out_len);
+    EXPECT_EQ(0, memcmp(packets[i] + 4, kPcmuFrame + 4, rtp_len_ - 4));
+  }
+}
+
 TEST_F(SrtpSessionTest, TestReplay) {
   static const uint16_t kMaxSeqnum = static_cast<uint16_t>(-1);
   static const uint16_t seqnum_big = 62275;
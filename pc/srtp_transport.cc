@@ -27,13 +27,21 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/task_utils/to_queued_task.h"
 #include "rtc_base/third_party/base64/base64.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
 #include "rtc_base/trace_event.h"
 #include "rtc_base/zero_memory.h"
 
 namespace webrtc {
 
+namespace {
+// The most batchable RTP packets held before they are sent, matching the
+// largest batch that a UDPPort sends with one call.
+constexpr size_t kMaxPendingRtpBatchSize = 64;
+}  // namespace
+
 SrtpTransport::SrtpTransport(bool rtcp_mux_enabled)
     : RtpTransport(rtcp_mux_enabled) {}
 
@@ -125,6 +133,21 @@ bool SrtpTransport::SendRtpPacket(rtc::CopyOnWriteBuffer* packet,
         << "Failed to send the packet because SRTP transport is inactive.";
     return false;
   }
+  if (crypto_workers_) {
+    crypto_workers_->ProtectAndSendRtp(std::move(*packet), options, flags);
+    return true;
+  }
+  if (options.batchable) {
+    return AddToPendingRtpBatch(packet, options, flags);
+  }
+  // Keep the packet behind the batch sent before it.
+  SendPendingRtpBatch();
+  return ProtectAndSendRtpPacket(packet, options, flags);
+}
+
+bool SrtpTransport::ProtectAndSendRtpPacket(rtc::CopyOnWriteBuffer* packet,
+                                            const rtc::PacketOptions& options,
+                                            int flags) {
   rtc::PacketOptions updated_options = options;
   TRACE_EVENT0("webrtc", "SRTP Encode");
   bool res;
@@ -175,6 +198,92 @@ bool SrtpTransport::SendRtpPacket(rtc::CopyOnWriteBuffer* packet,
   return SendPacket(/*rtcp=*/false, packet, updated_options, flags);
 }
 
+int SrtpTransport::SendRtpPackets(rtc::ArrayView<OutgoingRtpPacket> packets,
+                                  int flags) {
+  if (!IsSrtpActive()) {
+    RTC_LOG(LS_ERROR)
+        << "Failed to send the packets because SRTP transport is inactive.";
+    return 0;
+  }
+  int num_sent = 0;
+  if (crypto_workers_) {
+    for (OutgoingRtpPacket& outgoing : packets) {
+      crypto_workers_->ProtectAndSendRtp(std::move(*outgoing.packet),
+                                         outgoing.options, flags);
+    }
+    return static_cast<int>(packets.size());
+  }
+#if defined(ENABLE_EXTERNAL_AUTH)
+  // Every packet needs its own index and auth params for the socket layer.
+  // They are sent one by one without going through the pending batch again,
+  // since this may be sending that batch.
+  if (IsExternalAuthActive()) {
+    for (OutgoingRtpPacket& outgoing : packets) {
+      if (ProtectAndSendRtpPacket(outgoing.packet, outgoing.options, flags))
+        ++num_sent;
+    }
+    return num_sent;
+  }
+#endif
+
+  TRACE_EVENT0("webrtc", "SRTP Encode");
+  RTC_CHECK(send_session_);
+  cricket::ProtectRtpBuffers(
+      send_session_.get(), packets,
+      [](const OutgoingRtpPacket& outgoing) { return outgoing.packet; },
+      &srtp_batch_);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    if (srtp_batch_[i].ok &&
+        SendPacket(/*rtcp=*/false, packets[i].packet, packets[i].options,
+                   flags)) {
+      ++num_sent;
+    }
+  }
+  return num_sent;
+}
+
+bool SrtpTransport::AddToPendingRtpBatch(rtc::CopyOnWriteBuffer* packet,
+                                         const rtc::PacketOptions& options,
+                                         int flags) {
+  if (!pending_rtp_batch_.empty() && flags != pending_rtp_flags_) {
+    SendPendingRtpBatch();
+  }
+  pending_rtp_flags_ = flags;
+  pending_rtp_batch_.push_back({std::move(*packet), options});
+  if (options.last_packet_in_batch ||
+      pending_rtp_batch_.size() >= kMaxPendingRtpBatchSize) {
+    SendPendingRtpBatch();
+    return true;
+  }
+  // Don't hold the packets for long if the end of the batch never comes, e.g.
+  // because the last packet was dropped before reaching the transport.
+  rtc::Thread* thread = rtc::Thread::Current();
+  if (!thread) {
+    SendPendingRtpBatch();
+  } else if (!pending_rtp_batch_task_posted_) {
+    pending_rtp_batch_task_posted_ = true;
+    thread->PostTask(ToQueuedTask(task_safety_, [this] {
+      pending_rtp_batch_task_posted_ = false;
+      SendPendingRtpBatch();
+    }));
+  }
+  return true;
+}
+
+void SrtpTransport::SendPendingRtpBatch() {
+  if (pending_rtp_batch_.empty()) {
+    return;
+  }
+  outgoing_rtp_batch_.clear();
+  for (PendingRtpPacket& pending : pending_rtp_batch_) {
+    outgoing_rtp_batch_.push_back({&pending.packet, pending.options});
+  }
+  // Let the socket send the packets as one batch too.
+  outgoing_rtp_batch_.back().options.last_packet_in_batch = true;
+  SendRtpPackets(outgoing_rtp_batch_, pending_rtp_flags_);
+  pending_rtp_batch_.clear();
+}
+
 bool SrtpTransport::SendRtcpPacket(rtc::CopyOnWriteBuffer* packet,
                                    const rtc::PacketOptions& options,
                                    int flags) {
@@ -183,6 +292,7 @@ bool SrtpTransport::SendRtcpPacket(rtc::CopyOnWriteBuffer* packet,
         << "Failed to send the packet because SRTP transport is inactive.";
     return false;
   }
+  SendPendingRtpBatch();
 
   TRACE_EVENT0("webrtc", "SRTP Encode");
   uint8_t* data = packet->data();
@@ -197,6 +307,11 @@ bool SrtpTransport::SendRtcpPacket(rtc::CopyOnWriteBuffer* packet,
   // Update the length of the packet now that we've added the auth tag.
   packet->SetSize(len);
 
+  if (crypto_workers_) {
+    // Keep the RTCP packet behind the RTP packets still being protected.
+    return crypto_workers_->SendInOrder(/*rtcp=*/true, std::move(*packet),
+                                        options, flags);
+  }
   return SendPacket(/*rtcp=*/true, packet, options, flags);
 }
 
@@ -216,10 +331,7 @@ void SrtpTransport::OnRtpPacketReceived(rtc::CopyOnWriteBuffer packet,
     cricket::GetRtpSeqNum(data, len, &seq_num);
     cricket::GetRtpSsrc(data, len, &ssrc);
 
-    // Limit the error logging to avoid excessive logs when there are lots of
-    // bad packets.
-    const int kFailureLogThrottleCount = 100;
-    if (decryption_failure_count_ % kFailureLogThrottleCount == 0) {
+    if (cricket::ShouldLogSrtpFailure(decryption_failure_count_)) {
       RTC_LOG(LS_ERROR) << "Failed to unprotect RTP packet: size=" << len
                         << ", seqnum=" << seq_num << ", SSRC=" << ssrc
                         << ", previous failure count: "
@@ -298,6 +410,10 @@ bool SrtpTransport::SetRtpParams(int send_cs,
     ResetParams();
     return false;
   }
+  if (crypto_workers_) {
+    crypto_workers_->SetSendKey(send_cs, send_key, send_key_len,
+                                send_extension_ids);
+  }
 
   ret = new_sessions ? recv_session_->SetRecv(recv_cs, recv_key, recv_key_len,
                                               recv_extension_ids)
@@ -362,6 +478,9 @@ void SrtpTransport::ResetParams() {
   recv_session_ = nullptr;
   send_rtcp_session_ = nullptr;
   recv_rtcp_session_ = nullptr;
+  if (crypto_workers_) {
+    crypto_workers_->ResetSendKey();
+  }
   MaybeUpdateWritableState();
   RTC_LOG(LS_INFO) << "The params in SRTP transport are reset.";
 }
@@ -459,9 +578,22 @@ bool SrtpTransport::GetSrtpOverhead(int* srtp_overhead) const {
 
 void SrtpTransport::EnableExternalAuth() {
   RTC_DCHECK(!IsSrtpActive());
+  RTC_DCHECK(!crypto_workers_);
   external_auth_enabled_ = true;
 }
 
+void SrtpTransport::EnableCryptoWorkers(TaskQueueFactory* task_queue_factory,
+                                        int num_workers) {
+  RTC_DCHECK(!IsSrtpActive());
+  RTC_DCHECK(!external_auth_enabled_);
+  crypto_workers_ = std::make_unique<SrtpCryptoWorkerPool>(
+      task_queue_factory, num_workers,
+      [this](bool rtcp, rtc::CopyOnWriteBuffer* packet,
+             const rtc::PacketOptions& options, int flags) {
+        return SendPacket(rtcp, packet, options, flags);
+      });
+}
+
 bool SrtpTransport::IsExternalAuthEnabled() const {
   return external_auth_enabled_;
 }
@@ -19,15 +19,19 @@
 #include <vector>
 
 #include "absl/types/optional.h"
+#include "api/array_view.h"
 #include "api/crypto_params.h"
 #include "api/rtc_error.h"
+#include "api/task_queue/task_queue_factory.h"
 #include "p2p/base/packet_transport_internal.h"
 #include "pc/rtp_transport.h"
+#include "pc/srtp_crypto_worker_pool.h"
 #include "pc/srtp_session.h"
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/copy_on_write_buffer.h"
 #include "rtc_base/network_route.h"
+#include "rtc_base/task_utils/pending_task_safety_flag.h"
 
 namespace webrtc {
 
@@ -44,6 +48,10 @@ class SrtpTransport : public RtpTransport {
   virtual RTCError SetSrtpSendKey(const cricket::CryptoParams& params);
   virtual RTCError SetSrtpReceiveKey(const cricket::CryptoParams& params);
 
+  // Packets marked |batchable| are held until the packet marked
+  // |last_packet_in_batch|, or the next RTCP or non-batchable packet, and
+  // then sent with SendRtpPackets(). For those, returning true only means
+  // that the packet was queued.
   bool SendRtpPacket(rtc::CopyOnWriteBuffer* packet,
                      const rtc::PacketOptions& options,
                      int flags) override;
@@ -52,6 +60,17 @@ class SrtpTransport : public RtpTransport {
                       const rtc::PacketOptions& options,
                       int flags) override;
 
+  // An RTP packet of a SendRtpPackets() call.
+  struct OutgoingRtpPacket {
+    rtc::CopyOnWriteBuffer* packet;
+    rtc::PacketOptions options;
+  };
+  // Protects a burst of RTP packets, e.g. everything the pacer releases at
+  // once, with a single SrtpSession call, and then sends them in order.
+  // Packets that fail to be protected are dropped. Returns the number of
+  // packets sent.
+  int SendRtpPackets(rtc::ArrayView<OutgoingRtpPacket> packets, int flags);
+
   // The transport becomes active if the send_session_ and recv_session_ are
   // created.
   bool IsSrtpActive() const override;
@@ -92,6 +111,15 @@ class SrtpTransport : public RtpTransport {
   void EnableExternalAuth();
   bool IsExternalAuthEnabled() const;
 
+  // Moves the protection of outgoing RTP packets to |num_workers| threads,
+  // which encrypt packets of different SSRCs in parallel. The packets are
+  // still sent on the network thread, in the order they were given to the
+  // transport, so SendRtpPacket() returning true only means that the packet
+  // was queued. Can't be combined with external auth. This method is only
+  // valid before the RTP params have been set.
+  void EnableCryptoWorkers(TaskQueueFactory* task_queue_factory,
+                           int num_workers);
+
   // A SrtpTransport supports external creation of the auth tag if a non-GCM
   // cipher is used. This method is only valid after the RTP params have
   // been set.
@@ -143,6 +171,17 @@ class SrtpTransport : public RtpTransport {
 
   bool UnprotectRtcp(void* data, int in_len, int* out_len);
 
+  // Protects and sends one RTP packet, without batching it.
+  bool ProtectAndSendRtpPacket(rtc::CopyOnWriteBuffer* packet,
+                               const rtc::PacketOptions& options,
+                               int flags);
+  // Holds a batchable RTP packet until the end of its batch.
+  bool AddToPendingRtpBatch(rtc::CopyOnWriteBuffer* packet,
+                            const rtc::PacketOptions& options,
+                            int flags);
+  // Sends the packets held by AddToPendingRtpBatch(), if any.
+  void SendPendingRtpBatch();
+
   bool MaybeSetKeyParams();
   bool ParseKeyParams(const std::string& key_params, uint8_t* key, size_t len);
 
@@ -167,6 +206,25 @@ class SrtpTransport : public RtpTransport {
   int rtp_abs_sendtime_extn_id_ = -1;
 
   int decryption_failure_count_ = 0;
+
+  // Reused by SendRtpPackets() to avoid an allocation per burst.
+  std::vector<cricket::SrtpBatchPacket> srtp_batch_;
+
+  struct PendingRtpPacket {
+    rtc::CopyOnWriteBuffer packet;
+    rtc::PacketOptions options;
+  };
+  // Batchable packets waiting for the end of their batch, all with the
+  // send flags |pending_rtp_flags_|.
+  std::vector<PendingRtpPacket> pending_rtp_batch_;
+  int pending_rtp_flags_ = 0;
+  // Reused by SendPendingRtpBatch() to pass the batch to SendRtpPackets().
+  std::vector<OutgoingRtpPacket> outgoing_rtp_batch_;
+  bool pending_rtp_batch_task_posted_ = false;
+
+  std::unique_ptr<SrtpCryptoWorkerPool> crypto_workers_;
+
+  ScopedTaskSafety task_safety_;
 };
 
 }  // namespace webrtc
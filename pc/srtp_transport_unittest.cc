@@ -16,6 +16,7 @@
 #include <set>
 #include <vector>
 
+#include "api/task_queue/default_task_queue_factory.h"
 #include "call/rtp_demuxer.h"
 #include "media/base/fake_rtp.h"
 #include "p2p/base/dtls_transport_internal.h"
@@ -25,6 +26,7 @@
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/byte_order.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/gunit.h"
 #include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "test/gtest.h"
@@ -43,6 +45,7 @@ static const uint8_t kTestKeyGcm256_1[] =
 static const uint8_t kTestKeyGcm256_2[] =
     "rqponmlkjihgfedcbaZYXWVUTSRQPONMLKJIHGFEDCBA";
 static const int kTestKeyGcm256Len = 44;  // 256 bits key + 96 bits salt.
+static const int kTimeoutMs = 5000;
 
 class SrtpTransportTest : public ::testing::Test, public sigslot::has_slots<> {
  protected:
@@ -68,6 +71,8 @@ class SrtpTransportTest : public ::testing::Test, public sigslot::has_slots<> {
         &rtp_sink1_, &TransportObserver::OnRtcpPacketReceived);
     srtp_transport2_->SignalRtcpPacketReceived.connect(
         &rtp_sink2_, &TransportObserver::OnRtcpPacketReceived);
+    srtp_transport1_->SignalSentPacket.connect(
+        this, &SrtpTransportTest::OnSentPacket);
 
     RtpDemuxerCriteria demuxer_criteria;
     // 0x00 is the payload type used in kPcmuFrame.
@@ -324,6 +329,10 @@ class SrtpTransportTest : public ::testing::Test, public sigslot::has_slots<> {
     TestSendRecvPacketWithEncryptedHeaderExtension(cs_name, encrypted_headers);
   }
 
+  void OnSentPacket(const rtc::SentPacket& sent_packet) {
+    sent_packet_ids_.push_back(sent_packet.packet_id);
+  }
+
   std::unique_ptr<SrtpTransport> srtp_transport1_;
   std::unique_ptr<SrtpTransport> srtp_transport2_;
 
@@ -334,6 +343,7 @@ class SrtpTransportTest : public ::testing::Test, public sigslot::has_slots<> {
   TransportObserver rtp_sink2_;
 
   int sequence_number_ = 0;
+  std::vector<int64_t> sent_packet_ids_;
 };
 
 class SrtpTransportTestWithExternalAuth
@@ -405,6 +415,180 @@ INSTANTIATE_TEST_SUITE_P(ExternalAuth,
                          SrtpTransportTestWithExternalAuth,
                          ::testing::Values(true, false));
 
+TEST_F(SrtpTransportTest, SendRtpPacketsProtectsTheWholeBurst) {
+  std::vector<int> extension_ids;
+  ASSERT_TRUE(srtp_transport1_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids));
+  ASSERT_TRUE(srtp_transport2_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids));
+
+  constexpr int kNumPackets = 5;
+  size_t rtp_len = sizeof(kPcmuFrame);
+  size_t packet_size =
+      rtp_len + rtc::rtp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80);
+  std::vector<rtc::CopyOnWriteBuffer> buffers;
+  for (int i = 0; i < kNumPackets; ++i) {
+    buffers.emplace_back(kPcmuFrame, rtp_len, packet_size);
+    rtc::SetBE16(buffers.back().data() + 2, i + 1);
+  }
+  // Leave no room for the auth tag of one packet.
+  buffers[2] = rtc::CopyOnWriteBuffer(kPcmuFrame, rtp_len, rtp_len);
+  std::vector<SrtpTransport::OutgoingRtpPacket> packets;
+  for (rtc::CopyOnWriteBuffer& buffer : buffers)
+    packets.push_back({&buffer, rtc::PacketOptions()});
+
+  EXPECT_EQ(kNumPackets - 1, srtp_transport1_->SendRtpPackets(
+                                 packets, cricket::PF_SRTP_BYPASS));
+  EXPECT_EQ(kNumPackets - 1, rtp_sink2_.rtp_count());
+  ASSERT_TRUE(rtp_sink2_.last_recv_rtp_packet().data());
+  EXPECT_EQ(0, memcmp(rtp_sink2_.last_recv_rtp_packet().data() + 4,
+                      kPcmuFrame + 4, rtp_len - 4));
+}
+
+TEST_F(SrtpTransportTest, SendsBatchableRtpPacketsAtTheEndOfTheBatch) {
+  std::vector<int> extension_ids;
+  ASSERT_TRUE(srtp_transport1_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids));
+  ASSERT_TRUE(srtp_transport2_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids));
+
+  constexpr int kNumPackets = 4;
+  size_t rtp_len = sizeof(kPcmuFrame);
+  size_t packet_size =
+      rtp_len + rtc::rtp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80);
+  rtc::PacketOptions options;
+  options.batchable = true;
+  for (int i = 0; i < kNumPackets; ++i) {
+    rtc::CopyOnWriteBuffer packet(kPcmuFrame, rtp_len, packet_size);
+    rtc::SetBE16(packet.data() + 2, i + 1);
+    options.last_packet_in_batch = i == kNumPackets - 1;
+    EXPECT_TRUE(srtp_transport1_->SendRtpPacket(&packet, options,
+                                                cricket::PF_SRTP_BYPASS));
+    EXPECT_EQ(options.last_packet_in_batch ? kNumPackets : 0,
+              rtp_sink2_.rtp_count());
+  }
+  ASSERT_TRUE(rtp_sink2_.last_recv_rtp_packet().data());
+  EXPECT_EQ(0, memcmp(rtp_sink2_.last_recv_rtp_packet().data() + 4,
+                      kPcmuFrame + 4, rtp_len - 4));
+}
+
+// With external auth, the batch is sent packet by packet, each packet once
+// and in order.
+TEST_F(SrtpTransportTest, SendsBatchableRtpPacketsWithExternalAuth) {
+  srtp_transport1_->EnableExternalAuth();
+  std::vector<int> extension_ids;
+  ASSERT_TRUE(srtp_transport1_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids));
+  ASSERT_TRUE(srtp_transport1_->IsExternalAuthActive());
+
+  constexpr int kNumPackets = 4;
+  size_t rtp_len = sizeof(kPcmuFrame);
+  size_t packet_size =
+      rtp_len + rtc::rtp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80);
+  rtc::PacketOptions options;
+  options.batchable = true;
+  for (int i = 0; i < kNumPackets; ++i) {
+    rtc::CopyOnWriteBuffer packet(kPcmuFrame, rtp_len, packet_size);
+    rtc::SetBE16(packet.data() + 2, i + 1);
+    options.packet_id = i;
+    options.last_packet_in_batch = i == kNumPackets - 1;
+    EXPECT_TRUE(srtp_transport1_->SendRtpPacket(&packet, options,
+                                                cricket::PF_SRTP_BYPASS));
+    EXPECT_EQ(options.last_packet_in_batch ? kNumPackets : 0,
+              static_cast<int>(sent_packet_ids_.size()));
+  }
+  EXPECT_EQ(sent_packet_ids_, std::vector<int64_t>({0, 1, 2, 3}));
+  TestRtpAuthParams(srtp_transport1_.get(), rtc::CS_AES_CM_128_HMAC_SHA1_80);
+}
+
+TEST_F(SrtpTransportTest, SendsHeldRtpPacketsBeforeRtcp) {
+  std::vector<int> extension_ids;
+  ASSERT_TRUE(srtp_transport1_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids));
+  ASSERT_TRUE(srtp_transport2_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids));
+
+  size_t rtp_len = sizeof(kPcmuFrame);
+  size_t packet_size =
+      rtp_len + rtc::rtp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80);
+  rtc::PacketOptions options;
+  options.batchable = true;
+  for (int i = 0; i < 2; ++i) {
+    rtc::CopyOnWriteBuffer packet(kPcmuFrame, rtp_len, packet_size);
+    rtc::SetBE16(packet.data() + 2, i + 1);
+    EXPECT_TRUE(srtp_transport1_->SendRtpPacket(&packet, options,
+                                                cricket::PF_SRTP_BYPASS));
+  }
+  EXPECT_EQ(0, rtp_sink2_.rtp_count());
+
+  size_t rtcp_len = sizeof(::kRtcpReport);
+  rtc::CopyOnWriteBuffer rtcp_packet(
+      ::kRtcpReport, rtcp_len,
+      rtcp_len + 4 + rtc::rtcp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80));
+  EXPECT_TRUE(srtp_transport1_->SendRtcpPacket(
+      &rtcp_packet, rtc::PacketOptions(), cricket::PF_SRTP_BYPASS));
+  EXPECT_EQ(2, rtp_sink2_.rtp_count());
+  EXPECT_EQ(1, rtp_sink2_.rtcp_count());
+}
+
+TEST_F(SrtpTransportTest, SendsUnfinishedRtpBatch) {
+  std::vector<int> extension_ids;
+  ASSERT_TRUE(srtp_transport1_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids));
+  ASSERT_TRUE(srtp_transport2_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids));
+
+  size_t rtp_len = sizeof(kPcmuFrame);
+  size_t packet_size =
+      rtp_len + rtc::rtp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80);
+  rtc::PacketOptions options;
+  options.batchable = true;
+  for (int i = 0; i < 2; ++i) {
+    rtc::CopyOnWriteBuffer packet(kPcmuFrame, rtp_len, packet_size);
+    rtc::SetBE16(packet.data() + 2, i + 1);
+    EXPECT_TRUE(srtp_transport1_->SendRtpPacket(&packet, options,
+                                                cricket::PF_SRTP_BYPASS));
+  }
+  EXPECT_EQ(0, rtp_sink2_.rtp_count());
+  // The end of the batch never comes, the packets are sent anyway.
+  EXPECT_EQ_WAIT(2, rtp_sink2_.rtp_count(), kTimeoutMs);
+}
+
+TEST_F(SrtpTransportTest, SendRtpPacketsOnCryptoWorkers) {
+  constexpr int kNumPackets = 16;
+  std::unique_ptr<TaskQueueFactory> task_queue_factory =
+      CreateDefaultTaskQueueFactory();
+  srtp_transport1_->EnableCryptoWorkers(task_queue_factory.get(), 2);
+  std::vector<int> extension_ids;
+  ASSERT_TRUE(srtp_transport1_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids));
+  ASSERT_TRUE(srtp_transport2_->SetRtpParams(
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey2, kTestKeyLen, extension_ids,
+      rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen, extension_ids));
+
+  size_t rtp_len = sizeof(kPcmuFrame);
+  size_t packet_size =
+      rtp_len + rtc::rtp_auth_tag_len(rtc::CS_AES_CM_128_HMAC_SHA1_80);
+  for (int i = 0; i < kNumPackets; ++i) {
+    rtc::CopyOnWriteBuffer packet(kPcmuFrame, rtp_len, packet_size);
+    rtc::SetBE16(packet.data() + 2, i / 2 + 1);
+    rtc::SetBE32(packet.data() + 8, 1 + i % 2);
+    EXPECT_TRUE(srtp_transport1_->SendRtpPacket(&packet, rtc::PacketOptions(),
+                                                cricket::PF_SRTP_BYPASS));
+  }
+  EXPECT_EQ_WAIT(kNumPackets, rtp_sink2_.rtp_count(), kTimeoutMs);
+}
+
 // Test directly setting the params with bogus keys.
 TEST_F(SrtpTransportTest, TestSetParamsKeyTooShort) {
   std::vector<int> extension_ids;
@@ -24,10 +24,27 @@ PacketOptions::PacketOptions(DiffServCodePoint dscp) : dscp(dscp) {}
 PacketOptions::PacketOptions(const PacketOptions& other) = default;
 PacketOptions::~PacketOptions() = default;
 
+BatchedPacket::BatchedPacket(const void* data,
+                             size_t size,
+                             const SocketAddress& addr,
+                             const PacketOptions& options)
+    : data(data), size(size), addr(addr), options(options) {}
+BatchedPacket::BatchedPacket(const BatchedPacket& other) = default;
+BatchedPacket::~BatchedPacket() = default;
+
 AsyncPacketSocket::AsyncPacketSocket() = default;
 
 AsyncPacketSocket::~AsyncPacketSocket() = default;
 
+int AsyncPacketSocket::SendToBatch(rtc::ArrayView<const BatchedPacket> packets) {
+  int sent = 0;
+  for (const BatchedPacket& packet : packets) {
+    if (SendTo(packet.data, packet.size, packet.addr, packet.options) >= 0)
+      ++sent;
+  }
+  return (sent == 0 && !packets.empty()) ? -1 : sent;
+}
+
 void CopySocketInformationToPacketInfo(size_t packet_size_bytes,
                                        const AsyncPacketSocket& socket_from,
                                        bool is_connectionless,
@@ -13,6 +13,7 @@
 
 #include <vector>
 
+#include "api/array_view.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/dscp.h"
 #include "rtc_base/network/sent_packet.h"
@@ -52,6 +53,28 @@ struct RTC_EXPORT PacketOptions {
   PacketTimeUpdateParams packet_time_params;
   // PacketInfo is passed to SentPacket when signaling this packet is sent.
   PacketInfo info_signaled_after_sent;
+  // A batchable packet may be held back by the sending port until the packet
+  // with |last_packet_in_batch| set, and then be handed to the socket together
+  // with the rest of the batch in a single SendToBatch() call. Set by the RTP
+  // sender for the packets that the pacer releases in one burst.
+  bool batchable = false;
+  bool last_packet_in_batch = false;
+};
+
+// One packet of an AsyncPacketSocket::SendToBatch() call. |data| must stay
+// valid for the duration of the call.
+struct RTC_EXPORT BatchedPacket {
+  BatchedPacket(const void* data,
+                size_t size,
+                const SocketAddress& addr,
+                const PacketOptions& options);
+  BatchedPacket(const BatchedPacket& other);
+  ~BatchedPacket();
+
+  const void* data;
+  size_t size;
+  SocketAddress addr;
+  PacketOptions options;
 };
 
 // Provides the ability to receive packets asynchronously. Sends are not
@@ -82,6 +105,12 @@ class RTC_EXPORT AsyncPacketSocket : public sigslot::has_slots<> {
                      size_t cb,
                      const SocketAddress& addr,
                      const PacketOptions& options) = 0;
+  // Sends a burst of packets, e.g. everything the pacer releases in one
+  // process call, with as few system calls as the socket allows.
+  // SignalSentPacket is emitted once per packet, in order. Returns the number
+  // of packets handed to the network, or -1 if none could be sent. The
+  // default implementation calls SendTo() for each packet.
+  virtual int SendToBatch(rtc::ArrayView<const BatchedPacket> packets);
 
   // Close the socket.
   virtual int Close() = 0;
@@ -75,6 +75,10 @@ int AsyncSocketAdapter::RecvFrom(void* pv,
   return socket_->RecvFrom(pv, cb, paddr, timestamp);
 }
 
+int AsyncSocketAdapter::RecvFromBatch(rtc::ArrayView<ReceiveSlot> slots) {
+  return socket_->RecvFromBatch(slots);
+}
+
 int AsyncSocketAdapter::Listen(int backlog) {
   return socket_->Listen(backlog);
 }
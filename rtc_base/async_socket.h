@@ -63,6 +63,7 @@ class AsyncSocketAdapter : public AsyncSocket, public sigslot::has_slots<> {
                size_t cb,
                SocketAddress* paddr,
                int64_t* timestamp) override;
+  int RecvFromBatch(rtc::ArrayView<ReceiveSlot> slots) override;
   int Listen(int backlog) override;
   AsyncSocket* Accept(SocketAddress* paddr) override;
   int Close() override;
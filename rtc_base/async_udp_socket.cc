@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <string>
 
 #include "rtc_base/checks.h"
@@ -87,6 +88,31 @@ int AsyncUDPSocket::SendTo(const void* pv,
   return ret;
 }
 
+int AsyncUDPSocket::SendToBatch(rtc::ArrayView<const BatchedPacket> packets) {
+  if (packets.empty())
+    return 0;
+  const int64_t send_time_ms = rtc::TimeMillis();
+  send_slots_.resize(packets.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    send_slots_[i].data = packets[i].data;
+    send_slots_[i].size = packets[i].size;
+    send_slots_[i].remote_address = &packets[i].addr;
+  }
+  int ret = socket_->SendToBatch(send_slots_);
+
+  // Look up the local address once for the whole burst rather than once per
+  // packet as CopySocketInformationToPacketInfo() would.
+  const int ip_overhead_bytes = GetLocalAddress().ipaddr().overhead();
+  for (const BatchedPacket& packet : packets) {
+    rtc::SentPacket sent_packet(packet.options.packet_id, send_time_ms,
+                                packet.options.info_signaled_after_sent);
+    sent_packet.info.packet_size_bytes = packet.size;
+    sent_packet.info.ip_overhead_bytes = ip_overhead_bytes;
+    SignalSentPacket(this, sent_packet);
+  }
+  return ret < 0 ? -1 : ret;
+}
+
 int AsyncUDPSocket::Close() {
   return socket_->Close();
 }
@@ -111,9 +137,30 @@ void AsyncUDPSocket::SetError(int error) {
   return socket_->SetError(error);
 }
 
+void AsyncUDPSocket::SetReceiveBatchSize(size_t max_batch_size,
+                                         size_t slot_size) {
+  RTC_DCHECK_GT(max_batch_size, 0);
+  RTC_DCHECK_GT(slot_size, 0);
+  receive_slots_.clear();
+  batch_buf_.reset();
+  if (max_batch_size <= 1)
+    return;
+  batch_buf_.reset(new char[max_batch_size * slot_size]);
+  receive_slots_.resize(max_batch_size);
+  for (size_t i = 0; i < max_batch_size; ++i) {
+    receive_slots_[i].data = batch_buf_.get() + i * slot_size;
+    receive_slots_[i].capacity = slot_size;
+  }
+}
+
 void AsyncUDPSocket::OnReadEvent(AsyncSocket* socket) {
   RTC_DCHECK(socket_.get() == socket);
 
+  if (!receive_slots_.empty()) {
+    ReadBatch();
+    return;
+  }
+
   SocketAddress remote_addr;
   int64_t timestamp;
   int len = socket_->RecvFrom(buf_, size_, &remote_addr, &timestamp);
@@ -128,12 +175,53 @@ void AsyncUDPSocket::OnReadEvent(AsyncSocket* socket) {
     return;
   }
 
+  UpdateReceiveStats(1);
   // TODO: Make sure that we got all of the packet.
   // If we did not, then we should resize our buffer to be large enough.
   SignalReadPacket(this, buf_, static_cast<size_t>(len), remote_addr,
                    (timestamp > -1 ? timestamp : TimeMicros()));
 }
 
+void AsyncUDPSocket::ReadBatch() {
+  int count = socket_->RecvFromBatch(receive_slots_);
+  if (count < 0) {
+    // See OnReadEvent() for why errors are only logged.
+    SocketAddress local_addr = socket_->GetLocalAddress();
+    RTC_LOG(LS_INFO) << "AsyncUDPSocket[" << local_addr.ToSensitiveString()
+                     << "] batched receive failed with error "
+                     << socket_->GetError();
+    return;
+  }
+
+  UpdateReceiveStats(count);
+  int64_t now_us = -1;
+  for (int i = 0; i < count; ++i) {
+    const Socket::ReceiveSlot& slot = receive_slots_[i];
+    if (slot.truncated) {
+      RTC_LOG(LS_WARNING) << "Dropping datagram larger than the "
+                          << slot.capacity << " byte receive slot.";
+      continue;
+    }
+    int64_t timestamp = slot.timestamp;
+    if (timestamp < 0) {
+      if (now_us < 0)
+        now_us = TimeMicros();
+      timestamp = now_us;
+    }
+    SignalReadPacket(this, static_cast<const char*>(slot.data), slot.size,
+                     slot.remote_address, timestamp);
+  }
+}
+
+void AsyncUDPSocket::UpdateReceiveStats(size_t packets) {
+  if (packets == 0)
+    return;
+  ++receive_stats_.read_events;
+  receive_stats_.packets_received += packets;
+  receive_stats_.max_packets_per_read_event =
+      std::max(receive_stats_.max_packets_per_read_event, packets);
+}
+
 void AsyncUDPSocket::OnWriteEvent(AsyncSocket* socket) {
   SignalReadyToSend(this);
 }
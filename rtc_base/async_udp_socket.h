@@ -14,6 +14,7 @@
 #include <stddef.h>
 
 #include <memory>
+#include <vector>
 
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/async_socket.h"
@@ -48,6 +49,9 @@ class AsyncUDPSocket : public AsyncPacketSocket {
              size_t cb,
              const SocketAddress& addr,
              const rtc::PacketOptions& options) override;
+  // Hands the whole burst to the underlying socket at once, which on Linux
+  // means a single sendmmsg() or UDP GSO sendmsg() call.
+  int SendToBatch(rtc::ArrayView<const BatchedPacket> packets) override;
   int Close() override;
 
   State GetState() const override;
@@ -56,15 +60,49 @@ class AsyncUDPSocket : public AsyncPacketSocket {
   int GetError() const override;
   void SetError(int error) override;
 
+  // Packets-per-wakeup counters for the receive path.
+  struct ReceiveStats {
+    // Number of read events that delivered at least one packet.
+    int64_t read_events = 0;
+    int64_t packets_received = 0;
+    size_t max_packets_per_read_event = 0;
+  };
+
+  // Slot size used by the batched receive mode. Large enough for any datagram
+  // that fits a typical 1500 byte MTU.
+  static constexpr size_t kDefaultReceiveSlotSize = 2048;
+
+  // Enables batched receive: every read event drains up to |max_batch_size|
+  // datagrams from the underlying socket in one call and delivers each one
+  // through SignalReadPacket, pointing directly into a preallocated slot of
+  // |slot_size| bytes. Datagrams that do not fit in a slot are dropped.
+  // Handlers of SignalReadPacket must not destroy this socket while a batch
+  // is being delivered. A |max_batch_size| of 1 restores the default path.
+  void SetReceiveBatchSize(size_t max_batch_size,
+                           size_t slot_size = kDefaultReceiveSlotSize);
+  size_t receive_batch_size() const { return receive_slots_.size(); }
+
+  const ReceiveStats& receive_stats() const { return receive_stats_; }
+
  private:
   // Called when the underlying socket is ready to be read from.
   void OnReadEvent(AsyncSocket* socket);
   // Called when the underlying socket is ready to send.
   void OnWriteEvent(AsyncSocket* socket);
+  // Batched counterpart of OnReadEvent().
+  void ReadBatch();
+  void UpdateReceiveStats(size_t packets);
 
   std::unique_ptr<AsyncSocket> socket_;
   char* buf_;
   size_t size_;
+  // Non-empty only in batched receive mode; each slot points into
+  // |batch_buf_|.
+  std::vector<Socket::ReceiveSlot> receive_slots_;
+  std::unique_ptr<char[]> batch_buf_;
+  ReceiveStats receive_stats_;
+  // Reused by SendToBatch() to avoid an allocation per burst.
+  std::vector<Socket::SendSlot> send_slots_;
 };
 
 }  // namespace rtc
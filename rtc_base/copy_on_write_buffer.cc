@@ -47,6 +47,13 @@ CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size, size_t capacity)
   RTC_DCHECK(IsConsistent());
 }
 
+CopyOnWriteBuffer::CopyOnWriteBuffer(
+    scoped_refptr<RefCountedObject<Buffer>> buffer)
+    : buffer_(std::move(buffer)), offset_(0), size_(buffer_->size()) {
+  RTC_DCHECK(buffer_->HasOneRef());
+  RTC_DCHECK(IsConsistent());
+}
+
 CopyOnWriteBuffer::~CopyOnWriteBuffer() = default;
 
 bool CopyOnWriteBuffer::operator==(const CopyOnWriteBuffer& buf) const {
@@ -43,6 +43,11 @@ class RTC_EXPORT CopyOnWriteBuffer {
   explicit CopyOnWriteBuffer(size_t size);
   CopyOnWriteBuffer(size_t size, size_t capacity);
 
+  // Construct a buffer that uses |buffer| as its storage without copying it.
+  // This lets buffer pools hand out recycled storage; |buffer| must have a
+  // non-zero capacity and must not be referenced by anyone else.
+  explicit CopyOnWriteBuffer(scoped_refptr<RefCountedObject<Buffer>> buffer);
+
   // Construct a buffer and copy the specified number of bytes into it. The
   // source array may be (const) uint8_t*, int8_t*, or char*.
   template <typename T,
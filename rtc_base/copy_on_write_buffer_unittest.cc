@@ -82,6 +82,26 @@ TEST(CopyOnWriteBufferTest, TestMoveAssign) {
   EXPECT_EQ(buf2.data(), buf1_data);
 }
 
+TEST(CopyOnWriteBufferTest, TestConstructFromExistingStorage) {
+  scoped_refptr<RefCountedObject<Buffer>> storage(
+      new RefCountedObject<Buffer>(kTestData, 3, 10));
+  const uint8_t* storage_data = storage->data();
+
+  CopyOnWriteBuffer buf1(std::move(storage));
+  EXPECT_EQ(buf1.size(), 3u);
+  EXPECT_EQ(buf1.capacity(), 10u);
+  EXPECT_EQ(buf1.cdata(), storage_data);
+
+  // The storage is not shared, so writing to it doesn't copy.
+  buf1.AppendData(kTestData, 3);
+  EXPECT_EQ(buf1.cdata(), storage_data);
+
+  CopyOnWriteBuffer buf2 = buf1;
+  buf2.AppendData(kTestData, 3);
+  EnsureBuffersDontShareData(buf1, buf2);
+  EXPECT_EQ(buf1.cdata(), storage_data);
+}
+
 TEST(CopyOnWriteBufferTest, TestSwap) {
   CopyOnWriteBuffer buf1(kTestData, 3, 10);
   size_t buf1_size = buf1.size();
@@ -10,11 +10,39 @@
 
 #include "rtc_base/crc32.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "test/gtest.h"
 
 namespace rtc {
+namespace {
+
+// Bit-at-a-time CRC32 to check the table driven and vectorized versions
+// against.
+uint32_t ReferenceCrc32(uint32_t start, const uint8_t* buf, size_t len) {
+  uint32_t c = start ^ 0xFFFFFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    c ^= buf[i];
+    for (int j = 0; j < 8; ++j) {
+      c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+    }
+  }
+  return c ^ 0xFFFFFFFF;
+}
+
+std::vector<uint8_t> PseudoRandomBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  uint32_t x = 0x12345678;
+  for (uint8_t& byte : bytes) {
+    x = x * 1664525 + 1013904223;
+    byte = static_cast<uint8_t>(x >> 24);
+  }
+  return bytes;
+}
+
+}  // namespace
 
 TEST(Crc32Test, TestBasic) {
   EXPECT_EQ(0U, ComputeCrc32(""));
@@ -34,4 +62,38 @@ TEST(Crc32Test, TestMultipleUpdates) {
   EXPECT_EQ(0x171A3F5FU, c);
 }
 
+// Covers the byte, 8-byte and, where the CPU supports it, 64-byte paths, with
+// every length and misalignment around their boundaries.
+TEST(Crc32Test, MatchesReferenceForAllLengthsAndOffsets) {
+  const std::vector<uint8_t> data = PseudoRandomBytes(1024 + 16);
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t len = 0; len <= 300; ++len) {
+      EXPECT_EQ(ReferenceCrc32(0, &data[offset], len),
+                ComputeCrc32(&data[offset], len))
+          << "offset " << offset << ", length " << len;
+    }
+  }
+  EXPECT_EQ(ReferenceCrc32(0, &data[3], 1024), ComputeCrc32(&data[3], 1024));
+}
+
+TEST(Crc32Test, MatchesReferenceForChunkedUpdates) {
+  const std::vector<uint8_t> data = PseudoRandomBytes(4096);
+  const uint32_t expected = ReferenceCrc32(0, data.data(), data.size());
+  for (size_t chunk : {1, 7, 8, 15, 63, 64, 65, 200, 1500}) {
+    uint32_t c = 0;
+    for (size_t pos = 0; pos < data.size(); pos += chunk) {
+      c = UpdateCrc32(c, &data[pos], std::min(chunk, data.size() - pos));
+    }
+    EXPECT_EQ(expected, c) << "chunk " << chunk;
+  }
+}
+
+TEST(Crc32Test, MatchesReferenceForNonZeroStart) {
+  const std::vector<uint8_t> data = PseudoRandomBytes(256);
+  for (uint32_t start : {0x00000001U, 0xFFFFFFFFU, 0xDEADBEEFU}) {
+    EXPECT_EQ(ReferenceCrc32(start, data.data(), data.size()),
+              UpdateCrc32(start, data.data(), data.size()));
+  }
+}
+
 }  // namespace rtc
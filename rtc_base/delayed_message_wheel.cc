@@ -0,0 +1,331 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/delayed_message_wheel.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "rtc_base/checks.h"
+
+namespace rtc {
+namespace {
+
+int LowestSetBit(uint64_t x) {
+  RTC_DCHECK_NE(x, 0);
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#else
+  int bit = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+int HighestSetBit(uint64_t x) {
+  RTC_DCHECK_NE(x, 0);
+#if defined(__GNUC__)
+  return 63 - __builtin_clzll(x);
+#else
+  int bit = 0;
+  while (x >>= 1)
+    ++bit;
+  return bit;
+#endif
+}
+
+}  // namespace
+
+DelayedMessageWheel::DelayedMessageWheel() = default;
+
+DelayedMessageWheel::~DelayedMessageWheel() = default;
+
+void DelayedMessageWheel::Insert(int64_t run_at_ms, const Message& msg) {
+  int32_t index = AllocateEntry();
+  Entry& entry = entries_[index];
+  entry.run_at_ms = run_at_ms;
+  entry.number = next_number_;
+  entry.msg = msg;
+  // If this message queue processes 1 message every millisecond for 50 days,
+  // we will wrap this number.  Even then, only messages with identical times
+  // will be misordered, and then only briefly.  This is probably ok.
+  ++next_number_;
+  RTC_DCHECK_NE(0, next_number_);
+
+  Link(index);
+  LinkToHandler(index);
+  ++size_;
+  if (next_run_time_valid_)
+    next_run_time_ms_ = std::min(next_run_time_ms_, run_at_ms);
+}
+
+void DelayedMessageWheel::PopDue(int64_t now_ms, MessageList* due) {
+  RTC_DCHECK(due_.empty());
+  std::vector<int32_t>& ready = slots_[kReadySlot];
+  auto not_due = std::remove_if(ready.begin(), ready.end(), [&](int32_t index) {
+    if (entries_[index].run_at_ms > now_ms)
+      return false;
+    due_.push_back(index);
+    return true;
+  });
+  ready.erase(not_due, ready.end());
+  for (size_t i = 0; i < ready.size(); ++i)
+    entries_[ready[i]].position = static_cast<int32_t>(i);
+
+  int64_t slot_time_ms;
+  int slot;
+  while (NextSlot(&slot_time_ms, &slot) && slot_time_ms <= now_ms)
+    Advance(slot_time_ms, slot);
+  // Nothing is due before the next slot, so the remaining messages stay in
+  // the right slots when the wheel is moved forward to |now_ms|.
+  current_ms_ = std::max(current_ms_, now_ms);
+
+  if (due_.empty())
+    return;
+  std::sort(due_.begin(), due_.end(), [this](int32_t a, int32_t b) {
+    const Entry& entry_a = entries_[a];
+    const Entry& entry_b = entries_[b];
+    return entry_a.run_at_ms < entry_b.run_at_ms ||
+           (entry_a.run_at_ms == entry_b.run_at_ms &&
+            entry_a.number < entry_b.number);
+  });
+  for (int32_t index : due_) {
+    UnlinkFromHandler(index);
+    due->push_back(entries_[index].msg);
+    FreeEntry(index);
+  }
+  size_ -= due_.size();
+  due_.clear();
+  next_run_time_valid_ = false;
+}
+
+int64_t DelayedMessageWheel::NextRunTimeMs() {
+  RTC_DCHECK(!empty());
+  if (next_run_time_valid_)
+    return next_run_time_ms_;
+
+  int64_t slot_time_ms;
+  int slot;
+  if (!slots_[kReadySlot].empty()) {
+    next_run_time_ms_ = EarliestRunTimeInSlot(kReadySlot);
+  } else if (NextSlot(&slot_time_ms, &slot)) {
+    // Slots on the first level hold a single run time. Slots further up, and
+    // the overflow list, need to be searched.
+    next_run_time_ms_ = slot < kSlotsPerLevel ? slot_time_ms
+                                              : EarliestRunTimeInSlot(slot);
+  } else {
+    RTC_NOTREACHED();
+  }
+  next_run_time_valid_ = true;
+  return next_run_time_ms_;
+}
+
+void DelayedMessageWheel::Remove(MessageHandler* handler,
+                                 uint32_t id,
+                                 MessageList* removed) {
+  if (handler == nullptr) {
+    // Matches all handlers, collect the entries first since removing them
+    // changes the lists being walked.
+    std::vector<int32_t> matching;
+    for (const auto& handler_and_head : handler_heads_) {
+      for (int32_t index = handler_and_head.second; index != kNone;
+           index = entries_[index].handler_next) {
+        if (entries_[index].msg.Match(nullptr, id))
+          matching.push_back(index);
+      }
+    }
+    for (int32_t index : matching)
+      RemoveEntry(index, removed);
+    return;
+  }
+
+  auto it = handler_heads_.find(handler);
+  if (it == handler_heads_.end())
+    return;
+  for (int32_t index = it->second; index != kNone;) {
+    int32_t next = entries_[index].handler_next;
+    if (entries_[index].msg.Match(handler, id))
+      RemoveEntry(index, removed);
+    index = next;
+  }
+}
+
+int32_t DelayedMessageWheel::AllocateEntry() {
+  if (free_list_ == kNone) {
+    entries_.emplace_back();
+    return static_cast<int32_t>(entries_.size() - 1);
+  }
+  // Free entries are linked through |position|.
+  int32_t index = free_list_;
+  free_list_ = entries_[index].position;
+  return index;
+}
+
+void DelayedMessageWheel::FreeEntry(int32_t index) {
+  entries_[index].msg = Message();
+  entries_[index].slot = kNone;
+  entries_[index].position = free_list_;
+  free_list_ = index;
+}
+
+void DelayedMessageWheel::Link(int32_t index) {
+  Entry& entry = entries_[index];
+  int slot;
+  if (entry.run_at_ms <= current_ms_) {
+    slot = kReadySlot;
+  } else {
+    // A message goes to the level of the highest bit in which its run time
+    // differs from the current time. Since the run time is later, its digit at
+    // that level is larger than that of the current time, and all the digits
+    // above are the same.
+    int level = HighestSetBit(static_cast<uint64_t>(entry.run_at_ms) ^
+                              static_cast<uint64_t>(current_ms_)) /
+                kBitsPerLevel;
+    if (level < kNumLevels) {
+      int slot_in_level = static_cast<int>(
+          (entry.run_at_ms >> (level * kBitsPerLevel)) & (kSlotsPerLevel - 1));
+      slot = level * kSlotsPerLevel + slot_in_level;
+      occupied_[level] |= uint64_t{1} << slot_in_level;
+    } else {
+      constexpr int64_t kOverflowMask =
+          (int64_t{1} << (kNumLevels * kBitsPerLevel)) - 1;
+      int64_t overflow_ms = entry.run_at_ms & ~kOverflowMask;
+      overflow_next_ms_ = slots_[kOverflowSlot].empty()
+                              ? overflow_ms
+                              : std::min(overflow_next_ms_, overflow_ms);
+      slot = kOverflowSlot;
+    }
+  }
+
+  entry.slot = slot;
+  entry.position = static_cast<int32_t>(slots_[slot].size());
+  slots_[slot].push_back(index);
+}
+
+void DelayedMessageWheel::Unlink(int32_t index) {
+  Entry& entry = entries_[index];
+  std::vector<int32_t>& slot = slots_[entry.slot];
+  int32_t last = slot.back();
+  slot[entry.position] = last;
+  entries_[last].position = entry.position;
+  slot.pop_back();
+  if (slot.empty() && entry.slot < kNumWheelSlots) {
+    occupied_[entry.slot / kSlotsPerLevel] &=
+        ~(uint64_t{1} << (entry.slot % kSlotsPerLevel));
+  }
+  entry.slot = kNone;
+}
+
+void DelayedMessageWheel::LinkToHandler(int32_t index) {
+  MaybePruneHandlers();
+  Entry& entry = entries_[index];
+  int32_t& head =
+      handler_heads_.emplace(entry.msg.phandler, kNone).first->second;
+  entry.handler_head = &head;
+  entry.handler_prev = kNone;
+  entry.handler_next = head;
+  if (head != kNone)
+    entries_[head].handler_prev = index;
+  head = index;
+}
+
+void DelayedMessageWheel::UnlinkFromHandler(int32_t index) {
+  Entry& entry = entries_[index];
+  if (entry.handler_prev != kNone) {
+    entries_[entry.handler_prev].handler_next = entry.handler_next;
+  } else {
+    *entry.handler_head = entry.handler_next;
+  }
+  if (entry.handler_next != kNone)
+    entries_[entry.handler_next].handler_prev = entry.handler_prev;
+}
+
+void DelayedMessageWheel::MaybePruneHandlers() {
+  // Handlers often post again right after their message has run, so they are
+  // kept around for a while. Pruning once there are twice as many handlers as
+  // messages keeps this amortized O(1).
+  constexpr size_t kMinHandlersToPrune = 64;
+  if (handler_heads_.size() < kMinHandlersToPrune ||
+      handler_heads_.size() <= 2 * size_) {
+    return;
+  }
+  for (auto it = handler_heads_.begin(); it != handler_heads_.end();) {
+    it = it->second == kNone ? handler_heads_.erase(it) : std::next(it);
+  }
+}
+
+void DelayedMessageWheel::RemoveEntry(int32_t index, MessageList* removed) {
+  Unlink(index);
+  UnlinkFromHandler(index);
+  if (removed) {
+    removed->push_back(entries_[index].msg);
+  } else {
+    delete entries_[index].msg.pdata;
+  }
+  FreeEntry(index);
+  --size_;
+  next_run_time_valid_ = false;
+}
+
+bool DelayedMessageWheel::NextSlot(int64_t* time_ms, int* slot) const {
+  // Everything on a level is due before anything on the levels above, so the
+  // first non-empty slot of the lowest non-empty level is next.
+  for (int level = 0; level < kNumLevels; ++level) {
+    if (occupied_[level] == 0)
+      continue;
+    int slot_in_level = LowestSetBit(occupied_[level]);
+    int shift = level * kBitsPerLevel;
+    int64_t level_mask = (int64_t{1} << (shift + kBitsPerLevel)) - 1;
+    *time_ms = (current_ms_ & ~level_mask) | (int64_t{slot_in_level} << shift);
+    *slot = level * kSlotsPerLevel + slot_in_level;
+    return true;
+  }
+  if (!slots_[kOverflowSlot].empty()) {
+    *time_ms = overflow_next_ms_;
+    *slot = kOverflowSlot;
+    return true;
+  }
+  return false;
+}
+
+void DelayedMessageWheel::Advance(int64_t time_ms, int slot) {
+  RTC_DCHECK_GT(time_ms, current_ms_);
+  current_ms_ = time_ms;
+  // Swapped out, since overflow entries may go back to the same slot.
+  RTC_DCHECK(advancing_.empty());
+  std::swap(advancing_, slots_[slot]);
+  if (slot < kNumWheelSlots) {
+    occupied_[slot / kSlotsPerLevel] &=
+        ~(uint64_t{1} << (slot % kSlotsPerLevel));
+  }
+  for (int32_t index : advancing_) {
+    if (entries_[index].run_at_ms <= current_ms_) {
+      entries_[index].slot = kNone;
+      due_.push_back(index);
+    } else {
+      Link(index);
+    }
+  }
+  advancing_.clear();
+}
+
+int64_t DelayedMessageWheel::EarliestRunTimeInSlot(int slot) const {
+  RTC_DCHECK(!slots_[slot].empty());
+  int64_t earliest_ms = entries_[slots_[slot][0]].run_at_ms;
+  for (int32_t index : slots_[slot])
+    earliest_ms = std::min(earliest_ms, entries_[index].run_at_ms);
+  return earliest_ms;
+}
+
+}  // namespace rtc
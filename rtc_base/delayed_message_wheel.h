@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_DELAYED_MESSAGE_WHEEL_H_
+#define RTC_BASE_DELAYED_MESSAGE_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "rtc_base/thread_message.h"
+
+namespace rtc {
+
+// Holds the delayed messages of an rtc::Thread in a hierarchical timing wheel
+// with millisecond resolution. Inserting and removing a message is O(1), and
+// each message is moved between levels of the wheel at most once per level
+// before it is due. Messages are also linked per MessageHandler, so that
+// removing the messages of one handler only touches those messages.
+//
+// Messages are returned in run time order, and messages with the same run
+// time in the order they were inserted.
+//
+// Not thread safe, rtc::Thread guards it with its own lock.
+class DelayedMessageWheel {
+ public:
+  DelayedMessageWheel();
+  DelayedMessageWheel(const DelayedMessageWheel&) = delete;
+  DelayedMessageWheel& operator=(const DelayedMessageWheel&) = delete;
+  ~DelayedMessageWheel();
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Adds |msg| to be run at |run_at_ms|.
+  void Insert(int64_t run_at_ms, const Message& msg);
+
+  // Appends all messages with a run time not later than |now_ms| to |due|.
+  // |now_ms| is expected to be non-decreasing between calls.
+  void PopDue(int64_t now_ms, MessageList* due);
+
+  // Returns the run time of the earliest message. Must not be called when
+  // empty.
+  int64_t NextRunTimeMs();
+
+  // Removes all messages that match |handler| and |id|, in the same sense as
+  // Message::Match(). Removed messages are appended to |removed| if not null,
+  // otherwise their data is deleted.
+  void Remove(MessageHandler* handler, uint32_t id, MessageList* removed);
+
+ private:
+  static constexpr int kBitsPerLevel = 6;
+  static constexpr int kSlotsPerLevel = 1 << kBitsPerLevel;
+  // Six levels cover a bit more than two years; anything further out is kept
+  // in a separate overflow list.
+  static constexpr int kNumLevels = 6;
+  static constexpr int kNumWheelSlots = kNumLevels * kSlotsPerLevel;
+  // Messages with a run time not later than |current_ms_|.
+  static constexpr int kReadySlot = kNumWheelSlots;
+  static constexpr int kOverflowSlot = kNumWheelSlots + 1;
+  static constexpr int kNumSlots = kNumWheelSlots + 2;
+  static constexpr int32_t kNone = -1;
+
+  struct Entry {
+    int64_t run_at_ms;
+    // Insertion order, used to order messages with the same run time.
+    uint32_t number;
+    // Slot the entry is in, and its position there.
+    int32_t slot;
+    int32_t position;
+    // Links within the list of messages of the handler, and the head of that
+    // list in |handler_heads_|.
+    int32_t handler_prev;
+    int32_t handler_next;
+    int32_t* handler_head;
+    Message msg;
+  };
+
+  int32_t AllocateEntry();
+  void FreeEntry(int32_t index);
+
+  // Puts entry |index| in the slot given by its run time relative to
+  // |current_ms_|.
+  void Link(int32_t index);
+  void Unlink(int32_t index);
+  void LinkToHandler(int32_t index);
+  void UnlinkFromHandler(int32_t index);
+  void RemoveEntry(int32_t index, MessageList* removed);
+  // Drops the handlers that have no messages from |handler_heads_| once there
+  // are many of them.
+  void MaybePruneHandlers();
+
+  // Finds the next non-empty wheel slot, or the overflow list, and the time at
+  // which it needs to be looked at. Returns false if there is none.
+  bool NextSlot(int64_t* time_ms, int* slot) const;
+  // Moves |current_ms_| to |time_ms| and the contents of |slot| to the lower
+  // levels, or to |due_| if they are due at |time_ms|.
+  void Advance(int64_t time_ms, int slot);
+  // Returns the earliest run time in |slot|.
+  int64_t EarliestRunTimeInSlot(int slot) const;
+
+  size_t size_ = 0;
+  uint32_t next_number_ = 0;
+  int64_t current_ms_ = 0;
+  int64_t overflow_next_ms_ = 0;
+  // Cached result of NextRunTimeMs(), valid if |next_run_time_valid_|.
+  bool next_run_time_valid_ = false;
+  int64_t next_run_time_ms_ = 0;
+
+  std::vector<Entry> entries_;
+  int32_t free_list_ = kNone;
+  // Indices of the entries in each slot.
+  std::vector<int32_t> slots_[kNumSlots];
+  // Bit i of |occupied_[level]| is set if slot i of that level is non-empty.
+  uint64_t occupied_[kNumLevels] = {};
+  // First entry of each handler, or kNone. Entries point to the values, which
+  // stay in place until the handler is pruned.
+  std::unordered_map<MessageHandler*, int32_t> handler_heads_;
+
+  // Scratch space for PopDue().
+  std::vector<int32_t> due_;
+  std::vector<int32_t> advancing_;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_DELAYED_MESSAGE_WHEEL_H_
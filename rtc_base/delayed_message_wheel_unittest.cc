@@ -0,0 +1,227 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/delayed_message_wheel.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class FakeHandler : public MessageHandler {
+ public:
+  void OnMessage(Message* msg) override {}
+};
+
+class DeleteCounter : public MessageData {
+ public:
+  explicit DeleteCounter(int* deleted) : deleted_(deleted) {}
+  ~DeleteCounter() override { ++*deleted_; }
+
+ private:
+  int* const deleted_;
+};
+
+Message MakeMessage(MessageHandler* handler, uint32_t id) {
+  Message msg;
+  msg.phandler = handler;
+  msg.message_id = id;
+  return msg;
+}
+
+std::vector<uint32_t> PopDueIds(DelayedMessageWheel& wheel, int64_t now_ms) {
+  MessageList due;
+  wheel.PopDue(now_ms, &due);
+  std::vector<uint32_t> ids;
+  for (const Message& msg : due)
+    ids.push_back(msg.message_id);
+  return ids;
+}
+
+TEST(DelayedMessageWheelTest, ReturnsMessagesInRunTimeOrder) {
+  FakeHandler handler;
+  DelayedMessageWheel wheel;
+  wheel.Insert(1300, MakeMessage(&handler, 3));
+  wheel.Insert(1100, MakeMessage(&handler, 1));
+  wheel.Insert(1200, MakeMessage(&handler, 2));
+  EXPECT_EQ(wheel.size(), 3u);
+  EXPECT_EQ(wheel.NextRunTimeMs(), 1100);
+
+  EXPECT_THAT(PopDueIds(wheel, 1099), IsEmpty());
+  EXPECT_THAT(PopDueIds(wheel, 1250), ElementsAre(1, 2));
+  EXPECT_EQ(wheel.NextRunTimeMs(), 1300);
+  EXPECT_THAT(PopDueIds(wheel, 1300), ElementsAre(3));
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(DelayedMessageWheelTest, KeepsInsertionOrderOfMessagesWithSameRunTime) {
+  FakeHandler handler;
+  DelayedMessageWheel wheel;
+  PopDueIds(wheel, 1000);
+  // Inserted far enough ahead to be moved down from an upper level of the
+  // wheel, while the later messages are inserted directly on the first level.
+  wheel.Insert(5000, MakeMessage(&handler, 1));
+  wheel.Insert(5000, MakeMessage(&handler, 2));
+  EXPECT_THAT(PopDueIds(wheel, 4990), IsEmpty());
+  wheel.Insert(5000, MakeMessage(&handler, 3));
+  wheel.Insert(4995, MakeMessage(&handler, 0));
+  EXPECT_THAT(PopDueIds(wheel, 5000), ElementsAre(0, 1, 2, 3));
+}
+
+TEST(DelayedMessageWheelTest, ReturnsMessagesInsertedInThePastRightAway) {
+  FakeHandler handler;
+  DelayedMessageWheel wheel;
+  PopDueIds(wheel, 1000);
+  wheel.Insert(900, MakeMessage(&handler, 2));
+  wheel.Insert(1000, MakeMessage(&handler, 3));
+  wheel.Insert(800, MakeMessage(&handler, 1));
+  EXPECT_EQ(wheel.NextRunTimeMs(), 800);
+  EXPECT_THAT(PopDueIds(wheel, 1000), ElementsAre(1, 2, 3));
+}
+
+TEST(DelayedMessageWheelTest, HandlesRunTimesFarInTheFuture) {
+  constexpr int64_t kHourMs = 60 * 60 * 1000;
+  FakeHandler handler;
+  DelayedMessageWheel wheel;
+  PopDueIds(wheel, 1000);
+  // The last one is further out than the wheel covers.
+  wheel.Insert(1000 + 24 * kHourMs, MakeMessage(&handler, 2));
+  wheel.Insert(1000 + kHourMs, MakeMessage(&handler, 1));
+  wheel.Insert(1000 + 5 * 365 * 24 * kHourMs, MakeMessage(&handler, 3));
+
+  EXPECT_EQ(wheel.NextRunTimeMs(), 1000 + kHourMs);
+  EXPECT_THAT(PopDueIds(wheel, 1000 + kHourMs - 1), IsEmpty());
+  EXPECT_THAT(PopDueIds(wheel, 1000 + kHourMs), ElementsAre(1));
+  EXPECT_EQ(wheel.NextRunTimeMs(), 1000 + 24 * kHourMs);
+  EXPECT_THAT(PopDueIds(wheel, 1000 + 24 * kHourMs), ElementsAre(2));
+  EXPECT_EQ(wheel.NextRunTimeMs(), 1000 + 5 * 365 * 24 * kHourMs);
+  EXPECT_THAT(PopDueIds(wheel, 1000 + 5 * 365 * 24 * kHourMs - 1), IsEmpty());
+  EXPECT_THAT(PopDueIds(wheel, 1000 + 5 * 365 * 24 * kHourMs), ElementsAre(3));
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(DelayedMessageWheelTest, RemovesMessagesOfOneHandler) {
+  FakeHandler handler1;
+  FakeHandler handler2;
+  DelayedMessageWheel wheel;
+  wheel.Insert(100, MakeMessage(&handler1, 1));
+  wheel.Insert(200, MakeMessage(&handler2, 2));
+  wheel.Insert(300, MakeMessage(&handler1, 3));
+  wheel.Insert(400, MakeMessage(&handler2, 4));
+
+  MessageList removed;
+  wheel.Remove(&handler1, MQID_ANY, &removed);
+  ASSERT_EQ(removed.size(), 2u);
+  for (const Message& msg : removed)
+    EXPECT_EQ(msg.phandler, &handler1);
+  EXPECT_EQ(wheel.size(), 2u);
+  EXPECT_EQ(wheel.NextRunTimeMs(), 200);
+  EXPECT_THAT(PopDueIds(wheel, 1000), ElementsAre(2, 4));
+}
+
+TEST(DelayedMessageWheelTest, RemovesMessagesWithId) {
+  FakeHandler handler1;
+  FakeHandler handler2;
+  DelayedMessageWheel wheel;
+  wheel.Insert(100, MakeMessage(&handler1, 1));
+  wheel.Insert(200, MakeMessage(&handler1, 2));
+  wheel.Insert(300, MakeMessage(&handler2, 1));
+
+  wheel.Remove(&handler1, 1, nullptr);
+  EXPECT_EQ(wheel.size(), 2u);
+  wheel.Remove(nullptr, 1, nullptr);
+  EXPECT_EQ(wheel.size(), 1u);
+  EXPECT_THAT(PopDueIds(wheel, 1000), ElementsAre(2));
+}
+
+TEST(DelayedMessageWheelTest, DeletesDataOfRemovedMessages) {
+  FakeHandler handler;
+  DelayedMessageWheel wheel;
+  int deleted = 0;
+  for (int i = 0; i < 3; ++i) {
+    Message msg = MakeMessage(&handler, i);
+    msg.pdata = new DeleteCounter(&deleted);
+    wheel.Insert(100 * i, msg);
+  }
+  wheel.Remove(nullptr, MQID_ANY, nullptr);
+  EXPECT_EQ(deleted, 3);
+  EXPECT_TRUE(wheel.empty());
+}
+
+// Compares against a plain ordered map for a random mix of insertions,
+// removals and time steps of very different sizes.
+TEST(DelayedMessageWheelTest, MatchesOrderedMapForRandomOperations) {
+  webrtc::Random random(4711);
+  FakeHandler handlers[4];
+  DelayedMessageWheel wheel;
+  // Keyed on (run time, insertion order).
+  std::map<std::pair<int64_t, int>, Message> reference;
+  int64_t now_ms = 123456;
+  int num_inserted = 0;
+
+  for (int step = 0; step < 20000; ++step) {
+    int action = random.Rand(0, 9);
+    if (action < 6) {
+      int64_t delay_ms = 0;
+      switch (random.Rand(0, 3)) {
+        case 0:
+          delay_ms = random.Rand(-10, 100);
+          break;
+        case 1:
+          delay_ms = random.Rand(0, 10000);
+          break;
+        case 2:
+          delay_ms = random.Rand(0, 10000000);
+          break;
+        case 3:
+          delay_ms = int64_t{random.Rand(0, 1000000)} * 100000;
+          break;
+      }
+      Message msg = MakeMessage(&handlers[random.Rand(0, 3)], num_inserted);
+      wheel.Insert(now_ms + delay_ms, msg);
+      reference.emplace(std::make_pair(now_ms + delay_ms, num_inserted), msg);
+      ++num_inserted;
+    } else if (action < 7) {
+      MessageHandler* handler = &handlers[random.Rand(0, 3)];
+      uint32_t id = random.Rand(0, 1) ? MQID_ANY : random.Rand(0, num_inserted);
+      wheel.Remove(handler, id, nullptr);
+      for (auto it = reference.begin(); it != reference.end();) {
+        it = it->second.Match(handler, id) ? reference.erase(it) : ++it;
+      }
+    } else {
+      if (!reference.empty()) {
+        ASSERT_EQ(wheel.NextRunTimeMs(), reference.begin()->first.first);
+        // Mostly jump to the next message, sometimes way past it.
+        now_ms = std::max(now_ms, wheel.NextRunTimeMs()) +
+                 (random.Rand(0, 3) == 0 ? random.Rand(0, 100000000) : 0);
+      }
+      std::vector<uint32_t> expected;
+      while (!reference.empty() && reference.begin()->first.first <= now_ms) {
+        expected.push_back(reference.begin()->second.message_id);
+        reference.erase(reference.begin());
+      }
+      ASSERT_EQ(PopDueIds(wheel, now_ms), expected);
+    }
+    ASSERT_EQ(wheel.size(), reference.size());
+  }
+}
+
+}  // namespace
+}  // namespace rtc
@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/hmac_sha1.h"
+
+#include <openssl/sha.h>
+#include <string.h>
+
+namespace rtc {
+
+struct HmacSha1::State {
+  SHA_CTX inner;
+  SHA_CTX outer;
+};
+
+HmacSha1::HmacSha1(const void* key, size_t key_len) : state_(new State()) {
+  // Keys longer than a block are hashed first, shorter ones are zero-padded.
+  uint8_t key_block[SHA_CBLOCK] = {0};
+  if (key_len > SHA_CBLOCK) {
+    SHA1(static_cast<const uint8_t*>(key), key_len, key_block);
+  } else if (key_len > 0) {
+    memcpy(key_block, key, key_len);
+  }
+
+  uint8_t pad[SHA_CBLOCK];
+  for (size_t i = 0; i < SHA_CBLOCK; ++i) {
+    pad[i] = key_block[i] ^ 0x36;
+  }
+  SHA1_Init(&state_->inner);
+  SHA1_Update(&state_->inner, pad, sizeof(pad));
+  for (size_t i = 0; i < SHA_CBLOCK; ++i) {
+    pad[i] = key_block[i] ^ 0x5c;
+  }
+  SHA1_Init(&state_->outer);
+  SHA1_Update(&state_->outer, pad, sizeof(pad));
+}
+
+HmacSha1::HmacSha1(const std::string& key)
+    : HmacSha1(key.data(), key.size()) {}
+
+HmacSha1::~HmacSha1() = default;
+
+void HmacSha1::Compute(std::initializer_list<ArrayView<const uint8_t>> parts,
+                       uint8_t mac[kSize]) const {
+  static_assert(kSize == SHA_DIGEST_LENGTH, "");
+  SHA_CTX ctx = state_->inner;
+  for (const ArrayView<const uint8_t>& part : parts) {
+    SHA1_Update(&ctx, part.data(), part.size());
+  }
+  uint8_t inner[SHA_DIGEST_LENGTH];
+  SHA1_Final(inner, &ctx);
+
+  ctx = state_->outer;
+  SHA1_Update(&ctx, inner, sizeof(inner));
+  SHA1_Final(mac, &ctx);
+}
+
+}  // namespace rtc
@@ -0,0 +1,56 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_HMAC_SHA1_H_
+#define RTC_BASE_HMAC_SHA1_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+#include "api/array_view.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/system/rtc_export.h"
+
+namespace rtc {
+
+// HMAC-SHA1 (RFC 2104) with a fixed key. The hash states after the inner and
+// outer key pads are computed once, when the object is created, so that
+// computing a MAC costs only the hashing of the data, which for short messages
+// such as STUN binding requests is less than half of what rtc::ComputeHmac
+// costs. Compute() is const and may be called from several threads at once.
+class RTC_EXPORT HmacSha1 {
+ public:
+  static constexpr size_t kSize = 20;
+
+  HmacSha1(const void* key, size_t key_len);
+  explicit HmacSha1(const std::string& key);
+  ~HmacSha1();
+
+  // Computes the MAC of the concatenation of |parts| into |mac|.
+  void Compute(std::initializer_list<ArrayView<const uint8_t>> parts,
+               uint8_t mac[kSize]) const;
+  void Compute(const void* data, size_t len, uint8_t mac[kSize]) const {
+    Compute({MakeArrayView(static_cast<const uint8_t*>(data), len)}, mac);
+  }
+
+ private:
+  struct State;
+  const std::unique_ptr<State> state_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(HmacSha1);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_HMAC_SHA1_H_
@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/hmac_sha1.h"
+
+#include <string>
+
+#include "rtc_base/message_digest.h"
+#include "rtc_base/string_encode.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+std::string HexHmac(const std::string& key, const std::string& input) {
+  HmacSha1 hmac(key);
+  uint8_t mac[HmacSha1::kSize];
+  hmac.Compute(input.data(), input.size(), mac);
+  return hex_encode(reinterpret_cast<const char*>(mac), sizeof(mac));
+}
+
+}  // namespace
+
+// Test vectors from RFC 2202.
+TEST(HmacSha1Test, TestVectors) {
+  EXPECT_EQ("b617318655057264e28bc0b6fb378c8ef146be00",
+            HexHmac(std::string(20, '\x0b'), "Hi There"));
+  EXPECT_EQ("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+            HexHmac("Jefe", "what do ya want for nothing?"));
+  EXPECT_EQ("125d7342b9ac11cd91a39af48aa17b4f63f175d3",
+            HexHmac(std::string(20, '\xaa'), std::string(50, '\xdd')));
+  EXPECT_EQ(
+      "4c9007f4026250c6bc8414f9bf50c86c2d7235da",
+      HexHmac("\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+              "\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19",
+              std::string(50, '\xcd')));
+  EXPECT_EQ("4c1a03424b55e07fe7f27be1d58bb9324a9a5a04",
+            HexHmac(std::string(20, '\x0c'), "Test With Truncation"));
+  EXPECT_EQ("aa4ae5e15272d00e95705637ce8a3b55ed402112",
+            HexHmac(std::string(80, '\xaa'),
+                    "Test Using Larger Than Block-Size Key - Hash Key First"));
+  EXPECT_EQ("e8e99d0f45237d786d6bbaa7965c7808bbff1a91",
+            HexHmac(std::string(80, '\xaa'),
+                    "Test Using Larger Than Block-Size Key and Larger "
+                    "Than One Block-Size Data"));
+}
+
+TEST(HmacSha1Test, MatchesComputeHmac) {
+  // Key lengths around the block size, and inputs of up to several blocks.
+  for (size_t key_len : {0, 1, 22, 63, 64, 65, 200}) {
+    std::string key(key_len, '\0');
+    for (size_t i = 0; i < key_len; ++i) {
+      key[i] = static_cast<char>(i * 31 + 7);
+    }
+    HmacSha1 hmac(key);
+    for (size_t input_len = 0; input_len < 300; input_len += 13) {
+      std::string input(input_len, '\0');
+      for (size_t i = 0; i < input_len; ++i) {
+        input[i] = static_cast<char>(i * 17 + key_len);
+      }
+      uint8_t mac[HmacSha1::kSize];
+      hmac.Compute(input.data(), input.size(), mac);
+      EXPECT_EQ(ComputeHmac(DIGEST_SHA_1, key, input),
+                hex_encode(reinterpret_cast<const char*>(mac), sizeof(mac)))
+          << "key length " << key_len << ", input length " << input_len;
+    }
+  }
+}
+
+TEST(HmacSha1Test, ComputesOverConcatenatedParts) {
+  HmacSha1 hmac("Jefe");
+  const std::string input = "what do ya want for nothing?";
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+  uint8_t mac[HmacSha1::kSize];
+  hmac.Compute({MakeArrayView(data, 2), MakeArrayView(data + 2, 0),
+                MakeArrayView(data + 2, input.size() - 2)},
+               mac);
+  EXPECT_EQ("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+            hex_encode(reinterpret_cast<const char*>(mac), sizeof(mac)));
+  // The key state is reused, not consumed.
+  hmac.Compute(data, input.size(), mac);
+  EXPECT_EQ("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+            hex_encode(reinterpret_cast<const char*>(mac), sizeof(mac)));
+}
+
+}  // namespace rtc
@@ -342,6 +342,7 @@ bool OpenSSLStreamAdapter::SetPeerCertificateDigest(
   }
 
   if (state_ == SSL_CONNECTED) {
+    CacheSession();
     // Post the event asynchronously to unwind the stack. The caller
     // of ContinueSSL may be the same object listening for these
     // events and may not be prepared for reentrancy.
@@ -487,6 +488,10 @@ bool OpenSSLStreamAdapter::IsTlsConnected() {
   return state_ == SSL_CONNECTED;
 }
 
+bool OpenSSLStreamAdapter::IsResumedSession() const {
+  return state_ == SSL_CONNECTED && SSL_session_reused(ssl_);
+}
+
 int OpenSSLStreamAdapter::StartSSL() {
   // Don't allow StartSSL to be called twice.
   if (state_ != SSL_NONE) {
@@ -522,6 +527,11 @@ void OpenSSLStreamAdapter::SetInitialRetransmissionTimeout(int timeout_ms) {
   dtls_handshake_timeout_ms_ = timeout_ms;
 }
 
+void OpenSSLStreamAdapter::SetSessionCache(SSLSessionCache* cache) {
+  RTC_DCHECK(ssl_ctx_ == nullptr);
+  session_cache_ = static_cast<OpenSSLStreamSessionCache*>(cache);
+}
+
 //
 // StreamInterface Implementation
 //
@@ -828,6 +838,16 @@ int OpenSSLStreamAdapter::BeginSSL() {
   SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE |
                          SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 
+  // Offer the last session with this peer, if there is one. The server decides
+  // whether to resume it.
+  if (session_cache_ && role_ == SSL_CLIENT && HasPeerCertificateDigest()) {
+    SSL_SESSION* session = session_cache_->LookupSession(SessionCacheKey());
+    if (session) {
+      SSL_set_session(ssl_, session);
+      SSL_SESSION_free(session);
+    }
+  }
+
   // Do the connect
   return ContinueSSL();
 }
@@ -845,11 +865,18 @@ int OpenSSLStreamAdapter::ContinueSSL() {
   switch (ssl_error) {
     case SSL_ERROR_NONE:
       RTC_LOG(LS_VERBOSE) << " -- success";
+      if (SSL_session_reused(ssl_)) {
+        RTC_LOG(LS_INFO) << "Resumed session with peer.";
+        if (!SetPeerCertChainFromSession()) {
+          return -1;
+        }
+      }
       // By this point, OpenSSL should have given us a certificate, or errored
       // out if one was missing.
       RTC_DCHECK(peer_cert_chain_ || !GetClientAuthEnabled());
 
       state_ = SSL_CONNECTED;
+      CacheSession();
       if (!WaitingToVerifyPeerCertificate()) {
         // We have everything we need to start the connection, so signal
         // SE_OPEN. If we need a client certificate fingerprint and don't have
@@ -1008,6 +1035,14 @@ SSL_CTX* OpenSSLStreamAdapter::SetupSSLContext() {
     return nullptr;
   }
 
+  if (session_cache_ && role_ == SSL_SERVER) {
+    RTC_DCHECK_EQ(session_cache_->GetSSLMode(), ssl_mode_);
+    if (!session_cache_->ConfigureServerContext(ctx)) {
+      SSL_CTX_free(ctx);
+      return nullptr;
+    }
+  }
+
 #if !defined(NDEBUG)
   SSL_CTX_set_info_callback(ctx, OpenSSLAdapter::SSLInfoCallback);
 #endif
@@ -1076,6 +1111,58 @@ bool OpenSSLStreamAdapter::VerifyPeerCertificate() {
   return true;
 }
 
+bool OpenSSLStreamAdapter::SetPeerCertChainFromSession() {
+#if defined(OPENSSL_IS_BORINGSSL)
+  STACK_OF(X509)* chain = SSL_get_peer_full_cert_chain(ssl_);
+  if (!chain || sk_X509_num(chain) == 0) {
+    RTC_LOG(LS_WARNING) << "Resumed session has no peer certificate.";
+    return role_ == SSL_SERVER && !GetClientAuthEnabled();
+  }
+  std::vector<std::unique_ptr<SSLCertificate>> cert_chain;
+  for (X509* cert : chain) {
+    cert_chain.emplace_back(new OpenSSLCertificate(cert));
+  }
+  peer_cert_chain_.reset(new SSLCertChain(std::move(cert_chain)));
+#else
+  X509* cert = SSL_get_peer_certificate(ssl_);
+  if (!cert) {
+    RTC_LOG(LS_WARNING) << "Resumed session has no peer certificate.";
+    return role_ == SSL_SERVER && !GetClientAuthEnabled();
+  }
+  peer_cert_chain_.reset(
+      new SSLCertChain(std::make_unique<OpenSSLCertificate>(cert)));
+  X509_free(cert);
+#endif
+
+  // As after a full handshake, verification waits for the digest if it isn't
+  // known yet.
+  if (!HasPeerCertificateDigest()) {
+    return true;
+  }
+  return VerifyPeerCertificate();
+}
+
+std::string OpenSSLStreamAdapter::SessionCacheKey() const {
+  return peer_certificate_digest_algorithm_ + ":" +
+         std::string(peer_certificate_digest_value_.data<char>(),
+                     peer_certificate_digest_value_.size());
+}
+
+void OpenSSLStreamAdapter::CacheSession() {
+  if (!session_cache_ || role_ != SSL_CLIENT || !peer_certificate_verified_) {
+    return;
+  }
+  SSL_SESSION* session = SSL_get1_session(ssl_);
+  if (!session) {
+    return;
+  }
+  if (!SSL_SESSION_is_resumable(session)) {
+    SSL_SESSION_free(session);
+    return;
+  }
+  session_cache_->AddSession(SessionCacheKey(), session);
+}
+
 std::unique_ptr<SSLCertChain> OpenSSLStreamAdapter::GetPeerSSLCertChain()
     const {
   return peer_cert_chain_ ? peer_cert_chain_->Clone() : nullptr;
@@ -21,6 +21,7 @@
 
 #include "rtc_base/buffer.h"
 #include "rtc_base/openssl_identity.h"
+#include "rtc_base/openssl_stream_session_cache.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/stream.h"
@@ -79,6 +80,7 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   void SetMode(SSLMode mode) override;
   void SetMaxProtocolVersion(SSLProtocolVersion version) override;
   void SetInitialRetransmissionTimeout(int timeout_ms) override;
+  void SetSessionCache(SSLSessionCache* cache) override;
 
   StreamResult Read(void* data,
                     size_t data_len,
@@ -111,6 +113,7 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   bool GetDtlsSrtpCryptoSuite(int* crypto_suite) override;
 
   bool IsTlsConnected() override;
+  bool IsResumedSession() const override;
 
   // Capabilities interfaces.
   static bool IsBoringSsl();
@@ -179,6 +182,16 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
     return GetClientAuthEnabled() && !peer_certificate_verified_;
   }
 
+  // A resumed session carries no certificate in the handshake, so the verify
+  // callback is not called. Takes the certificate chain the peer presented
+  // when the session was established instead.
+  bool SetPeerCertChainFromSession();
+  // The key of sessions with this peer in |session_cache_|.
+  std::string SessionCacheKey() const;
+  // Stores the session in |session_cache_|, if this is a client whose
+  // connection is established and whose peer has been verified.
+  void CacheSession();
+
   bool HasPeerCertificateDigest() const {
     return !peer_certificate_digest_algorithm_.empty() &&
            !peer_certificate_digest_value_.empty();
@@ -218,6 +231,9 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   // be too aggressive for low bandwidth links.
   int dtls_handshake_timeout_ms_ = 50;
 
+  // Sessions shared with other adapters. Not owned.
+  OpenSSLStreamSessionCache* session_cache_ = nullptr;
+
   // TODO(https://bugs.webrtc.org/10261): Completely remove this option in M84.
   const bool support_legacy_tls_protocols_flag_;
 };
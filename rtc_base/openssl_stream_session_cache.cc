@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/openssl_stream_session_cache.h"
+
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/openssl.h"
+
+namespace rtc {
+namespace {
+
+// Servers only resume sessions that were established in the same context.
+// Since peers are authenticated by certificate digest rather than by the
+// context, all servers share one.
+const unsigned char kSessionIdContext[] = "webrtc";
+
+}  // namespace
+
+OpenSSLStreamSessionCache::OpenSSLStreamSessionCache(SSLMode ssl_mode,
+                                                     size_t max_sessions)
+    : ssl_mode_(ssl_mode), max_sessions_(max_sessions) {
+  RTC_DCHECK_GT(max_sessions, 0);
+  RTC_CHECK_EQ(1, RAND_bytes(ticket_keys_, sizeof(ticket_keys_)));
+}
+
+OpenSSLStreamSessionCache::~OpenSSLStreamSessionCache() {
+  for (const auto& it : sessions_) {
+    SSL_SESSION_free(it.second);
+  }
+}
+
+SSLMode OpenSSLStreamSessionCache::GetSSLMode() const {
+  return ssl_mode_;
+}
+
+bool OpenSSLStreamSessionCache::ConfigureServerContext(SSL_CTX* ssl_ctx) const {
+  if (!SSL_CTX_set_session_id_context(ssl_ctx, kSessionIdContext,
+                                      sizeof(kSessionIdContext) - 1)) {
+    return false;
+  }
+  // The const_cast is needed for OpenSSL, whose macro takes a void*. The keys
+  // are only read.
+  return SSL_CTX_set_tlsext_ticket_keys(
+             ssl_ctx, const_cast<uint8_t*>(ticket_keys_),
+             sizeof(ticket_keys_)) == 1;
+}
+
+SSL_SESSION* OpenSSLStreamSessionCache::LookupSession(
+    const std::string& peer_digest) {
+  CritScope cs(&crit_);
+  auto it = sessions_by_digest_.find(peer_digest);
+  if (it == sessions_by_digest_.end()) {
+    return nullptr;
+  }
+  sessions_.splice(sessions_.begin(), sessions_, it->second);
+  SSL_SESSION* session = it->second->second;
+  SSL_SESSION_up_ref(session);
+  return session;
+}
+
+void OpenSSLStreamSessionCache::AddSession(const std::string& peer_digest,
+                                           SSL_SESSION* new_session) {
+  CritScope cs(&crit_);
+  auto it = sessions_by_digest_.find(peer_digest);
+  if (it != sessions_by_digest_.end()) {
+    SSL_SESSION_free(it->second->second);
+    it->second->second = new_session;
+    sessions_.splice(sessions_.begin(), sessions_, it->second);
+    return;
+  }
+  if (sessions_.size() == max_sessions_) {
+    SSL_SESSION_free(sessions_.back().second);
+    sessions_by_digest_.erase(sessions_.back().first);
+    sessions_.pop_back();
+  }
+  sessions_.emplace_front(peer_digest, new_session);
+  sessions_by_digest_[peer_digest] = sessions_.begin();
+}
+
+size_t OpenSSLStreamSessionCache::GetSessionCount() const {
+  CritScope cs(&crit_);
+  return sessions_.size();
+}
+
+}  // namespace rtc
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_OPENSSL_STREAM_SESSION_CACHE_H_
+#define RTC_BASE_OPENSSL_STREAM_SESSION_CACHE_H_
+
+#include <openssl/ossl_typ.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/thread_annotations.h"
+
+#ifndef OPENSSL_IS_BORINGSSL
+typedef struct ssl_session_st SSL_SESSION;
+#endif
+
+namespace rtc {
+
+// The OpenSSLStreamSessionCache holds what OpenSSLStreamAdapters need to
+// resume sessions with each other: the keys that servers protect their session
+// tickets with, and for clients, the last session with each peer, keyed by the
+// digest of the certificate the peer is expected to present.
+class OpenSSLStreamSessionCache final : public SSLSessionCache {
+ public:
+  // The number of peers whose sessions are kept by default. Beyond that, the
+  // least recently used session is dropped.
+  static constexpr size_t kDefaultMaxSessions = 10000;
+
+  explicit OpenSSLStreamSessionCache(
+      SSLMode ssl_mode,
+      size_t max_sessions = kDefaultMaxSessions);
+  // Frees the cached SSL_SESSIONs.
+  ~OpenSSLStreamSessionCache() override;
+
+  SSLMode GetSSLMode() const override;
+
+  // Makes servers using |ssl_ctx| issue session tickets that any server using
+  // this cache can resume from, and accept the tickets those servers issued.
+  // Returns false if the SSL_CTX could not be configured.
+  bool ConfigureServerContext(SSL_CTX* ssl_ctx) const;
+
+  // Looks up the session with the peer whose certificate digest is
+  // |peer_digest|. The returned SSL_SESSION is up_refed and must be freed by
+  // the caller. Returns nullptr if there is no such session.
+  SSL_SESSION* LookupSession(const std::string& peer_digest);
+  // Adds a session to the cache, taking over the caller's reference. Any
+  // existing session with the same peer is replaced.
+  void AddSession(const std::string& peer_digest, SSL_SESSION* session);
+  // The number of peers that have a session in the cache.
+  size_t GetSessionCount() const;
+
+ private:
+#ifdef OPENSSL_IS_BORINGSSL
+  static constexpr size_t kTicketKeysLength = 48;
+#else
+  static constexpr size_t kTicketKeysLength = 80;
+#endif
+
+  const SSLMode ssl_mode_;
+  const size_t max_sessions_;
+  // Name, MAC and encryption keys for session tickets, drawn at random when
+  // the cache is created, so that tickets cannot outlive it.
+  uint8_t ticket_keys_[kTicketKeysLength];
+
+  rtc::CriticalSection crit_;
+  // Sessions with their peer digests, most recently used first; holds
+  // references to the SSL_SESSIONs.
+  std::list<std::pair<std::string, SSL_SESSION*>> sessions_
+      RTC_GUARDED_BY(crit_);
+  std::map<std::string,
+           std::list<std::pair<std::string, SSL_SESSION*>>::iterator>
+      sessions_by_digest_ RTC_GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLStreamSessionCache);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_OPENSSL_STREAM_SESSION_CACHE_H_
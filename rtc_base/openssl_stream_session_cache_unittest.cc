@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/openssl_stream_session_cache.h"
+
+#include <openssl/ssl.h>
+
+#include "rtc_base/gunit.h"
+#include "rtc_base/openssl.h"
+
+namespace rtc {
+
+TEST(OpenSSLStreamSessionCache, ModeSetCorrectly) {
+  OpenSSLStreamSessionCache dtls_cache(SSL_MODE_DTLS);
+  EXPECT_EQ(dtls_cache.GetSSLMode(), SSL_MODE_DTLS);
+  OpenSSLStreamSessionCache tls_cache(SSL_MODE_TLS);
+  EXPECT_EQ(tls_cache.GetSSLMode(), SSL_MODE_TLS);
+}
+
+TEST(OpenSSLStreamSessionCache, InvalidLookupReturnsNullptr) {
+  OpenSSLStreamSessionCache session_cache(SSL_MODE_DTLS);
+  EXPECT_EQ(session_cache.LookupSession("sha-256:invalid"), nullptr);
+  EXPECT_EQ(session_cache.LookupSession(""), nullptr);
+}
+
+TEST(OpenSSLStreamSessionCache, LookupReturnsReferenceToSession) {
+  SSL_CTX* ssl_ctx = SSL_CTX_new(DTLSv1_2_client_method());
+  SSL_SESSION* ssl_session = SSL_SESSION_new(ssl_ctx);
+
+  OpenSSLStreamSessionCache session_cache(SSL_MODE_DTLS);
+  session_cache.AddSession("peer", ssl_session);
+  SSL_SESSION* found = session_cache.LookupSession("peer");
+  EXPECT_EQ(found, ssl_session);
+  SSL_SESSION_free(found);
+  EXPECT_EQ(session_cache.GetSessionCount(), 1u);
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLStreamSessionCache, AddToExistingReplacesPrevious) {
+  SSL_CTX* ssl_ctx = SSL_CTX_new(DTLSv1_2_client_method());
+  SSL_SESSION* ssl_session_1 = SSL_SESSION_new(ssl_ctx);
+  SSL_SESSION* ssl_session_2 = SSL_SESSION_new(ssl_ctx);
+
+  OpenSSLStreamSessionCache session_cache(SSL_MODE_DTLS);
+  session_cache.AddSession("peer", ssl_session_1);
+  session_cache.AddSession("peer", ssl_session_2);
+  SSL_SESSION* found = session_cache.LookupSession("peer");
+  EXPECT_EQ(found, ssl_session_2);
+  SSL_SESSION_free(found);
+  EXPECT_EQ(session_cache.GetSessionCount(), 1u);
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLStreamSessionCache, EvictsLeastRecentlyUsedSession) {
+  SSL_CTX* ssl_ctx = SSL_CTX_new(DTLSv1_2_client_method());
+
+  OpenSSLStreamSessionCache session_cache(SSL_MODE_DTLS, /*max_sessions=*/2);
+  session_cache.AddSession("peer 1", SSL_SESSION_new(ssl_ctx));
+  session_cache.AddSession("peer 2", SSL_SESSION_new(ssl_ctx));
+  // Using the session with peer 1 makes peer 2 the least recently used.
+  SSL_SESSION_free(session_cache.LookupSession("peer 1"));
+  session_cache.AddSession("peer 3", SSL_SESSION_new(ssl_ctx));
+
+  EXPECT_EQ(session_cache.GetSessionCount(), 2u);
+  EXPECT_EQ(session_cache.LookupSession("peer 2"), nullptr);
+  SSL_SESSION* session_1 = session_cache.LookupSession("peer 1");
+  EXPECT_NE(session_1, nullptr);
+  SSL_SESSION_free(session_1);
+  SSL_SESSION* session_3 = session_cache.LookupSession("peer 3");
+  EXPECT_NE(session_3, nullptr);
+  SSL_SESSION_free(session_3);
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLStreamSessionCache, ConfiguresServerContext) {
+  SSL_CTX* ssl_ctx = SSL_CTX_new(DTLS_method());
+
+  OpenSSLStreamSessionCache session_cache(SSL_MODE_DTLS);
+  EXPECT_TRUE(session_cache.ConfigureServerContext(ssl_ctx));
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+}  // namespace rtc
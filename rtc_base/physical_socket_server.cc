@@ -40,6 +40,7 @@
 #include <errno.h>
 
 #include <algorithm>
+#include <array>
 #include <map>
 
 #include "rtc_base/arraysize.h"
@@ -54,6 +55,17 @@
 #include <linux/sockios.h>
 #endif
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+#include <netinet/udp.h>
+// Only defined by recent kernel/libc headers.
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+#if !defined(SOL_UDP)
+#define SOL_UDP 17
+#endif
+#endif
+
 #if defined(WEBRTC_WIN)
 #define LAST_SYSTEM_ERROR (::GetLastError())
 #elif defined(__native_client__) && __native_client__
@@ -432,6 +444,221 @@ int PhysicalSocket::RecvFrom(void* buffer,
   return received;
 }
 
+int PhysicalSocket::RecvFromBatch(rtc::ArrayView<ReceiveSlot> slots) {
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  if (!udp_ || slots.size() <= 1) {
+    return AsyncSocket::RecvFromBatch(slots);
+  }
+  if (!recv_timestamps_enabled_) {
+    // SIOCGSTAMP only reports the timestamp of the last datagram read, so ask
+    // for a per-datagram timestamp as ancillary data instead.
+    int enable = 1;
+    ::setsockopt(s_, SOL_SOCKET, SO_TIMESTAMP, &enable, sizeof(enable));
+    recv_timestamps_enabled_ = true;
+  }
+
+  const size_t count = std::min(slots.size(), kMaxRecvBatchSize);
+  constexpr size_t kControlSize = CMSG_SPACE(sizeof(struct timeval));
+  std::array<mmsghdr, kMaxRecvBatchSize> msgs;
+  std::array<iovec, kMaxRecvBatchSize> iovs;
+  std::array<sockaddr_storage, kMaxRecvBatchSize> addrs;
+  alignas(cmsghdr) char control[kMaxRecvBatchSize][kControlSize];
+  for (size_t i = 0; i < count; ++i) {
+    iovs[i].iov_base = slots[i].data;
+    iovs[i].iov_len = slots[i].capacity;
+    msghdr& hdr = msgs[i].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &addrs[i];
+    hdr.msg_namelen = sizeof(addrs[i]);
+    hdr.msg_iov = &iovs[i];
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control[i];
+    hdr.msg_controllen = kControlSize;
+    msgs[i].msg_len = 0;
+  }
+  int received =
+      ::recvmmsg(s_, msgs.data(), static_cast<unsigned int>(count), 0, nullptr);
+  UpdateLastError();
+  for (int i = 0; i < received; ++i) {
+    ReceiveSlot& slot = slots[i];
+    const msghdr& hdr = msgs[i].msg_hdr;
+    slot.size = std::min<size_t>(msgs[i].msg_len, slot.capacity);
+    slot.truncated = (hdr.msg_flags & MSG_TRUNC) != 0;
+    SocketAddressFromSockAddrStorage(addrs[i], &slot.remote_address);
+    slot.timestamp = -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&hdr), cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP) {
+        struct timeval tv;
+        memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+        slot.timestamp =
+            kNumMicrosecsPerSec * static_cast<int64_t>(tv.tv_sec) +
+            static_cast<int64_t>(tv.tv_usec);
+      }
+    }
+  }
+  int error = GetError();
+  bool success = (received >= 0) || IsBlockingError(error);
+  // Datagram sockets always re-arm the read event, as in RecvFrom().
+  EnableEvents(DE_READ);
+  if (!success) {
+    RTC_LOG_F(LS_VERBOSE) << "Error = " << error;
+  }
+  return received;
+#else
+  return AsyncSocket::RecvFromBatch(slots);
+#endif
+}
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+namespace {
+
+// Upper bounds for one UDP GSO send, see UDP_MAX_SEGMENTS in the kernel and
+// the 64 KB limit of the resulting super-datagram.
+constexpr size_t kMaxGsoSegments = 64;
+constexpr size_t kMaxGsoPayloadSize = 64000;
+
+// Returns how many datagrams, at most |max_count|, at the front of |slots| can
+// be sent as one UDP GSO super-datagram: all to the same destination and of
+// the same size, except for the last one which may be shorter.
+size_t GsoRunLength(rtc::ArrayView<const Socket::SendSlot> slots,
+                    size_t max_count) {
+  max_count = std::min({max_count, slots.size(), kMaxGsoSegments});
+  if (max_count == 0 || slots[0].size == 0)
+    return 0;
+  const Socket::SendSlot& first = slots[0];
+  size_t total_size = 0;
+  size_t count = 0;
+  while (count < max_count) {
+    const Socket::SendSlot& slot = slots[count];
+    if (slot.size == 0 || slot.size > first.size ||
+        total_size + slot.size > kMaxGsoPayloadSize ||
+        (slot.remote_address != first.remote_address &&
+         *slot.remote_address != *first.remote_address)) {
+      break;
+    }
+    total_size += slot.size;
+    ++count;
+    if (slot.size < first.size)
+      break;
+  }
+  return count;
+}
+
+}  // namespace
+#endif  // defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+
+int PhysicalSocket::SendToBatch(rtc::ArrayView<const SendSlot> slots) {
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  if (!udp_ || slots.size() <= 1) {
+    return AsyncSocket::SendToBatch(slots);
+  }
+
+  size_t sent = 0;
+  bool failed = false;
+  while (sent < slots.size() && !failed) {
+    rtc::ArrayView<const SendSlot> remaining = slots.subview(sent);
+    size_t gso_count =
+        udp_gso_enabled_ ? GsoRunLength(remaining, kMaxSendBatchSize) : 0;
+    int result;
+    if (gso_count >= 2) {
+      result = SendGsoBatch(remaining.subview(0, gso_count));
+      if (result < 0 && !udp_gso_enabled_) {
+        // Not supported on this socket; retry the same datagrams below.
+        continue;
+      }
+    } else {
+      // Send everything up to the start of the next GSO candidate run.
+      size_t count = 1;
+      while (count < remaining.size() && count < kMaxSendBatchSize &&
+             !(udp_gso_enabled_ &&
+               GsoRunLength(remaining.subview(count), 2) == 2)) {
+        ++count;
+      }
+      result = SendMmsgBatch(remaining.subview(0, count));
+    }
+    if (result <= 0) {
+      failed = true;
+    } else {
+      sent += result;
+    }
+  }
+
+  MaybeRemapSendError();
+  if (failed && IsBlockingError(GetError())) {
+    EnableEvents(DE_WRITE);
+  }
+  return sent > 0 ? static_cast<int>(sent) : SOCKET_ERROR;
+#else
+  return AsyncSocket::SendToBatch(slots);
+#endif
+}
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+int PhysicalSocket::SendGsoBatch(rtc::ArrayView<const SendSlot> slots) {
+  RTC_DCHECK_LE(slots.size(), kMaxSendBatchSize);
+  std::array<iovec, kMaxSendBatchSize> iovs;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    iovs[i].iov_base = const_cast<void*>(slots[i].data);
+    iovs[i].iov_len = slots[i].size;
+  }
+  sockaddr_storage saddr;
+  size_t addr_len = slots[0].remote_address->ToSockAddrStorage(&saddr);
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {0};
+  msghdr hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.msg_name = &saddr;
+  hdr.msg_namelen = static_cast<socklen_t>(addr_len);
+  hdr.msg_iov = iovs.data();
+  hdr.msg_iovlen = slots.size();
+  hdr.msg_control = control;
+  hdr.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  const uint16_t segment_size = static_cast<uint16_t>(slots[0].size);
+  memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+
+  int ret = ::sendmsg(s_, &hdr, MSG_NOSIGNAL);
+  UpdateLastError();
+  if (ret < 0) {
+    int error = GetError();
+    if (error == EIO || error == EINVAL || error == ENOPROTOOPT ||
+        error == EOPNOTSUPP) {
+      RTC_LOG(LS_INFO) << "UDP GSO send failed with error " << error
+                       << ", falling back to sendmmsg.";
+      udp_gso_enabled_ = false;
+    }
+    return SOCKET_ERROR;
+  }
+  return static_cast<int>(slots.size());
+}
+
+int PhysicalSocket::SendMmsgBatch(rtc::ArrayView<const SendSlot> slots) {
+  RTC_DCHECK_LE(slots.size(), kMaxSendBatchSize);
+  std::array<mmsghdr, kMaxSendBatchSize> msgs;
+  std::array<iovec, kMaxSendBatchSize> iovs;
+  std::array<sockaddr_storage, kMaxSendBatchSize> addrs;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    iovs[i].iov_base = const_cast<void*>(slots[i].data);
+    iovs[i].iov_len = slots[i].size;
+    size_t addr_len = slots[i].remote_address->ToSockAddrStorage(&addrs[i]);
+    msghdr& hdr = msgs[i].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &addrs[i];
+    hdr.msg_namelen = static_cast<socklen_t>(addr_len);
+    hdr.msg_iov = &iovs[i];
+    hdr.msg_iovlen = 1;
+    msgs[i].msg_len = 0;
+  }
+  int ret = ::sendmmsg(s_, msgs.data(), static_cast<unsigned int>(slots.size()),
+                       MSG_NOSIGNAL);
+  UpdateLastError();
+  return ret;
+}
+#endif  // defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+
 int PhysicalSocket::Listen(int backlog) {
   int err = ::listen(s_, backlog);
   UpdateLastError();
@@ -586,6 +813,15 @@ int PhysicalSocket::TranslateOption(Option opt, int* slevel, int* sopt) {
 #endif
     case OPT_RTP_SENDTIME_EXTN_ID:
       return -1;  // No logging is necessary as this not a OS socket option.
+    case OPT_REUSEPORT:
+#if defined(WEBRTC_POSIX) && defined(SO_REUSEPORT)
+      *slevel = SOL_SOCKET;
+      *sopt = SO_REUSEPORT;
+      break;
+#else
+      RTC_LOG(LS_WARNING) << "Socket::OPT_REUSEPORT not supported.";
+      return -1;
+#endif
     default:
       RTC_NOTREACHED();
       return -1;
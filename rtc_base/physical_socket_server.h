@@ -150,6 +150,14 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
                size_t length,
                SocketAddress* out_addr,
                int64_t* timestamp) override;
+  // On Linux, drains up to kMaxRecvBatchSize datagrams with one recvmmsg()
+  // call. Other platforms fall back to a single RecvFrom().
+  int RecvFromBatch(rtc::ArrayView<ReceiveSlot> slots) override;
+  // On Linux, sends runs of equally sized datagrams to the same destination
+  // as one UDP GSO (UDP_SEGMENT) super-datagram when the kernel supports it,
+  // and everything else with sendmmsg(). Other platforms send one datagram
+  // at a time.
+  int SendToBatch(rtc::ArrayView<const SendSlot> slots) override;
 
   int Listen(int backlog) override;
   AsyncSocket* Accept(SocketAddress* out_addr) override;
@@ -158,6 +166,11 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
 
   SocketServer* socketserver() { return ss_; }
 
+  // The maximum number of datagrams read by a single RecvFromBatch() call.
+  static constexpr size_t kMaxRecvBatchSize = 64;
+  // The maximum number of datagrams passed to a single send system call.
+  static constexpr size_t kMaxSendBatchSize = 64;
+
  protected:
   int DoConnect(const SocketAddress& connect_addr);
 
@@ -202,6 +215,17 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
 
  private:
   uint8_t enabled_events_ = 0;
+  // Set once SO_TIMESTAMP has been enabled for batched receives.
+  bool recv_timestamps_enabled_ = false;
+  // Cleared the first time the kernel rejects a UDP GSO send.
+  bool udp_gso_enabled_ = true;
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  // Helpers for SendToBatch(). Both return the number of datagrams sent or
+  // SOCKET_ERROR.
+  int SendGsoBatch(rtc::ArrayView<const SendSlot> slots);
+  int SendMmsgBatch(rtc::ArrayView<const SendSlot> slots);
+#endif
 };
 
 class SocketDispatcher : public Dispatcher, public PhysicalSocket {
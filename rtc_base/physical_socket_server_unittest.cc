@@ -14,7 +14,11 @@
 
 #include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "rtc_base/async_socket.h"
+#include "rtc_base/async_udp_socket.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/ip_address.h"
 #include "rtc_base/logging.h"
@@ -501,6 +505,230 @@ TEST_F(PhysicalSocketTest,
   server_->set_network_binder(nullptr);
 }
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+
+class ReadPacketCollector : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    packets.emplace_back(data, size);
+  }
+
+  std::vector<std::string> packets;
+};
+
+class SentPacketCollector : public sigslot::has_slots<> {
+ public:
+  void OnSentPacket(AsyncPacketSocket* socket, const SentPacket& sent_packet) {
+    packet_ids.push_back(sent_packet.packet_id);
+    packet_sizes.push_back(sent_packet.info.packet_size_bytes);
+  }
+
+  std::vector<int64_t> packet_ids;
+  std::vector<size_t> packet_sizes;
+};
+
+TEST_F(PhysicalSocketTest, RecvFromBatchReadsAllQueuedDatagramsIPv4) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncSocket> receiver(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<AsyncSocket> sender(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  // Loopback delivery is synchronous, so all datagrams are queued on return.
+  const int kNumDatagrams = 5;
+  for (int i = 0; i < kNumDatagrams; ++i) {
+    char payload = static_cast<char>('a' + i);
+    ASSERT_EQ(1, sender->SendTo(&payload, 1, receiver->GetLocalAddress()));
+  }
+
+  char buffers[8][16];
+  std::vector<Socket::ReceiveSlot> slots(8);
+  for (size_t i = 0; i < slots.size(); ++i) {
+    slots[i].data = buffers[i];
+    slots[i].capacity = sizeof(buffers[i]);
+  }
+  ASSERT_EQ(kNumDatagrams, receiver->RecvFromBatch(slots));
+  for (int i = 0; i < kNumDatagrams; ++i) {
+    EXPECT_EQ(1u, slots[i].size);
+    EXPECT_FALSE(slots[i].truncated);
+    EXPECT_EQ('a' + i, buffers[i][0]);
+    EXPECT_EQ(sender->GetLocalAddress(), slots[i].remote_address);
+    EXPECT_GT(slots[i].timestamp, 0);
+  }
+
+  EXPECT_EQ(SOCKET_ERROR, receiver->RecvFromBatch(slots));
+  EXPECT_TRUE(receiver->IsBlocking());
+}
+
+TEST_F(PhysicalSocketTest, AsyncSocketAdapterForwardsRecvFromBatchIPv4) {
+  MAYBE_SKIP_IPV4;
+  AsyncSocketAdapter receiver(server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<AsyncSocket> sender(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver.Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  const int kNumDatagrams = 3;
+  for (int i = 0; i < kNumDatagrams; ++i) {
+    char payload = static_cast<char>('a' + i);
+    ASSERT_EQ(1, sender->SendTo(&payload, 1, receiver.GetLocalAddress()));
+  }
+
+  // The default implementation would only read one datagram per call.
+  char buffers[4][16];
+  std::vector<Socket::ReceiveSlot> slots(4);
+  for (size_t i = 0; i < slots.size(); ++i) {
+    slots[i].data = buffers[i];
+    slots[i].capacity = sizeof(buffers[i]);
+  }
+  EXPECT_EQ(kNumDatagrams, receiver.RecvFromBatch(slots));
+}
+
+TEST_F(PhysicalSocketTest, RecvFromBatchReportsTruncatedDatagramsIPv4) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncSocket> receiver(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<AsyncSocket> sender(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  const char kPayload[] = "0123456789";
+  ASSERT_EQ(10, sender->SendTo(kPayload, 10, receiver->GetLocalAddress()));
+  ASSERT_EQ(2, sender->SendTo(kPayload, 2, receiver->GetLocalAddress()));
+
+  char buffers[2][4];
+  std::vector<Socket::ReceiveSlot> slots(2);
+  for (size_t i = 0; i < slots.size(); ++i) {
+    slots[i].data = buffers[i];
+    slots[i].capacity = sizeof(buffers[i]);
+  }
+  ASSERT_EQ(2, receiver->RecvFromBatch(slots));
+  EXPECT_TRUE(slots[0].truncated);
+  EXPECT_EQ(4u, slots[0].size);
+  EXPECT_FALSE(slots[1].truncated);
+  EXPECT_EQ(2u, slots[1].size);
+}
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketDeliversBatchOnSingleReadEventIPv4) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(server_.get(), SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<AsyncSocket> sender(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_TRUE(receiver);
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  receiver->SetReceiveBatchSize(16);
+  ReadPacketCollector collector;
+  receiver->SignalReadPacket.connect(&collector,
+                                     &ReadPacketCollector::OnReadPacket);
+
+  const int kNumDatagrams = 10;
+  for (int i = 0; i < kNumDatagrams; ++i) {
+    std::string payload = "packet" + std::to_string(i);
+    ASSERT_EQ(static_cast<int>(payload.size()),
+              sender->SendTo(payload.data(), payload.size(),
+                             receiver->GetLocalAddress()));
+  }
+  EXPECT_TRUE(server_->Wait(0, true));
+
+  ASSERT_EQ(static_cast<size_t>(kNumDatagrams), collector.packets.size());
+  for (int i = 0; i < kNumDatagrams; ++i) {
+    EXPECT_EQ("packet" + std::to_string(i), collector.packets[i]);
+  }
+  EXPECT_EQ(1, receiver->receive_stats().read_events);
+  EXPECT_EQ(kNumDatagrams, receiver->receive_stats().packets_received);
+  EXPECT_EQ(static_cast<size_t>(kNumDatagrams),
+            receiver->receive_stats().max_packets_per_read_event);
+}
+
+// Mixes runs of equally sized datagrams, which may be sent with UDP GSO, with
+// differently sized ones, which are sent with sendmmsg().
+TEST_F(PhysicalSocketTest, SendToBatchDeliversDatagramsInOrderIPv4) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncSocket> receiver(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<AsyncSocket> sender(
+      server_->CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  const SocketAddress destination = receiver->GetLocalAddress();
+
+  const std::vector<size_t> kSizes = {1200, 1200, 1200, 1200, 700,
+                                      100,  200,  300,  900,  900};
+  std::vector<std::string> payloads;
+  std::vector<Socket::SendSlot> send_slots(kSizes.size());
+  payloads.reserve(kSizes.size());
+  for (size_t i = 0; i < kSizes.size(); ++i) {
+    payloads.emplace_back(kSizes[i], static_cast<char>('a' + i));
+    send_slots[i].data = payloads[i].data();
+    send_slots[i].size = payloads[i].size();
+    send_slots[i].remote_address = &destination;
+  }
+  ASSERT_EQ(static_cast<int>(kSizes.size()), sender->SendToBatch(send_slots));
+
+  char buffers[16][1500];
+  std::vector<Socket::ReceiveSlot> slots(16);
+  for (size_t i = 0; i < slots.size(); ++i) {
+    slots[i].data = buffers[i];
+    slots[i].capacity = sizeof(buffers[i]);
+  }
+  ASSERT_EQ(static_cast<int>(kSizes.size()), receiver->RecvFromBatch(slots));
+  for (size_t i = 0; i < kSizes.size(); ++i) {
+    EXPECT_EQ(payloads[i],
+              std::string(static_cast<const char*>(slots[i].data),
+                          slots[i].size));
+    EXPECT_EQ(sender->GetLocalAddress(), slots[i].remote_address);
+  }
+}
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketSignalsEachPacketOfBatchIPv4) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(server_.get(), SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(server_.get(), SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(sender);
+  ASSERT_TRUE(receiver);
+  receiver->SetReceiveBatchSize(16);
+  SentPacketCollector sent_collector;
+  sender->SignalSentPacket.connect(&sent_collector,
+                                   &SentPacketCollector::OnSentPacket);
+  ReadPacketCollector read_collector;
+  receiver->SignalReadPacket.connect(&read_collector,
+                                     &ReadPacketCollector::OnReadPacket);
+
+  const std::string kPayload(1000, 'x');
+  std::vector<BatchedPacket> packets;
+  for (int i = 0; i < 8; ++i) {
+    PacketOptions options;
+    options.packet_id = 100 + i;
+    packets.emplace_back(kPayload.data(), kPayload.size() - i,
+                         receiver->GetLocalAddress(), options);
+  }
+  EXPECT_EQ(8, sender->SendToBatch(packets));
+
+  ASSERT_EQ(8u, sent_collector.packet_ids.size());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(100 + i, sent_collector.packet_ids[i]);
+    EXPECT_EQ(kPayload.size() - i, sent_collector.packet_sizes[i]);
+  }
+
+  EXPECT_TRUE(server_->Wait(0, true));
+  ASSERT_EQ(8u, read_collector.packets.size());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(kPayload.size() - i, read_collector.packets[i].size());
+  }
+}
+
+#endif  // defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+
 #endif
 
 }  // namespace rtc
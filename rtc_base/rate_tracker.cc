@@ -22,7 +22,7 @@ static const int64_t kTimeUnset = -1;
 RateTracker::RateTracker(int64_t bucket_milliseconds, size_t bucket_count)
     : bucket_milliseconds_(bucket_milliseconds),
       bucket_count_(bucket_count),
-      sample_buckets_(new int64_t[bucket_count + 1]),
+      sample_buckets_(nullptr),
       total_sample_count_(0u),
       bucket_start_time_milliseconds_(kTimeUnset) {
   RTC_CHECK(bucket_milliseconds > 0);
@@ -140,6 +140,9 @@ void RateTracker::EnsureInitialized() {
     initialization_time_milliseconds_ = Time();
     bucket_start_time_milliseconds_ = initialization_time_milliseconds_;
     current_bucket_ = 0;
+    // The buckets are allocated with the first sample, since many trackers,
+    // like those of unused connections, never get one.
+    sample_buckets_ = new int64_t[bucket_count_ + 1];
     // We only need to initialize the first bucket because we reset buckets when
     // current_bucket_ increments.
     sample_buckets_[current_bucket_] = 0;
@@ -57,6 +57,20 @@ class RTCCertificateGenerationTask : public RefCountInterface,
     RTC_DCHECK(worker_thread_);
     RTC_DCHECK(callback_);
   }
+  // For a request that is served with an already generated |certificate|,
+  // which only needs the |MSG_GENERATE_DONE| step.
+  RTCCertificateGenerationTask(
+      Thread* signaling_thread,
+      const scoped_refptr<RTCCertificate>& certificate,
+      const scoped_refptr<RTCCertificateGeneratorCallback>& callback)
+      : signaling_thread_(signaling_thread),
+        worker_thread_(nullptr),
+        callback_(callback),
+        certificate_(certificate) {
+    RTC_DCHECK(signaling_thread_);
+    RTC_DCHECK(certificate_);
+    RTC_DCHECK(callback_);
+  }
   ~RTCCertificateGenerationTask() override {}
 
   // Handles |MSG_GENERATE| and its follow-up |MSG_GENERATE_DONE|.
@@ -133,7 +147,14 @@ scoped_refptr<RTCCertificate> RTCCertificateGenerator::GenerateCertificate(
 
 RTCCertificateGenerator::RTCCertificateGenerator(Thread* signaling_thread,
                                                  Thread* worker_thread)
-    : signaling_thread_(signaling_thread), worker_thread_(worker_thread) {
+    : RTCCertificateGenerator(signaling_thread, worker_thread, nullptr) {}
+
+RTCCertificateGenerator::RTCCertificateGenerator(Thread* signaling_thread,
+                                                 Thread* worker_thread,
+                                                 RTCCertificatePool* pool)
+    : signaling_thread_(signaling_thread),
+      worker_thread_(worker_thread),
+      pool_(pool) {
   RTC_DCHECK(signaling_thread_);
   RTC_DCHECK(worker_thread_);
 }
@@ -145,6 +166,23 @@ void RTCCertificateGenerator::GenerateCertificateAsync(
   RTC_DCHECK(signaling_thread_->IsCurrent());
   RTC_DCHECK(callback);
 
+  // Certificates from the pool have the default expiration time, so they can
+  // only be used when no other was asked for. The callback is still posted,
+  // as callers rely on it not being invoked synchronously.
+  scoped_refptr<RTCCertificate> certificate;
+  if (pool_ && !expires_ms && key_params.IsValid()) {
+    certificate = pool_->TakeCertificate(key_params);
+  }
+  if (certificate) {
+    ScopedRefMessageData<RTCCertificateGenerationTask>* msg_data =
+        new ScopedRefMessageData<RTCCertificateGenerationTask>(
+            new RefCountedObject<RTCCertificateGenerationTask>(
+                signaling_thread_, certificate, callback));
+    signaling_thread_->Post(RTC_FROM_HERE, msg_data->data().get(),
+                            MSG_GENERATE_DONE, msg_data);
+    return;
+  }
+
   // Create a new |RTCCertificateGenerationTask| for this generation request. It
   // is reference counted and referenced by the message data, ensuring it lives
   // until the task has completed (independent of |RTCCertificateGenerator|).
@@ -0,0 +1,173 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/rtc_certificate_pool.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/metrics.h"
+
+namespace rtc {
+
+namespace {
+
+bool SameKeyParams(const KeyParams& a, const KeyParams& b) {
+  if (a.type() != b.type()) {
+    return false;
+  }
+  if (a.type() == KT_RSA) {
+    return a.rsa_params().mod_size == b.rsa_params().mod_size &&
+           a.rsa_params().pub_exp == b.rsa_params().pub_exp;
+  }
+  return a.ec_curve() == b.ec_curve();
+}
+
+}  // namespace
+
+RTCCertificatePool::Config::Config() = default;
+RTCCertificatePool::Config::Config(const Config&) = default;
+RTCCertificatePool::Config::~Config() = default;
+
+RTCCertificatePool::Supply::Supply(const KeyParams& key_params)
+    : key_params(key_params) {}
+RTCCertificatePool::Supply::Supply(Supply&&) = default;
+RTCCertificatePool::Supply::~Supply() = default;
+
+RTCCertificatePool::RTCCertificatePool(
+    webrtc::TaskQueueFactory* task_queue_factory,
+    const Config& config)
+    : low_watermark_(config.low_watermark),
+      high_watermark_(config.high_watermark),
+      max_age_ms_(config.max_age_ms) {
+  RTC_DCHECK(task_queue_factory);
+  RTC_DCHECK_GT(config.num_workers, 0);
+  RTC_DCHECK_GE(config.high_watermark, config.low_watermark);
+  for (int i = 0; i < config.num_workers; ++i) {
+    workers_.push_back(
+        std::make_unique<TaskQueue>(task_queue_factory->CreateTaskQueue(
+            "RTCCertificatePool" + std::to_string(i),
+            webrtc::TaskQueueFactory::Priority::LOW)));
+  }
+  CritScope cs(&crit_);
+  for (const KeyParams& key_params : config.key_params) {
+    RTC_DCHECK(key_params.IsValid());
+    if (!FindSupply(key_params)) {
+      supplies_.emplace_back(key_params);
+    }
+  }
+  for (size_t i = 0; i < supplies_.size(); ++i) {
+    MaybeRefill(i);
+  }
+}
+
+RTCCertificatePool::~RTCCertificatePool() {
+  // Stop the workers before anything they use goes away.
+  workers_.clear();
+}
+
+scoped_refptr<RTCCertificate> RTCCertificatePool::TakeCertificate(
+    const KeyParams& key_params) {
+  scoped_refptr<RTCCertificate> certificate;
+  {
+    CritScope cs(&crit_);
+    Supply* supply = FindSupply(key_params);
+    if (supply) {
+      DropExpired(supply, TimeMillis());
+      if (!supply->ready.empty()) {
+        certificate = std::move(supply->ready.front().second);
+        supply->ready.pop_front();
+      }
+      MaybeRefill(static_cast<size_t>(supply - supplies_.data()));
+    }
+    if (certificate) {
+      ++stats_.hits;
+    } else {
+      ++stats_.misses;
+    }
+  }
+  RTC_HISTOGRAM_BOOLEAN("WebRTC.PeerConnection.CertificatePoolHit",
+                        certificate != nullptr);
+  return certificate;
+}
+
+size_t RTCCertificatePool::GetReadyCount(const KeyParams& key_params) const {
+  CritScope cs(&crit_);
+  for (const Supply& supply : supplies_) {
+    if (SameKeyParams(supply.key_params, key_params)) {
+      return supply.ready.size();
+    }
+  }
+  return 0;
+}
+
+RTCCertificatePool::Stats RTCCertificatePool::GetStats() const {
+  CritScope cs(&crit_);
+  return stats_;
+}
+
+RTCCertificatePool::Supply* RTCCertificatePool::FindSupply(
+    const KeyParams& key_params) {
+  for (Supply& supply : supplies_) {
+    if (SameKeyParams(supply.key_params, key_params)) {
+      return &supply;
+    }
+  }
+  return nullptr;
+}
+
+void RTCCertificatePool::DropExpired(Supply* supply, int64_t now_ms) {
+  while (!supply->ready.empty() &&
+         now_ms - supply->ready.front().first >= max_age_ms_) {
+    supply->ready.pop_front();
+    ++stats_.expired;
+  }
+}
+
+void RTCCertificatePool::MaybeRefill(size_t supply_index) {
+  Supply& supply = supplies_[supply_index];
+  if (static_cast<int>(supply.ready.size()) >= low_watermark_) {
+    return;
+  }
+  while (static_cast<int>(supply.ready.size()) + supply.generating <
+         high_watermark_) {
+    ++supply.generating;
+    workers_[next_worker_]->PostTask(
+        [this, supply_index] { Generate(supply_index); });
+    next_worker_ = (next_worker_ + 1) % workers_.size();
+  }
+}
+
+void RTCCertificatePool::Generate(size_t supply_index) {
+  KeyParams key_params;
+  {
+    CritScope cs(&crit_);
+    key_params = supplies_[supply_index].key_params;
+  }
+  scoped_refptr<RTCCertificate> certificate =
+      RTCCertificateGenerator::GenerateCertificate(key_params, absl::nullopt);
+  CritScope cs(&crit_);
+  Supply& supply = supplies_[supply_index];
+  --supply.generating;
+  if (!certificate) {
+    // Not retried right away, which could keep a worker busy failing. The
+    // next TakeCertificate() tries again.
+    RTC_LOG(LS_WARNING) << "Failed to generate a certificate for the pool.";
+    return;
+  }
+  supply.ready.emplace_back(TimeMillis(), std::move(certificate));
+}
+
+}  // namespace rtc
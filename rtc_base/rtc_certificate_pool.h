@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_RTC_CERTIFICATE_POOL_H_
+#define RTC_BASE_RTC_CERTIFICATE_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/rtc_certificate.h"
+#include "rtc_base/ssl_identity.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// Keeps certificates that were generated ahead of time, so that they can be
+// handed out without waiting for key generation, which takes long for RSA
+// keys in particular. Certificates are generated on a pool of worker threads
+// and the pool is refilled in the background as certificates are taken out.
+// All methods are thread-safe.
+class RTC_EXPORT RTCCertificatePool {
+ public:
+  struct RTC_EXPORT Config {
+    Config();
+    Config(const Config&);
+    ~Config();
+
+    // The key types to keep certificates for, each with its own supply.
+    std::vector<KeyParams> key_params = {KeyParams()};
+    // When fewer than |low_watermark| certificates of a key type are ready,
+    // new ones are generated until |high_watermark| are ready or being
+    // generated.
+    int low_watermark = 2;
+    int high_watermark = 4;
+    // The number of threads that certificates are generated on.
+    int num_workers = 2;
+    // Certificates that have been ready for longer than this are dropped
+    // rather than handed out, so that the certificates that are handed out
+    // have nearly all of the default lifetime left.
+    int64_t max_age_ms = 24 * 60 * 60 * 1000;
+  };
+
+  struct Stats {
+    // Certificates taken out of the pool.
+    int hits = 0;
+    // Requests the pool had no certificate for.
+    int misses = 0;
+    // Certificates dropped because they had reached |max_age_ms|.
+    int expired = 0;
+  };
+
+  RTCCertificatePool(webrtc::TaskQueueFactory* task_queue_factory,
+                     const Config& config);
+  // Waits for certificates that are being generated.
+  ~RTCCertificatePool();
+
+  // Takes a ready certificate with |key_params| out of the pool, or returns
+  // null if there is none, in which case the caller has to generate one. The
+  // certificates have the default expiration time. Records a hit or miss in
+  // the WebRTC.PeerConnection.CertificatePoolHit histogram.
+  scoped_refptr<RTCCertificate> TakeCertificate(const KeyParams& key_params);
+
+  // The number of certificates with |key_params| that are ready.
+  size_t GetReadyCount(const KeyParams& key_params) const;
+  Stats GetStats() const;
+
+ private:
+  struct Supply {
+    explicit Supply(const KeyParams& key_params);
+    Supply(Supply&&);
+    ~Supply();
+
+    KeyParams key_params;
+    // Ready certificates with the time they were ready at, oldest first.
+    std::deque<std::pair<int64_t, scoped_refptr<RTCCertificate>>> ready;
+    // The number of certificates that are being generated.
+    int generating = 0;
+  };
+
+  Supply* FindSupply(const KeyParams& key_params)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void DropExpired(Supply* supply, int64_t now_ms)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Starts generating certificates for |supplies_[supply_index]| if it has
+  // run low.
+  void MaybeRefill(size_t supply_index) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Runs on a worker.
+  void Generate(size_t supply_index);
+
+  const int low_watermark_;
+  const int high_watermark_;
+  const int64_t max_age_ms_;
+
+  rtc::CriticalSection crit_;
+  std::vector<Supply> supplies_ RTC_GUARDED_BY(crit_);
+  Stats stats_ RTC_GUARDED_BY(crit_);
+  size_t next_worker_ RTC_GUARDED_BY(crit_) = 0;
+
+  // Declared last, so that the workers are done generating before the rest
+  // goes away.
+  std::vector<std::unique_ptr<TaskQueue>> workers_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RTCCertificatePool);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_RTC_CERTIFICATE_POOL_H_
@@ -0,0 +1,168 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/rtc_certificate_pool.h"
+
+#include <memory>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kGenerationTimeoutMs = 10000;
+
+class RTCCertificatePoolTest : public ::testing::Test {
+ protected:
+  RTCCertificatePoolTest()
+      : task_queue_factory_(webrtc::CreateDefaultTaskQueueFactory()) {
+    config_.key_params = {KeyParams::ECDSA()};
+    config_.low_watermark = 2;
+    config_.high_watermark = 3;
+  }
+
+  std::unique_ptr<RTCCertificatePool> CreatePool() {
+    return std::make_unique<RTCCertificatePool>(task_queue_factory_.get(),
+                                                config_);
+  }
+
+  const std::unique_ptr<webrtc::TaskQueueFactory> task_queue_factory_;
+  RTCCertificatePool::Config config_;
+};
+
+TEST_F(RTCCertificatePoolTest, FillsUpToHighWatermark) {
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  EXPECT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  EXPECT_EQ(0u, pool->GetReadyCount(KeyParams::RSA()));
+}
+
+TEST_F(RTCCertificatePoolTest, TakesCertificates) {
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  ASSERT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  scoped_refptr<RTCCertificate> first =
+      pool->TakeCertificate(KeyParams::ECDSA());
+  scoped_refptr<RTCCertificate> second =
+      pool->TakeCertificate(KeyParams::ECDSA());
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(*first, *second);
+  EXPECT_EQ(2, pool->GetStats().hits);
+  EXPECT_EQ(0, pool->GetStats().misses);
+}
+
+TEST_F(RTCCertificatePoolTest, MissesForKeyTypeNotInPool) {
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  ASSERT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  EXPECT_FALSE(pool->TakeCertificate(KeyParams::RSA()));
+  EXPECT_EQ(0, pool->GetStats().hits);
+  EXPECT_EQ(1, pool->GetStats().misses);
+}
+
+TEST_F(RTCCertificatePoolTest, MissesWhenEmpty) {
+  config_.low_watermark = 0;
+  config_.high_watermark = 0;
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  EXPECT_FALSE(pool->TakeCertificate(KeyParams::ECDSA()));
+  EXPECT_EQ(1, pool->GetStats().misses);
+}
+
+TEST_F(RTCCertificatePoolTest, RefillsWhenBelowLowWatermark) {
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  ASSERT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  // Still at the low watermark, so nothing is generated.
+  EXPECT_TRUE(pool->TakeCertificate(KeyParams::ECDSA()));
+  EXPECT_EQ(2u, pool->GetReadyCount(KeyParams::ECDSA()));
+  // Below it, so the pool is filled up again.
+  EXPECT_TRUE(pool->TakeCertificate(KeyParams::ECDSA()));
+  EXPECT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+}
+
+TEST_F(RTCCertificatePoolTest, KeepsSupplyPerKeyType) {
+  config_.key_params = {KeyParams::ECDSA(), KeyParams::RSA()};
+  config_.low_watermark = 1;
+  config_.high_watermark = 1;
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  ASSERT_EQ_WAIT(1u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  ASSERT_EQ_WAIT(1u, pool->GetReadyCount(KeyParams::RSA()),
+                 kGenerationTimeoutMs);
+  scoped_refptr<RTCCertificate> rsa = pool->TakeCertificate(KeyParams::RSA());
+  ASSERT_TRUE(rsa);
+  EXPECT_EQ(1u, pool->GetReadyCount(KeyParams::ECDSA()));
+}
+
+TEST_F(RTCCertificatePoolTest, DropsCertificatesOlderThanMaxAge) {
+  ScopedFakeClock clock;
+  config_.max_age_ms = 60 * 60 * 1000;
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  ASSERT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  clock.AdvanceTime(webrtc::TimeDelta::Millis(config_.max_age_ms));
+  EXPECT_FALSE(pool->TakeCertificate(KeyParams::ECDSA()));
+  EXPECT_EQ(3, pool->GetStats().expired);
+  EXPECT_EQ(1, pool->GetStats().misses);
+  // The dropped certificates are replaced.
+  EXPECT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  EXPECT_TRUE(pool->TakeCertificate(KeyParams::ECDSA()));
+}
+
+TEST_F(RTCCertificatePoolTest, GeneratorTakesCertificateFromPool) {
+  std::unique_ptr<RTCCertificatePool> pool = CreatePool();
+  ASSERT_EQ_WAIT(3u, pool->GetReadyCount(KeyParams::ECDSA()),
+                 kGenerationTimeoutMs);
+  std::unique_ptr<Thread> worker_thread = Thread::Create();
+  ASSERT_TRUE(worker_thread->Start());
+  RTCCertificateGenerator generator(Thread::Current(), worker_thread.get(),
+                                    pool.get());
+
+  class Callback : public RTCCertificateGeneratorCallback {
+   public:
+    void OnSuccess(const scoped_refptr<RTCCertificate>& certificate) override {
+      certificate_ = certificate;
+      done_ = true;
+    }
+    void OnFailure() override { done_ = true; }
+
+    scoped_refptr<RTCCertificate> certificate_;
+    bool done_ = false;
+  };
+  scoped_refptr<Callback> callback(new RefCountedObject<Callback>());
+
+  generator.GenerateCertificateAsync(KeyParams::ECDSA(), absl::nullopt,
+                                     callback);
+  // The callback is invoked asynchronously, even for a pool hit.
+  EXPECT_FALSE(callback->done_);
+  EXPECT_TRUE_WAIT(callback->done_, kGenerationTimeoutMs);
+  EXPECT_TRUE(callback->certificate_);
+  EXPECT_EQ(1, pool->GetStats().hits);
+
+  // Certificates with a custom expiration time are generated.
+  callback->done_ = false;
+  generator.GenerateCertificateAsync(KeyParams::ECDSA(), 60000, callback);
+  EXPECT_TRUE_WAIT(callback->done_, kGenerationTimeoutMs);
+  EXPECT_TRUE(callback->certificate_);
+  EXPECT_EQ(1, pool->GetStats().hits);
+  EXPECT_EQ(0, pool->GetStats().misses);
+}
+
+}  // namespace
+}  // namespace rtc
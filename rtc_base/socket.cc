@@ -10,4 +10,29 @@
 
 #include "rtc_base/socket.h"
 
-namespace rtc {}  // namespace rtc
+namespace rtc {
+
+int Socket::RecvFromBatch(rtc::ArrayView<ReceiveSlot> slots) {
+  if (slots.empty())
+    return 0;
+  ReceiveSlot& slot = slots[0];
+  int received = RecvFrom(slot.data, slot.capacity, &slot.remote_address,
+                          &slot.timestamp);
+  if (received < 0)
+    return received;
+  slot.size = static_cast<size_t>(received);
+  slot.truncated = false;
+  return 1;
+}
+
+int Socket::SendToBatch(rtc::ArrayView<const SendSlot> slots) {
+  int sent = 0;
+  for (const SendSlot& slot : slots) {
+    if (SendTo(slot.data, slot.size, *slot.remote_address) < 0)
+      return sent > 0 ? sent : SOCKET_ERROR;
+    ++sent;
+  }
+  return sent;
+}
+
+}  // namespace rtc
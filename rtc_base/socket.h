@@ -25,6 +25,7 @@
 #include "rtc_base/win32.h"
 #endif
 
+#include "api/array_view.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/socket_address.h"
 
@@ -98,6 +99,40 @@ class Socket {
                        size_t cb,
                        SocketAddress* paddr,
                        int64_t* timestamp) = 0;
+
+  // Describes one datagram for RecvFromBatch(). |data| and |capacity| are
+  // provided by the caller, the remaining fields are filled in by the socket.
+  struct ReceiveSlot {
+    void* data = nullptr;
+    size_t capacity = 0;
+    // Number of bytes written to |data|.
+    size_t size = 0;
+    // True if the datagram did not fit in |capacity| bytes and was cut short.
+    bool truncated = false;
+    SocketAddress remote_address;
+    // In units of microseconds, or -1 if not available.
+    int64_t timestamp = -1;
+  };
+  // Receives up to |slots.size()| datagrams, using as few system calls as the
+  // implementation allows. Returns the number of datagrams received, or
+  // SOCKET_ERROR if none could be read (see GetError()). The default
+  // implementation reads a single datagram using RecvFrom().
+  virtual int RecvFromBatch(rtc::ArrayView<ReceiveSlot> slots);
+
+  // Describes one datagram for SendToBatch(). |remote_address| must outlive
+  // the call.
+  struct SendSlot {
+    const void* data = nullptr;
+    size_t size = 0;
+    const SocketAddress* remote_address = nullptr;
+  };
+  // Sends the datagrams in |slots| in order, using as few system calls as the
+  // implementation allows. Sending stops at the first datagram that can not
+  // be sent. Returns the number of datagrams sent, or SOCKET_ERROR if the
+  // first one failed (see GetError()). The default implementation calls
+  // SendTo() for each datagram.
+  virtual int SendToBatch(rtc::ArrayView<const SendSlot> slots);
+
   virtual int Listen(int backlog) = 0;
   virtual Socket* Accept(SocketAddress* paddr) = 0;
   virtual int Close() = 0;
@@ -118,6 +153,8 @@ class Socket {
     OPT_RTP_SENDTIME_EXTN_ID,  // This is a non-traditional socket option param.
                                // This is specific to libjingle and will be used
                                // if SendTime option is needed at socket level.
+    OPT_REUSEPORT,             // Whether several sockets may bind the same
+                               // address and port, must be set before Bind().
   };
   virtual int GetOption(Option opt, int* value) = 0;
   virtual int SetOption(Option opt, int value) = 0;
@@ -12,6 +12,7 @@
 
 #include "absl/memory/memory.h"
 #include "rtc_base/openssl_stream_adapter.h"
+#include "rtc_base/openssl_stream_session_cache.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -90,6 +91,10 @@ bool IsGcmCryptoSuiteName(const std::string& crypto_suite) {
           crypto_suite == CS_AEAD_AES_128_GCM);
 }
 
+std::unique_ptr<SSLSessionCache> SSLSessionCache::Create(SSLMode mode) {
+  return std::make_unique<OpenSSLStreamSessionCache>(mode);
+}
+
 std::unique_ptr<SSLStreamAdapter> SSLStreamAdapter::Create(
     std::unique_ptr<StreamInterface> stream) {
   return std::make_unique<OpenSSLStreamAdapter>(std::move(stream));
@@ -119,6 +119,23 @@ enum { SSE_MSG_TRUNC = 0xff0001 };
 // Used to send back UMA histogram value. Logged when Dtls handshake fails.
 enum class SSLHandshakeError { UNKNOWN, INCOMPATIBLE_CIPHERSUITE, MAX_VALUE };
 
+// Sessions kept for resumption by the SSLStreamAdapters it is set on. A client
+// resumes the last session it had with a peer that presents the same
+// certificate digest; a server resumes sessions from tickets it issued with
+// the same cache. Resumed handshakes skip the certificate exchange and the key
+// agreement, so peers reconnecting after an ICE restart rejoin in fewer round
+// trips and at a fraction of the CPU cost. It is safe to share a cache between
+// adapters on different threads.
+class SSLSessionCache {
+ public:
+  static std::unique_ptr<SSLSessionCache> Create(SSLMode mode);
+
+  virtual ~SSLSessionCache() = default;
+
+  // The mode of the adapters that the cache can be used with.
+  virtual SSLMode GetSSLMode() const = 0;
+};
+
 class SSLStreamAdapter : public StreamAdapterInterface {
  public:
   // Instantiate an SSLStreamAdapter wrapping the given stream,
@@ -158,6 +175,12 @@ class SSLStreamAdapter : public StreamAdapterInterface {
   // This should only be called before StartSSL().
   virtual void SetInitialRetransmissionTimeout(int timeout_ms) = 0;
 
+  // Resume sessions from, and store new sessions in, |cache|, which must be
+  // for the same mode and outlive this object. The peer certificate of a
+  // resumed session is checked against the digest just like after a full
+  // handshake. This should only be called before StartSSL().
+  virtual void SetSessionCache(SSLSessionCache* cache) {}
+
   // StartSSL starts negotiation with a peer, whose certificate is verified
   // using the certificate digest. Generally, SetIdentity() and possibly
   // SetServerRole() should have been called before this.
@@ -234,6 +257,10 @@ class SSLStreamAdapter : public StreamAdapterInterface {
   // SS_OPENING but IsTlsConnected should return true.
   virtual bool IsTlsConnected() = 0;
 
+  // Returns true if the connection was established by resuming a session from
+  // the session cache rather than with a full handshake.
+  virtual bool IsResumedSession() const { return false; }
+
   // Capabilities testing.
   // Used to have "DTLS supported", "DTLS-SRTP supported" etc. methods, but now
   // that's assumed.
@@ -0,0 +1,199 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/message_digest.h"
+#include "rtc_base/ssl_identity.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/stream.h"
+#include "rtc_base/thread.h"
+
+namespace rtc {
+namespace {
+
+class DatagramLink;
+
+// One end of a DatagramLink.
+class DatagramEndpoint : public StreamInterface {
+ public:
+  DatagramEndpoint(DatagramLink* link, int side) : link_(link), side_(side) {}
+  ~DatagramEndpoint() override;
+
+  StreamState GetState() const override { return SS_OPEN; }
+  StreamResult Read(void* buffer,
+                    size_t buffer_len,
+                    size_t* read,
+                    int* error) override;
+  StreamResult Write(const void* data,
+                     size_t data_len,
+                     size_t* written,
+                     int* error) override;
+  void Close() override {}
+
+  void OnPacket() { PostEvent(SE_READ, 0); }
+
+ private:
+  DatagramLink* const link_;
+  const int side_;
+};
+
+// A lossless datagram link with no delay, so that the benchmarks measure the
+// CPU cost of the handshakes and nothing else. Packets are delivered on the
+// next message loop iteration, as they would be from a socket.
+class DatagramLink {
+ public:
+  std::unique_ptr<StreamInterface> CreateEndpoint(int side) {
+    auto endpoint = std::make_unique<DatagramEndpoint>(this, side);
+    endpoints_[side] = endpoint.get();
+    return endpoint;
+  }
+
+  void RemoveEndpoint(int side) { endpoints_[side] = nullptr; }
+
+  void Send(int from_side, const void* data, size_t size) {
+    int to_side = 1 - from_side;
+    if (!endpoints_[to_side]) {
+      return;
+    }
+    inboxes_[to_side].emplace_back(static_cast<const uint8_t*>(data), size);
+    endpoints_[to_side]->OnPacket();
+  }
+
+  bool Receive(int side, void* buffer, size_t buffer_len, size_t* read) {
+    std::deque<Buffer>& inbox = inboxes_[side];
+    if (inbox.empty()) {
+      return false;
+    }
+    *read = std::min(buffer_len, inbox.front().size());
+    memcpy(buffer, inbox.front().data(), *read);
+    inbox.pop_front();
+    return true;
+  }
+
+ private:
+  DatagramEndpoint* endpoints_[2] = {nullptr, nullptr};
+  std::deque<Buffer> inboxes_[2];
+};
+
+DatagramEndpoint::~DatagramEndpoint() {
+  link_->RemoveEndpoint(side_);
+}
+
+StreamResult DatagramEndpoint::Read(void* buffer,
+                                    size_t buffer_len,
+                                    size_t* read,
+                                    int* error) {
+  return link_->Receive(side_, buffer, buffer_len, read) ? SR_SUCCESS
+                                                         : SR_BLOCK;
+}
+
+StreamResult DatagramEndpoint::Write(const void* data,
+                                     size_t data_len,
+                                     size_t* written,
+                                     int* error) {
+  link_->Send(side_, data, data_len);
+  *written = data_len;
+  return SR_SUCCESS;
+}
+
+// A DTLS peer with a fixed identity that reconnects over and over, as a media
+// server and one of its clients would after repeated ICE restarts.
+class DtlsPeer {
+ public:
+  explicit DtlsPeer(const std::string& name)
+      : identity_(SSLIdentity::Create(name, KT_DEFAULT)) {
+    RTC_CHECK(identity_->certificate().ComputeDigest(
+        DIGEST_SHA_256, digest_, sizeof(digest_), &digest_length_));
+  }
+
+  void EnableSessionCache() {
+    session_cache_ = SSLSessionCache::Create(SSL_MODE_DTLS);
+  }
+
+  std::unique_ptr<SSLStreamAdapter> CreateAdapter(
+      std::unique_ptr<StreamInterface> stream,
+      SSLRole role,
+      const DtlsPeer& remote) const {
+    std::unique_ptr<SSLStreamAdapter> adapter =
+        SSLStreamAdapter::Create(std::move(stream));
+    adapter->SetIdentity(identity_->Clone());
+    adapter->SetMode(SSL_MODE_DTLS);
+    adapter->SetServerRole(role);
+    adapter->SetDtlsSrtpCryptoSuites(
+        {SRTP_AEAD_AES_128_GCM, SRTP_AES128_CM_SHA1_80});
+    adapter->SetSessionCache(session_cache_.get());
+    RTC_CHECK(adapter->SetPeerCertificateDigest(
+        DIGEST_SHA_256, remote.digest_, remote.digest_length_));
+    return adapter;
+  }
+
+ private:
+  const std::unique_ptr<SSLIdentity> identity_;
+  unsigned char digest_[32];
+  size_t digest_length_ = 0;
+  std::unique_ptr<SSLSessionCache> session_cache_;
+};
+
+// Runs one handshake between |client| and |server| and returns whether the
+// session was resumed.
+bool Handshake(const DtlsPeer& client, const DtlsPeer& server) {
+  DatagramLink link;
+  std::unique_ptr<SSLStreamAdapter> client_ssl =
+      client.CreateAdapter(link.CreateEndpoint(0), SSL_CLIENT, server);
+  std::unique_ptr<SSLStreamAdapter> server_ssl =
+      server.CreateAdapter(link.CreateEndpoint(1), SSL_SERVER, client);
+  RTC_CHECK_EQ(0, server_ssl->StartSSL());
+  RTC_CHECK_EQ(0, client_ssl->StartSSL());
+  while (client_ssl->GetState() != SS_OPEN ||
+         server_ssl->GetState() != SS_OPEN) {
+    RTC_CHECK(client_ssl->GetState() != SS_CLOSED &&
+              server_ssl->GetState() != SS_CLOSED);
+    Thread::Current()->ProcessMessages(0);
+  }
+  RTC_CHECK_EQ(client_ssl->IsResumedSession(),
+               server_ssl->IsResumedSession());
+  return client_ssl->IsResumedSession();
+}
+
+// Handshakes per second that one core can do for both ends of the
+// connection. The argument is whether both ends use a session cache, in which
+// case every handshake but the first resumes the previous session.
+void BM_DtlsHandshake(benchmark::State& state) {
+  const bool use_session_cache = state.range(0);
+  AutoThread thread;
+  DtlsPeer client("client");
+  DtlsPeer server("server");
+  if (use_session_cache) {
+    client.EnableSessionCache();
+    server.EnableSessionCache();
+    Handshake(client, server);
+  }
+  for (auto s : state) {
+    if (Handshake(client, server) != use_session_cache) {
+      state.SkipWithError("Unexpected handshake type.");
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DtlsHandshake)->Arg(false)->Arg(true);
+
+}  // namespace
+}  // namespace rtc
@@ -1630,3 +1630,173 @@ TEST_F(SSLStreamAdapterTestDTLSLegacyProtocols,
   SetupProtocolVersions(rtc::SSL_PROTOCOL_DTLS_10, rtc::SSL_PROTOCOL_DTLS_10);
   TestHandshake(false);
 }
+
+// Tests for resuming sessions from a session cache. Each side keeps its
+// identity and its cache when it reconnects, as a peer rejoining after an ICE
+// restart would.
+class SSLStreamAdapterTestDTLSResumption : public SSLStreamAdapterTestDTLSBase {
+ public:
+  SSLStreamAdapterTestDTLSResumption()
+      : SSLStreamAdapterTestDTLSBase(rtc::KeyParams::ECDSA(rtc::EC_NIST_P256),
+                                     rtc::KeyParams::ECDSA(rtc::EC_NIST_P256)),
+        client_session_cache_(
+            rtc::SSLSessionCache::Create(rtc::SSL_MODE_DTLS)),
+        server_session_cache_(
+            rtc::SSLSessionCache::Create(rtc::SSL_MODE_DTLS)) {}
+
+  void SetUp() override {
+    SSLStreamAdapterTestDTLSBase::SetUp();
+    client_ssl_->SetSessionCache(client_session_cache_.get());
+    server_ssl_->SetSessionCache(server_session_cache_.get());
+  }
+
+  // Replaces both adapters with new ones on fresh streams. The server gets
+  // |new_server_identity| if given, and keeps its identity otherwise.
+  void Reconnect(
+      std::unique_ptr<rtc::SSLIdentity> new_server_identity = nullptr) {
+    std::unique_ptr<rtc::SSLIdentity> new_client_identity =
+        client_identity()->Clone();
+    if (!new_server_identity) {
+      new_server_identity = server_identity()->Clone();
+    }
+    client_ssl_.reset();
+    server_ssl_.reset();
+    // Drop the alerts the old adapters sent when closing.
+    client_buffer_.Clear();
+    server_buffer_.Clear();
+
+    CreateStreams();
+    client_ssl_ =
+        rtc::SSLStreamAdapter::Create(absl::WrapUnique(client_stream_));
+    server_ssl_ =
+        rtc::SSLStreamAdapter::Create(absl::WrapUnique(server_stream_));
+    client_ssl_->SignalEvent.connect(
+        static_cast<SSLStreamAdapterTestBase*>(this),
+        &SSLStreamAdapterTestBase::OnEvent);
+    server_ssl_->SignalEvent.connect(
+        static_cast<SSLStreamAdapterTestBase*>(this),
+        &SSLStreamAdapterTestBase::OnEvent);
+    client_ssl_->SetIdentity(std::move(new_client_identity));
+    server_ssl_->SetIdentity(std::move(new_server_identity));
+    client_ssl_->SetSessionCache(client_session_cache_.get());
+    server_ssl_->SetSessionCache(server_session_cache_.get());
+    identities_set_ = false;
+  }
+
+  // Sets the digest the client expects for the server certificate, and, if
+  // |set_client_digest|, the digest the server expects for the client
+  // certificate, which is corrupted unless |correct_client_digest|.
+  void SetDigests(bool set_client_digest, bool correct_client_digest) {
+    unsigned char digest[20];
+    size_t digest_len;
+    ASSERT_TRUE(server_identity()->certificate().ComputeDigest(
+        rtc::DIGEST_SHA_1, digest, sizeof(digest), &digest_len));
+    ASSERT_TRUE(client_ssl_->SetPeerCertificateDigest(rtc::DIGEST_SHA_1,
+                                                      digest, digest_len));
+    if (set_client_digest) {
+      ASSERT_TRUE(client_identity()->certificate().ComputeDigest(
+          rtc::DIGEST_SHA_1, digest, sizeof(digest), &digest_len));
+      if (!correct_client_digest) {
+        digest[0]++;
+      }
+      ASSERT_TRUE(server_ssl_->SetPeerCertificateDigest(rtc::DIGEST_SHA_1,
+                                                        digest, digest_len));
+    }
+    identities_set_ = true;
+  }
+
+  void StartSSL() {
+    server_ssl_->SetMode(rtc::SSL_MODE_DTLS);
+    client_ssl_->SetMode(rtc::SSL_MODE_DTLS);
+    server_ssl_->SetServerRole();
+    ASSERT_EQ(0, server_ssl_->StartSSL());
+    ASSERT_EQ(0, client_ssl_->StartSSL());
+  }
+
+ protected:
+  std::unique_ptr<rtc::SSLSessionCache> client_session_cache_;
+  std::unique_ptr<rtc::SSLSessionCache> server_session_cache_;
+};
+
+TEST_F(SSLStreamAdapterTestDTLSResumption, FirstHandshakeIsFull) {
+  TestHandshake();
+  EXPECT_FALSE(client_ssl_->IsResumedSession());
+  EXPECT_FALSE(server_ssl_->IsResumedSession());
+}
+
+TEST_F(SSLStreamAdapterTestDTLSResumption, ReconnectResumesSession) {
+  TestHandshake();
+  Reconnect();
+  TestHandshake();
+  EXPECT_TRUE(client_ssl_->IsResumedSession());
+  EXPECT_TRUE(server_ssl_->IsResumedSession());
+  // No certificates are exchanged in a resumed handshake, but each side still
+  // knows the one its peer presented.
+  EXPECT_TRUE(GetPeerCertificate(true));
+  EXPECT_TRUE(GetPeerCertificate(false));
+  TestTransfer(100);
+}
+
+TEST_F(SSLStreamAdapterTestDTLSResumption, ReconnectResumesSessionAgain) {
+  TestHandshake();
+  for (int i = 0; i < 3; ++i) {
+    Reconnect();
+    TestHandshake();
+    EXPECT_TRUE(client_ssl_->IsResumedSession());
+    EXPECT_TRUE(server_ssl_->IsResumedSession());
+  }
+}
+
+TEST_F(SSLStreamAdapterTestDTLSResumption,
+       ReconnectWithLostFirstPacketResumesSession) {
+  TestHandshake();
+  Reconnect();
+  SetLoseFirstPacket(true);
+  TestHandshake();
+  EXPECT_TRUE(client_ssl_->IsResumedSession());
+  EXPECT_TRUE(server_ssl_->IsResumedSession());
+}
+
+TEST_F(SSLStreamAdapterTestDTLSResumption, NewServerCertificateIsNotResumed) {
+  TestHandshake();
+  Reconnect(rtc::SSLIdentity::Create("server", rtc::KT_ECDSA));
+  TestHandshake();
+  EXPECT_FALSE(client_ssl_->IsResumedSession());
+  EXPECT_FALSE(server_ssl_->IsResumedSession());
+}
+
+// The server only learns which session the client resumes during the
+// handshake, so it must check the client certificate of that session.
+TEST_F(SSLStreamAdapterTestDTLSResumption,
+       ResumedSessionWithMismatchedClientDigestFails) {
+  TestHandshake();
+  Reconnect();
+  SetDigests(/*set_client_digest=*/true, /*correct_client_digest=*/false);
+  // The client completes the abbreviated handshake before the server checks
+  // the certificate, and then reads the server closing; don't treat that as
+  // application data.
+  client_ssl_->SignalEvent.disconnect(
+      static_cast<SSLStreamAdapterTestBase*>(this));
+  StartSSL();
+  EXPECT_TRUE_WAIT(server_ssl_->GetState() == rtc::SS_CLOSED,
+                   handshake_wait_);
+}
+
+TEST_F(SSLStreamAdapterTestDTLSResumption,
+       ResumedSessionIsVerifiedWhenDigestArrives) {
+  TestHandshake();
+  Reconnect();
+  SetDigests(/*set_client_digest=*/false, /*correct_client_digest=*/true);
+  StartSSL();
+  EXPECT_TRUE_WAIT(server_ssl_->IsTlsConnected(), handshake_wait_);
+  EXPECT_TRUE(server_ssl_->IsResumedSession());
+  EXPECT_EQ(rtc::SS_OPENING, server_ssl_->GetState());
+
+  unsigned char digest[20];
+  size_t digest_len;
+  ASSERT_TRUE(client_identity()->certificate().ComputeDigest(
+      rtc::DIGEST_SHA_1, digest, sizeof(digest), &digest_len));
+  EXPECT_TRUE(server_ssl_->SetPeerCertificateDigest(rtc::DIGEST_SHA_1, digest,
+                                                    digest_len));
+  EXPECT_EQ(rtc::SS_OPEN, server_ssl_->GetState());
+}
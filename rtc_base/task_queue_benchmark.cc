@@ -0,0 +1,132 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_factory.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/task_queue_lock_free.h"
+#include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumProducers = 8;
+constexpr int kTasksPerProducer = 20000;
+
+enum class Implementation { kStdlib = 0, kLockFree = 1 };
+
+std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateQueue(
+    benchmark::State& state) {
+  std::unique_ptr<TaskQueueFactory> factory;
+  switch (static_cast<Implementation>(state.range(0))) {
+    case Implementation::kStdlib:
+      state.SetLabel("stdlib");
+      factory = CreateTaskQueueStdlibFactory();
+      break;
+    case Implementation::kLockFree:
+      state.SetLabel("lock_free");
+      factory = CreateTaskQueueLockFreeFactory();
+      break;
+  }
+  return factory->CreateTaskQueue("Benchmark",
+                                  TaskQueueFactory::Priority::NORMAL);
+}
+
+// Latency from posting a task to it starting to run. Only touched on the
+// task queue.
+struct LatencyStats {
+  int64_t num_tasks = 0;
+  int64_t sum_ns = 0;
+  int64_t max_ns = 0;
+
+  void Add(int64_t latency_ns) {
+    ++num_tasks;
+    sum_ns += latency_ns;
+    max_ns = std::max(max_ns, latency_ns);
+  }
+};
+
+struct Producer {
+  TaskQueueBase* queue;
+  LatencyStats* stats;
+};
+
+void ProduceTasks(void* context) {
+  const Producer* producer = static_cast<const Producer*>(context);
+  LatencyStats* stats = producer->stats;
+  for (int i = 0; i < kTasksPerProducer; ++i) {
+    const int64_t posted_ns = rtc::TimeNanos();
+    producer->queue->PostTask(ToQueuedTask(
+        [stats, posted_ns] { stats->Add(rtc::TimeNanos() - posted_ns); }));
+  }
+}
+
+// Eight threads post small tasks to one queue as fast as they can, which is
+// roughly what the encoder, pacer and network threads do to each other at
+// packet rate, but with much more contention.
+void BM_TaskQueuePostFromManyThreads(benchmark::State& state) {
+  auto queue = CreateQueue(state);
+  LatencyStats stats;
+  std::vector<Producer> producers(kNumProducers, Producer{queue.get(), &stats});
+
+  for (auto s : state) {
+    std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+    for (Producer& producer : producers) {
+      threads.push_back(std::make_unique<rtc::PlatformThread>(
+          &ProduceTasks, &producer, "Producer"));
+    }
+    for (auto& thread : threads)
+      thread->Start();
+    for (auto& thread : threads)
+      thread->Stop();
+    rtc::Event done;
+    queue->PostTask(ToQueuedTask([&done] { done.Set(); }));
+    done.Wait(rtc::Event::kForever);
+  }
+
+  state.SetItemsProcessed(state.iterations() * kNumProducers *
+                          kTasksPerProducer);
+  state.counters["mean_latency_us"] =
+      stats.sum_ns / std::max<int64_t>(stats.num_tasks, 1) / 1000.0;
+  state.counters["max_latency_us"] = stats.max_ns / 1000.0;
+}
+
+BENCHMARK(BM_TaskQueuePostFromManyThreads)
+    ->Arg(static_cast<int>(Implementation::kStdlib))
+    ->Arg(static_cast<int>(Implementation::kLockFree))
+    ->UseRealTime();
+
+// Round trip of a single task to an idle queue, which includes waking up the
+// task queue thread.
+void BM_TaskQueuePostToIdleQueue(benchmark::State& state) {
+  auto queue = CreateQueue(state);
+  rtc::Event done;
+  for (auto s : state) {
+    queue->PostTask(ToQueuedTask([&done] { done.Set(); }));
+    done.Wait(rtc::Event::kForever);
+  }
+}
+
+BENCHMARK(BM_TaskQueuePostToIdleQueue)
+    ->Arg(static_cast<int>(Implementation::kStdlib))
+    ->Arg(static_cast<int>(Implementation::kLockFree))
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace webrtc
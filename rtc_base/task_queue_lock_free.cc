@@ -0,0 +1,369 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_lock_free.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "api/task_queue/queued_task.h"
+#include "api/task_queue/task_queue_base.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/synchronization/yield.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+rtc::ThreadPriority TaskQueuePriorityToThreadPriority(
+    TaskQueueFactory::Priority priority) {
+  switch (priority) {
+    case TaskQueueFactory::Priority::HIGH:
+      return rtc::kRealtimePriority;
+    case TaskQueueFactory::Priority::LOW:
+      return rtc::kLowPriority;
+    case TaskQueueFactory::Priority::NORMAL:
+      return rtc::kNormalPriority;
+    default:
+      RTC_NOTREACHED();
+      return rtc::kNormalPriority;
+  }
+}
+
+// Unbounded multi-producer single-consumer queue of posted tasks, after
+// Dmitry Vyukov's intrusive MPSC queue. Push() is wait-free and may be called
+// from any thread; Pop() and IsEmpty() must only be called by the consumer.
+class PostedTaskQueue {
+ public:
+  PostedTaskQueue() : head_(new Node()), tail_(head_.load()) {}
+  PostedTaskQueue(const PostedTaskQueue&) = delete;
+  PostedTaskQueue& operator=(const PostedTaskQueue&) = delete;
+  ~PostedTaskQueue() {
+    std::unique_ptr<QueuedTask> task;
+    int64_t run_at_ms;
+    while (Pop(&task, &run_at_ms)) {
+    }
+    RTC_DCHECK(IsEmpty());
+    delete tail_;
+  }
+
+  // |run_at_ms| is the time to run a delayed task at, or -1 for tasks that
+  // should run as soon as possible.
+  void Push(std::unique_ptr<QueuedTask> task, int64_t run_at_ms) {
+    Node* node = new Node();
+    node->task = std::move(task);
+    node->run_at_ms = run_at_ms;
+    // Sequentially consistent so that it is ordered with the consumer's
+    // announcement that it is going to sleep, see NotifyWake().
+    Node* previous = head_.exchange(node);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  // Returns false if there is no task, or if the next task is still being
+  // pushed. Use IsEmpty() to tell the two apart.
+  bool Pop(std::unique_ptr<QueuedTask>* task, int64_t* run_at_ms) {
+    Node* next = tail_->next.load(std::memory_order_acquire);
+    if (!next)
+      return false;
+    // |next| becomes the new dummy node once its task has been taken.
+    delete tail_;
+    tail_ = next;
+    *task = std::move(next->task);
+    *run_at_ms = next->run_at_ms;
+    return true;
+  }
+
+  // Returns true if there is nothing to pop and nothing being pushed.
+  bool IsEmpty() const { return head_.load() == tail_; }
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    std::unique_ptr<QueuedTask> task;
+    int64_t run_at_ms = -1;
+  };
+
+  // Most recently pushed node, written by producers.
+  std::atomic<Node*> head_;
+  // Dummy node preceding the oldest task, owned by the consumer.
+  Node* tail_;
+};
+
+// Hashed timer wheel with one slot per millisecond. A task due within one turn
+// of the wheel is found by looking at the slot for its due time; tasks further
+// out stay in their slot for as many turns as needed. Tasks due at the same
+// time run in the order they were inserted.
+class DelayedTaskWheel {
+ public:
+  explicit DelayedTaskWheel(int64_t now_ms) : current_ms_(now_ms) {}
+
+  bool empty() const { return size_ == 0; }
+
+  void Insert(int64_t run_at_ms, std::unique_ptr<QueuedTask> task) {
+    // Slots before |current_ms_| have already been processed, so late tasks go
+    // in the next slot to be processed.
+    run_at_ms = std::max(run_at_ms, current_ms_);
+    slots_[run_at_ms % kNumSlots].push_back(
+        {run_at_ms, next_order_++, std::move(task)});
+    ++size_;
+  }
+
+  // Appends all tasks due at |now_ms| to |due|, in the order they should run.
+  void PopDue(int64_t now_ms, std::vector<std::unique_ptr<QueuedTask>>* due) {
+    if (now_ms < current_ms_)
+      return;
+    if (empty()) {
+      current_ms_ = now_ms + 1;
+      return;
+    }
+    // Each slot needs to be looked at no more than once, even if more than a
+    // turn has passed.
+    const int64_t last_ms = std::min(now_ms, current_ms_ + kNumSlots - 1);
+    for (int64_t t = current_ms_; t <= last_ms; ++t) {
+      std::vector<Entry>& slot = slots_[t % kNumSlots];
+      size_t kept = 0;
+      for (size_t i = 0; i < slot.size(); ++i) {
+        if (slot[i].run_at_ms <= now_ms) {
+          due_entries_.push_back(std::move(slot[i]));
+        } else if (kept++ != i) {
+          slot[kept - 1] = std::move(slot[i]);
+        }
+      }
+      slot.erase(slot.begin() + kept, slot.end());
+    }
+    current_ms_ = now_ms + 1;
+
+    if (due_entries_.size() > 1) {
+      std::sort(due_entries_.begin(), due_entries_.end(),
+                [](const Entry& a, const Entry& b) {
+                  return a.run_at_ms != b.run_at_ms ? a.run_at_ms < b.run_at_ms
+                                                    : a.order < b.order;
+                });
+    }
+    for (Entry& entry : due_entries_) {
+      due->push_back(std::move(entry.task));
+    }
+    size_ -= due_entries_.size();
+    due_entries_.clear();
+  }
+
+  // Returns the time the next task is due. Must not be called when empty.
+  int64_t NextRunTime() const {
+    RTC_DCHECK(!empty());
+    for (int64_t t = current_ms_; t < current_ms_ + kNumSlots; ++t) {
+      for (const Entry& entry : slots_[t % kNumSlots]) {
+        if (entry.run_at_ms <= t)
+          return t;
+      }
+    }
+    // Everything is at least a turn away.
+    int64_t next_ms = std::numeric_limits<int64_t>::max();
+    for (const std::vector<Entry>& slot : slots_) {
+      for (const Entry& entry : slot) {
+        next_ms = std::min(next_ms, entry.run_at_ms);
+      }
+    }
+    return next_ms;
+  }
+
+ private:
+  static constexpr int64_t kNumSlots = 512;
+
+  struct Entry {
+    int64_t run_at_ms;
+    uint64_t order;
+    std::unique_ptr<QueuedTask> task;
+  };
+
+  std::array<std::vector<Entry>, kNumSlots> slots_;
+  // Slots for times before this have been processed.
+  int64_t current_ms_;
+  uint64_t next_order_ = 0;
+  size_t size_ = 0;
+  // Scratch space for PopDue().
+  std::vector<Entry> due_entries_;
+};
+
+class TaskQueueLockFree final : public TaskQueueBase {
+ public:
+  TaskQueueLockFree(absl::string_view queue_name,
+                    rtc::ThreadPriority priority);
+  ~TaskQueueLockFree() override = default;
+
+  void Delete() override;
+  void PostTask(std::unique_ptr<QueuedTask> task) override;
+  void PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                       uint32_t milliseconds) override;
+
+ private:
+  static void ThreadMain(void* context);
+
+  void ProcessTasks();
+
+  void NotifyWake();
+
+  // Indicates if the thread has started.
+  rtc::Event started_;
+
+  // Indicates if the thread has stopped.
+  rtc::Event stopped_;
+
+  // Signaled to wake up the worker thread when it sleeps.
+  rtc::Event flag_notify_;
+
+  // Contains the active worker thread assigned to processing
+  // tasks (including delayed tasks).
+  rtc::PlatformThread thread_;
+
+  // Indicates if the worker thread needs to shutdown now.
+  std::atomic<bool> thread_should_quit_{false};
+
+  // Set by the worker thread before it waits on |flag_notify_|, so that
+  // posting only has to signal the event when the worker may be asleep.
+  std::atomic<bool> thread_sleeping_{false};
+
+  // All posted tasks, immediate and delayed, in posting order.
+  PostedTaskQueue posted_tasks_;
+
+  // Delayed tasks taken off |posted_tasks_|. Only used on the worker thread.
+  DelayedTaskWheel delayed_tasks_;
+};
+
+TaskQueueLockFree::TaskQueueLockFree(absl::string_view queue_name,
+                                     rtc::ThreadPriority priority)
+    : started_(/*manual_reset=*/false, /*initially_signaled=*/false),
+      stopped_(/*manual_reset=*/false, /*initially_signaled=*/false),
+      flag_notify_(/*manual_reset=*/false, /*initially_signaled=*/false),
+      thread_(&TaskQueueLockFree::ThreadMain, this, queue_name, priority),
+      delayed_tasks_(rtc::TimeMillis()) {
+  thread_.Start();
+  started_.Wait(rtc::Event::kForever);
+}
+
+void TaskQueueLockFree::Delete() {
+  RTC_DCHECK(!IsCurrent());
+
+  thread_should_quit_.store(true);
+  flag_notify_.Set();
+
+  stopped_.Wait(rtc::Event::kForever);
+  thread_.Stop();
+  delete this;
+}
+
+void TaskQueueLockFree::PostTask(std::unique_ptr<QueuedTask> task) {
+  posted_tasks_.Push(std::move(task), /*run_at_ms=*/-1);
+  NotifyWake();
+}
+
+void TaskQueueLockFree::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                        uint32_t milliseconds) {
+  posted_tasks_.Push(std::move(task), rtc::TimeMillis() + milliseconds);
+  NotifyWake();
+}
+
+// static
+void TaskQueueLockFree::ThreadMain(void* context) {
+  TaskQueueLockFree* me = static_cast<TaskQueueLockFree*>(context);
+  CurrentTaskQueueSetter set_current(me);
+  me->ProcessTasks();
+}
+
+void TaskQueueLockFree::ProcessTasks() {
+  started_.Set();
+
+  std::vector<std::unique_ptr<QueuedTask>> due_tasks;
+  while (!thread_should_quit_.load()) {
+    if (!delayed_tasks_.empty()) {
+      delayed_tasks_.PopDue(rtc::TimeMillis(), &due_tasks);
+      for (std::unique_ptr<QueuedTask>& task : due_tasks) {
+        QueuedTask* release_ptr = task.release();
+        if (release_ptr->Run())
+          delete release_ptr;
+      }
+      due_tasks.clear();
+    }
+
+    std::unique_ptr<QueuedTask> task;
+    int64_t run_at_ms;
+    if (posted_tasks_.Pop(&task, &run_at_ms)) {
+      if (run_at_ms < 0) {
+        QueuedTask* release_ptr = task.release();
+        if (release_ptr->Run())
+          delete release_ptr;
+      } else {
+        delayed_tasks_.Insert(run_at_ms, std::move(task));
+      }
+      continue;
+    }
+
+    if (!posted_tasks_.IsEmpty()) {
+      // A producer is between the two steps of Push().
+      YieldCurrentThread();
+      continue;
+    }
+
+    // Announce that the thread is about to sleep before checking for tasks
+    // one last time. Together with the sequentially consistent Push() this
+    // guarantees that a producer either sees the announcement and signals
+    // |flag_notify_|, or its task is seen here.
+    thread_sleeping_.store(true);
+    if (posted_tasks_.IsEmpty() && !thread_should_quit_.load()) {
+      if (delayed_tasks_.empty()) {
+        flag_notify_.Wait(rtc::Event::kForever);
+      } else {
+        int64_t sleep_time_ms =
+            delayed_tasks_.NextRunTime() - rtc::TimeMillis();
+        if (sleep_time_ms > 0)
+          flag_notify_.Wait(sleep_time_ms);
+      }
+    }
+    thread_sleeping_.store(false);
+  }
+
+  stopped_.Set();
+}
+
+void TaskQueueLockFree::NotifyWake() {
+  // Only the first producer to see the worker asleep signals it. The plain
+  // load keeps producers from writing to the shared flag while the worker is
+  // busy.
+  if (thread_sleeping_.load() && thread_sleeping_.exchange(false))
+    flag_notify_.Set();
+}
+
+class TaskQueueLockFreeFactory final : public TaskQueueFactory {
+ public:
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
+      absl::string_view name,
+      Priority priority) const override {
+    return std::unique_ptr<TaskQueueBase, TaskQueueDeleter>(
+        new TaskQueueLockFree(name,
+                              TaskQueuePriorityToThreadPriority(priority)));
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueLockFreeFactory() {
+  return std::make_unique<TaskQueueLockFreeFactory>();
+}
+
+}  // namespace webrtc
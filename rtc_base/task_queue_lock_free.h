@@ -0,0 +1,28 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef RTC_BASE_TASK_QUEUE_LOCK_FREE_H_
+#define RTC_BASE_TASK_QUEUE_LOCK_FREE_H_
+
+#include <memory>
+
+#include "api/task_queue/task_queue_factory.h"
+
+namespace webrtc {
+
+// Creates task queues that, like the stdlib ones, run on a dedicated
+// rtc::PlatformThread, but post tasks through a lock-free multi-producer
+// single-consumer queue and only signal the worker thread when it is asleep.
+// Delayed tasks are kept in a timer wheel that only the worker thread touches.
+// Meant for queues that many threads post to at a high rate.
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueLockFreeFactory();
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_TASK_QUEUE_LOCK_FREE_H_
@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_lock_free.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_test.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+INSTANTIATE_TEST_SUITE_P(LockFree,
+                         TaskQueueTest,
+                         ::testing::Values(CreateTaskQueueLockFreeFactory));
+
+std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateQueue(
+    absl::string_view name) {
+  return CreateTaskQueueLockFreeFactory()->CreateTaskQueue(
+      name, TaskQueueFactory::Priority::NORMAL);
+}
+
+TEST(TaskQueueLockFreeTest, KeepsPostingOrderOfEachProducer) {
+  constexpr int kNumProducers = 8;
+  constexpr int kTasksPerProducer = 10000;
+  auto queue = CreateQueue("KeepsPostingOrderOfEachProducer");
+
+  struct Producer {
+    TaskQueueBase* queue;
+    // Only touched on |queue|.
+    int last_run = -1;
+    bool in_order = true;
+  };
+  std::vector<Producer> producers(kNumProducers, Producer{queue.get()});
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (Producer& producer : producers) {
+    threads.push_back(std::make_unique<rtc::PlatformThread>(
+        [](void* context) {
+          Producer* producer = static_cast<Producer*>(context);
+          for (int i = 0; i < kTasksPerProducer; ++i) {
+            producer->queue->PostTask(ToQueuedTask([producer, i] {
+              producer->in_order &= producer->last_run == i - 1;
+              producer->last_run = i;
+            }));
+          }
+        },
+        &producer, "Producer"));
+  }
+  for (auto& thread : threads)
+    thread->Start();
+  for (auto& thread : threads)
+    thread->Stop();
+
+  rtc::Event done;
+  queue->PostTask(ToQueuedTask([&done] { done.Set(); }));
+  ASSERT_TRUE(done.Wait(10000));
+  for (const Producer& producer : producers) {
+    EXPECT_TRUE(producer.in_order);
+    EXPECT_EQ(producer.last_run, kTasksPerProducer - 1);
+  }
+}
+
+TEST(TaskQueueLockFreeTest, RunsDelayedTasksInDueTimeOrder) {
+  auto queue = CreateQueue("RunsDelayedTasksInDueTimeOrder");
+  std::vector<int> order;
+  rtc::Event done;
+  // Posted from the queue so that the due times are relative to the same
+  // point in time, give or take a millisecond.
+  queue->PostTask(ToQueuedTask([&] {
+    queue->PostDelayedTask(ToQueuedTask([&order] { order.push_back(3); }),
+                           30);
+    queue->PostDelayedTask(ToQueuedTask([&order] { order.push_back(1); }),
+                           10);
+    queue->PostDelayedTask(ToQueuedTask([&order] { order.push_back(2); }),
+                           20);
+    queue->PostDelayedTask(ToQueuedTask([&order] { order.push_back(4); }),
+                           30);
+    queue->PostDelayedTask(ToQueuedTask([&done] { done.Set(); }), 40);
+  }));
+  ASSERT_TRUE(done.Wait(1000));
+  EXPECT_EQ(order, std::vector<int>({1, 2, 3, 4}));
+}
+
+TEST(TaskQueueLockFreeTest, RunsTaskDelayedBeyondOneTurnOfTheTimerWheel) {
+  auto queue = CreateQueue("RunsTaskDelayedBeyondOneTurnOfTheTimerWheel");
+  rtc::Event short_done;
+  rtc::Event long_done;
+  int64_t start_ms = rtc::TimeMillis();
+  int64_t long_done_ms = 0;
+  // The wheel has 512 one millisecond slots, so both tasks use the same slot.
+  queue->PostDelayedTask(ToQueuedTask([&] {
+                           long_done_ms = rtc::TimeMillis();
+                           long_done.Set();
+                         }),
+                         612);
+  queue->PostDelayedTask(ToQueuedTask([&short_done] { short_done.Set(); }),
+                         100);
+  ASSERT_TRUE(short_done.Wait(1000));
+  EXPECT_FALSE(long_done.Wait(0));
+  ASSERT_TRUE(long_done.Wait(2000));
+  EXPECT_GE(long_done_ms - start_ms, 612);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "api/units/time_delta.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/location.h"
+#include "rtc_base/null_socket_server.h"
+#include "rtc_base/random.h"
+#include "rtc_base/thread.h"
+
+namespace rtc {
+namespace {
+
+// Roughly what a busy relay thread has pending in STUN retransmissions, TURN
+// refreshes and connection pings.
+constexpr int kNumPendingTimers = 100000;
+constexpr int kMaxDelayMs = 30000;
+
+class NullHandler : public MessageHandler {
+ public:
+  void OnMessage(Message* msg) override {}
+};
+
+// A thread that is never started, so that the benchmarks can pull messages
+// off it directly.
+class TimerThread {
+ public:
+  TimerThread()
+      : random_(1234), thread_(std::make_unique<NullSocketServer>()) {}
+
+  Thread& thread() { return thread_; }
+  int RandomDelayMs() { return random_.Rand(1, kMaxDelayMs); }
+
+  void PostTimers(std::vector<NullHandler>& handlers) {
+    for (NullHandler& handler : handlers)
+      thread_.PostDelayed(RTC_FROM_HERE, RandomDelayMs(), &handler);
+  }
+
+ private:
+  webrtc::Random random_;
+  Thread thread_;
+};
+
+// A short lived timer on a thread with many pending ones, like a STUN request
+// that is answered before it needs to be retransmitted. Its handler clears it
+// when destroyed.
+void BM_ThreadPostAndClearDelayed(benchmark::State& state) {
+  std::vector<NullHandler> handlers(kNumPendingTimers);
+  TimerThread timers;
+  timers.PostTimers(handlers);
+  for (auto s : state) {
+    NullHandler handler;
+    timers.thread().PostDelayed(RTC_FROM_HERE, timers.RandomDelayMs(),
+                                &handler);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ThreadPostAndClearDelayed);
+
+// Many periodic timers, each rescheduled when it fires, with time moving
+// forward a millisecond at a time.
+void BM_ThreadRunPeriodicTimers(benchmark::State& state) {
+  ScopedBaseFakeClock clock;
+  clock.AdvanceTime(webrtc::TimeDelta::Seconds(1));
+  std::vector<NullHandler> handlers(kNumPendingTimers);
+  TimerThread timers;
+  timers.PostTimers(handlers);
+  int64_t num_fired = 0;
+  for (auto s : state) {
+    clock.AdvanceTime(webrtc::TimeDelta::Millis(1));
+    Message msg;
+    while (timers.thread().Get(&msg, 0)) {
+      timers.thread().PostDelayed(RTC_FROM_HERE, timers.RandomDelayMs(),
+                                  msg.phandler);
+      ++num_fired;
+    }
+  }
+  state.SetItemsProcessed(num_fired);
+}
+
+BENCHMARK(BM_ThreadRunPeriodicTimers);
+
+}  // namespace
+}  // namespace rtc
@@ -0,0 +1,201 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "rtc_tools/network_controller_replay/log_replay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_tools/rtc_event_log_visualizer/log_simulation.h"
+
+namespace webrtc {
+namespace {
+
+constexpr double kDelayPercentile = 0.95;
+
+// The logs to replay, shared by the replay threads. Each thread takes the next
+// log that is not yet taken, until none remain.
+class ParallelReplay {
+ public:
+  ParallelReplay(
+      const std::vector<std::string>& log_files,
+      std::function<std::unique_ptr<NetworkControllerFactoryInterface>()>
+          factory_builder,
+      std::function<void(size_t, LogReplayResult)> result_handler)
+      : log_files_(log_files),
+        factory_builder_(std::move(factory_builder)),
+        result_handler_(std::move(result_handler)) {}
+
+  static void Run(void* obj) {
+    ParallelReplay* replay = static_cast<ParallelReplay*>(obj);
+    for (size_t index = replay->next_index_.fetch_add(1);
+         index < replay->log_files_.size();
+         index = replay->next_index_.fetch_add(1)) {
+      replay->result_handler_(
+          index,
+          ReplayLog(replay->log_files_[index], replay->factory_builder_()));
+    }
+  }
+
+ private:
+  const std::vector<std::string>& log_files_;
+  const std::function<std::unique_ptr<NetworkControllerFactoryInterface>()>
+      factory_builder_;
+  const std::function<void(size_t, LogReplayResult)> result_handler_;
+  std::atomic<size_t> next_index_{0};
+};
+
+}  // namespace
+
+LogReplayMetricsCollector::LogReplayMetricsCollector() = default;
+LogReplayMetricsCollector::~LogReplayMetricsCollector() = default;
+
+void LogReplayMetricsCollector::AdvanceTime(Timestamp at_time) {
+  if (first_feedback_time_.IsFinite() && target_rate_ && at_time > last_time_)
+    target_size_ += *target_rate_ * (at_time - last_time_);
+  last_time_ = std::max(last_time_, at_time);
+}
+
+void LogReplayMetricsCollector::OnNetworkControlUpdate(
+    const NetworkControlUpdate& update,
+    Timestamp at_time) {
+  AdvanceTime(at_time);
+  if (update.target_rate) {
+    target_rate_ = update.target_rate->target_rate;
+    ++num_target_rate_updates_;
+  }
+}
+
+void LogReplayMetricsCollector::OnTransportPacketsFeedback(
+    const TransportPacketsFeedback& feedback) {
+  AdvanceTime(feedback.feedback_time);
+  // The packets of the first feedback were received before the measured
+  // duration starts.
+  const bool first_feedback = first_feedback_time_.IsInfinite();
+  if (first_feedback)
+    first_feedback_time_ = feedback.feedback_time;
+  last_feedback_time_ = feedback.feedback_time;
+  target_size_at_last_feedback_ = target_size_;
+
+  for (const PacketResult& packet : feedback.packet_feedbacks) {
+    ++num_packets_;
+    if (!packet.receive_time.IsFinite()) {
+      ++num_lost_packets_;
+      continue;
+    }
+    one_way_delays_.push_back(packet.receive_time -
+                              packet.sent_packet.send_time);
+    if (!first_feedback)
+      acknowledged_size_ += packet.sent_packet.size;
+  }
+}
+
+LogReplayMetrics LogReplayMetricsCollector::GetMetrics() const {
+  LogReplayMetrics metrics;
+  metrics.num_target_rate_updates = num_target_rate_updates_;
+  metrics.num_packets = num_packets_;
+  metrics.num_lost_packets = num_lost_packets_;
+  if (num_packets_ > 0)
+    metrics.loss_ratio = static_cast<double>(num_lost_packets_) / num_packets_;
+
+  if (last_feedback_time_ > first_feedback_time_) {
+    metrics.duration = last_feedback_time_ - first_feedback_time_;
+    metrics.mean_target_rate = target_size_at_last_feedback_ / metrics.duration;
+    metrics.acknowledged_rate = acknowledged_size_ / metrics.duration;
+    if (!target_size_at_last_feedback_.IsZero())
+      metrics.utilization = acknowledged_size_ / target_size_at_last_feedback_;
+  }
+
+  if (!one_way_delays_.empty()) {
+    std::vector<TimeDelta> delays = one_way_delays_;
+    const auto minmax = std::minmax_element(delays.begin(), delays.end());
+    const TimeDelta min_delay = *minmax.first;
+    const TimeDelta max_delay = *minmax.second;
+    TimeDelta sum = TimeDelta::Zero();
+    for (const TimeDelta& delay : delays)
+      sum += delay - min_delay;
+    metrics.mean_queue_delay = sum / delays.size();
+    metrics.max_queue_delay = max_delay - min_delay;
+    auto percentile =
+        delays.begin() +
+        static_cast<size_t>(kDelayPercentile * (delays.size() - 1));
+    std::nth_element(delays.begin(), percentile, delays.end());
+    metrics.p95_queue_delay = *percentile - min_delay;
+  }
+  return metrics;
+}
+
+LogReplayResult ReplayLog(
+    const ParsedRtcEventLog& parsed_log,
+    std::unique_ptr<NetworkControllerFactoryInterface> factory) {
+  LogReplayResult result;
+  LogReplayMetricsCollector metrics;
+  const Timestamp log_start = Timestamp::Micros(parsed_log.first_timestamp());
+  LogBasedNetworkControllerSimulation simulation(
+      std::move(factory),
+      [&](const NetworkControlUpdate& update, Timestamp at_time) {
+        metrics.OnNetworkControlUpdate(update, at_time);
+        if (update.target_rate) {
+          LogReplayTargetRate target_rate;
+          target_rate.log_time = at_time - log_start;
+          target_rate.target_rate = update.target_rate->target_rate;
+          target_rate.stable_target_rate =
+              update.target_rate->stable_target_rate;
+          result.target_rates.push_back(target_rate);
+        }
+      },
+      [&](const TransportPacketsFeedback& feedback) {
+        metrics.OnTransportPacketsFeedback(feedback);
+      });
+  simulation.ProcessEventsInLog(parsed_log);
+  result.metrics = metrics.GetMetrics();
+  return result;
+}
+
+LogReplayResult ReplayLog(
+    const std::string& log_file,
+    std::unique_ptr<NetworkControllerFactoryInterface> factory) {
+  ParsedRtcEventLog parsed_log(
+      ParsedRtcEventLog::UnconfiguredHeaderExtensions::
+          kAttemptWebrtcDefaultConfig,
+      /*allow_incomplete_log=*/true);
+  ParsedRtcEventLog::ParseStatus status = parsed_log.ParseFile(log_file);
+  if (!status.ok()) {
+    LogReplayResult result;
+    result.error = status.message();
+    return result;
+  }
+  return ReplayLog(parsed_log, std::move(factory));
+}
+
+void ReplayLogsInParallel(
+    const std::vector<std::string>& log_files,
+    int num_threads,
+    std::function<std::unique_ptr<NetworkControllerFactoryInterface>()>
+        factory_builder,
+    std::function<void(size_t, LogReplayResult)> result_handler) {
+  RTC_DCHECK_GT(num_threads, 0);
+  ParallelReplay replay(log_files, std::move(factory_builder),
+                        std::move(result_handler));
+  const size_t num_replay_threads =
+      std::min(log_files.size(), static_cast<size_t>(num_threads));
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (size_t i = 0; i < num_replay_threads; ++i) {
+    threads.push_back(std::make_unique<rtc::PlatformThread>(
+        &ParallelReplay::Run, &replay, "LogReplay" + std::to_string(i)));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_H_
+#define RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/transport/network_control.h"
+#include "api/transport/network_types.h"
+#include "api/units/data_rate.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+
+namespace webrtc {
+
+// Summary of replaying an RtcEventLog through a network controller. The
+// packets of the log were sent at the rates of the logged call, not at the
+// simulated target rate, so the delay and loss are those the logged transport
+// feedback reported, i.e. the network conditions the controller reacted to.
+struct LogReplayMetrics {
+  // From the first to the last transport feedback.
+  TimeDelta duration = TimeDelta::Zero();
+  int64_t num_target_rate_updates = 0;
+  // Time weighted over |duration|.
+  DataRate mean_target_rate = DataRate::Zero();
+  // Of the packets acknowledged as received over |duration|.
+  DataRate acknowledged_rate = DataRate::Zero();
+  // |acknowledged_rate| relative to |mean_target_rate|.
+  double utilization = 0;
+  int64_t num_packets = 0;
+  int64_t num_lost_packets = 0;
+  double loss_ratio = 0;
+  // One way delay above the smallest one of the log, as the clock offset
+  // between sender and receiver is unknown.
+  TimeDelta mean_queue_delay = TimeDelta::Zero();
+  TimeDelta p95_queue_delay = TimeDelta::Zero();
+  TimeDelta max_queue_delay = TimeDelta::Zero();
+};
+
+// Collects LogReplayMetrics from the updates of a network controller and the
+// transport feedback it was given, in the order the controller saw them.
+class LogReplayMetricsCollector {
+ public:
+  LogReplayMetricsCollector();
+  ~LogReplayMetricsCollector();
+
+  void OnNetworkControlUpdate(const NetworkControlUpdate& update,
+                              Timestamp at_time);
+  void OnTransportPacketsFeedback(const TransportPacketsFeedback& feedback);
+
+  LogReplayMetrics GetMetrics() const;
+
+ private:
+  // Integrates the target rate up to |at_time|.
+  void AdvanceTime(Timestamp at_time);
+
+  Timestamp first_feedback_time_ = Timestamp::PlusInfinity();
+  Timestamp last_feedback_time_ = Timestamp::MinusInfinity();
+  Timestamp last_time_ = Timestamp::MinusInfinity();
+  absl::optional<DataRate> target_rate_;
+  int64_t num_target_rate_updates_ = 0;
+  DataSize target_size_ = DataSize::Zero();
+  DataSize target_size_at_last_feedback_ = DataSize::Zero();
+  DataSize acknowledged_size_ = DataSize::Zero();
+  int64_t num_packets_ = 0;
+  int64_t num_lost_packets_ = 0;
+  std::vector<TimeDelta> one_way_delays_;
+};
+
+struct LogReplayTargetRate {
+  // Since the first event of the log.
+  TimeDelta log_time = TimeDelta::Zero();
+  DataRate target_rate = DataRate::Zero();
+  DataRate stable_target_rate = DataRate::Zero();
+};
+
+struct LogReplayResult {
+  // Empty if the log was replayed, otherwise why it could not be.
+  std::string error;
+  // Every target rate the controller set, in order.
+  std::vector<LogReplayTargetRate> target_rates;
+  LogReplayMetrics metrics;
+};
+
+// Replays the packets, feedback and reports of |parsed_log| through a
+// network controller created by |factory|.
+LogReplayResult ReplayLog(
+    const ParsedRtcEventLog& parsed_log,
+    std::unique_ptr<NetworkControllerFactoryInterface> factory);
+
+// As above, parsing the log from |log_file| first.
+LogReplayResult ReplayLog(
+    const std::string& log_file,
+    std::unique_ptr<NetworkControllerFactoryInterface> factory);
+
+// Replays |log_files| on up to |num_threads| threads, each log through a
+// controller of its own, from a factory created by |factory_builder|. As each
+// log is done, |result_handler| is called with its index in |log_files| and
+// its result, on the thread that replayed it. Both callbacks are therefore
+// called concurrently. Returns when all logs have been replayed.
+void ReplayLogsInParallel(
+    const std::vector<std::string>& log_files,
+    int num_threads,
+    std::function<std::unique_ptr<NetworkControllerFactoryInterface>()>
+        factory_builder,
+    std::function<void(size_t, LogReplayResult)> result_handler);
+
+}  // namespace webrtc
+
+#endif  // RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_H_
@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "rtc_tools/network_controller_replay/log_replay.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/rtc_event_log/rtc_event.h"
+#include "api/transport/goog_cc_factory.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
+#include "logging/rtc_event_log/events/rtc_event_rtcp_packet_incoming.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_outgoing.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+
+namespace webrtc {
+namespace {
+
+PacketResult ReceivedPacket(Timestamp send_time, TimeDelta one_way_delay) {
+  PacketResult packet;
+  packet.sent_packet.send_time = send_time;
+  packet.sent_packet.size = DataSize::Bytes(1000);
+  packet.receive_time = send_time + one_way_delay;
+  return packet;
+}
+
+PacketResult LostPacket(Timestamp send_time) {
+  PacketResult packet;
+  packet.sent_packet.send_time = send_time;
+  packet.sent_packet.size = DataSize::Bytes(1000);
+  return packet;
+}
+
+// Encodes a log of a 1 Mbps video stream over a 2 Mbps link with a one way
+// delay of 20 ms, with transport feedback for every packet, every 50 ms.
+std::string EncodeSyntheticLog(TimeDelta duration) {
+  constexpr TimeDelta kSendInterval = TimeDelta::Micros(9600);
+  constexpr TimeDelta kFeedbackInterval = TimeDelta::Millis(50);
+  constexpr TimeDelta kOneWayDelay = TimeDelta::Millis(20);
+  constexpr DataRate kLinkCapacity = DataRate::KilobitsPerSec(2000);
+  constexpr size_t kPayloadSize = 1180;
+
+  const Timestamp start_time = Timestamp::Seconds(1000);
+  rtc::ScopedBaseFakeClock clock;
+  clock.SetTime(start_time);
+  RtcEventLogEncoderNewFormat encoder;
+  std::string encoded =
+      encoder.EncodeLogStart(rtc::TimeMicros(), rtc::TimeUTCMicros());
+  std::deque<std::unique_ptr<RtcEvent>> events;
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<TransportSequenceNumber>(5);
+
+  Timestamp next_feedback_time = start_time + kFeedbackInterval;
+  Timestamp link_free_time = start_time;
+  std::vector<Timestamp> arrival_times;
+  uint16_t next_acked_sequence_number = 0;
+  uint8_t feedback_sequence_number = 0;
+  for (Timestamp now = start_time; now < start_time + duration;
+       now += kSendInterval) {
+    clock.SetTime(now);
+    RtpPacketToSend packet(&extensions);
+    const uint16_t sequence_number = arrival_times.size();
+    packet.SetSsrc(1234);
+    packet.SetSequenceNumber(sequence_number);
+    packet.SetExtension<TransportSequenceNumber>(sequence_number);
+    packet.SetPayloadSize(kPayloadSize);
+    packet.set_packet_type(RtpPacketMediaType::kVideo);
+    events.push_back(std::make_unique<RtcEventRtpPacketOutgoing>(
+        packet, PacedPacketInfo::kNotAProbe));
+    link_free_time = std::max(link_free_time, now) +
+                     DataSize::Bytes(packet.size()) / kLinkCapacity;
+    arrival_times.push_back(link_free_time + kOneWayDelay);
+
+    if (now + kSendInterval < next_feedback_time)
+      continue;
+    // Feedback for the packets that arrived by now, sent back with the same
+    // delay.
+    clock.SetTime(next_feedback_time);
+    const Timestamp received_before = next_feedback_time - kOneWayDelay;
+    uint16_t end = next_acked_sequence_number;
+    while (end < arrival_times.size() && arrival_times[end] <= received_before)
+      ++end;
+    next_feedback_time += kFeedbackInterval;
+    if (end == next_acked_sequence_number)
+      continue;
+    rtcp::TransportFeedback feedback;
+    feedback.SetMediaSsrc(1234);
+    feedback.SetBase(next_acked_sequence_number,
+                     arrival_times[next_acked_sequence_number].us());
+    feedback.SetFeedbackSequenceNumber(feedback_sequence_number++);
+    for (; next_acked_sequence_number < end; ++next_acked_sequence_number) {
+      feedback.AddReceivedPacket(
+          next_acked_sequence_number,
+          arrival_times[next_acked_sequence_number].us());
+    }
+    events.push_back(
+        std::make_unique<RtcEventRtcpPacketIncoming>(feedback.Build()));
+  }
+  encoded += encoder.EncodeBatch(events.begin(), events.end());
+  encoded += encoder.EncodeLogEnd(rtc::TimeMicros());
+  return encoded;
+}
+
+NetworkControlUpdate TargetRateUpdate(DataRate target_rate) {
+  NetworkControlUpdate update;
+  update.target_rate = TargetTransferRate();
+  update.target_rate->target_rate = target_rate;
+  return update;
+}
+
+TEST(LogReplayMetricsCollectorTest, ReportsLossAndQueueDelay) {
+  LogReplayMetricsCollector collector;
+  const Timestamp start = Timestamp::Seconds(10);
+  TransportPacketsFeedback feedback;
+  feedback.feedback_time = start + TimeDelta::Millis(200);
+  // One way delays of 100 to 119 ms, i.e. queue delays of 0 to 19 ms.
+  for (int i = 0; i < 20; ++i) {
+    feedback.packet_feedbacks.push_back(ReceivedPacket(
+        start + TimeDelta::Millis(i), TimeDelta::Millis(100 + i)));
+  }
+  feedback.packet_feedbacks.push_back(LostPacket(start));
+  collector.OnTransportPacketsFeedback(feedback);
+
+  feedback.feedback_time += TimeDelta::Millis(100);
+  feedback.packet_feedbacks.clear();
+  for (int i = 0; i < 3; ++i)
+    feedback.packet_feedbacks.push_back(LostPacket(start));
+  collector.OnTransportPacketsFeedback(feedback);
+
+  LogReplayMetrics metrics = collector.GetMetrics();
+  EXPECT_EQ(metrics.num_packets, 24);
+  EXPECT_EQ(metrics.num_lost_packets, 4);
+  EXPECT_DOUBLE_EQ(metrics.loss_ratio, 4.0 / 24);
+  EXPECT_EQ(metrics.mean_queue_delay, TimeDelta::Micros(9500));
+  EXPECT_EQ(metrics.p95_queue_delay, TimeDelta::Millis(18));
+  EXPECT_EQ(metrics.max_queue_delay, TimeDelta::Millis(19));
+}
+
+TEST(LogReplayMetricsCollectorTest, WeighsTargetRateByTime) {
+  LogReplayMetricsCollector collector;
+  const Timestamp start = Timestamp::Seconds(10);
+  TransportPacketsFeedback feedback;
+  feedback.feedback_time = start;
+  collector.OnNetworkControlUpdate(TargetRateUpdate(DataRate::BitsPerSec(1)),
+                                   start - TimeDelta::Seconds(1));
+  collector.OnNetworkControlUpdate(
+      TargetRateUpdate(DataRate::KilobitsPerSec(100)), start);
+  // Not counted, as it was received before the first feedback.
+  feedback.packet_feedbacks.push_back(
+      ReceivedPacket(start, TimeDelta::Millis(10)));
+  collector.OnTransportPacketsFeedback(feedback);
+
+  collector.OnNetworkControlUpdate(
+      TargetRateUpdate(DataRate::KilobitsPerSec(300)),
+      start + TimeDelta::Seconds(1));
+  feedback.feedback_time = start + TimeDelta::Seconds(2);
+  // 20 kB, i.e. 80 kbps over the two seconds.
+  feedback.packet_feedbacks.clear();
+  for (int i = 0; i < 20; ++i) {
+    feedback.packet_feedbacks.push_back(
+        ReceivedPacket(start + TimeDelta::Seconds(1), TimeDelta::Millis(10)));
+  }
+  collector.OnTransportPacketsFeedback(feedback);
+  // Not counted, as it is after the last feedback.
+  collector.OnNetworkControlUpdate(TargetRateUpdate(DataRate::BitsPerSec(1)),
+                                   start + TimeDelta::Seconds(3));
+
+  LogReplayMetrics metrics = collector.GetMetrics();
+  EXPECT_EQ(metrics.num_target_rate_updates, 4);
+  EXPECT_EQ(metrics.duration, TimeDelta::Seconds(2));
+  EXPECT_EQ(metrics.mean_target_rate, DataRate::KilobitsPerSec(200));
+  EXPECT_EQ(metrics.acknowledged_rate, DataRate::KilobitsPerSec(80));
+  EXPECT_DOUBLE_EQ(metrics.utilization, 0.4);
+}
+
+TEST(LogReplayMetricsCollectorTest, ReportsNothingWithoutFeedback) {
+  LogReplayMetricsCollector collector;
+  collector.OnNetworkControlUpdate(
+      TargetRateUpdate(DataRate::KilobitsPerSec(300)), Timestamp::Seconds(1));
+  LogReplayMetrics metrics = collector.GetMetrics();
+  EXPECT_EQ(metrics.num_target_rate_updates, 1);
+  EXPECT_EQ(metrics.duration, TimeDelta::Zero());
+  EXPECT_EQ(metrics.mean_target_rate, DataRate::Zero());
+  EXPECT_EQ(metrics.num_packets, 0);
+}
+
+TEST(LogReplayTest, ReplaysEachLogOnce) {
+  std::vector<std::string> log_files;
+  for (int i = 0; i < 20; ++i)
+    log_files.push_back("/nonexistent/log_" + std::to_string(i));
+
+  rtc::CriticalSection lock;
+  std::vector<int> times_replayed(log_files.size());
+  int factories_created = 0;
+  ReplayLogsInParallel(
+      log_files, /*num_threads=*/4,
+      [&] {
+        rtc::CritScope cs(&lock);
+        ++factories_created;
+        return std::make_unique<GoogCcNetworkControllerFactory>();
+      },
+      [&](size_t index, LogReplayResult result) {
+        EXPECT_FALSE(result.error.empty());
+        rtc::CritScope cs(&lock);
+        ++times_replayed[index];
+      });
+  EXPECT_EQ(factories_created, 20);
+  EXPECT_EQ(times_replayed, std::vector<int>(log_files.size(), 1));
+}
+
+TEST(LogReplayTest, ReplaysEncodedLog) {
+  const TimeDelta kDuration = TimeDelta::Seconds(10);
+  const std::string encoded_log = EncodeSyntheticLog(kDuration);
+  const std::string log_file =
+      test::TempFilename(test::OutputPath(), "log_replay_unittest");
+  FILE* file = fopen(log_file.c_str(), "wb");
+  ASSERT_TRUE(file);
+  fwrite(encoded_log.data(), 1, encoded_log.size(), file);
+  fclose(file);
+
+  LogReplayResult result = ReplayLog(
+      log_file, std::make_unique<GoogCcNetworkControllerFactory>());
+  remove(log_file.c_str());
+  ASSERT_TRUE(result.error.empty()) << result.error;
+
+  // The target rate starts out low and ramps up while the packets are
+  // acknowledged.
+  ASSERT_FALSE(result.target_rates.empty());
+  TimeDelta last_log_time = TimeDelta::Zero();
+  for (const LogReplayTargetRate& target_rate : result.target_rates) {
+    EXPECT_GE(target_rate.log_time, last_log_time);
+    EXPECT_LE(target_rate.log_time, kDuration);
+    EXPECT_GT(target_rate.target_rate, DataRate::Zero());
+    last_log_time = target_rate.log_time;
+  }
+  EXPECT_GT(result.target_rates.back().target_rate,
+            result.target_rates.front().target_rate);
+
+  const LogReplayMetrics& metrics = result.metrics;
+  EXPECT_EQ(metrics.num_target_rate_updates,
+            static_cast<int64_t>(result.target_rates.size()));
+  EXPECT_GT(metrics.num_packets, 1000);
+  EXPECT_EQ(metrics.num_lost_packets, 0);
+  EXPECT_GT(metrics.duration, kDuration - TimeDelta::Millis(200));
+  // Nothing queues, as the stream uses half of the link.
+  EXPECT_LT(metrics.max_queue_delay, TimeDelta::Millis(10));
+  EXPECT_GT(metrics.acknowledged_rate, DataRate::KilobitsPerSec(900));
+  EXPECT_LT(metrics.acknowledged_rate, DataRate::KilobitsPerSec(1100));
+}
+
+}  // namespace
+}  // namespace webrtc
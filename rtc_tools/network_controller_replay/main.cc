@@ -0,0 +1,234 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "api/transport/goog_cc_factory.h"
+#include "api/transport/network_control.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_tools/network_controller_replay/log_replay.h"
+#include "system_wrappers/include/cpu_info.h"
+#include "system_wrappers/include/field_trial.h"
+
+ABSL_FLAG(std::string,
+          log_list,
+          "",
+          "A file with the paths of RtcEventLogs to replay, one per line, in "
+          "addition to those given as arguments.");
+
+ABSL_FLAG(std::string,
+          output_dir,
+          ".",
+          "The directory to write summary.csv, and the target rates of each "
+          "log, to.");
+
+ABSL_FLAG(int,
+          num_threads,
+          0,
+          "The number of logs to replay in parallel. Defaults to the number of "
+          "cores.");
+
+ABSL_FLAG(bool,
+          write_target_rates,
+          true,
+          "Write the target rates of each log to <index>_<log name>.csv in "
+          "--output_dir.");
+
+ABSL_FLAG(bool,
+          feedback_only,
+          false,
+          "Run GoogCC in its packet feedback only mode.");
+
+ABSL_FLAG(
+    std::string,
+    force_fieldtrials,
+    "",
+    "Field trials control experimental feature code which can be forced. "
+    "E.g. running with --force_fieldtrials=WebRTC-FooFeature/Enabled/"
+    " will assign the group Enabled to field trial WebRTC-FooFeature. Multiple "
+    "trials are separated by \"/\"");
+
+namespace webrtc {
+namespace {
+
+std::string BaseName(const std::string& path) {
+  size_t separator = path.find_last_of("/\\");
+  return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+// Quotes |field| if it contains a separator, quote or line break, with the
+// quotes in it doubled, so that any log path or error message is one field.
+std::string CsvField(const std::string& field) {
+  if (field.find_first_of(",\"\r\n") == std::string::npos)
+    return field;
+  std::string quoted = "\"";
+  for (char c : field) {
+    if (c == '"')
+      quoted += '"';
+    quoted += c;
+  }
+  quoted += '"';
+  return quoted;
+}
+
+bool ReadLogList(const std::string& log_list,
+                 std::vector<std::string>* log_files) {
+  std::ifstream stream(log_list);
+  if (!stream.is_open())
+    return false;
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (!line.empty())
+      log_files->push_back(line);
+  }
+  return true;
+}
+
+bool WriteTargetRates(const std::string& file_name,
+                      const std::vector<LogReplayTargetRate>& target_rates) {
+  FILE* file = fopen(file_name.c_str(), "w");
+  if (!file)
+    return false;
+  fprintf(file, "time_ms,target_rate_bps,stable_target_rate_bps\n");
+  for (const LogReplayTargetRate& target_rate : target_rates) {
+    fprintf(file, "%lld,%lld,%lld\n",
+            static_cast<long long>(target_rate.log_time.ms()),        // NOLINT
+            static_cast<long long>(target_rate.target_rate.bps()),    // NOLINT
+            static_cast<long long>(                                   // NOLINT
+                target_rate.stable_target_rate.bps()));
+  }
+  fclose(file);
+  return true;
+}
+
+bool WriteSummary(const std::string& file_name,
+                  const std::vector<std::string>& log_files,
+                  const std::vector<LogReplayResult>& results) {
+  FILE* file = fopen(file_name.c_str(), "w");
+  if (!file)
+    return false;
+  fprintf(file,
+          "index,log,error,duration_s,target_rate_updates,"
+          "mean_target_rate_kbps,acknowledged_rate_kbps,utilization,packets,"
+          "lost_packets,loss_ratio,mean_queue_delay_ms,p95_queue_delay_ms,"
+          "max_queue_delay_ms\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const LogReplayMetrics& metrics = results[i].metrics;
+    fprintf(file,
+            "%zu,%s,%s,%.3f,%lld,%.1f,%.1f,%.4f,%lld,%lld,%.4f,%.1f,%.1f,"
+            "%.1f\n",
+            i, CsvField(log_files[i]).c_str(),
+            CsvField(results[i].error).c_str(),
+            metrics.duration.seconds<double>(),
+            static_cast<long long>(metrics.num_target_rate_updates),  // NOLINT
+            metrics.mean_target_rate.kbps<double>(),
+            metrics.acknowledged_rate.kbps<double>(), metrics.utilization,
+            static_cast<long long>(metrics.num_packets),       // NOLINT
+            static_cast<long long>(metrics.num_lost_packets),  // NOLINT
+            metrics.loss_ratio, metrics.mean_queue_delay.ms<double>(),
+            metrics.p95_queue_delay.ms<double>(),
+            metrics.max_queue_delay.ms<double>());
+  }
+  fclose(file);
+  return true;
+}
+
+}  // namespace
+}  // namespace webrtc
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Replays RtcEventLogs through GoogCC, without plotting, and writes the "
+      "simulated target rates and a summary of each log as CSV.\n"
+      "Example usage:\n"
+      "./network_controller_replay --output_dir=out --log_list=logs.txt\n");
+  std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+
+  // Print RTC_LOG warnings and errors even in release builds.
+  if (rtc::LogMessage::GetLogToDebug() > rtc::LS_WARNING) {
+    rtc::LogMessage::LogToDebug(rtc::LS_WARNING);
+  }
+  rtc::LogMessage::SetLogToStderr(true);
+
+  // InitFieldTrialsFromString stores the char*, so the char array must outlive
+  // the application.
+  const std::string field_trials = absl::GetFlag(FLAGS_force_fieldtrials);
+  webrtc::field_trial::InitFieldTrialsFromString(field_trials.c_str());
+
+  std::vector<std::string> log_files(args.begin() + 1, args.end());
+  const std::string log_list = absl::GetFlag(FLAGS_log_list);
+  if (!log_list.empty() && !webrtc::ReadLogList(log_list, &log_files)) {
+    std::cerr << "Failed to read " << log_list << std::endl;
+    return 1;
+  }
+  if (log_files.empty()) {
+    std::cerr << absl::ProgramUsageMessage();
+    return 1;
+  }
+
+  int num_threads = absl::GetFlag(FLAGS_num_threads);
+  if (num_threads <= 0)
+    num_threads = webrtc::CpuInfo::DetectNumberOfCores();
+  const std::string output_dir = absl::GetFlag(FLAGS_output_dir);
+  const bool write_target_rates = absl::GetFlag(FLAGS_write_target_rates);
+  const bool feedback_only = absl::GetFlag(FLAGS_feedback_only);
+
+  rtc::CriticalSection lock;
+  std::vector<webrtc::LogReplayResult> results(log_files.size());
+  const int64_t start_ms = rtc::TimeMillis();
+  webrtc::ReplayLogsInParallel(
+      log_files, num_threads,
+      [feedback_only] {
+        webrtc::GoogCcFactoryConfig config;
+        config.feedback_only = feedback_only;
+        return std::make_unique<webrtc::GoogCcNetworkControllerFactory>(
+            std::move(config));
+      },
+      [&](size_t index, webrtc::LogReplayResult result) {
+        if (!result.error.empty()) {
+          RTC_LOG(LS_WARNING) << "Failed to replay " << log_files[index] << ": "
+                              << result.error;
+        } else if (write_target_rates) {
+          const std::string file_name = output_dir + "/" +
+                                        std::to_string(index) + "_" +
+                                        webrtc::BaseName(log_files[index]) +
+                                        ".csv";
+          if (!webrtc::WriteTargetRates(file_name, result.target_rates))
+            RTC_LOG(LS_WARNING) << "Failed to write " << file_name;
+        }
+        // The time series are written, only the summary is kept.
+        result.target_rates.clear();
+        result.target_rates.shrink_to_fit();
+        rtc::CritScope cs(&lock);
+        results[index] = std::move(result);
+      });
+
+  const std::string summary_file = output_dir + "/summary.csv";
+  if (!webrtc::WriteSummary(summary_file, log_files, results)) {
+    std::cerr << "Failed to write " << summary_file << std::endl;
+    return 1;
+  }
+  std::cerr << "Replayed " << log_files.size() << " logs on " << num_threads
+            << " threads in " << (rtc::TimeMillis() - start_ms) << " ms."
+            << std::endl;
+  return 0;
+}
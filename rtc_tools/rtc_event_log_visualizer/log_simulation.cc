@@ -20,7 +20,17 @@ namespace webrtc {
 LogBasedNetworkControllerSimulation::LogBasedNetworkControllerSimulation(
     std::unique_ptr<NetworkControllerFactoryInterface> factory,
     std::function<void(const NetworkControlUpdate&, Timestamp)> update_handler)
-    : update_handler_(update_handler), factory_(std::move(factory)) {}
+    : LogBasedNetworkControllerSimulation(std::move(factory),
+                                          std::move(update_handler),
+                                          nullptr) {}
+
+LogBasedNetworkControllerSimulation::LogBasedNetworkControllerSimulation(
+    std::unique_ptr<NetworkControllerFactoryInterface> factory,
+    std::function<void(const NetworkControlUpdate&, Timestamp)> update_handler,
+    std::function<void(const TransportPacketsFeedback&)> feedback_handler)
+    : update_handler_(std::move(update_handler)),
+      feedback_handler_(std::move(feedback_handler)),
+      factory_(std::move(factory)) {}
 
 LogBasedNetworkControllerSimulation::~LogBasedNetworkControllerSimulation() {}
 
@@ -108,10 +118,13 @@ void LogBasedNetworkControllerSimulation::OnFeedback(
     const LoggedRtcpPacketTransportFeedback& feedback) {
   auto feedback_time = Timestamp::Millis(feedback.log_time_ms());
   ProcessUntil(feedback_time);
-  auto msg = transport_feedback_.ProcessTransportFeedback(
-      feedback.transport_feedback, feedback_time);
-  if (msg)
-    HandleStateUpdate(controller_->OnTransportPacketsFeedback(*msg));
+  if (!transport_feedback_.ProcessTransportFeedback(
+          feedback.transport_feedback, feedback_time, &feedback_msg_)) {
+    return;
+  }
+  if (feedback_handler_)
+    feedback_handler_(feedback_msg_);
+  HandleStateUpdate(controller_->OnTransportPacketsFeedback(feedback_msg_));
 }
 
 void LogBasedNetworkControllerSimulation::OnReceiverReport(
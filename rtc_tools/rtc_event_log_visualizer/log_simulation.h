@@ -28,6 +28,13 @@ class LogBasedNetworkControllerSimulation {
       std::unique_ptr<NetworkControllerFactoryInterface> factory,
       std::function<void(const NetworkControlUpdate&, Timestamp)>
           update_handler);
+  // As above, but |feedback_handler| is also given each transport feedback
+  // that is passed to the controller.
+  LogBasedNetworkControllerSimulation(
+      std::unique_ptr<NetworkControllerFactoryInterface> factory,
+      std::function<void(const NetworkControlUpdate&, Timestamp)>
+          update_handler,
+      std::function<void(const TransportPacketsFeedback&)> feedback_handler);
   ~LogBasedNetworkControllerSimulation();
   void ProcessEventsInLog(const ParsedRtcEventLog& parsed_log_);
 
@@ -49,12 +56,15 @@ class LogBasedNetworkControllerSimulation {
 
   const std::function<void(const NetworkControlUpdate&, Timestamp)>
       update_handler_;
+  const std::function<void(const TransportPacketsFeedback&)>
+      feedback_handler_;
   std::unique_ptr<NetworkControllerFactoryInterface> factory_;
   std::unique_ptr<NetworkControllerInterface> controller_;
 
   Timestamp current_time_ = Timestamp::MinusInfinity();
   Timestamp last_process_ = Timestamp::MinusInfinity();
   TransportFeedbackAdapter transport_feedback_;
+  TransportPacketsFeedback feedback_msg_;
   std::deque<ProbingStatus> pending_probes_;
   std::map<uint32_t, rtcp::ReportBlock> last_report_blocks_;
   Timestamp last_report_block_time_ = Timestamp::MinusInfinity();
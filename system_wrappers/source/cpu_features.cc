@@ -10,6 +10,8 @@
 
 // Parts of this file derived from Chromium's base/cpu.cc.
 
+#include <stdint.h>
+
 #include "rtc_base/system/arch.h"
 #include "system_wrappers/include/cpu_features_wrapper.h"
 
@@ -45,6 +47,38 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
 }
 #endif
 #endif  // _MSC_VER
+
+// Same as __cpuid(), but also sets the sub-leaf in ecx as needed for leaf 7.
+static inline void CpuIdEx(int cpu_info[4], int info_type, int sub_leaf) {
+#if defined(_MSC_VER)
+  __cpuidex(cpu_info, info_type, sub_leaf);
+#elif defined(__pic__) && defined(__i386__)
+  __asm__ volatile(
+      "mov %%ebx, %%edi\n"
+      "cpuid\n"
+      "xchg %%edi, %%ebx\n"
+      : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]),
+        "=d"(cpu_info[3])
+      : "a"(info_type), "c"(sub_leaf));
+#else
+  __asm__ volatile("cpuid\n"
+                   : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]),
+                     "=d"(cpu_info[3])
+                   : "a"(info_type), "c"(sub_leaf));
+#endif
+}
+
+// xgetbv returns the value of an Intel Extended Control Register (XCR).
+// Currently only XCR0 is defined by Intel so |xcr| should always be zero.
+static inline uint64_t XGetBv(uint32_t xcr) {
+#if defined(_MSC_VER)
+  return _xgetbv(xcr);
+#else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
@@ -58,6 +92,28 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  if (feature == kPCLMUL) {
+    return 0 != (cpu_info[2] & 0x00000002);
+  }
+  if (feature == kAVX2) {
+    // AVX instructions can be used when AVX and XSAVE are supported by the
+    // CPU and the kernel saves the YMM registers on context switches.
+    // See http://software.intel.com/en-us/blogs/2011/04/14/is-avx-enabled
+    const bool avx_supported = (cpu_info[2] & 0x10000000) != 0 &&
+                               (cpu_info[2] & 0x04000000) != 0 /* XSAVE */ &&
+                               (cpu_info[2] & 0x08000000) != 0 /* OSXSAVE */;
+    if (!avx_supported || (XGetBv(0) & 0x00000006) != 6) {
+      return 0;
+    }
+    int max_info[4];
+    __cpuid(max_info, 0);
+    if (max_info[0] < 7) {
+      return 0;
+    }
+    int extended_info[4];
+    CpuIdEx(extended_info, 7, 0);
+    return 0 != (extended_info[1] & 0x00000020);
+  }
   return 0;
 }
 #else
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/allocation_counter.h"
+
+#include <cstddef>
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+// Each block is prefixed with its size, so that it can be subtracted again
+// when it is freed.
+namespace {
+
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+std::atomic<int64_t> g_allocated_bytes(0);
+std::atomic<int64_t> g_num_allocations(0);
+
+void* CountedAlloc(size_t size) {
+  void* block = malloc(size + kHeaderSize);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *static_cast<size_t*>(block) = size;
+  g_allocated_bytes += size;
+  ++g_num_allocations;
+  return static_cast<char*>(block) + kHeaderSize;
+}
+
+void CountedFree(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  void* block = static_cast<char*>(ptr) - kHeaderSize;
+  g_allocated_bytes -= *static_cast<size_t*>(block);
+  free(block);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+  return CountedAlloc(size);
+}
+void* operator new[](size_t size) {
+  return CountedAlloc(size);
+}
+void operator delete(void* ptr) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+  CountedFree(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+  CountedFree(ptr);
+}
+
+namespace webrtc {
+namespace test {
+
+int64_t AllocatedBytes() {
+  return g_allocated_bytes.load();
+}
+
+int64_t NumAllocations() {
+  return g_num_allocations.load();
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,33 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef TEST_ALLOCATION_COUNTER_H_
+#define TEST_ALLOCATION_COUNTER_H_
+
+#include <stdint.h>
+
+namespace webrtc {
+namespace test {
+
+// Linking in allocation_counter.cc replaces the global operator new and
+// delete with ones that count the allocations of the whole binary, for
+// benchmarks and tests that check how much code allocates. It should only be
+// linked into the benchmarks and allocation_tests binaries, and only once.
+
+// Returns the number of bytes currently allocated with operator new.
+int64_t AllocatedBytes();
+
+// Returns the number of calls to operator new so far.
+int64_t NumAllocations();
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // TEST_ALLOCATION_COUNTER_H_
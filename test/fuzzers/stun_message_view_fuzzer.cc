@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "api/transport/stun.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/socket_address.h"
+
+namespace webrtc {
+void FuzzOneInput(const uint8_t* data, size_t size) {
+  const char* message = reinterpret_cast<const char*>(data);
+
+  cricket::StunMessageView view;
+  if (!view.Parse(message, size)) {
+    RTC_CHECK(view.empty());
+    return;
+  }
+
+  // Every attribute has to lie within the message.
+  size_t num_attributes = 0;
+  for (const cricket::StunMessageView::Attribute& attribute : view) {
+    if (!attribute.value.empty()) {
+      RTC_CHECK_GE(attribute.value.data(), data + cricket::kStunHeaderSize);
+      RTC_CHECK_LE(attribute.value.data() + attribute.value.size(),
+                   data + size);
+    }
+    ++num_attributes;
+  }
+
+  absl::string_view username;
+  view.GetByteString(cricket::STUN_ATTR_USERNAME, &username);
+  uint32_t priority;
+  view.GetUInt32(cricket::STUN_ATTR_PRIORITY, &priority);
+  uint64_t tie_breaker;
+  view.GetUInt64(cricket::STUN_ATTR_ICE_CONTROLLING, &tie_breaker);
+  rtc::SocketAddress address;
+  view.GetXorAddress(cricket::STUN_ATTR_XOR_MAPPED_ADDRESS, &address);
+  view.ValidateFingerprint();
+  view.ValidateMessageIntegrity("");
+  view.ValidateMessageIntegrity32("");
+
+  // A StunMessage is built from the view, and can't hold more attributes.
+  cricket::IceMessage msg;
+  if (msg.Read(view)) {
+    RTC_CHECK_EQ(view.type(), msg.type());
+    RTC_CHECK_EQ(view.transaction_id(), msg.transaction_id());
+    RTC_CHECK_LE(msg.GetNonComprehendedAttributes().size(), num_attributes);
+  }
+}
+}  // namespace webrtc